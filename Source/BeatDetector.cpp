@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    BeatDetector.cpp
+    Created: 19 Oct 2026 7:24:16pm
+    Author:  Ophelia
+    Purpose: works out the tempo (BPM) and beat grid of a track from its decoded audio
+
+  ==============================================================================
+*/
+
+#include "BeatDetector.h"
+#include <cmath>
+
+/** Constructor: takes in the sample rate of the audio which will be passed to process() */
+BeatDetector::BeatDetector(double inputSampleRate)
+{
+    // 44.1/48kHz audio is halved to 22.05/24kHz, which still has every frequency that drums and notes start with
+    decimationFactor = juce::jmax(1, (int)(inputSampleRate / 20000.0));
+    analysisSampleRate = inputSampleRate / decimationFactor;
+    hopSize = juce::jmax(1, juce::roundToInt(analysisSampleRate / targetEnvelopeRate));
+    envelopeRate = analysisSampleRate / hopSize;
+
+    fftData.resize((size_t)fftSize * 2);
+    previousMagnitudes.resize((size_t)numBins);
+    flux.resize((size_t)numBins);
+}
+
+/** Adds the next block of the track's audio (mixed down to mono) to the onset envelope */
+void BeatDetector::process(const float* monoSamples, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        decimationSum += monoSamples[i];
+        if (++decimationCount == decimationFactor)
+        {
+            analysisSamples.push_back(decimationSum / (float)decimationFactor);
+            decimationSum = 0.0f;
+            decimationCount = 0;
+        }
+    }
+
+    processFrames();
+}
+
+/** Works out the spectral flux of every full frame of audio waiting in analysisSamples */
+void BeatDetector::processFrames()
+{
+    while (analysisSamples.size() - readPosition >= (size_t)fftSize)
+    {
+        // The frames overlap, as the hop between them is much shorter than a frame
+        std::fill(fftData.begin(), fftData.end(), 0.0f);
+        juce::FloatVectorOperations::copy(fftData.data(), analysisSamples.data() + readPosition, fftSize);
+        window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+        // Log magnitudes, so that a quiet hi-hat counts as an onset next to a loud bassline
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            fftData[(size_t)bin] = std::log1p(100.0f * fftData[(size_t)bin]);
+        }
+
+        // Spectral flux: only the frequencies which got louder count, as a note dying away is not an onset
+        float frameFlux = 0.0f;
+        if (hasPreviousFrame)
+        {
+            juce::FloatVectorOperations::subtract(flux.data(), fftData.data(), previousMagnitudes.data(), numBins);
+            juce::FloatVectorOperations::max(flux.data(), flux.data(), 0.0f, numBins);
+            for (float binFlux : flux)
+            {
+                frameFlux += binFlux;
+            }
+        }
+        juce::FloatVectorOperations::copy(previousMagnitudes.data(), fftData.data(), numBins);
+        hasPreviousFrame = true;
+
+        onsetEnvelope.push_back(frameFlux);
+        readPosition += (size_t)hopSize;
+    }
+
+    // Throws away the audio which every remaining frame is past, now and then rather than after every frame
+    if (readPosition >= 65536)
+    {
+        analysisSamples.erase(analysisSamples.begin(), analysisSamples.begin() + (std::ptrdiff_t)readPosition);
+        readPosition = 0;
+    }
+}
+
+/** Returns the onset envelope with its local average taken off, so only the peaks are left */
+std::vector<float> BeatDetector::getOnsetPeaks() const
+{
+    size_t numFrames = onsetEnvelope.size();
+
+    // Running totals, so the average of any window is a single subtraction
+    std::vector<double> runningTotals(numFrames + 1, 0.0);
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        runningTotals[i + 1] = runningTotals[i] + onsetEnvelope[i];
+    }
+
+    // The average is taken over about 0.4 seconds on either side, which is longer than a beat at the slowest tempo
+    size_t halfWindow = (size_t)juce::roundToInt(0.4 * envelopeRate);
+    std::vector<float> peaks(numFrames);
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+        size_t start = i > halfWindow ? i - halfWindow : 0;
+        size_t end = juce::jmin(numFrames, i + halfWindow + 1);
+        double average = (runningTotals[end] - runningTotals[start]) / (double)(end - start);
+        peaks[i] = juce::jmax(0.0f, onsetEnvelope[i] - (float)average);
+    }
+    return peaks;
+}
+
+/** Returns the envelope's value at a fractional frame position, interpolating between frames */
+float BeatDetector::interpolate(const std::vector<float>& envelope, double position)
+{
+    size_t frame = (size_t)position;
+    if (frame + 1 >= envelope.size())
+    {
+        return frame < envelope.size() ? envelope[frame] : 0.0f;
+    }
+    float fraction = (float)(position - (double)frame);
+    return envelope[frame] + fraction * (envelope[frame + 1] - envelope[frame]);
+}
+
+/** Works out the tempo and beat grid from all of the audio passed in so far */
+BeatDetector::BeatGrid BeatDetector::getBeatGrid() const
+{
+    // At least 10 seconds are needed to hear a steady beat
+    if ((double)onsetEnvelope.size() < 10.0 * envelopeRate)
+    {
+        return {};
+    }
+
+    std::vector<float> peaks = getOnsetPeaks();
+    size_t numFrames = peaks.size();
+
+    // Autocorrelation: how well the envelope lines up with itself shifted by one beat period, for every period in the tempo range.
+    // Periods are weighted by how far their tempo is from 120 BPM (in octaves), as half and double the real tempo line up nearly as well
+    int minLag = (int)std::floor(60.0 * envelopeRate / maxBpm);
+    int maxLag = (int)std::ceil(60.0 * envelopeRate / minBpm);
+    std::vector<double> weightedCorrelation((size_t)maxLag + 2, 0.0);
+    for (int lag = minLag; lag <= maxLag + 1; ++lag)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i + (size_t)lag < numFrames; ++i)
+        {
+            sum += (double)peaks[i] * (double)peaks[i + (size_t)lag];
+        }
+        double octavesFrom120 = std::log2((60.0 * envelopeRate / lag) / 120.0);
+        double weight = std::exp(-0.5 * std::pow(octavesFrom120 / 1.4, 2.0));
+        weightedCorrelation[(size_t)lag] = weight * sum / (double)(numFrames - (size_t)lag);
+    }
+
+    int bestLag = minLag;
+    for (int lag = minLag + 1; lag <= maxLag; ++lag)
+    {
+        if (weightedCorrelation[(size_t)lag] > weightedCorrelation[(size_t)bestLag])
+        {
+            bestLag = lag;
+        }
+    }
+    if (weightedCorrelation[(size_t)bestLag] <= 0.0)
+    {
+        return {};
+    }
+
+    // Fits a parabola through the best period and its neighbours, as the real period falls between two frames
+    double period = bestLag;
+    if (bestLag > minLag)
+    {
+        double before = weightedCorrelation[(size_t)bestLag - 1];
+        double at = weightedCorrelation[(size_t)bestLag];
+        double after = weightedCorrelation[(size_t)bestLag + 1];
+        double curvature = before - 2.0 * at + after;
+        if (curvature < 0.0)
+        {
+            period += juce::jlimit(-0.5, 0.5, 0.5 * (before - after) / curvature);
+        }
+    }
+
+    // Fine-tunes the period and finds the phase together: the grid which lands on the most onset energy over the whole track.
+    // An error of a hundredth of a frame in the period adds up to a whole frame after 100 beats, so it is searched in small steps
+    double bestScore = -1.0;
+    double bestPeriod = period;
+    double bestPhase = 0.0;
+    for (double candidatePeriod = period * 0.98; candidatePeriod <= period * 1.02; candidatePeriod += 0.01)
+    {
+        for (double phase = 0.0; phase < candidatePeriod; phase += 0.5)
+        {
+            double score = 0.0;
+            for (double position = phase; position < (double)numFrames; position += candidatePeriod)
+            {
+                score += interpolate(peaks, position);
+            }
+            // Normalised by the number of beats, so shorter periods (with more beats) are not favoured
+            score *= candidatePeriod;
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestPeriod = candidatePeriod;
+                bestPhase = phase;
+            }
+        }
+    }
+
+    // Most dance music is between 70 and 180 BPM, so a tempo outside that range is usually half or double the real one
+    double bpm = 60.0 * envelopeRate / bestPeriod;
+    while (bpm < 70.0)
+    {
+        bpm *= 2.0;
+    }
+    while (bpm >= 180.0)
+    {
+        bpm /= 2.0;
+    }
+    double beatFrames = 60.0 * envelopeRate / bpm;
+    bestPhase = std::fmod(bestPhase, beatFrames);
+
+    // Each envelope frame measures the onset at the centre of its FFT frame
+    BeatGrid grid;
+    grid.bpm = bpm;
+    grid.firstBeatSeconds = (bestPhase * hopSize + fftSize / 2) / analysisSampleRate;
+    return grid;
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    BeatDetector.h
+    Created: 19 Oct 2026 7:24:16pm
+    Author:  Ophelia
+    Purpose: works out the tempo (BPM) and beat grid of a track from its decoded audio
+
+  ==============================================================================
+  The audio is passed in block by block as it is decoded, so a whole track never has to be kept in memory.
+  It is turned into an onset envelope (the "spectral flux": how much louder each frequency got since the
+  previous frame, added up over all frequencies), which has a peak wherever a note or drum hit starts.
+  The tempo is the beat period which best lines up with the envelope's peaks (found by autocorrelation,
+  favouring tempos around 120 BPM so that half or double the real tempo is rarely picked), and the beat
+  grid is the period and phase which land on the most onsets across the whole track.
+  Attribution: D. Ellis, "Beat Tracking by Dynamic Programming", Journal of New Music Research 36(1), 2007,
+  for the onset envelope and the tempo weighting.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class BeatDetector
+{
+public:
+    /** The tempo and beat grid of a track. A bpm of 0 means no steady beat was found */
+    struct BeatGrid
+    {
+        // The tempo in beats per minute
+        double bpm = 0.0;
+        // The time of the first beat in seconds: beat n is at firstBeatSeconds + n * 60 / bpm
+        double firstBeatSeconds = 0.0;
+    };
+
+    /** Constructor: takes in the sample rate of the audio which will be passed to process() */
+    explicit BeatDetector(double inputSampleRate);
+
+    /** Adds the next block of the track's audio (mixed down to mono) to the onset envelope */
+    void process(const float* monoSamples, int numSamples);
+
+    /** Works out the tempo and beat grid from all of the audio passed in so far */
+    BeatGrid getBeatGrid() const;
+
+private:
+    /** Works out the spectral flux of every full frame of audio waiting in analysisSamples */
+    void processFrames();
+
+    /** Returns the onset envelope with its local average taken off, so only the peaks are left */
+    std::vector<float> getOnsetPeaks() const;
+
+    /** Returns the envelope's value at a fractional frame position, interpolating between frames */
+    static float interpolate(const std::vector<float>& envelope, double position);
+
+    // The size of each FFT frame: 2^10 = 1024 samples (about 46 ms at the analysis sample rate)
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    // The number of onset envelope frames per second which the hop size aims for
+    static constexpr double targetEnvelopeRate = 100.0;
+
+    // The range of tempos which are searched, in BPM
+    static constexpr double minBpm = 60.0;
+    static constexpr double maxBpm = 200.0;
+
+    // The audio is averaged down by this factor before the FFT, as onsets do not need the highest frequencies
+    int decimationFactor;
+    double analysisSampleRate;
+    int hopSize;
+    double envelopeRate;
+
+    // The running total and count of the input samples being averaged into the next analysis sample
+    float decimationSum = 0.0f;
+    int decimationCount = 0;
+
+    // The decimated audio which has not been made into full frames yet, starting at readPosition
+    std::vector<float> analysisSamples;
+    size_t readPosition = 0;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+
+    // The FFT's working buffer (twice the frame size, as the FFT needs), and the last frame's log magnitudes
+    std::vector<float> fftData;
+    std::vector<float> previousMagnitudes;
+    std::vector<float> flux;
+    bool hasPreviousFrame = false;
+
+    // The spectral flux of every frame so far
+    std::vector<float> onsetEnvelope;
+};
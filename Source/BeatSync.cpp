@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    BeatSync.cpp
+    Created: 19 Oct 2026 9:48:12pm
+    Author:  Ophelia
+    Purpose: works out the speed a synced deck plays at, so its beats match the leader deck's tempo and stay in phase with them
+
+  ==============================================================================
+*/
+
+#include "BeatSync.h"
+#include <cmath>
+
+/**
+ *Works out the follower's speed ratio for its next audio block, from both decks' positions in beats at the start of
+ *the block (counted along their beat grids), their tempos in beats per second (the leader's at the speed it plays at,
+ *and the follower's at its normal speed), and the length of the block in seconds
+ */
+double BeatSync::getSpeedRatio(double leaderBeat, double leaderBeatsPerSecond, double followerBeat, double followerBeatsPerSecond, double blockSeconds)
+{
+    if (leaderBeatsPerSecond <= 0.0 || followerBeatsPerSecond <= 0.0)
+    {
+        return 1.0;
+    }
+
+    // The speed which plays the follower's beats as fast as the leader's, halved or doubled until it is between
+    // 2/3 and 4/3, so each of the follower's beats may stand for two (or half) of the leader's
+    double tempoRatio = leaderBeatsPerSecond / followerBeatsPerSecond;
+    double leaderBeatsPerFollowerBeat = 1.0;
+    while (tempoRatio > 4.0 / 3.0)
+    {
+        tempoRatio /= 2.0;
+        leaderBeatsPerFollowerBeat *= 2.0;
+    }
+    while (tempoRatio < 2.0 / 3.0)
+    {
+        tempoRatio *= 2.0;
+        leaderBeatsPerFollowerBeat /= 2.0;
+    }
+
+    // How far the follower is behind the nearest of the leader's beats, in the leader's beats and then in seconds
+    double beatError = leaderBeat - followerBeat * leaderBeatsPerFollowerBeat;
+    beatError -= std::floor(beatError + 0.5);
+    phaseError = beatError / leaderBeatsPerSecond;
+
+    // While the correction is at its limit the error isn't added up, so it doesn't overshoot once it has been pulled in
+    double correction = proportionalGain * phaseError + integralGain * integratedError;
+    if (std::abs(correction) < maxCorrection)
+    {
+        integratedError += phaseError * blockSeconds;
+    }
+    correction = juce::jlimit(-maxCorrection, maxCorrection, correction);
+
+    return tempoRatio * (1.0 + correction);
+}
+
+/** Forgets the control loop's history, when the follower starts following a leader (or the leader stops) */
+void BeatSync::reset()
+{
+    phaseError = 0.0;
+    integratedError = 0.0;
+}
+
+/** Returns how far the follower's beats were behind the leader's at the start of the last block, in seconds (negative if ahead) */
+double BeatSync::getPhaseError() const
+{
+    return phaseError;
+}
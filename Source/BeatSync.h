@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    BeatSync.h
+    Created: 19 Oct 2026 9:48:12pm
+    Author:  Ophelia
+    Purpose: works out the speed a synced deck plays at, so its beats match the leader deck's tempo and stay in phase with them
+
+  ==============================================================================
+  The tempo is matched by playing the follower's beats as fast as the leader's (a track of half or double the tempo
+  is matched beat for two beats, rather than played at half or double speed). Whatever phase error is left (from
+  syncing in the middle of a beat, the leader changing speed, or the follower's position drifting as it is resampled)
+  is corrected by a proportional-integral control loop, called once per audio block, which nudges the speed a fraction
+  of a percent up or down rather than jumping, so the correction can't be heard.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class BeatSync
+{
+public:
+    /**
+     *Works out the follower's speed ratio for its next audio block, from both decks' positions in beats at the start of
+     *the block (counted along their beat grids), their tempos in beats per second (the leader's at the speed it plays at,
+     *and the follower's at its normal speed), and the length of the block in seconds
+     */
+    double getSpeedRatio(double leaderBeat, double leaderBeatsPerSecond, double followerBeat, double followerBeatsPerSecond, double blockSeconds);
+
+    /** Forgets the control loop's history, when the follower starts following a leader (or the leader stops) */
+    void reset();
+
+    /** Returns how far the follower's beats were behind the leader's at the start of the last block, in seconds (negative if ahead) */
+    double getPhaseError() const;
+
+private:
+    // The speed change per second of phase error (2 means a 10ms error plays 2% faster), and per second of error held
+    // for a second. Together they pull a small error in within a couple of seconds without overshooting by more than
+    // a millisecond or so (a large one is pulled in at the correction limit, about 100ms every 5 seconds)
+    static constexpr double proportionalGain = 2.0;
+    static constexpr double integralGain = 1.0;
+
+    // The largest correction, as a fraction of the matched speed: about a third of a semitone, which a listener won't notice
+    static constexpr double maxCorrection = 0.02;
+
+    // The phase error of the last block in seconds, and the sum of the phase error over time
+    double phaseError = 0.0;
+    double integratedError = 0.0;
+};
@@ -73,6 +73,34 @@ void CSVHelper::writeTracksDataIntoCSVFile(std::vector<Track>& tracks)
     }
 }
 
+/**
+ * Appends the data of newly imported tracks to the end of the CSV File,
+ * without rewriting the tracks which are already stored in it.
+*/
+void CSVHelper::appendTracksDataToCSVFile(std::vector<Track>& newTracks)
+{
+    // Gets the file object from the stored path to file
+    juce::File targetFile = juce::File(filePath);
+
+    // A FileOutputStream starts writing at the end of an existing file, so the stored tracks are kept
+    juce::FileOutputStream stream(targetFile);
+
+    if (stream.openedOk())
+    {
+        // Each row is written separately, as readTracksDataFromCSVFile() reads the rows back one null-terminated string at a time
+        // (the FileOutputStream buffers these writes, so a bulk import still only makes a few writes to disk)
+        for (Track& track : newTracks)
+        {
+            stream.writeString(trackToCSV(track));
+        }
+    }
+    // Print DBG error message if stream could not be opened
+    else
+    {
+        DBG("CSVHelper::appendTracksDataToCSVFile - could not open file write stream!");
+    }
+}
+
 /**
  * Reads rows (1 track per row) from the trackdata CSV file and
  * outputs a vector of Tracks to store in the Playlist
@@ -122,9 +150,21 @@ juce::String CSVHelper::trackToCSV(Track& track)
     // Converts the track's juce::URL property into a std::string
     std::string trackUrlAsString = track.getUrl().toString(false).toStdString();
 
-    // Creates a string storing the track's URL, title, extension, duration, filePath
-    std::string trackDataAsString = std::to_string(track.getRowNumber()) + "," + trackUrlAsString + "," + track.getTitle() +
-        "," + track.getExtensionName() + "," + track.getDuration() + "," + track.getFilePath();
+    // Creates a string storing the track's URL, title, extension, duration, filePath, followed by the tag metadata,
+    // the position of the cover art in the audio file, the content hash of the audio, its analysed beat grid, key and loudness,
+    // and its hot cues (separated by semicolons, with an empty item for a cue which is not set)
+    // (the URL, title, file path and tags can contain commas, so these are escaped before being written into the CSV row)
+    std::string trackDataAsString = std::to_string(track.getRowNumber()) + "," + escapeCommas(trackUrlAsString) + "," + escapeCommas(track.getTitle()) +
+        "," + track.getExtensionName() + "," + track.getDuration() + "," + escapeCommas(track.getFilePath()) +
+        "," + escapeCommas(track.getArtist()) + "," + escapeCommas(track.getAlbum()) + "," + escapeCommas(track.getGenre()) +
+        "," + escapeCommas(track.getBpm()) + "," + escapeCommas(track.getKey()) + "," + escapeCommas(track.getYear()) +
+        "," + std::to_string(track.getCoverArtOffset()) + "," + std::to_string(track.getCoverArtSize()) +
+        "," + track.getContentHash() +
+        "," + std::to_string(track.getAnalysedBpm()) + "," + std::to_string(track.getFirstBeatSeconds()) +
+        "," + track.getAnalysedKey() +
+        "," + std::to_string(track.getIntegratedLoudness()) + "," + std::to_string(track.getLoudnessRange()) +
+        "," + std::to_string(track.getTruePeak()) +
+        "," + hotCuesToString(track.getHotCues());
 
     // Converts the above line to a juce::String in order to use the juce::WriteString/juce::readString methods for file management
     juce::String trackDataAsJuceString = juce::String(trackDataAsString);
@@ -148,14 +188,19 @@ Track CSVHelper::CSVToTrack(juce::StringRef& csvLine)
     // Breaks the CSV string/row into the tokens that make up the data for one track
     trackAsStrings.addTokens(csvLine, juce::StringRef(","), juce::StringRef(","));
 
-    // Throws an exception if the row/line cannot be converted into precisely six tokens
-    if (trackAsStrings.size() != 6)
+    // Throws an exception if the row/line cannot be converted into precisely twenty-two tokens, or twenty-one/eighteen/seventeen/fifteen/fourteen/
+    // twelve/six tokens for rows written before the hot cue/loudness/key/beat grid/content hash/cover art/tag metadata columns were added
+    int numTokens = trackAsStrings.size();
+    if (numTokens != 22 && numTokens != 21 && numTokens != 18 && numTokens != 17 && numTokens != 15 && numTokens != 14 && numTokens != 12 && numTokens != 6)
     {
-        DBG("CSVHelper::CSVToTrack - bad CSV row! Does not have six tokens!");
+        DBG("CSVHelper::CSVToTrack - bad CSV row! Does not have twenty-two (or twenty-one, eighteen, seventeen, fifteen, fourteen, twelve or six) tokens!");
         throw std::exception();
     }
     // Token size is good: convert the CSV line to a Track and return it
-    // Order of data items from the CSV row: row index, fileUrl (as string), title, file extension, duration, filepath
+    // Order of data items from the CSV row: row index, fileUrl (as string), title, file extension, duration, filepath,
+    // then artist, album, genre, BPM, key and year, then the cover art's offset and size, then the content hash,
+    // then the analysed BPM, the time of the first beat and the analysed key, then the integrated loudness, loudness range and true peak,
+    // then the hot cues
     else
     {
         unsigned __int64 rowIndex;
@@ -170,15 +215,105 @@ Track CSVHelper::CSVToTrack(juce::StringRef& csvLine)
             throw;
         }
 
+        // Rows written before the tag metadata columns were added have empty metadata
+        bool hasMetadata = numTokens >= 12;
+
+        // Rows written before the cover art columns were added have no cover art, until the track is imported again
+        bool hasCoverArt = numTokens >= 14;
+
+        // Rows written before the content hash column was added (or before the track was hashed) are hashed again in the background
+        bool hasContentHash = numTokens >= 15;
+
+        // Rows written before the beat grid columns were added are analysed again in the background
+        bool hasBeatGrid = numTokens >= 17;
+
+        // Rows written before the key column was added are analysed again in the background, to find their key
+        bool hasAnalysedKey = numTokens >= 18;
+
+        // Rows written before the loudness columns were added are analysed again in the background, to measure their loudness
+        bool hasLoudness = numTokens >= 21;
+
+        // Rows written before the hot cue column was added have no hot cues
+        bool hasHotCues = numTokens >= 22;
+
         // Create a Track if an error was not thrown when converting the row index token from string to int
+        // (the last item in the row is trimmed, as it ends with the row's newline character: this is the file path in a six-token row)
         Track track{
             rowIndex,
-            juce::URL(juce::String(trackAsStrings[1])),
-            juce::String(trackAsStrings[2]).toStdString(),
+            juce::URL(juce::String(unescapeCommas(trackAsStrings[1]))),
+            unescapeCommas(trackAsStrings[2]),
             juce::String(trackAsStrings[3]).toStdString(),
             juce::String(trackAsStrings[4]).toStdString(),
-            juce::String(trackAsStrings[5]).toStdString() };
+            unescapeCommas(numTokens == 6 ? trackAsStrings[5].trimEnd() : trackAsStrings[5]),
+            hasMetadata ? unescapeCommas(trackAsStrings[6]) : "",
+            hasMetadata ? unescapeCommas(trackAsStrings[7]) : "",
+            hasMetadata ? unescapeCommas(trackAsStrings[8]) : "",
+            hasMetadata ? unescapeCommas(trackAsStrings[9]) : "",
+            hasMetadata ? unescapeCommas(trackAsStrings[10]) : "",
+            hasMetadata ? unescapeCommas(trackAsStrings[11].trimEnd()) : "",
+            hasCoverArt ? trackAsStrings[12].getLargeIntValue() : 0,
+            hasCoverArt ? trackAsStrings[13].trimEnd().getLargeIntValue() : 0,
+            hasContentHash ? trackAsStrings[14].trimEnd().toStdString() : "",
+            hasBeatGrid ? trackAsStrings[15].getDoubleValue() : 0.0,
+            hasBeatGrid ? trackAsStrings[16].trimEnd().getDoubleValue() : 0.0,
+            hasAnalysedKey ? trackAsStrings[17].trimEnd().toStdString() : "",
+            hasLoudness ? trackAsStrings[18].getDoubleValue() : 0.0,
+            hasLoudness ? trackAsStrings[19].getDoubleValue() : 0.0,
+            hasLoudness ? trackAsStrings[20].trimEnd().getDoubleValue() : 0.0,
+            hasHotCues ? stringToHotCues(trackAsStrings[21].trimEnd()) : std::vector<double>() };
 
         return track;
     }
+}
+
+/**
+ * Replaces the commas in a text item (e.g. an artist name from the track's tags)
+ * with "%2C", so that the item can be stored in a single column of the CSV file
+*/
+std::string CSVHelper::escapeCommas(const std::string& text)
+{
+    // Percent signs are escaped first, so that a "%2C" which was already in the text is read back unchanged
+    return juce::String(text).replace("%", "%25").replace(",", "%2C").toStdString();
+}
+
+/** Reverses escapeCommas() when an item is read back from the CSV file */
+std::string CSVHelper::unescapeCommas(const juce::String& text)
+{
+    return text.replace("%2C", ",").replace("%25", "%").toStdString();
+}
+
+/** Joins a track's hot cue positions into a single CSV item, separated by semicolons (with an empty item for a cue which is not set) */
+std::string CSVHelper::hotCuesToString(const std::vector<double>& hotCues)
+{
+    std::string text;
+    for (size_t i = 0; i < hotCues.size(); ++i)
+    {
+        if (i > 0)
+        {
+            text += ";";
+        }
+        if (hotCues[i] >= 0.0)
+        {
+            text += std::to_string(hotCues[i]);
+        }
+    }
+    return text;
+}
+
+/** Reverses hotCuesToString() when the hot cues are read back from the CSV file */
+std::vector<double> CSVHelper::stringToHotCues(const juce::String& text)
+{
+    std::vector<double> hotCues;
+    if (text.isEmpty())
+    {
+        return hotCues;
+    }
+
+    juce::StringArray items;
+    items.addTokens(text, ";", "");
+    for (const juce::String& item : items)
+    {
+        hotCues.push_back(item.isEmpty() ? -1.0 : item.getDoubleValue());
+    }
+    return hotCues;
 }
\ No newline at end of file
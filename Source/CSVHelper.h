@@ -32,6 +32,12 @@ public:
     */
     void writeTracksDataIntoCSVFile(std::vector<Track>& tracks);
 
+    /**
+     * Appends the data of newly imported tracks to the end of the CSV File,
+     * without rewriting the tracks which are already stored in it.
+    */
+    void appendTracksDataToCSVFile(std::vector<Track>& newTracks);
+
     /**
      * Reads rows (1 track per row) from the trackdata CSV file and
      * outputs a vector of tracks to store in the Playlist
@@ -50,6 +56,21 @@ private:
     */
     Track CSVToTrack(juce::StringRef& csvLine);
 
+    /**
+     * Replaces the commas in a text item (e.g. an artist name from the track's tags)
+     * with "%2C", so that the item can be stored in a single column of the CSV file
+    */
+    std::string escapeCommas(const std::string& text);
+
+    /** Reverses escapeCommas() when an item is read back from the CSV file */
+    std::string unescapeCommas(const juce::String& text);
+
+    /** Joins a track's hot cue positions into a single CSV item, separated by semicolons (with an empty item for a cue which is not set) */
+    std::string hotCuesToString(const std::vector<double>& hotCues);
+
+    /** Reverses hotCuesToString() when the hot cues are read back from the CSV file */
+    std::vector<double> stringToHotCues(const juce::String& text);
+
     // Stores the absolute path to the trackData CSV File
     juce::String filePath;
 };
\ No newline at end of file
@@ -0,0 +1,268 @@
+/*
+  ==============================================================================
+
+    CoverArtCache.cpp
+    Created: 19 Oct 2026 4:26:09pm
+    Author:  Ophelia
+    Purpose: decodes the cover art of audio files into small thumbnails on a background thread,
+             and keeps them in a memory cache and an on-disk cache
+
+  ==============================================================================
+*/
+
+#include "CoverArtCache.h"
+
+namespace
+{
+    /**
+     *Returns a 64-bit FNV-1a hash of the image data as a hex string, which names the image's thumbnails in the disk cache.
+     *The same cover art embedded in every track of an album has the same hash, so it is only decoded once
+     */
+    juce::String hashImageData(const juce::MemoryBlock& data)
+    {
+        juce::uint64 hash = 14695981039346656037ull;
+        const juce::uint8* bytes = static_cast<const juce::uint8*>(data.getData());
+        for (size_t i = 0; i < data.getSize(); ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return juce::String::toHexString((juce::int64)hash).paddedLeft('0', 16);
+    }
+
+    /** Scales the image down (keeping its aspect ratio) to fit in a square of thumbnailSize pixels */
+    juce::Image scaleToFit(juce::Image image, int thumbnailSize)
+    {
+        float scale = juce::jmin(1.0f, (float)thumbnailSize / (float)juce::jmax(image.getWidth(), image.getHeight()));
+        int width = juce::jmax(1, juce::roundToInt(image.getWidth() * scale));
+        int height = juce::jmax(1, juce::roundToInt(image.getHeight() * scale));
+
+        // Halves the image until it is less than twice the thumbnail's size, as shrinking a large image in a single step
+        // skips most of its pixels and leaves the thumbnail grainy
+        while (image.getWidth() >= width * 2 && image.getHeight() >= height * 2)
+        {
+            image = image.rescaled(image.getWidth() / 2, image.getHeight() / 2, juce::Graphics::mediumResamplingQuality);
+        }
+
+        if (image.getWidth() != width || image.getHeight() != height)
+        {
+            image = image.rescaled(width, height, juce::Graphics::highResamplingQuality);
+        }
+        return image;
+    }
+}
+
+//=========================================Thread Pool Jobs===========================================================
+
+/** A ThreadPoolJob which reads the cover art of one file and decodes it (or loads it from the disk cache) */
+class CoverArtCache::DecodeJob : public juce::ThreadPoolJob
+{
+public:
+    DecodeJob(CoverArtCache& _owner, juce::String _key, juce::File _audioFile, juce::int64 _offset, juce::int64 _size, int _thumbnailSize) :
+        juce::ThreadPoolJob("DecodeJob"),
+        owner(_owner),
+        key(_key),
+        audioFile(_audioFile),
+        offset(_offset),
+        size(_size),
+        thumbnailSize(_thumbnailSize)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        DecodedThumbnail decoded;
+        decoded.key = key;
+
+        // Thumbnails which have not been started are left alone if the cache is being destroyed
+        if (!shouldExit())
+        {
+            decoded.image = loadThumbnail();
+        }
+
+        owner.addDecodedThumbnail(decoded);
+        return jobHasFinished;
+    }
+
+private:
+    /** Returns the thumbnail from the disk cache if it is there, otherwise decodes the cover art and saves its thumbnail */
+    juce::Image loadThumbnail()
+    {
+        // Only the bytes of the image itself are read, not the rest of the audio file
+        juce::MemoryBlock coverArt;
+        {
+            juce::FileInputStream stream(audioFile);
+            if (!stream.openedOk() || !stream.setPosition(offset) || (juce::int64)stream.readIntoMemoryBlock(coverArt, (juce::ssize_t)size) != size)
+            {
+                return {};
+            }
+        }
+
+        // Hashing the image is much quicker than decoding it, and the thumbnail PNG is much smaller than the image
+        juce::File thumbnailFile = owner.diskCacheFolder.getChildFile(hashImageData(coverArt) + "_" + juce::String(thumbnailSize) + ".png");
+        if (thumbnailFile.existsAsFile())
+        {
+            juce::Image thumbnail = juce::ImageFileFormat::loadFrom(thumbnailFile);
+            if (thumbnail.isValid())
+            {
+                return thumbnail;
+            }
+        }
+
+        // Decodes the JPEG/PNG/GIF image, which can be a few thousand pixels across
+        juce::Image image = juce::ImageFileFormat::loadFrom(coverArt.getData(), coverArt.getSize());
+        if (!image.isValid())
+        {
+            return {};
+        }
+        juce::Image thumbnail = scaleToFit(image, thumbnailSize);
+
+        // Written to a temporary file which then replaces the thumbnail file, so that another job (or the next run of
+        // the app) never reads a half-written thumbnail
+        juce::TemporaryFile tempFile(thumbnailFile);
+        {
+            juce::FileOutputStream stream(tempFile.getFile());
+            juce::PNGImageFormat pngFormat;
+            if (!stream.openedOk() || !pngFormat.writeImageToStream(thumbnail, stream))
+            {
+                return thumbnail;
+            }
+        }
+        tempFile.overwriteTargetFileWithTemporary();
+
+        return thumbnail;
+    }
+
+    CoverArtCache& owner;
+    juce::String key;
+    juce::File audioFile;
+    juce::int64 offset;
+    juce::int64 size;
+    int thumbnailSize;
+};
+
+//=========================================CoverArtCache===========================================================
+
+/** Constructor: creates the folder which stores the thumbnails on disk, if it does not exist yet */
+CoverArtCache::CoverArtCache()
+{
+    diskCacheFolder = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("CoverArtThumbnails");
+    diskCacheFolder.createDirectory();
+}
+
+/** Destructor: stops the worker threads before the cache is destroyed */
+CoverArtCache::~CoverArtCache()
+{
+    stopTimer();
+    // Asks every running job to exit and waits for them, as the jobs hold a reference to this cache
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/**
+ *Returns the thumbnail of the cover art stored at the given position in the audio file, scaled to fit in a square
+ *of thumbnailSize pixels. If it has not been decoded yet, a null image is returned and the image is decoded on a worker
+ *thread: a change message is sent once it is ready, so the caller can repaint and ask for it again.
+ *Only call this from the message thread
+ */
+juce::Image CoverArtCache::getThumbnail(const juce::File& audioFile, juce::int64 offset, juce::int64 size, int thumbnailSize)
+{
+    // Tracks without any cover art have a size of 0
+    if (size <= 0 || size > maxCoverArtSize || thumbnailSize <= 0)
+    {
+        return {};
+    }
+
+    juce::String key = getKey(audioFile, offset, thumbnailSize);
+
+    auto cached = memoryCache.find(key);
+    if (cached != memoryCache.end())
+    {
+        // Moves the key to the front of the list, as this is now the most recently used thumbnail
+        recentlyUsedKeys.splice(recentlyUsedKeys.begin(), recentlyUsedKeys, cached->second.recentlyUsedPosition);
+        return cached->second.image;
+    }
+
+    // Each thumbnail is only queued once, however many times its row is painted while it is being decoded
+    if (pendingKeys.count(key) == 0 && failedKeys.count(key) == 0)
+    {
+        pendingKeys.insert(key);
+        threadPool.addJob(new DecodeJob(*this, key, audioFile, offset, size, thumbnailSize), true);
+
+        // Checks for decoded thumbnails ten times a second, so a table full of new thumbnails is only repainted a few times
+        startTimer(100);
+    }
+
+    return {};
+}
+
+/** Returns the memory cache's key for a thumbnail */
+juce::String CoverArtCache::getKey(const juce::File& audioFile, juce::int64 offset, int thumbnailSize)
+{
+    return audioFile.getFullPathName() + ":" + juce::String(offset) + ":" + juce::String(thumbnailSize);
+}
+
+/** Stores a thumbnail decoded by one of the worker threads, so that the timerCallback can add it to the memory cache */
+void CoverArtCache::addDecodedThumbnail(DecodedThumbnail decoded)
+{
+    const juce::ScopedLock lock(decodedLock);
+    decodedThumbnails.push_back(decoded);
+}
+
+/** Adds a thumbnail to the memory cache, removing the least recently used thumbnails if it has grown too big */
+void CoverArtCache::addToMemoryCache(const juce::String& key, const juce::Image& image)
+{
+    recentlyUsedKeys.push_front(key);
+    memoryCache[key] = CachedThumbnail{ image, recentlyUsedKeys.begin() };
+    memoryCacheBytes += (size_t)image.getWidth() * (size_t)image.getHeight() * 4;
+
+    // The thumbnail just added is never removed, even if it is bigger than the whole cache
+    while (memoryCacheBytes > maxMemoryCacheBytes && recentlyUsedKeys.size() > 1)
+    {
+        auto leastRecentlyUsed = memoryCache.find(recentlyUsedKeys.back());
+        const juce::Image& oldImage = leastRecentlyUsed->second.image;
+        memoryCacheBytes -= (size_t)oldImage.getWidth() * (size_t)oldImage.getHeight() * 4;
+        memoryCache.erase(leastRecentlyUsed);
+        recentlyUsedKeys.pop_back();
+    }
+}
+
+/**
+ *Implements juce::Timer's inherited pure virtual function: moves the thumbnails which the worker threads
+ *have decoded into the memory cache, and tells the listeners so they can repaint
+ */
+void CoverArtCache::timerCallback()
+{
+    // Takes every decoded thumbnail in one go, so the worker threads are only blocked for the time it takes to swap two vectors
+    std::vector<DecodedThumbnail> batch;
+    {
+        const juce::ScopedLock lock(decodedLock);
+        batch.swap(decodedThumbnails);
+    }
+
+    bool hasNewThumbnails = false;
+    for (DecodedThumbnail& decoded : batch)
+    {
+        pendingKeys.erase(decoded.key);
+
+        if (decoded.image.isValid())
+        {
+            addToMemoryCache(decoded.key, decoded.image);
+            hasNewThumbnails = true;
+        }
+        else
+        {
+            failedKeys.insert(decoded.key);
+        }
+    }
+
+    if (pendingKeys.empty())
+    {
+        stopTimer();
+    }
+
+    if (hasNewThumbnails)
+    {
+        sendChangeMessage();
+    }
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    CoverArtCache.h
+    Created: 19 Oct 2026 4:26:09pm
+    Author:  Ophelia
+    Purpose: decodes the cover art of audio files into small thumbnails on a background thread,
+             and keeps them in a memory cache and an on-disk cache
+
+  ==============================================================================
+  The MetadataReader only records where each file's cover art is stored when a track is imported, so
+  nothing is decoded until a thumbnail is first asked for. The PlaylistComponent and the DeckGUIs ask for
+  thumbnails while painting: if one is not ready yet they draw nothing, and repaint when this cache sends
+  a change message. Decoded thumbnails are saved as PNG files named after a hash of the image, so the
+  many tracks of an album share one file, and a big image is only decoded once across restarts.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+class CoverArtCache : public juce::ChangeBroadcaster,
+    private juce::Timer
+{
+public:
+    /** Constructor: creates the folder which stores the thumbnails on disk, if it does not exist yet */
+    CoverArtCache();
+
+    /** Destructor: stops the worker threads before the cache is destroyed */
+    ~CoverArtCache() override;
+
+    /**
+     *Returns the thumbnail of the cover art stored at the given position in the audio file, scaled to fit in a square
+     *of thumbnailSize pixels. If it has not been decoded yet, a null image is returned and the image is decoded on a worker
+     *thread: a change message is sent once it is ready, so the caller can repaint and ask for it again.
+     *Only call this from the message thread
+     */
+    juce::Image getThumbnail(const juce::File& audioFile, juce::int64 offset, juce::int64 size, int thumbnailSize);
+
+private:
+    /** A ThreadPoolJob which reads the cover art of one file and decodes it (or loads it from the disk cache) */
+    class DecodeJob;
+
+    /** A thumbnail which a DecodeJob has finished with, waiting to be moved into the memory cache */
+    struct DecodedThumbnail
+    {
+        // The key of the file, position and size of the thumbnail, made by getKey()
+        juce::String key;
+        // The thumbnail, or a null image if the cover art could not be read or decoded
+        juce::Image image;
+    };
+
+    /** A thumbnail in the memory cache, with its place in the list of the most recently used thumbnails */
+    struct CachedThumbnail
+    {
+        juce::Image image;
+        std::list<juce::String>::iterator recentlyUsedPosition;
+    };
+
+    /** Returns the memory cache's key for a thumbnail */
+    static juce::String getKey(const juce::File& audioFile, juce::int64 offset, int thumbnailSize);
+
+    /** Stores a thumbnail decoded by one of the worker threads, so that the timerCallback can add it to the memory cache */
+    void addDecodedThumbnail(DecodedThumbnail decoded);
+
+    /** Adds a thumbnail to the memory cache, removing the least recently used thumbnails if it has grown too big */
+    void addToMemoryCache(const juce::String& key, const juce::Image& image);
+
+    /**
+     *Implements juce::Timer's inherited pure virtual function: moves the thumbnails which the worker threads
+     *have decoded into the memory cache, and tells the listeners so they can repaint
+     */
+    void timerCallback() override;
+
+    // The folder which stores the thumbnails as PNG files, named after the hash of the image they were made from
+    juce::File diskCacheFolder;
+
+    // The thumbnails in memory, looked up by their key, and their keys in order from the most to the least recently used
+    std::map<juce::String, CachedThumbnail> memoryCache;
+    std::list<juce::String> recentlyUsedKeys;
+
+    // The number of bytes of pixel data in the memory cache, which is kept below maxMemoryCacheBytes
+    size_t memoryCacheBytes = 0;
+
+    // The keys of the thumbnails which are queued on the thread pool, so that each one is only decoded once
+    std::set<juce::String> pendingKeys;
+
+    // The keys of the cover art which could not be read or decoded, so that they are not tried again whenever a row is painted
+    std::set<juce::String> failedKeys;
+
+    // Decoding is quick next to the audio, so two worker threads keep up with scrolling without competing with the importer
+    juce::ThreadPool threadPool{ 2 };
+
+    // Stores the thumbnails which have been decoded but not yet moved into the memory cache, locked by decodedLock
+    std::vector<DecodedThumbnail> decodedThumbnails;
+    juce::CriticalSection decodedLock;
+
+    // Around 1000 table thumbnails, or a few hundred of the larger deck thumbnails
+    static constexpr size_t maxMemoryCacheBytes = 16 * 1024 * 1024;
+
+    // Cover art larger than this is skipped, as it is most likely a broken tag rather than a picture
+    static constexpr juce::int64 maxCoverArtSize = 32 * 1024 * 1024;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoverArtCache)
+};
@@ -1,5 +1,9 @@
 #include <../JuceLibraryCode/JuceHeader.h>
 #include "DJAudioPlayer.h"
+#include <cmath>
+
+// Most streaming services play tracks at -14 LUFS, which leaves modern masters close to their own level
+std::atomic<double> DJAudioPlayer::targetLoudness{ -14.0 };
 
 /** Constructor: takes in the program-scope formatManager from Main Component*/
 DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager) : formatManager(_formatManager)
@@ -16,6 +20,9 @@ DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager) : formatM
     params.freezeMode = 0.0f;
     reverbAudioSource.setParameters(params);
 
+    // Starts the thread which reads the loaded track ahead of playback
+    readAheadThread.startThread();
+
     // Call timerCallback every 10 milliseconds (one hundredth of a second)
     startTimer(10);
 }
@@ -31,6 +38,9 @@ DJAudioPlayer::~DJAudioPlayer()
 /** Tells the audio source to prepare for playing */
 void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
+    outputSampleRate = sampleRate;
+    outputSampleCount = 0;
+
     transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
     // Reverb Audio Source for reverb effects, takes in the resampleSource, which takes in transportSource
@@ -41,15 +51,35 @@ void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate
 /** Called repeatedly to fetch subsequent blocks of audio data */
 void DJAudioPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {   
+    // Every block is counted, playing or not, so both decks' beat clocks count the same samples
+    const juce::int64 blockStartSample = outputSampleCount;
+    outputSampleCount += bufferToFill.numSamples;
+
     // If no more data to get,or audio is paused, then clears the audio buffer
     if (readerSource.get() == nullptr || !playing)
     {
         bufferToFill.clearActiveBufferRegion();
+        publishBeatClock();
         return;
     }
 
+    // A synced deck sets its speed for the block from where the leader's beats are
+    DJAudioPlayer* leader = syncLeader.load();
+    if (leader != nullptr)
+    {
+        followLeader(*leader, blockStartSample, bufferToFill.numSamples);
+    }
+    lastSyncLeader = leader;
+
     // Delegate responsibility to the reverbAudioSource which takes in the resampleSource as a parameter when created
     reverbAudioSource.getNextAudioBlock(bufferToFill);
+
+    // Turns the track up or down to the target loudness, on top of the volume slider's gain in the transportSource
+    float normalisationGain = getNormalisationGain();
+    bufferToFill.buffer->applyGainRamp(bufferToFill.startSample, bufferToFill.numSamples, lastNormalisationGain, normalisationGain);
+    lastNormalisationGain = normalisationGain;
+
+    publishBeatClock();
 }
 
 // Death
@@ -70,10 +100,30 @@ void DJAudioPlayer::loadURL(juce::URL audioURL)
 
     if (reader != nullptr) // Good file!
     {
+        double sampleRate = reader->sampleRate;
         std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader,
             true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
+
+        // About a second and a half is decoded ahead of playback, so the decoder can catch up after a hot cue while its audio plays from memory
+        std::unique_ptr<juce::BufferingAudioSource> newBufferingSource(new juce::BufferingAudioSource(newSource.get(), readAheadThread,
+            false, 65536, 2));
+        std::unique_ptr<HotCueSource> newHotCueSource(new HotCueSource(newBufferingSource.get(), formatManager, audioURL, sampleRate,
+            readAheadThread));
+        std::unique_ptr<LoopSource> newLoopSource(new LoopSource(newHotCueSource.get(), sampleRate));
+
+        transportSource.setSource(newLoopSource.get(), 0, nullptr, sampleRate);
+
+        // The old track's sources are deleted in the order they were stacked, once the transportSource has stopped using them
+        loopSource.reset(newLoopSource.release());
+        hotCueSource.reset(newHotCueSource.release());
+        bufferingSource.reset(newBufferingSource.release());
         readerSource.reset(newSource.release());
+        trackSampleRate = sampleRate;
+
+        // The beat grid is set by the DeckGUI once the track is loaded
+        trackBpm = 0.0;
+        trackFirstBeatSeconds = 0.0;
+        loopInPosition = -1;
     }
 }
 
@@ -114,8 +164,13 @@ void DJAudioPlayer::setSpeed(double ratio)
     }
     else
     {   
-        // Speed can only be changed on resampleSource and not the audio transportSource!
-        resampleSource.setResamplingRatio(ratio);
+        // While the deck is synced, the audio thread sets the speed instead
+        if (syncLeader.load() == nullptr)
+        {
+            // Speed can only be changed on resampleSource and not the audio transportSource!
+            resampleSource.setResamplingRatio(ratio);
+            playingSpeedRatio = ratio;
+        }
     }
 }
 
@@ -286,7 +341,298 @@ void DJAudioPlayer::timerCallback()
             setGain(0.0);
         }
     }
-    
+}
+
+
+//=====================================Loudness Normalisation======================================================
+/** Sets the loudness in LUFS which every deck plays its tracks at (-14 LUFS by default) */
+void DJAudioPlayer::setTargetLoudness(double lufs)
+{
+    targetLoudness = lufs;
+}
+
+/** Returns the loudness in LUFS which every deck plays its tracks at */
+double DJAudioPlayer::getTargetLoudness()
+{
+    return targetLoudness;
+}
+
+/**
+ *Sets the loaded track's integrated loudness (LUFS) and true peak (dBTP) worked out by the TrackAnalyser, so the
+ *track is turned up or down to the target loudness. An integrated loudness of 0 (not analysed yet) plays the track as it is
+ */
+void DJAudioPlayer::setTrackLoudness(double integratedLoudness, double truePeak)
+{
+    trackTruePeak = truePeak;
+    trackIntegratedLoudness = integratedLoudness;
+}
+
+/** Returns the gain which brings the loaded track to the target loudness, without pushing its true peak above the headroom limit */
+float DJAudioPlayer::getNormalisationGain()
+{
+    double integratedLoudness = trackIntegratedLoudness;
+    if (integratedLoudness == 0.0)
+    {
+        return 1.0f;
+    }
+
+    // A quiet track is only turned up as far as its peaks allow, so it never clips at -1 dBTP or above
+    double gainDecibels = targetLoudness - integratedLoudness;
+    gainDecibels = juce::jmin(gainDecibels, -1.0 - trackTruePeak);
+
+    // Silent or broken tracks are not turned up (or down) by absurd amounts
+    gainDecibels = juce::jlimit(-24.0, 12.0, gainDecibels);
+    return juce::Decibels::decibelsToGain((float)gainDecibels);
+}
+
+
+//=====================================Hot Cues======================================================
+/** Sets every hot cue of the loaded track from their positions in seconds (-1 for a cue which is not set) */
+void DJAudioPlayer::setHotCues(const std::vector<double>& hotCueSeconds)
+{
+    for (int i = 0; i < numHotCues; ++i)
+    {
+        setHotCue(i, i < (int)hotCueSeconds.size() ? hotCueSeconds[(size_t)i] : -1.0);
+    }
+}
+
+/** Sets the hot cue to a position in seconds, or clears it for a negative position */
+void DJAudioPlayer::setHotCue(int index, double positionInSeconds)
+{
+    if (hotCueSource != nullptr)
+    {
+        hotCueSource->setHotCue(index, positionInSeconds < 0.0 ? -1 : (juce::int64)(positionInSeconds * trackSampleRate));
+    }
+}
+
+/** Returns the position of the hot cue in seconds, or -1 if it is not set (or no track is loaded) */
+double DJAudioPlayer::getHotCue(int index)
+{
+    juce::int64 position = hotCueSource != nullptr ? hotCueSource->getHotCue(index) : -1;
+    return position < 0 ? -1.0 : position / trackSampleRate;
+}
+
+/** Jumps to the hot cue and plays from it, straight away from the audio decoded in advance. Returns false if the cue is not set */
+bool DJAudioPlayer::triggerHotCue(int index)
+{
+    if (hotCueSource == nullptr || hotCueSource->getHotCue(index) < 0)
+    {
+        return false;
+    }
+
+    // A hot cue jumps out of any loop
+    loopSource->cancelLoop();
+    hotCueSource->triggerHotCue(index);
+
+    // The speed resampler still holds a few samples from before the jump, which would be heard first
+    resampleSource.flushBuffers();
+    if (!playing)
+    {
+        play();
+    }
+    return true;
+}
+
+/** Gets the position of the playhead in seconds */
+double DJAudioPlayer::getPositionInSeconds()
+{
+    return transportSource.getCurrentPosition();
+}
+
+
+//=====================================Loops======================================================
+/**
+ *Sets the loaded track's beat grid worked out by the TrackAnalyser, which auto-loops are snapped to and measured in.
+ *A BPM of 0 or less (not analysed, or no steady beat) makes auto-loops start at the playhead and count 120 BPM
+ */
+void DJAudioPlayer::setBeatGrid(double bpm, double firstBeatSeconds)
+{
+    trackBpm = bpm;
+    trackFirstBeatSeconds = firstBeatSeconds;
+}
+
+/** Marks the playhead as the start of the next manual loop */
+void DJAudioPlayer::setLoopIn()
+{
+    if (loopSource != nullptr)
+    {
+        loopInPosition = loopSource->getNextReadPosition();
+    }
+}
+
+/** Loops playback between the loop in point and the playhead */
+void DJAudioPlayer::setLoopOut()
+{
+    // An out point at or before the in point is ignored by the loopSource
+    if (loopSource != nullptr && loopInPosition >= 0)
+    {
+        loopSource->setLoop(loopInPosition, loopSource->getNextReadPosition(), slipMode);
+    }
+}
+
+/**
+ *Loops playback for the given number of beats from the last beat (or fraction of a beat, for loops shorter than a beat).
+ *If a loop is already active, it keeps its start and is resized instead
+ */
+void DJAudioPlayer::setAutoLoop(double beats)
+{
+    if (loopSource == nullptr)
+    {
+        return;
+    }
+
+    // Resizing an active loop from its start keeps it on the beat, e.g. when it is halved or doubled
+    juce::Range<juce::int64> loopRange = getAutoLoopRange(beats);
+    if (loopSource->isLooping())
+    {
+        loopRange = loopRange.movedToStartAt(loopSource->getLoopStart());
+    }
+    loopSource->setLoop(loopRange.getStart(), loopRange.getEnd(), slipMode);
+}
+
+/** Starts a loop roll of the given number of beats: a loop which always returns to where the track would have been when it is exited */
+void DJAudioPlayer::startLoopRoll(double beats)
+{
+    if (loopSource != nullptr)
+    {
+        juce::Range<juce::int64> loopRange = getAutoLoopRange(beats);
+        loopSource->setLoop(loopRange.getStart(), loopRange.getEnd(), true);
+    }
+}
+
+/** Stops looping: playback carries on through the track, or, in slip mode and after a loop roll, from where it would have been without the loop */
+void DJAudioPlayer::exitLoop()
+{
+    if (loopSource != nullptr)
+    {
+        loopSource->exitLoop();
+    }
+}
+
+/** Turns slip mode on or off for the loops which are started after it */
+void DJAudioPlayer::setSlipMode(bool shouldSlip)
+{
+    slipMode = shouldSlip;
+}
+
+/** Returns true while a loop (or loop roll) is playing */
+bool DJAudioPlayer::isLooping()
+{
+    return loopSource != nullptr && loopSource->isLooping();
+}
+
+/** Returns the position of the auto-loop of the given number of beats which the playhead is in, in samples */
+juce::Range<juce::int64> DJAudioPlayer::getAutoLoopRange(double beats)
+{
+    beats = juce::jlimit(minLoopBeats, maxLoopBeats, beats);
+    double bpm = trackBpm;
+    double firstBeatSeconds = trackFirstBeatSeconds;
+    bool hasBeatGrid = bpm > 0.0;
+    double beatSeconds = 60.0 / (hasBeatGrid ? bpm : 120.0);
+    double startSeconds = getPositionInSeconds();
+
+    // Snapped back to the last beat, or to the last fraction of a beat which a loop shorter than a beat fits in.
+    // The small allowance keeps a playhead sitting right on a beat from snapping to the one before it
+    if (hasBeatGrid)
+    {
+        double snapSeconds = juce::jmin(1.0, beats) * beatSeconds;
+        double snapsFromFirstBeat = std::floor((startSeconds - firstBeatSeconds) / snapSeconds + 1.0e-6);
+        startSeconds = firstBeatSeconds + snapsFromFirstBeat * snapSeconds;
+        if (startSeconds < 0.0)
+        {
+            startSeconds += std::ceil(-startSeconds / snapSeconds) * snapSeconds;
+        }
+    }
+
+    juce::int64 start = (juce::int64)std::llround(startSeconds * trackSampleRate);
+    juce::int64 length = juce::jmax((juce::int64)1, (juce::int64)std::llround(beats * beatSeconds * trackSampleRate));
+    return { start, start + length };
+}
+
+
+//=====================================Beat Sync======================================================
+/**
+ *Makes this deck follow the leader deck's tempo and keep its beats in phase with the leader's, using both decks'
+ *beat grids (nullptr turns sync off, leaving the deck at the synced speed). A leader which was following this deck
+ *stops following it, so the two never chase each other
+ */
+void DJAudioPlayer::syncTo(DJAudioPlayer* leader)
+{
+    if (leader == this)
+    {
+        return;
+    }
+
+    if (leader != nullptr && leader->syncLeader.load() == this)
+    {
+        leader->syncTo(nullptr);
+    }
+
+    // Once sync is off the deck carries on at the synced speed, until the speed slider is moved
+    syncLeader = leader;
+}
+
+/** Returns true while this deck follows another deck */
+bool DJAudioPlayer::isSynced()
+{
+    return syncLeader.load() != nullptr;
+}
+
+/** Returns the speed ratio the deck is playing at: the speed slider's, or the synced speed while it follows another deck */
+double DJAudioPlayer::getSpeed()
+{
+    return playingSpeedRatio;
+}
+
+/** Returns the deck's beat clock as of its last audio block, for a deck which follows this one */
+DJAudioPlayer::BeatClock DJAudioPlayer::getBeatClock()
+{
+    const juce::SpinLock::ScopedLockType lock(beatClockLock);
+    return beatClock;
+}
+
+/** Publishes the deck's beat clock at the end of an audio block (called on the audio thread) */
+void DJAudioPlayer::publishBeatClock()
+{
+    BeatClock clock;
+    double bpm = trackBpm;
+    clock.isValid = playing && readerSource != nullptr && bpm > 0.0;
+    if (clock.isValid)
+    {
+        clock.beat = (transportSource.getCurrentPosition() - trackFirstBeatSeconds) * bpm / 60.0;
+        clock.beatsPerSecond = bpm / 60.0 * playingSpeedRatio;
+    }
+    clock.outputSample = outputSampleCount;
+
+    const juce::SpinLock::ScopedLockType lock(beatClockLock);
+    beatClock = clock;
+}
+
+/** Sets the speed which matches the leader's tempo and pulls the deck's beats into phase with the leader's (called on the audio thread before each block) */
+void DJAudioPlayer::followLeader(DJAudioPlayer& leader, juce::int64 blockStartSample, int numSamples)
+{
+    if (&leader != lastSyncLeader)
+    {
+        beatSync.reset();
+    }
+
+    // Without both beat grids (or while the leader is stopped) the deck carries on at the speed it was playing at
+    BeatClock leaderClock = leader.getBeatClock();
+    double bpm = trackBpm;
+    if (!leaderClock.isValid || bpm <= 0.0)
+    {
+        beatSync.reset();
+        return;
+    }
+
+    // The leader's clock is from the end of its last block, which may be in this callback or the one before (depending on
+    // which deck the mixer plays first), so it is carried on to the start of this deck's block at the leader's tempo
+    double leaderBeat = leaderClock.beat + (blockStartSample - leaderClock.outputSample) / outputSampleRate * leaderClock.beatsPerSecond;
+    double followerBeat = (transportSource.getCurrentPosition() - trackFirstBeatSeconds) * bpm / 60.0;
+
+    double ratio = beatSync.getSpeedRatio(leaderBeat, leaderClock.beatsPerSecond, followerBeat, bpm / 60.0, numSamples / outputSampleRate);
+    resampleSource.setResamplingRatio(ratio);
+    playingSpeedRatio = ratio;
 }
 
 
@@ -1,5 +1,10 @@
 #pragma once
 #include <../JuceLibraryCode/JuceHeader.h>
+#include <atomic>
+#include <vector>
+#include "HotCueSource.h"
+#include "LoopSource.h"
+#include "BeatSync.h"
 
 // This is an audio source: it inherits from the JUCE AudioSource clas, so it has virtual functions to implement
 class DJAudioPlayer : public juce::AudioSource,
@@ -79,6 +84,77 @@ public:
     void timerCallback() override;
 
 
+    //=====================================Loudness Normalisation======================================================
+    /** Sets the loudness in LUFS which every deck plays its tracks at (-14 LUFS by default) */
+    static void setTargetLoudness(double lufs);
+    /** Returns the loudness in LUFS which every deck plays its tracks at */
+    static double getTargetLoudness();
+    /**
+     *Sets the loaded track's integrated loudness (LUFS) and true peak (dBTP) worked out by the TrackAnalyser, so the
+     *track is turned up or down to the target loudness. An integrated loudness of 0 (not analysed yet) plays the track as it is
+     */
+    void setTrackLoudness(double integratedLoudness, double truePeak);
+
+
+    //=====================================Hot Cues======================================================
+    // The number of hot cues on each deck
+    static constexpr int numHotCues = HotCueSource::numHotCues;
+
+    /** Sets every hot cue of the loaded track from their positions in seconds (-1 for a cue which is not set) */
+    void setHotCues(const std::vector<double>& hotCueSeconds);
+    /** Sets the hot cue to a position in seconds, or clears it for a negative position */
+    void setHotCue(int index, double positionInSeconds);
+    /** Returns the position of the hot cue in seconds, or -1 if it is not set (or no track is loaded) */
+    double getHotCue(int index);
+    /** Jumps to the hot cue and plays from it, straight away from the audio decoded in advance. Returns false if the cue is not set */
+    bool triggerHotCue(int index);
+
+    /** Gets the position of the playhead in seconds */
+    double getPositionInSeconds();
+
+
+    //=====================================Loops======================================================
+    // The shortest and longest auto-loops, in beats
+    static constexpr double minLoopBeats = 1.0 / 32.0;
+    static constexpr double maxLoopBeats = 32.0;
+
+    /**
+     *Sets the loaded track's beat grid worked out by the TrackAnalyser, which auto-loops are snapped to and measured in.
+     *A BPM of 0 or less (not analysed, or no steady beat) makes auto-loops start at the playhead and count 120 BPM
+     */
+    void setBeatGrid(double bpm, double firstBeatSeconds);
+    /** Marks the playhead as the start of the next manual loop */
+    void setLoopIn();
+    /** Loops playback between the loop in point and the playhead */
+    void setLoopOut();
+    /**
+     *Loops playback for the given number of beats from the last beat (or fraction of a beat, for loops shorter than a beat).
+     *If a loop is already active, it keeps its start and is resized instead
+     */
+    void setAutoLoop(double beats);
+    /** Starts a loop roll of the given number of beats: a loop which always returns to where the track would have been when it is exited */
+    void startLoopRoll(double beats);
+    /** Stops looping: playback carries on through the track, or, in slip mode and after a loop roll, from where it would have been without the loop */
+    void exitLoop();
+    /** Turns slip mode on or off for the loops which are started after it */
+    void setSlipMode(bool shouldSlip);
+    /** Returns true while a loop (or loop roll) is playing */
+    bool isLooping();
+
+
+    //=====================================Beat Sync======================================================
+    /**
+     *Makes this deck follow the leader deck's tempo and keep its beats in phase with the leader's, using both decks'
+     *beat grids (nullptr turns sync off, leaving the deck at the synced speed). A leader which was following this deck
+     *stops following it, so the two never chase each other
+     */
+    void syncTo(DJAudioPlayer* leader);
+    /** Returns true while this deck follows another deck */
+    bool isSynced();
+    /** Returns the speed ratio the deck is playing at: the speed slider's, or the synced speed while it follows another deck */
+    double getSpeed();
+
+
     //=====================================Basic Playback======================================================
     /** Starts playing the file */
     void play();
@@ -96,8 +172,23 @@ private:
     // The reference to the audio format manager passed in from MainComponent 
     juce::AudioFormatManager& formatManager;
 
+    // Reads the next part of the loaded track ahead of the audio thread, and decodes the audio after its hot cues
+    juce::TimeSliceThread readAheadThread{ "Deck read-ahead" };
+
     // Reader for the data stream from the audio file being played
     std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+
+    // Decodes the reader's audio ahead of playback on the readAheadThread, so seeking and decoding never happen on the audio thread
+    std::unique_ptr<juce::BufferingAudioSource> bufferingSource;
+
+    // Plays the bufferingSource, and jumps to the hot cues straight away from the audio decoded after each of them
+    std::unique_ptr<HotCueSource> hotCueSource;
+
+    // Plays the hotCueSource, and loops it sample-accurately from the audio it has just played
+    std::unique_ptr<LoopSource> loopSource;
+
+    // The sample rate of the loaded track, which the hot cues' positions are counted in
+    double trackSampleRate = 0.0;
     
     // The three transport sources to play (transportSource) and manipulate (resample, reverb) the audio
     juce::AudioTransportSource transportSource;
@@ -109,6 +200,79 @@ private:
     bool playing = false;
 
 
+    //======================================Loop Data===================================================================
+    /** Returns the position of the auto-loop of the given number of beats which the playhead is in, in samples */
+    juce::Range<juce::int64> getAutoLoopRange(double beats);
+
+    // The loaded track's beat grid (a BPM of 0 or less if it has none). Read by the audio thread to sync, so it is atomic
+    std::atomic<double> trackBpm{ 0.0 };
+    std::atomic<double> trackFirstBeatSeconds{ 0.0 };
+
+    // The start of the next manual loop in samples, or -1 if the loop in point has not been set
+    juce::int64 loopInPosition = -1;
+
+    // Whether loops return to where the track would have been when they are exited
+    bool slipMode = false;
+
+
+    //======================================Loudness Normalisation Data===================================================
+    /** Returns the gain which brings the loaded track to the target loudness, without pushing its true peak above the headroom limit */
+    float getNormalisationGain();
+
+    // The loudness every deck plays its tracks at, shared by both players. Read by the audio thread, so it is atomic
+    static std::atomic<double> targetLoudness;
+
+    // The loaded track's analysed loudness, set from the message thread and read by the audio thread (an integrated loudness of 0 if unknown)
+    std::atomic<double> trackIntegratedLoudness{ 0.0 };
+    std::atomic<double> trackTruePeak{ 0.0 };
+
+    // The normalisation gain of the last audio block (only used on the audio thread), so a change of gain is ramped over the next block instead of clicking
+    float lastNormalisationGain = 1.0f;
+
+
+    //======================================Beat Sync Data===============================================================
+    /** Where the deck is along its beat grid and how fast its beats go, as of the end of its last audio block */
+    struct BeatClock
+    {
+        // The deck's position in beats, its tempo in beats per second at the speed it plays at, and the number of
+        // samples the deck had output by then (which both decks count together, as the mixer plays them in the same callbacks)
+        double beat = 0.0;
+        double beatsPerSecond = 0.0;
+        juce::int64 outputSample = 0;
+        // False while the deck is stopped, or its track has no beat grid
+        bool isValid = false;
+    };
+
+    /** Returns the deck's beat clock as of its last audio block, for a deck which follows this one */
+    BeatClock getBeatClock();
+
+    /** Publishes the deck's beat clock at the end of an audio block (called on the audio thread) */
+    void publishBeatClock();
+
+    /** Sets the speed which matches the leader's tempo and pulls the deck's beats into phase with the leader's (called on the audio thread before each block) */
+    void followLeader(DJAudioPlayer& leader, juce::int64 blockStartSample, int numSamples);
+
+    // The deck this deck follows, or nullptr when it isn't synced. Set from the message thread and read by the audio thread
+    std::atomic<DJAudioPlayer*> syncLeader{ nullptr };
+
+    // The leader of the last audio block (only used on the audio thread), so the control loop starts afresh with a new leader
+    DJAudioPlayer* lastSyncLeader = nullptr;
+
+    // Works out the synced speed for each block (only used on the audio thread)
+    BeatSync beatSync;
+
+    // The speed ratio the deck plays at: the speed slider's, or the synced one while it follows another deck
+    std::atomic<double> playingSpeedRatio{ 1.0 };
+
+    // The number of samples output since playback was prepared, and the output sample rate (only used on the audio thread)
+    juce::int64 outputSampleCount = 0;
+    double outputSampleRate = 44100.0;
+
+    // The beat clock of the last audio block, which a following deck reads
+    BeatClock beatClock;
+    juce::SpinLock beatClockLock;
+
+
     //======================================Fader Data===================================================================
     // Variables storing the speed of the fade, as well as Booleans keeping track of whether to fade the track at 
     // the present moment
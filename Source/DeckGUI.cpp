@@ -4,18 +4,22 @@
 //==============================================================================
 
 /** 
- *Constructor: takes in a pointer to one of the DJAudioPlayer instances in MainComponent, the MainComponent's
- * single formatManager, the thumbnail cache, the title of the DeckGUI to print as text on this component, and
- * the custom tech font by reference
+ *Constructor: takes in a pointer to one of the DJAudioPlayer instances in MainComponent, a pointer to the other
+ * deck's player (which this deck follows when SYNC is on), the MainComponent's single formatManager, the thumbnail
+ * cache, the cover art cache, the title of the DeckGUI to print as text on this component, and the custom tech font by reference
 */
 DeckGUI::DeckGUI(
     DJAudioPlayer* _player,
+    DJAudioPlayer* _otherPlayer,
     juce::AudioFormatManager& formatManagerToUse,
     juce::AudioThumbnailCache& cacheToUse,
+    CoverArtCache& _coverArtCache,
     std::string _deckTitle,
     juce::Font& _techFont) : 
         player(_player),
+        otherPlayer(_otherPlayer),
         waveformDisplay(formatManagerToUse, cacheToUse, _techFont),
+        coverArtCache(_coverArtCache),
         deckTitle(_deckTitle),
         techFont(_techFont)
 {
@@ -37,6 +41,32 @@ DeckGUI::DeckGUI(
     addAndMakeVisible(playButton);
     addAndMakeVisible(pauseButton);
 
+    // Number the hot cue buttons from 1, and colour them all as empty until a track with hot cues is loaded
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        hotCueButtons[i].setButtonText(juce::String(i + 1));
+        hotCueButtons[i].setTooltip("Click to set or jump to hot cue " + juce::String(i + 1) + ", shift-click to clear it");
+        addAndMakeVisible(hotCueButtons[i]);
+        hotCueButtons[i].addListener(this);
+    }
+    updateHotCueButtons();
+
+    // The loop and slip buttons light up while they are on
+    for (juce::TextButton* button : { &loopInButton, &loopOutButton, &halveLoopButton, &loopButton, &doubleLoopButton, &loopRollButton, &slipButton })
+    {
+        button->setColour(juce::TextButton::buttonColourId, juce::Colours::darkgrey);
+        button->setColour(juce::TextButton::buttonOnColourId, juce::Colour(14, 135, 250));
+        addAndMakeVisible(button);
+        button->addListener(this);
+    }
+    slipButton.setClickingTogglesState(true);
+    loopInButton.setTooltip("Set the start of a manual loop");
+    loopOutButton.setTooltip("Loop from the start set with IN to here");
+    loopButton.setTooltip("Loop the chosen number of beats, or stop looping");
+    loopRollButton.setTooltip("Hold to loop the chosen number of beats, then carry on where the track would have been");
+    slipButton.setTooltip("Loops carry on where the track would have been when they end");
+    updateLoopButton();
+
     //==========================Volume/Speed/Position sliders configuration======================================
 
     // Volume slider
@@ -79,6 +109,14 @@ DeckGUI::DeckGUI(
     volLabel.setJustificationType(juce::Justification::centred);
     speedLabel.setJustificationType(juce::Justification::centred);
     posLabel.setJustificationType(juce::Justification::centred);
+
+    // The SYNC button sits next to the speed slider's label, and lights up while the deck follows the other deck
+    addAndMakeVisible(syncButton);
+    syncButton.setClickingTogglesState(true);
+    syncButton.setColour(juce::TextButton::buttonColourId, juce::Colours::darkgrey);
+    syncButton.setColour(juce::TextButton::buttonOnColourId, juce::Colour(14, 135, 250));
+    syncButton.setTooltip("Match this deck's tempo and beats to the other deck's (both tracks need a beat grid)");
+    syncButton.addListener(this);
     
     //==========================Add custom components to the DecKGUI=====================================================
     addAndMakeVisible(volLabel);
@@ -99,6 +137,9 @@ DeckGUI::DeckGUI(
     speedSlider.addListener(this);
     posSlider.addListener(this);
 
+    // Repaints the cover art once the cache has decoded it
+    coverArtCache.addChangeListener(this);
+
     // TIMER CALLBACK: callback happens every 10 milliseconds (one hundredth of a second)
     startTimer(10); 
 }
@@ -107,6 +148,7 @@ DeckGUI::~DeckGUI()
 {
     // Stop the timer when the DeckGUI destructor is called
     stopTimer();
+    coverArtCache.removeChangeListener(this);
 }
 
 void DeckGUI::paint(juce::Graphics& g)
@@ -136,6 +178,14 @@ void DeckGUI::paint(juce::Graphics& g)
     g.setFont(techFont);
     // Draw the DeckGUI's name on the bottom left
     g.drawSingleLineText(juce::String(deckTitle), getWidth() * 0.05, getHeight() * 0.96, juce::Justification::left);
+
+    // Draws the loaded track's cover art next to the waveform, once the cache has decoded it
+    juce::Image coverArt = coverArtCache.getThumbnail(coverArtFile, coverArtOffset, coverArtSize, coverArtThumbnailSize);
+    if (coverArt.isValid())
+    {
+        g.drawImageWithin(coverArt, coverArtBounds.getX(), coverArtBounds.getY(), coverArtBounds.getWidth(), coverArtBounds.getHeight(),
+            juce::RectanglePlacement::centred);
+    }
 }
 
 
@@ -149,11 +199,26 @@ void DeckGUI::resized()
     double rowH = getHeight() / 7;
 
     // Places the Play and Pause buttons next to each other on one line
-    playButton.setBounds(getWidth() * 0.05, rowH * 0.25, getWidth() * 0.1, rowH);
-    pauseButton.setBounds(getWidth() * 0.18, rowH * 0.25, getWidth() * 0.1, rowH);
+    playButton.setBounds(getWidth() * 0.05, rowH * 0.25, getWidth() * 0.1, rowH * 0.75);
+    pauseButton.setBounds(getWidth() * 0.18, rowH * 0.25, getWidth() * 0.1, rowH * 0.75);
+
+    // The loaded track's cover art goes in a square to the right of the Play and Pause buttons, followed by the audio thumbnail/waveform
+    coverArtBounds.setBounds(getWidth() * 0.3, rowH * 0.25, rowH * 0.75, rowH * 0.75);
+    waveformDisplay.setBounds(getWidth() * 0.3 + rowH * 0.85, rowH * 0.25, getWidth() * 0.68 - rowH * 0.85, rowH * 0.75);
+
+    // The loop buttons go in a row underneath the Play and Pause buttons, followed by the hot cue buttons
+    juce::TextButton* loopButtons[] = { &loopInButton, &loopOutButton, &halveLoopButton, &loopButton, &doubleLoopButton, &loopRollButton, &slipButton };
+    double loopButtonWidth = getWidth() * 0.44 / 7;
+    for (int i = 0; i < 7; ++i)
+    {
+        loopButtons[i]->setBounds(getWidth() * 0.02 + loopButtonWidth * i, rowH * 1.05, loopButtonWidth - 2, rowH * 0.4);
+    }
 
-    // The next row below the Play and Pause buttons will show the audio thumbnail/waveform
-    waveformDisplay.setBounds(getWidth() * 0.3, rowH * 0.25, getWidth() * 0.68, rowH);
+    double hotCueWidth = getWidth() * 0.5 / DJAudioPlayer::numHotCues;
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        hotCueButtons[i].setBounds(getWidth() * 0.48 + hotCueWidth * i, rowH * 1.05, hotCueWidth - 2, rowH * 0.4);
+    }
 
     // Left column underneath Play/Pause buttons and the audio waveform: for the Fader buttons/slider
     fader.setBounds(0, rowH * 1.5, getWidth() * 0.25, rowH * 5);
@@ -162,7 +227,8 @@ void DeckGUI::resized()
     volSlider.setBounds(getWidth() * 0.25, rowH * 1.5, getWidth() * 0.25, rowH * 0.8);
     volLabel.setBounds(getWidth() * 0.25, rowH * 2.3, getWidth() * 0.25, rowH / 2);
     speedSlider.setBounds(getWidth() * 0.25, rowH * 3.5, getWidth() * 0.25, rowH * 0.8);
-    speedLabel.setBounds(getWidth() * 0.25, rowH * 4.3, getWidth() * 0.25, rowH / 2);
+    speedLabel.setBounds(getWidth() * 0.25, rowH * 4.3, getWidth() * 0.15, rowH / 2);
+    syncButton.setBounds(getWidth() * 0.4, rowH * 4.35, getWidth() * 0.09, rowH * 0.4);
     posSlider.setBounds(getWidth() * 0.25, rowH * 5.4, getWidth() * 0.25, rowH);
     posLabel.setBounds(getWidth() * 0.25, rowH * 6.3, getWidth() * 0.25, rowH / 2);
 
@@ -182,6 +248,105 @@ void DeckGUI::buttonClicked(juce::Button* button)
     {
         player->stop();
     }
+
+    if (button == &loopInButton)
+    {
+        player->setLoopIn();
+    }
+
+    if (button == &loopOutButton)
+    {
+        player->setLoopOut();
+    }
+
+    if (button == &loopButton)
+    {
+        if (player->isLooping())
+        {
+            player->exitLoop();
+        }
+        else
+        {
+            player->setAutoLoop(loopBeats);
+        }
+    }
+
+    // Halving or doubling the loop length resizes an active loop straight away
+    if (button == &halveLoopButton || button == &doubleLoopButton)
+    {
+        loopBeats = juce::jlimit(DJAudioPlayer::minLoopBeats, DJAudioPlayer::maxLoopBeats,
+            button == &halveLoopButton ? loopBeats / 2.0 : loopBeats * 2.0);
+        updateLoopButton();
+        if (player->isLooping() && !isRolling)
+        {
+            player->setAutoLoop(loopBeats);
+        }
+    }
+
+    if (button == &slipButton)
+    {
+        player->setSlipMode(slipButton.getToggleState());
+    }
+
+    // Turning sync off leaves the deck at the synced speed, which the speed slider already shows
+    if (button == &syncButton)
+    {
+        player->syncTo(syncButton.getToggleState() ? otherPlayer : nullptr);
+    }
+
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        if (button != &hotCueButtons[i] || loadedFilePath.empty())
+        {
+            continue;
+        }
+
+        // A set cue jumps straight there, an empty one is set at the playhead, and shift-clicking clears the cue
+        if (juce::ModifierKeys::currentModifiers.isShiftDown())
+        {
+            player->setHotCue(i, -1.0);
+        }
+        else if (player->triggerHotCue(i))
+        {
+            return;
+        }
+        else
+        {
+            player->setHotCue(i, player->getPositionInSeconds());
+        }
+
+        updateHotCueButtons();
+        if (onHotCuesChanged)
+        {
+            std::vector<double> hotCues;
+            for (int cue = 0; cue < DJAudioPlayer::numHotCues; ++cue)
+            {
+                hotCues.push_back(player->getHotCue(cue));
+            }
+            onHotCuesChanged(loadedFilePath, hotCues);
+        }
+    }
+}
+
+
+/** Called when a button is pressed or released: the loop roll plays while its button is held down */
+void DeckGUI::buttonStateChanged(juce::Button* button)
+{
+    if (button != &loopRollButton)
+    {
+        return;
+    }
+
+    if (button->isDown() && !isRolling)
+    {
+        player->startLoopRoll(loopBeats);
+        isRolling = true;
+    }
+    else if (!button->isDown() && isRolling)
+    {
+        player->exitLoop();
+        isRolling = false;
+    }
 }
 
 
@@ -212,19 +377,90 @@ void DeckGUI::timerCallback()
 
     // When the user clicks on Fade In/Fade Out buttons, update the position of the volume slider as the volume increases/decreases
     volSlider.setValue(player->getGain());
-    
+
+    // The loop button stays lit while a loop plays (which a hot cue or a jump out of the loop can end)
+    loopButton.setToggleState(player->isLooping(), juce::dontSendNotification);
+
+    // While the deck is synced the speed slider follows the synced speed, and the SYNC button goes out if the other
+    // deck is synced to this one instead
+    bool isSynced = player->isSynced();
+    syncButton.setToggleState(isSynced, juce::dontSendNotification);
+    if (isSynced)
+    {
+        speedSlider.setValue(player->getSpeed(), juce::dontSendNotification);
+    }
+}
+
+/** Implements the pure virtual function of the ChangeListener: called when the CoverArtCache has decoded more thumbnails */
+void DeckGUI::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    // Only the cover art's square needs redrawing
+    if (source == &coverArtCache)
+    {
+        repaint(coverArtBounds);
+    }
 }
 
-/** Passes an audio file's URL from the PlaylistComponent which owns this DeckGUI into the DeckGUI's DJAudioPlayer */
-void DeckGUI::loadTrack(juce::URL chosenFile)
+/**
+ *Passes a track from the PlaylistComponent which owns this DeckGUI into the DeckGUI's DJAudioPlayer, along with
+ *where its cover art is stored in the file (a size of 0 if it has none) and its loudness, if it has been analysed
+ */
+void DeckGUI::loadTrack(Track& track)
 {
+    juce::URL chosenFile = track.getUrl();
+    loadedFilePath = track.getFilePath();
+
+    // The cover art is fetched from the cache the next time the deck is painted
+    coverArtFile = chosenFile.getLocalFile();
+    coverArtOffset = track.getCoverArtOffset();
+    coverArtSize = track.getCoverArtSize();
+    repaint(coverArtBounds);
+
     // Attribution: https://docs.juce.com/master/classFileChooser.html#ac888983e4abdd8401ba7d6124ae64ff3
     // Loads the audio track URL into the player using it loadURL method
     player->loadURL(chosenFile);
+
+    // Auto-loops snap to the track's beat grid, once it has been analysed
+    player->setBeatGrid(track.getAnalysedBpm(), track.getFirstBeatSeconds());
+
+    // Plays the track at the target loudness (or as it is, until it has been analysed)
+    player->setTrackLoudness(track.getIntegratedLoudness(), track.getTruePeak());
+
+    // The player starts decoding the audio after each hot cue straight away, so they can be jumped to without a gap
+    player->setHotCues(track.getHotCues());
+    updateHotCueButtons();
     
-    // Loads the audio track data into the waveform display instance
-    waveformDisplay.loadURL(chosenFile);
+    // Loads the audio track data into the waveform display instance, whose thumbnail is cached under the track's content hash
+    waveformDisplay.loadURL(chosenFile, track.getContentHash());
 
     // Loads the length of the track into the waveformDisplay
     waveformDisplay.setTrackLengthInSeconds(player->getTrackLengthInSeconds());
+}
+
+/** Called by the PlaylistComponent when a track has been analysed: if it is the loaded track, its loudness and beat grid are passed to the player */
+void DeckGUI::trackAnalysed(Track& track)
+{
+    if (!loadedFilePath.empty() && track.getFilePath() == loadedFilePath)
+    {
+        player->setTrackLoudness(track.getIntegratedLoudness(), track.getTruePeak());
+        player->setBeatGrid(track.getAnalysedBpm(), track.getFirstBeatSeconds());
+    }
+}
+
+/** Colours each hot cue button by whether its cue is set */
+void DeckGUI::updateHotCueButtons()
+{
+    for (int i = 0; i < DJAudioPlayer::numHotCues; ++i)
+    {
+        bool isSet = player->getHotCue(i) >= 0.0;
+        hotCueButtons[i].setColour(juce::TextButton::buttonColourId, isSet ? juce::Colour(14, 135, 250) : juce::Colours::darkgrey);
+        hotCueButtons[i].setColour(juce::TextButton::textColourOffId, isSet ? juce::Colours::white : juce::Colours::lightgrey);
+    }
+}
+
+/** Shows the length of the next auto-loop (or loop roll) on the loop button */
+void DeckGUI::updateLoopButton()
+{
+    juce::String beats = loopBeats >= 1.0 ? juce::String((int)loopBeats) : "1/" + juce::String(juce::roundToInt(1.0 / loopBeats));
+    loopButton.setButtonText("LOOP " + beats);
 }
\ No newline at end of file
@@ -5,23 +5,31 @@
 #include "WaveformDisplay.h"
 #include "Fader.h"
 #include "ReverbEffects.h"
+#include "CoverArtCache.h"
+#include "Track.h"
+#include <functional>
+#include <vector>
 
 //==============================================================================
 class DeckGUI : public juce::Component,
     public juce::Button::Listener,
     public juce::Slider::Listener,
-    public juce::Timer
+    public juce::Timer,
+    // Repaints the cover art when the CoverArtCache has decoded it
+    public juce::ChangeListener
 {
 public:
     /** 
-     *Constructor: takes in a pointer to one of the DJAudioPlayer instances in MainComponent, the MainComponent's
-     * single formatManager, the thumbnail cache, the title of the DeckGUI to print as text on this component, and
-     * the custom tech font by reference
+     *Constructor: takes in a pointer to one of the DJAudioPlayer instances in MainComponent, a pointer to the other
+     * deck's player (which this deck follows when SYNC is on), the MainComponent's single formatManager, the thumbnail
+     * cache, the cover art cache, the title of the DeckGUI to print as text on this component, and the custom tech font by reference
     */
     DeckGUI(
         DJAudioPlayer* _player,
+        DJAudioPlayer* _otherPlayer,
         juce::AudioFormatManager& formatManagerToUse, // Pass in these args from mainComponent to use the data in the AudioThumbnail
         juce::AudioThumbnailCache& cacheToUse,
+        CoverArtCache& _coverArtCache,
         std::string _deckTitle,
         juce::Font& _techFont);
 
@@ -40,16 +48,40 @@ public:
     /** Implements the pure virtual function that cames with the Button listener which this class inherits from */
     void buttonClicked(juce::Button* button) override;
 
+    /** Called when a button is pressed or released: the loop roll plays while its button is held down */
+    void buttonStateChanged(juce::Button* button) override;
+
     /** Implements the pure virtual function that cames with the Slider listener which this class inherits from */
     void sliderValueChanged(juce::Slider* slider) override;
 
     /** Implements juce::Timer's inherited pure virtual function: callback routine that actually gets called periodically */
     void timerCallback() override;
 
-    /** Passes an audio file's URL from the PlaylistComponent which owns this DeckGUI into the DeckGUI's DJAudioPlayer */
-    void loadTrack(juce::URL chosenFile);
+    /** Implements the pure virtual function of the ChangeListener: called when the CoverArtCache has decoded more thumbnails */
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+    /**
+     *Passes a track from the PlaylistComponent which owns this DeckGUI into the DeckGUI's DJAudioPlayer, along with
+     *where its cover art is stored in the file (a size of 0 if it has none) and its loudness, if it has been analysed
+     */
+    void loadTrack(Track& track);
+
+    /** Called by the PlaylistComponent when a track has been analysed: if it is the loaded track, its loudness and beat grid are passed to the player */
+    void trackAnalysed(Track& track);
+
+    /**
+     *Called with the loaded track's file path and all of its hot cue positions in seconds (-1 for a cue which is not set)
+     *when the user sets or clears a hot cue, so the PlaylistComponent can store them in the library
+     */
+    std::function<void(const std::string& filePath, const std::vector<double>& hotCues)> onHotCuesChanged;
 
 private:
+    /** Colours each hot cue button by whether its cue is set */
+    void updateHotCueButtons();
+
+    /** Shows the length of the next auto-loop (or loop roll) on the loop button */
+    void updateLoopButton();
+
     // Your private member variables go here...
     
     // Loads "Play"/"Pause" icons from the Project's "SOURCE" directory
@@ -64,6 +96,26 @@ private:
     juce::ImageButton playButton{ "PLAY" };
     juce::ImageButton pauseButton{ "PAUSE" };
 
+    // One button for each hot cue: clicking an empty one sets it at the playhead, clicking a set one jumps to it,
+    // and shift-clicking one clears it
+    juce::TextButton hotCueButtons[DJAudioPlayer::numHotCues];
+
+    // Loop controls: manual in/out points, an auto-loop whose length is halved and doubled by the buttons either side
+    // of it, a loop roll which plays while it is held down, and slip mode
+    juce::TextButton loopInButton{ "IN" };
+    juce::TextButton loopOutButton{ "OUT" };
+    juce::TextButton halveLoopButton{ "/2" };
+    juce::TextButton loopButton;
+    juce::TextButton doubleLoopButton{ "x2" };
+    juce::TextButton loopRollButton{ "ROLL" };
+    juce::TextButton slipButton{ "SLIP" };
+
+    // The length in beats of the next auto-loop or loop roll
+    double loopBeats = 4.0;
+
+    // Whether the loop roll button is being held down
+    bool isRolling = false;
+
     // Create volume, speed, and relative position sliders and their respective labels
     juce::Slider volSlider;
     juce::Slider speedSlider;
@@ -72,11 +124,17 @@ private:
     juce::Label speedLabel;
     juce::Label posLabel;
 
+    // Matches this deck's tempo and beats to the other deck's while it is on
+    juce::TextButton syncButton{ "SYNC" };
+
     juce::FileChooser fChooser{ "Select a file..." };
 
     // Pointer to a DJAudioPlayer to transmit information received from button/slider listeners into the player
     DJAudioPlayer* player;
 
+    // Pointer to the other deck's DJAudioPlayer, which this deck's player follows when SYNC is on
+    DJAudioPlayer* otherPlayer;
+
     // A Component Class instance which stores buttons to auto fade-in/fade-out the music, as well as a fade-speed slider
     Fader fader{ player };
 
@@ -86,6 +144,23 @@ private:
     // Creates and stores an instance of the WaveformDisplay Class Component to show thumbnail of the track data
     WaveformDisplay waveformDisplay;
 
+    // The cache which decodes the loaded track's cover art in the background
+    CoverArtCache& coverArtCache;
+
+    // The loaded audio file and where its cover art is stored in it, so the thumbnail can be fetched from the cache when painting
+    juce::File coverArtFile;
+    juce::int64 coverArtOffset = 0;
+    juce::int64 coverArtSize = 0;
+
+    // The full path of the loaded audio file, so the deck knows when the loaded track's analysis comes back
+    std::string loadedFilePath;
+
+    // Where the cover art is drawn, next to the waveform (set in resized())
+    juce::Rectangle<int> coverArtBounds;
+
+    // The size the deck's cover art is decoded at: a little larger than it is drawn, so it stays sharp when the window is made bigger
+    static constexpr int coverArtThumbnailSize = 128;
+
     // Stores the name of this DeckGUI (e.g. "D1" for DeckGUI 1)
     std::string deckTitle;
 
@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    HotCueSource.cpp
+    Created: 19 Oct 2026 9:02:37pm
+    Author:  Ophelia
+    Purpose: plays a deck's track from its decoder, and jumps to its hot cues straight away by playing the first
+             couple of seconds after each cue from audio which was decoded into memory in advance
+
+  ==============================================================================
+*/
+
+#include "HotCueSource.h"
+
+/**
+ *Constructor: takes in the decoder which plays the track (a BufferingAudioSource reading ahead on the backgroundThread),
+ *the formatManager and URL used to open a second reader of the track for the hot cues, the track's sample rate,
+ *and the background thread which decodes the hot cues' audio
+ */
+HotCueSource::HotCueSource(
+    juce::BufferingAudioSource* _decoder,
+    juce::AudioFormatManager& _formatManager,
+    const juce::URL& _audioURL,
+    double _sampleRate,
+    juce::TimeSliceThread& _backgroundThread) :
+        decoder(_decoder),
+        formatManager(_formatManager),
+        audioURL(_audioURL),
+        backgroundThread(_backgroundThread)
+{
+    // Two seconds is far longer than the decoder takes to seek and read ahead, and keeps the memory of 8 cues to a few MB
+    numHotCueSamples = juce::jmax(1, juce::roundToInt(_sampleRate * 2.0));
+
+    backgroundThread.addTimeSliceClient(this);
+}
+
+/** Destructor: waits for the background thread to finish decoding any hot cue */
+HotCueSource::~HotCueSource()
+{
+    backgroundThread.removeTimeSliceClient(this);
+}
+
+//====================PositionableAudioSource Virtual Functions Implementation=============
+
+/** Tells the decoder to prepare for playing */
+void HotCueSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    decoder->prepareToPlay(samplesPerBlockExpected, sampleRate);
+}
+
+/** Fills the block from a triggered hot cue's decoded audio while there is some left, and from the decoder after that */
+void HotCueSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    int numFromMemory = 0;
+    bool waitingForDecoder = false;
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+
+        if (playingHotCue >= 0)
+        {
+            const juce::AudioBuffer<float>& samples = *hotCues[playingHotCue].samples;
+            numFromMemory = juce::jmin(bufferToFill.numSamples, samples.getNumSamples() - hotCueReadPosition);
+            for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+            {
+                bufferToFill.buffer->copyFrom(channel, bufferToFill.startSample, samples,
+                    channel % samples.getNumChannels(), hotCueReadPosition, numFromMemory);
+            }
+
+            // Once the cue's audio runs out, the decoder carries on from where it ends (where it was sent when the cue was triggered)
+            hotCueReadPosition += numFromMemory;
+            if (hotCueReadPosition >= samples.getNumSamples())
+            {
+                playingHotCue = -1;
+            }
+
+            if (triggerTime > 0.0)
+            {
+                lastTriggerLatency = juce::Time::getMillisecondCounterHiRes() - triggerTime;
+                lastTriggerFromMemory = true;
+                triggerTime = 0.0;
+            }
+        }
+        else
+        {
+            waitingForDecoder = triggerTime > 0.0;
+        }
+    }
+
+    if (numFromMemory == bufferToFill.numSamples)
+    {
+        return;
+    }
+
+    juce::AudioSourceChannelInfo remainder(bufferToFill.buffer, bufferToFill.startSample + numFromMemory, bufferToFill.numSamples - numFromMemory);
+
+    // A cue which was triggered before its audio was decoded is heard once the decoder has read ahead from it (until then it plays silence)
+    if (waitingForDecoder && decoder->waitForNextAudioBlockReady(remainder, 0))
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+        if (triggerTime > 0.0)
+        {
+            lastTriggerLatency = juce::Time::getMillisecondCounterHiRes() - triggerTime;
+            lastTriggerFromMemory = false;
+            triggerTime = 0.0;
+        }
+    }
+
+    decoder->getNextAudioBlock(remainder);
+}
+
+/** Allows the decoder to release anything it no longer needs after playback has stopped */
+void HotCueSource::releaseResources()
+{
+    decoder->releaseResources();
+}
+
+/** Moves playback to a new position (e.g. from the position slider), which stops playing from a hot cue's audio */
+void HotCueSource::setNextReadPosition(juce::int64 newPosition)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+        stopPlayingHotCue();
+        triggerTime = 0.0;
+    }
+    decoder->setNextReadPosition(newPosition);
+}
+
+/** Returns the position of the next sample which will be played */
+juce::int64 HotCueSource::getNextReadPosition() const
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+        if (playingHotCue >= 0)
+        {
+            return hotCues[playingHotCue].position + hotCueReadPosition;
+        }
+    }
+    return decoder->getNextReadPosition();
+}
+
+/** Returns the length of the track in samples */
+juce::int64 HotCueSource::getTotalLength() const
+{
+    return decoder->getTotalLength();
+}
+
+/** Returns false, as tracks are not looped */
+bool HotCueSource::isLooping() const
+{
+    return false;
+}
+
+//==============================================================================
+
+/** Sets the hot cue to the given position in samples (or clears it, for a negative position), and decodes its audio in the background */
+void HotCueSource::setHotCue(int index, juce::int64 position)
+{
+    if (index < 0 || index >= numHotCues)
+    {
+        return;
+    }
+
+    // The old audio is freed here rather than on the audio thread
+    std::unique_ptr<juce::AudioBuffer<float>> oldSamples;
+    juce::int64 reachedPosition = -1;
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+
+        // Playback which is still in the old cue's audio carries on from the decoder at the same position
+        if (playingHotCue == index)
+        {
+            reachedPosition = stopPlayingHotCue();
+        }
+
+        hotCues[index].position = position < 0 ? -1 : position;
+        oldSamples.swap(hotCues[index].samples);
+        hotCues[index].decodedPosition = -1;
+    }
+
+    if (reachedPosition >= 0)
+    {
+        decoder->setNextReadPosition(reachedPosition);
+    }
+
+    // Wakes the background thread to decode the cue's audio
+    if (position >= 0)
+    {
+        backgroundThread.moveToFrontOfQueue(this);
+    }
+}
+
+/** Returns the position of the hot cue in samples, or -1 if it is not set */
+juce::int64 HotCueSource::getHotCue(int index) const
+{
+    if (index < 0 || index >= numHotCues)
+    {
+        return -1;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(cueLock);
+    return hotCues[index].position;
+}
+
+/** Returns true if the hot cue's audio has been decoded into memory, so triggering it is heard in the next audio block */
+bool HotCueSource::isHotCueDecoded(int index) const
+{
+    if (index < 0 || index >= numHotCues)
+    {
+        return false;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(cueLock);
+    return hotCues[index].position >= 0 && hotCues[index].samples != nullptr && hotCues[index].decodedPosition == hotCues[index].position;
+}
+
+/** Jumps playback to the hot cue, returning false if it is not set */
+bool HotCueSource::triggerHotCue(int index)
+{
+    if (index < 0 || index >= numHotCues)
+    {
+        return false;
+    }
+
+    juce::int64 decoderPosition;
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+
+        HotCue& hotCue = hotCues[index];
+        if (hotCue.position < 0)
+        {
+            return false;
+        }
+
+        triggerTime = juce::Time::getMillisecondCounterHiRes();
+
+        // With the cue's audio in memory, the next audio block plays it, and the decoder starts reading ahead from where it ends
+        if (hotCue.samples != nullptr && hotCue.decodedPosition == hotCue.position)
+        {
+            playingHotCue = index;
+            hotCueReadPosition = 0;
+            decoderPosition = hotCue.position + hotCue.samples->getNumSamples();
+        }
+        else
+        {
+            playingHotCue = -1;
+            decoderPosition = hotCue.position;
+        }
+    }
+
+    decoder->setNextReadPosition(decoderPosition);
+    return true;
+}
+
+/**
+ *Returns the time in milliseconds from the last hot cue trigger to its first audio reaching the audio callback, and
+ *whether that audio came from memory (true) or from the decoder (false). Returns -1 if no trigger has been measured
+ *since the last call
+ */
+double HotCueSource::takeTriggerLatency(bool& playedFromMemory)
+{
+    const juce::SpinLock::ScopedLockType lock(cueLock);
+
+    double latency = lastTriggerLatency;
+    playedFromMemory = lastTriggerFromMemory;
+    lastTriggerLatency = -1.0;
+    return latency;
+}
+
+/**
+ *Implements juce::TimeSliceClient's inherited pure virtual function: decodes the audio of one hot cue whose audio
+ *is missing or out of date, and returns how long to wait before being called again
+ */
+int HotCueSource::useTimeSlice()
+{
+    int index = -1;
+    juce::int64 position = -1;
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+        for (int i = 0; i < numHotCues && index < 0; ++i)
+        {
+            if (hotCues[i].position >= 0 && hotCues[i].decodedPosition != hotCues[i].position)
+            {
+                index = i;
+                position = hotCues[i].position;
+            }
+        }
+    }
+
+    // Nothing to decode: checks again now and then, though setting a cue wakes the thread straight away
+    if (index < 0)
+    {
+        return 500;
+    }
+
+    if (hotCueReader == nullptr)
+    {
+        hotCueReader.reset(formatManager.createReaderFor(audioURL.createInputStream(false)));
+        if (hotCueReader == nullptr)
+        {
+            return 500;
+        }
+    }
+
+    // Decoded as stereo, as the AudioFormatReaderSource which the decoder reads from fills a stereo block
+    // (a mono track is copied into both channels)
+    auto samples = std::make_unique<juce::AudioBuffer<float>>(2, numHotCueSamples);
+    samples->clear();
+    int numSamples = (int)juce::jlimit<juce::int64>(0, numHotCueSamples, hotCueReader->lengthInSamples - position);
+    hotCueReader->read(samples.get(), 0, numSamples, position, true, true);
+    samples->setSize(2, juce::jmax(1, numSamples), true);
+
+    // The cue may have been moved while its audio was being decoded, in which case the audio is thrown away and decoded again
+    {
+        const juce::SpinLock::ScopedLockType lock(cueLock);
+        if (hotCues[index].position == position)
+        {
+            samples.swap(hotCues[index].samples);
+            hotCues[index].decodedPosition = position;
+        }
+    }
+
+    // Straight on to the next cue, if there is one
+    return 0;
+}
+
+/** Stops playing from a hot cue's audio (with cueLock held), returning the position playback had reached, or -1 if no cue was playing */
+juce::int64 HotCueSource::stopPlayingHotCue()
+{
+    if (playingHotCue < 0)
+    {
+        return -1;
+    }
+
+    juce::int64 reachedPosition = hotCues[playingHotCue].position + hotCueReadPosition;
+    playingHotCue = -1;
+    return reachedPosition;
+}
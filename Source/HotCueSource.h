@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    HotCueSource.h
+    Created: 19 Oct 2026 9:02:37pm
+    Author:  Ophelia
+    Purpose: plays a deck's track from its decoder, and jumps to its hot cues straight away by playing the first
+             couple of seconds after each cue from audio which was decoded into memory in advance
+
+  ==============================================================================
+  Jumping to a new position in a compressed file means the decoder has to seek and decode again before any audio
+  comes out, which is heard as a gap when a hot cue is pressed. So while a track is loaded, the audio just after each
+  of its hot cues is decoded into memory on the deck's background thread (with its own reader, so playback is never
+  held up). When a cue is triggered, playback starts from that memory in the very next audio block, while the decoder
+  (a BufferingAudioSource, which reads ahead on the same background thread) seeks to where the memory runs out and
+  catches up in the background; once the memory has been played, playback carries on from the decoder seamlessly.
+  A cue whose audio has not been decoded yet (e.g. just after the track was loaded) falls back to seeking the decoder.
+
+  The time from each trigger to the first audio of the cue reaching the audio callback is measured, so the two
+  paths can be compared (see takeTriggerLatency(), and HotCueSourceTests, which measures both).
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+
+class HotCueSource : public juce::PositionableAudioSource,
+    // Decodes the audio after each hot cue on the deck's background thread
+    private juce::TimeSliceClient
+{
+public:
+    // The number of hot cues on each deck
+    static constexpr int numHotCues = 8;
+
+    /**
+     *Constructor: takes in the decoder which plays the track (a BufferingAudioSource reading ahead on the backgroundThread),
+     *the formatManager and URL used to open a second reader of the track for the hot cues, the track's sample rate,
+     *and the background thread which decodes the hot cues' audio
+     */
+    HotCueSource(
+        juce::BufferingAudioSource* _decoder,
+        juce::AudioFormatManager& _formatManager,
+        const juce::URL& _audioURL,
+        double _sampleRate,
+        juce::TimeSliceThread& _backgroundThread);
+
+    /** Destructor: waits for the background thread to finish decoding any hot cue */
+    ~HotCueSource() override;
+
+    //====================PositionableAudioSource Virtual Functions Implementation=============
+    /** Tells the decoder to prepare for playing */
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    /** Fills the block from a triggered hot cue's decoded audio while there is some left, and from the decoder after that */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+    /** Allows the decoder to release anything it no longer needs after playback has stopped */
+    void releaseResources() override;
+    /** Moves playback to a new position (e.g. from the position slider), which stops playing from a hot cue's audio */
+    void setNextReadPosition(juce::int64 newPosition) override;
+    /** Returns the position of the next sample which will be played */
+    juce::int64 getNextReadPosition() const override;
+    /** Returns the length of the track in samples */
+    juce::int64 getTotalLength() const override;
+    /** Returns false, as tracks are not looped */
+    bool isLooping() const override;
+    //==============================================================================
+
+    /** Sets the hot cue to the given position in samples (or clears it, for a negative position), and decodes its audio in the background */
+    void setHotCue(int index, juce::int64 position);
+
+    /** Returns the position of the hot cue in samples, or -1 if it is not set */
+    juce::int64 getHotCue(int index) const;
+
+    /** Returns true if the hot cue's audio has been decoded into memory, so triggering it is heard in the next audio block */
+    bool isHotCueDecoded(int index) const;
+
+    /** Jumps playback to the hot cue, returning false if it is not set */
+    bool triggerHotCue(int index);
+
+    /**
+     *Returns the time in milliseconds from the last hot cue trigger to its first audio reaching the audio callback, and
+     *whether that audio came from memory (true) or from the decoder (false). Returns -1 if no trigger has been measured
+     *since the last call
+     */
+    double takeTriggerLatency(bool& playedFromMemory);
+
+private:
+    /** A hot cue and the audio after it which has been decoded into memory */
+    struct HotCue
+    {
+        // The position of the cue in samples, or -1 if it is not set
+        juce::int64 position = -1;
+        // The audio after the cue, and the position it was decoded from (which no longer matches once the cue is moved)
+        std::unique_ptr<juce::AudioBuffer<float>> samples;
+        juce::int64 decodedPosition = -1;
+    };
+
+    /**
+     *Implements juce::TimeSliceClient's inherited pure virtual function: decodes the audio of one hot cue whose audio
+     *is missing or out of date, and returns how long to wait before being called again
+     */
+    int useTimeSlice() override;
+
+    /** Stops playing from a hot cue's audio (with cueLock held), returning the position playback had reached, or -1 if no cue was playing */
+    juce::int64 stopPlayingHotCue();
+
+    // The decoder which plays the track, which reads ahead on the backgroundThread
+    juce::BufferingAudioSource* decoder;
+
+    // Used to open a second reader of the track on the background thread, so decoding the hot cues never moves the decoder
+    juce::AudioFormatManager& formatManager;
+    juce::URL audioURL;
+    std::unique_ptr<juce::AudioFormatReader> hotCueReader;
+
+    // The number of samples decoded into memory after each hot cue: long enough for the decoder to seek and catch up
+    int numHotCueSamples;
+
+    // The deck's background thread, which decodes the hot cues' audio
+    juce::TimeSliceThread& backgroundThread;
+
+    HotCue hotCues[numHotCues];
+
+    // The hot cue whose audio is being played (-1 when playing from the decoder), and how far into its audio playback has reached
+    int playingHotCue = -1;
+    int hotCueReadPosition = 0;
+
+    // The time of the last trigger (0 once its first audio has been played), and the last measured latency and whether it played from memory
+    double triggerTime = 0.0;
+    double lastTriggerLatency = -1.0;
+    bool lastTriggerFromMemory = false;
+
+    // Locks the hot cues and the playing state, which the audio thread, the message thread and the background thread all use.
+    // It is only ever held for a pointer swap or for copying one audio block, so the audio thread is never held up for long
+    mutable juce::SpinLock cueLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HotCueSource)
+};
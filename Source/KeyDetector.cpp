@@ -0,0 +1,265 @@
+/*
+  ==============================================================================
+
+    KeyDetector.cpp
+    Created: 19 Oct 2026 8:06:27pm
+    Author:  Ophelia
+    Purpose: works out the musical key of a track from its decoded audio, for harmonic mixing
+
+  ==============================================================================
+*/
+
+#include "KeyDetector.h"
+#include <cmath>
+
+namespace
+{
+    // The Krumhansl-Kessler profiles of a major and a minor key with their root at C, from C to B
+    const double majorProfile[12] = { 6.35, 2.23, 3.48, 2.33, 4.38, 4.09, 2.52, 5.19, 2.39, 3.66, 2.29, 2.88 };
+    const double minorProfile[12] = { 6.33, 2.68, 3.52, 5.38, 2.60, 3.53, 2.54, 4.75, 3.98, 2.69, 3.34, 3.17 };
+
+    // The names of the roots, using the spelling DJ software usually shows for each key
+    const char* const majorRootNames[12] = { "C", "Db", "D", "Eb", "E", "F", "F#", "G", "Ab", "A", "Bb", "B" };
+    const char* const minorRootNames[12] = { "C", "C#", "D", "Eb", "E", "F", "F#", "G", "G#", "A", "Bb", "B" };
+
+    /** Returns the Pearson correlation of the chromagram with the profile rotated to start at the given root */
+    double correlate(const double* chromagram, const double* profile, int root)
+    {
+        double chromaMean = 0.0, profileMean = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            chromaMean += chromagram[i] / 12.0;
+            profileMean += profile[i] / 12.0;
+        }
+
+        double covariance = 0.0, chromaVariance = 0.0, profileVariance = 0.0;
+        for (int i = 0; i < 12; ++i)
+        {
+            double chroma = chromagram[(root + i) % 12] - chromaMean;
+            double weight = profile[i] - profileMean;
+            covariance += chroma * weight;
+            chromaVariance += chroma * chroma;
+            profileVariance += weight * weight;
+        }
+        return chromaVariance > 0.0 ? covariance / std::sqrt(chromaVariance * profileVariance) : 0.0;
+    }
+}
+
+/** Constructor: takes in the sample rate of the audio which will be passed to process() */
+KeyDetector::KeyDetector(double inputSampleRate)
+{
+    decimationFactor = juce::jmax(1, (int)(inputSampleRate / targetAnalysisSampleRate));
+    analysisSampleRate = inputSampleRate / decimationFactor;
+
+    // Cuts off just above the highest note, well below the decimated audio's Nyquist frequency
+    for (juce::IIRFilter& filter : antiAliasingFilters)
+    {
+        filter.setCoefficients(juce::IIRCoefficients::makeLowPass(inputSampleRate, juce::jmin(maxFrequency * 1.5, analysisSampleRate * 0.4)));
+    }
+
+    fftData.resize((size_t)fftSize * 2);
+
+    // Works out which note each bin belongs to once, so that folding a frame is a single pass over the bins
+    firstBin = (int)std::ceil(minFrequency * fftSize / analysisSampleRate);
+    lastBin = juce::jmin(numBins - 1, (int)std::floor(maxFrequency * fftSize / analysisSampleRate));
+    for (int bin = firstBin; bin <= lastBin; ++bin)
+    {
+        double frequency = bin * analysisSampleRate / fftSize;
+        double midiNote = 69.0 + 12.0 * std::log2(frequency / 440.0);
+        double nearestNote = std::round(midiNote);
+
+        // Bins between two notes count less, as they are as likely to be the note above or below
+        double distance = midiNote - nearestNote;
+        binPitchClasses.push_back((int)nearestNote % 12);
+        binWeights.push_back((float)std::pow(std::cos(juce::MathConstants<double>::pi * distance), 2.0));
+    }
+}
+
+/** Adds the next block of the track's audio (mixed down to mono) to the chromagram */
+void KeyDetector::process(const float* monoSamples, int numSamples)
+{
+    // The filters run over a copy of the block, as the same block is passed to the other analysers
+    filteredSamples.assign(monoSamples, monoSamples + numSamples);
+    for (juce::IIRFilter& filter : antiAliasingFilters)
+    {
+        filter.processSamples(filteredSamples.data(), numSamples);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (++decimationCount == decimationFactor)
+        {
+            analysisSamples.push_back(filteredSamples[(size_t)i]);
+            decimationCount = 0;
+        }
+    }
+
+    processFrames();
+}
+
+/** Adds the pitch classes of every full frame of audio waiting in analysisSamples to the chromagram */
+void KeyDetector::processFrames()
+{
+    while (analysisSamples.size() - readPosition >= (size_t)fftSize)
+    {
+        std::fill(fftData.begin(), fftData.end(), 0.0f);
+        juce::FloatVectorOperations::copy(fftData.data(), analysisSamples.data() + readPosition, fftSize);
+        window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+        double frameChroma[12] = {};
+        double frameTotal = 0.0;
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+        {
+            double energy = (double)binWeights[(size_t)(bin - firstBin)] * fftData[(size_t)bin] * fftData[(size_t)bin];
+            frameChroma[binPitchClasses[(size_t)(bin - firstBin)]] += energy;
+            frameTotal += energy;
+        }
+
+        // Each frame is normalised before it is added, so a loud chorus does not outweigh the rest of the track.
+        // Near-silent frames (e.g. the gaps between tracks on a mix) are left out, as they are mostly noise
+        if (frameTotal > 1.0e-6)
+        {
+            for (int pitchClass = 0; pitchClass < 12; ++pitchClass)
+            {
+                chromagram[pitchClass] += std::sqrt(frameChroma[pitchClass] / frameTotal);
+            }
+        }
+
+        readPosition += (size_t)hopSize;
+    }
+
+    // Throws away the audio which every remaining frame is past, now and then rather than after every frame
+    if (readPosition >= 65536)
+    {
+        analysisSamples.erase(analysisSamples.begin(), analysisSamples.begin() + (std::ptrdiff_t)readPosition);
+        readPosition = 0;
+    }
+}
+
+/** Returns the key (0 to 23) which best fits all of the audio passed in so far, or -1 if no notes were heard */
+int KeyDetector::getKey() const
+{
+    int bestKey = -1;
+    double bestCorrelation = 0.0;
+    for (int root = 0; root < 12; ++root)
+    {
+        double majorCorrelation = correlate(chromagram, majorProfile, root);
+        if (majorCorrelation > bestCorrelation)
+        {
+            bestCorrelation = majorCorrelation;
+            bestKey = root;
+        }
+
+        double minorCorrelation = correlate(chromagram, minorProfile, root);
+        if (minorCorrelation > bestCorrelation)
+        {
+            bestCorrelation = minorCorrelation;
+            bestKey = 12 + root;
+        }
+    }
+    return bestKey;
+}
+
+/** Returns the Camelot code of the key, e.g. "8A" for A minor (an empty string for -1) */
+juce::String KeyDetector::getCamelotCode(int key)
+{
+    if (key < 0 || key >= 24)
+    {
+        return {};
+    }
+
+    // The wheel goes round the circle of fifths from 8B (C major). A minor key has the same number as its relative major, three semitones up
+    bool isMinor = key >= 12;
+    int majorRoot = isMinor ? (key - 12 + 3) % 12 : key;
+    int number = (majorRoot * 7 + 7) % 12 + 1;
+    return juce::String(number) + (isMinor ? "A" : "B");
+}
+
+/** Returns the short name of the key, e.g. "Am" for A minor or "Eb" for E flat major (an empty string for -1) */
+juce::String KeyDetector::getKeyName(int key)
+{
+    if (key < 0 || key >= 24)
+    {
+        return {};
+    }
+    return key < 12 ? juce::String(majorRootNames[key]) : juce::String(minorRootNames[key - 12]) + "m";
+}
+
+/**
+ *Reads a key from a Camelot code (e.g. "8A") or a key name as it is written in tags (e.g. "Am", "F#", "Bb minor", "Cmaj"),
+ *returning -1 if the text is not a key
+ */
+int KeyDetector::parseKey(const juce::String& text)
+{
+    juce::String trimmed = text.removeCharacters(" \t").toLowerCase();
+    if (trimmed.isEmpty())
+    {
+        return -1;
+    }
+
+    // Camelot codes: a number from 1 to 12, then A (minor) or B (major)
+    juce::String number = trimmed.initialSectionContainingOnly("0123456789");
+    if (number.isNotEmpty())
+    {
+        juce::String letter = trimmed.substring(number.length());
+        int camelotNumber = number.getIntValue();
+        if (camelotNumber < 1 || camelotNumber > 12 || (letter != "a" && letter != "b"))
+        {
+            return -1;
+        }
+        for (int key = 0; key < 24; ++key)
+        {
+            if (getCamelotCode(key).equalsIgnoreCase(trimmed))
+            {
+                return key;
+            }
+        }
+        return -1;
+    }
+
+    // Key names: a root letter, an optional sharp or flat, then nothing or "maj"/"major" for a major key, or "m"/"min"/"minor" for a minor key
+    static const int rootOfLetter[7] = { 9, 11, 0, 2, 4, 5, 7 };
+    juce::juce_wchar letter = trimmed[0];
+    if (letter < 'a' || letter > 'g')
+    {
+        return -1;
+    }
+    int root = rootOfLetter[letter - 'a'];
+
+    juce::String mode = trimmed.substring(1);
+    if (mode.startsWithChar('#') || mode.startsWithChar(0x266F))
+    {
+        root = (root + 1) % 12;
+        mode = mode.substring(1);
+    }
+    else if (mode.startsWithChar('b') || mode.startsWithChar(0x266D))
+    {
+        root = (root + 11) % 12;
+        mode = mode.substring(1);
+    }
+
+    if (mode.isEmpty() || mode == "maj" || mode == "major")
+    {
+        return root;
+    }
+    if (mode == "m" || mode == "min" || mode == "minor")
+    {
+        return 12 + root;
+    }
+    return -1;
+}
+
+/**
+ *Returns a number which sorts keys in Camelot order (1A, 1B, 2A, ... 12B), so that the keys which mix
+ *harmonically with each other are next to each other in the library
+ */
+int KeyDetector::getCamelotRank(int key)
+{
+    juce::String code = getCamelotCode(key);
+    if (code.isEmpty())
+    {
+        return -1;
+    }
+    return (code.getIntValue() - 1) * 2 + (code.endsWithChar('B') ? 1 : 0);
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    KeyDetector.h
+    Created: 19 Oct 2026 8:06:27pm
+    Author:  Ophelia
+    Purpose: works out the musical key of a track from its decoded audio, for harmonic mixing
+
+  ==============================================================================
+  The audio is passed in block by block as it is decoded, alongside the BeatDetector. Each FFT frame's
+  frequencies from A1 (55Hz) to A6 (1760Hz) are folded into the 12 pitch classes (C, C#, D, ... B),
+  giving a "chromagram" of how much of each note is heard. Summed over the whole track, this is compared
+  with the Krumhansl-Kessler key profiles (how often each note of the scale is heard in music in that key)
+  for all 24 major and minor keys, and the key whose profile correlates best is picked.
+  Attribution: C. Krumhansl, "Cognitive Foundations of Musical Pitch", Oxford University Press, 1990,
+  for the key profiles.
+
+  Keys are numbered from 0 to 23: 0 to 11 are the major keys with their root from C to B, and 12 to 23
+  are the minor keys with their root from C to B. The library stores them as Camelot codes (e.g. "8A" for
+  A minor), which DJs use because neighbouring codes mix harmonically.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class KeyDetector
+{
+public:
+    /** Constructor: takes in the sample rate of the audio which will be passed to process() */
+    explicit KeyDetector(double inputSampleRate);
+
+    /** Adds the next block of the track's audio (mixed down to mono) to the chromagram */
+    void process(const float* monoSamples, int numSamples);
+
+    /** Returns the key (0 to 23) which best fits all of the audio passed in so far, or -1 if no notes were heard */
+    int getKey() const;
+
+    /** Returns the Camelot code of the key, e.g. "8A" for A minor (an empty string for -1) */
+    static juce::String getCamelotCode(int key);
+
+    /** Returns the short name of the key, e.g. "Am" for A minor or "Eb" for E flat major (an empty string for -1) */
+    static juce::String getKeyName(int key);
+
+    /**
+     *Reads a key from a Camelot code (e.g. "8A") or a key name as it is written in tags (e.g. "Am", "F#", "Bb minor", "Cmaj"),
+     *returning -1 if the text is not a key
+     */
+    static int parseKey(const juce::String& text);
+
+    /**
+     *Returns a number which sorts keys in Camelot order (1A, 1B, 2A, ... 12B), so that the keys which mix
+     *harmonically with each other are next to each other in the library
+     */
+    static int getCamelotRank(int key);
+
+private:
+    /** Adds the pitch classes of every full frame of audio waiting in analysisSamples to the chromagram */
+    void processFrames();
+
+    // The size of each FFT frame: 2^13 = 8192 samples (about 0.7 seconds at the analysis sample rate), which
+    // separates neighbouring notes down to A1
+    static constexpr int fftOrder = 13;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    // The frames overlap by half, as the Hann window fades out each frame's ends
+    static constexpr int hopSize = fftSize / 2;
+
+    // The sample rate the audio is low-pass filtered and decimated to, which keeps every frequency up to A6
+    static constexpr double targetAnalysisSampleRate = 11025.0;
+
+    // The range of notes which are folded into the chromagram, in Hz
+    static constexpr double minFrequency = 55.0;
+    static constexpr double maxFrequency = 1760.0;
+
+    int decimationFactor;
+    double analysisSampleRate;
+
+    // Two low-pass filters in series, so that higher frequencies do not fold down onto the notes when the audio is decimated
+    juce::IIRFilter antiAliasingFilters[2];
+    int decimationCount = 0;
+
+    // The block being filtered, kept between blocks so that it is only allocated once
+    std::vector<float> filteredSamples;
+
+    // The decimated audio which has not been made into full frames yet, starting at readPosition
+    std::vector<float> analysisSamples;
+    size_t readPosition = 0;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+
+    // The FFT's working buffer (twice the frame size, as the FFT needs)
+    std::vector<float> fftData;
+
+    // For every FFT bin in the note range, its pitch class and how close it is to the centre of that note (0 to 1)
+    std::vector<int> binPitchClasses;
+    std::vector<float> binWeights;
+    int firstBin;
+    int lastBin;
+
+    // How much of each pitch class has been heard, summed over every frame so far
+    double chromagram[12] = {};
+};
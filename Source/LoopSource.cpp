@@ -0,0 +1,420 @@
+/*
+  ==============================================================================
+
+    LoopSource.cpp
+    Created: 19 Oct 2026 9:24:51pm
+    Author:  Ophelia
+    Purpose: loops a deck's track between two sample positions, wrapping at the exact sample in the middle of an
+             audio block, and keeps a shadow playhead so a slip loop or loop roll carries on where the track would have been
+
+  ==============================================================================
+*/
+
+#include "LoopSource.h"
+#include <cmath>
+#include <limits>
+
+/**
+ *Constructor: takes in the source which plays the track (the deck's HotCueSource), and the track's sample rate,
+ *which the length of the ring buffer of recent audio is worked out from
+ */
+LoopSource::LoopSource(juce::PositionableAudioSource* _source, double _sampleRate) : source(_source)
+{
+    // 5ms is too short to hear as a fade, but long enough to smooth over the jump in the waveform at the loop point
+    fadeSamples = juce::jmax(1, juce::roundToInt(_sampleRate * 0.005));
+
+    // 16 seconds holds every auto-loop up to 32 beats at 120 BPM, along with the audio leading into it for the crossfade
+    recentAudio.setSize(2, juce::jmax(1, juce::roundToInt(_sampleRate * 16.0)) + fadeSamples);
+    recentAudio.clear();
+}
+
+//====================PositionableAudioSource Virtual Functions Implementation=============
+
+/** Tells the source to prepare for playing */
+void LoopSource::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    source->prepareToPlay(samplesPerBlockExpected, sampleRate);
+
+    // Sized here rather than on the audio thread. A deck playing fast asks for larger blocks than expected,
+    // so there is room for four times as many samples, and anything longer is played into it in parts
+    shadowBuffer.setSize(2, juce::jmax(1, samplesPerBlockExpected) * shadowBufferBlocks);
+}
+
+/** Fills the block from the source or from memory, wrapping back to the loop start at the exact sample the loop ends */
+void LoopSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // The block is filled from a copy of the state, so the message thread is never kept waiting while the source renders
+    PlaybackState playback;
+    juce::uint32 versionAtStart;
+    {
+        const juce::SpinLock::ScopedLockType lock(loopLock);
+        playback = state;
+        versionAtStart = stateVersion;
+    }
+
+    const Loop& loop = playback.loop;
+    juce::int64 position = playback.playingFromMemory ? playback.memoryPosition : source->getNextReadPosition();
+    int numDone = 0;
+    while (numDone < bufferToFill.numSamples)
+    {
+        // Wraps back to the loop start at the exact sample the loop ends, which may be in the middle of the block
+        if (loop.active && position >= loop.end)
+        {
+            const juce::int64 wrappedPosition = loop.start + (position - loop.start) % (loop.end - loop.start);
+            const bool wasPlayingFromMemory = playback.playingFromMemory;
+            playback.playingFromMemory = memoryCoversLoop(playback);
+            if ((!playback.playingFromMemory || !wasPlayingFromMemory) && !seekSourceForBlock(playback, versionAtStart, wrappedPosition))
+            {
+                // The message thread moved playback while the block was being filled, so the rest of it carries on from there
+                position = playback.playingFromMemory ? playback.memoryPosition : source->getNextReadPosition();
+                continue;
+            }
+            position = wrappedPosition;
+        }
+
+        const juce::int64 loopEnd = loop.active ? loop.end : std::numeric_limits<juce::int64>::max();
+        const int numLeft = bufferToFill.numSamples - numDone;
+        int count;
+
+        if (playback.playingFromMemory)
+        {
+            // Past the audio in memory (e.g. after the loop was exited), playback hands back to the source, which is
+            // already waiting there unless it was playing on at the shadow playhead
+            if (position < playback.recentEnd - playback.numRecentSamples || position >= playback.recentEnd)
+            {
+                playback.playingFromMemory = false;
+                if (!seekSourceForBlock(playback, versionAtStart, position))
+                {
+                    position = playback.playingFromMemory ? playback.memoryPosition : source->getNextReadPosition();
+                }
+                continue;
+            }
+
+            count = (int)juce::jmin((juce::int64)numLeft, juce::jmin(loopEnd, playback.recentEnd) - position);
+            juce::AudioSourceChannelInfo chunk(bufferToFill.buffer, bufferToFill.startSample + numDone, count);
+            readFromMemory(chunk, position, playback);
+
+            // The source plays on silently at the shadow playhead, so it is ready to take over when the loop is exited
+            if (loop.active && loop.returnToShadowPlayhead)
+            {
+                playShadowSamples(count);
+            }
+        }
+        else
+        {
+            count = (int)juce::jmin((juce::int64)numLeft, loopEnd - position);
+            juce::AudioSourceChannelInfo chunk(bufferToFill.buffer, bufferToFill.startSample + numDone, count);
+            source->getNextAudioBlock(chunk);
+            recordFromSource(chunk, position, playback);
+        }
+
+        position += count;
+        numDone += count;
+        if (loop.active)
+        {
+            playback.shadowPosition += count;
+        }
+    }
+
+    if (playback.playingFromMemory)
+    {
+        playback.memoryPosition = position;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+
+    // Only the audio thread records into the ring buffer
+    state.recentEnd = playback.recentEnd;
+    state.numRecentSamples = playback.numRecentSamples;
+
+    // If the message thread moved playback while the block was being filled, where it moved it to stands. A loop which
+    // was only moved or resized doesn't count, and its new bounds are used from the next block
+    if (stateVersion == versionAtStart)
+    {
+        state.playingFromMemory = playback.playingFromMemory;
+        state.memoryPosition = playback.memoryPosition;
+        state.shadowPosition = playback.shadowPosition;
+    }
+}
+
+/** Allows the source to release anything it no longer needs after playback has stopped */
+void LoopSource::releaseResources()
+{
+    source->releaseResources();
+}
+
+/** Moves playback to a new position: inside the loop it carries on looping, and anywhere else it ends the loop */
+void LoopSource::setNextReadPosition(juce::int64 newPosition)
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    ++stateVersion;
+
+    if (state.loop.active && (newPosition < state.loop.start || newPosition >= state.loop.end))
+    {
+        state.loop.active = false;
+    }
+
+    // Jumping around inside a loop which is held in memory doesn't need the source to seek
+    if (state.loop.active && memoryCoversLoop(state))
+    {
+        state.playingFromMemory = true;
+        state.memoryPosition = newPosition;
+        parkSource(state);
+    }
+    else
+    {
+        state.playingFromMemory = false;
+        source->setNextReadPosition(newPosition);
+    }
+}
+
+/** Returns the position of the next sample which will be played */
+juce::int64 LoopSource::getNextReadPosition() const
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    return state.playingFromMemory ? state.memoryPosition : source->getNextReadPosition();
+}
+
+/** Returns the length of the track in samples */
+juce::int64 LoopSource::getTotalLength() const
+{
+    return source->getTotalLength();
+}
+
+/** Returns true while a loop is active, so the transport doesn't stop at the end of the track */
+bool LoopSource::isLooping() const
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    return state.loop.active;
+}
+
+//==============================================================================
+
+/**
+ *Loops playback between the start and end positions in samples, or moves the loop if one is active. When the loop
+ *is exited, a loop which returns to the shadow playhead (a slip loop or loop roll) carries on where the track would
+ *have been if it had never looped, and any other loop carries on from the loop's playhead
+ */
+void LoopSource::setLoop(juce::int64 start, juce::int64 end, bool returnToShadowPlayhead)
+{
+    if (start < 0 || end <= start)
+    {
+        return;
+    }
+
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+
+    // The shadow playhead starts where the first loop is engaged, and keeps running while the loop is moved or resized
+    if (!state.loop.active)
+    {
+        ++stateVersion;
+        state.shadowPosition = state.playingFromMemory ? state.memoryPosition : source->getNextReadPosition();
+    }
+
+    state.loop.start = start;
+    state.loop.end = end;
+    state.loop.returnToShadowPlayhead = returnToShadowPlayhead;
+    state.loop.active = true;
+
+    // A loop which already plays from memory may now be exited to somewhere else
+    parkSource(state);
+}
+
+/** Stops looping: playback carries on from the loop's playhead, or from the shadow playhead for a slip loop */
+void LoopSource::exitLoop()
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+
+    if (!state.loop.active)
+    {
+        return;
+    }
+    ++stateVersion;
+    state.loop.active = false;
+
+    // Otherwise the rest of the audio in memory is played out, and the source (which is waiting at its end) carries on from there
+    if (state.loop.returnToShadowPlayhead)
+    {
+        state.playingFromMemory = false;
+        if (source->getNextReadPosition() != state.shadowPosition)
+        {
+            source->setNextReadPosition(state.shadowPosition);
+        }
+    }
+}
+
+/** Stops looping straight away, before playback is moved somewhere else (e.g. to a hot cue) */
+void LoopSource::cancelLoop()
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    ++stateVersion;
+
+    state.loop.active = false;
+    if (state.playingFromMemory)
+    {
+        state.playingFromMemory = false;
+        source->setNextReadPosition(state.memoryPosition);
+    }
+}
+
+/** Returns the start of the active loop in samples, or -1 if no loop is active */
+juce::int64 LoopSource::getLoopStart() const
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    return state.loop.active ? state.loop.start : -1;
+}
+
+/** Returns the end of the active loop in samples, or -1 if no loop is active */
+juce::int64 LoopSource::getLoopEnd() const
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+    return state.loop.active ? state.loop.end : -1;
+}
+
+/** Returns true if the ring buffer holds all of the active loop's audio, so it can be played from memory */
+bool LoopSource::memoryCoversLoop(const PlaybackState& playback)
+{
+    const Loop& loop = playback.loop;
+    return loop.active && loop.start >= playback.recentEnd - playback.numRecentSamples && loop.end <= playback.recentEnd;
+}
+
+/** Returns the number of samples crossfaded at the end of each pass of the loop played from memory */
+int LoopSource::getFadeLength(const PlaybackState& playback) const
+{
+    const Loop& loop = playback.loop;
+    juce::int64 numBeforeStart = loop.start - (playback.recentEnd - playback.numRecentSamples);
+    return (int)juce::jmax((juce::int64)0, juce::jmin((juce::int64)fadeSamples, (loop.end - loop.start) / 2, numBeforeStart));
+}
+
+/** Copies the audio at the track position from memory into the block, crossfading the end of the loop into its start */
+void LoopSource::readFromMemory(const juce::AudioSourceChannelInfo& info, juce::int64 position, const PlaybackState& playback)
+{
+    const Loop& loop = playback.loop;
+    const int capacity = recentAudio.getNumSamples();
+    const int startIndex = (int)(position % capacity);
+    const int firstPart = juce::jmin(info.numSamples, capacity - startIndex);
+
+    // The fade runs over the last fadeLength samples of the loop, mixing in the same number of samples leading into its start
+    const int fadeLength = memoryCoversLoop(playback) ? getFadeLength(playback) : 0;
+    const juce::int64 fadeStart = loop.end - fadeLength;
+    const juce::int64 fadeFrom = juce::jmax(position, fadeStart);
+    const juce::int64 fadeTo = juce::jmin(position + info.numSamples, loop.end);
+
+    for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+    {
+        const float* recent = recentAudio.getReadPointer(channel % recentAudio.getNumChannels());
+        float* output = info.buffer->getWritePointer(channel, info.startSample);
+
+        juce::FloatVectorOperations::copy(output, recent + startIndex, firstPart);
+        juce::FloatVectorOperations::copy(output + firstPart, recent, info.numSamples - firstPart);
+
+        // An equal-power fade, which keeps the level steady across the loop point
+        for (juce::int64 fadePosition = fadeFrom; fadeLength > 0 && fadePosition < fadeTo; ++fadePosition)
+        {
+            int fadeIndex = (int)(fadePosition - fadeStart);
+            float angle = (fadeIndex + 0.5f) / fadeLength * juce::MathConstants<float>::halfPi;
+            float leadIn = recent[(loop.start - fadeLength + fadeIndex) % capacity];
+            float& sample = output[fadePosition - position];
+            sample = sample * std::cos(angle) + leadIn * std::sin(angle);
+        }
+    }
+}
+
+/** Records a block which the source has just played from the track position into the ring buffer */
+void LoopSource::recordFromSource(const juce::AudioSourceChannelInfo& info, juce::int64 position, PlaybackState& playback)
+{
+    const int capacity = recentAudio.getNumSamples();
+
+    // A jump breaks the run of audio which loops can be played from, so the ring starts again
+    if (position != playback.recentEnd)
+    {
+        playback.numRecentSamples = 0;
+    }
+
+    // Only the end of a block longer than the ring can be kept
+    const int skipped = juce::jmax(0, info.numSamples - capacity);
+    const int count = info.numSamples - skipped;
+    const int startIndex = (int)((position + skipped) % capacity);
+    const int firstPart = juce::jmin(count, capacity - startIndex);
+
+    for (int channel = 0; channel < recentAudio.getNumChannels(); ++channel)
+    {
+        const float* played = info.buffer->getReadPointer(channel % info.buffer->getNumChannels(), info.startSample + skipped);
+        float* recent = recentAudio.getWritePointer(channel);
+
+        juce::FloatVectorOperations::copy(recent + startIndex, played, firstPart);
+        juce::FloatVectorOperations::copy(recent, played + firstPart, count - firstPart);
+    }
+
+    playback.recentEnd = position + info.numSamples;
+    playback.numRecentSamples = juce::jmin((juce::int64)capacity, playback.numRecentSamples + info.numSamples);
+}
+
+/** Plays the given number of samples from the source into the shadow buffer, which is never heard */
+void LoopSource::playShadowSamples(int numSamples)
+{
+    // A block longer than the buffer (or one which comes before prepareToPlay) is played in parts, so the buffer is never resized on the audio thread
+    const int partLength = shadowBuffer.getNumSamples();
+    if (partLength == 0)
+    {
+        source->setNextReadPosition(source->getNextReadPosition() + numSamples);
+        return;
+    }
+
+    for (int numDone = 0; numDone < numSamples; numDone += partLength)
+    {
+        juce::AudioSourceChannelInfo shadowChunk(&shadowBuffer, 0, juce::jmin(partLength, numSamples - numDone));
+        source->getNextAudioBlock(shadowChunk);
+    }
+}
+
+/**
+ *Moves the source for the audio thread: to where playback will carry on once the loop is exited if the block is now
+ *playing from memory (see parkSource), or else to the track position. The seek is only made if the message thread
+ *hasn't moved playback since the block's copy of the state was taken, as otherwise it would undo that move. In that
+ *case, the copy is brought up to date instead (apart from the ring buffer, which only the audio thread records into),
+ *and false is returned
+ */
+bool LoopSource::seekSourceForBlock(PlaybackState& playback, juce::uint32& versionAtStart, juce::int64 position)
+{
+    const juce::SpinLock::ScopedLockType lock(loopLock);
+
+    if (stateVersion != versionAtStart)
+    {
+        const juce::int64 recentEnd = playback.recentEnd;
+        const juce::int64 numRecentSamples = playback.numRecentSamples;
+        playback = state;
+        playback.recentEnd = recentEnd;
+        playback.numRecentSamples = numRecentSamples;
+        versionAtStart = stateVersion;
+        return false;
+    }
+
+    if (playback.playingFromMemory)
+    {
+        parkSource(playback);
+    }
+    else if (source->getNextReadPosition() != position)
+    {
+        source->setNextReadPosition(position);
+    }
+    return true;
+}
+
+/**
+ *While playing from memory, moves the source to where playback will carry on once the loop is exited: the shadow
+ *playhead for a slip loop, or the end of the audio in memory for any other loop
+ */
+void LoopSource::parkSource(const PlaybackState& playback)
+{
+    if (!playback.playingFromMemory)
+    {
+        return;
+    }
+
+    juce::int64 parkedPosition = playback.loop.active && playback.loop.returnToShadowPlayhead ? playback.shadowPosition : playback.recentEnd;
+    if (source->getNextReadPosition() != parkedPosition)
+    {
+        source->setNextReadPosition(parkedPosition);
+    }
+}
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    LoopSource.h
+    Created: 19 Oct 2026 9:24:51pm
+    Author:  Ophelia
+    Purpose: loops a deck's track between two sample positions, wrapping at the exact sample in the middle of an
+             audio block, and keeps a shadow playhead so a slip loop or loop roll carries on where the track would have been
+
+  ==============================================================================
+  Everything the deck plays from its source is also recorded into a ring buffer of the last few seconds of the track
+  (as long as playback runs straight on). A loop's first pass plays from the source as usual, which fills the ring
+  with the loop's audio, so from the first wrap onwards a short loop plays from memory: there is no seek, and so no
+  gap, at the loop point. The last few milliseconds of each pass are crossfaded with the audio leading into the loop
+  start, so the wrap doesn't click. Loops too long for the ring (or whose audio has not been played straight through)
+  seek the source at each wrap instead.
+
+  While a loop plays from memory, the source is left where playback will carry on once the loop is exited: at the end
+  of the audio in memory, or, for a slip loop (and a loop roll), at the shadow playhead, which the source keeps
+  playing silently in step with the loop. Exiting a slip loop then hands straight back to the source without a seek.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class LoopSource : public juce::PositionableAudioSource
+{
+public:
+    /**
+     *Constructor: takes in the source which plays the track (the deck's HotCueSource), and the track's sample rate,
+     *which the length of the ring buffer of recent audio is worked out from
+     */
+    LoopSource(juce::PositionableAudioSource* _source, double _sampleRate);
+
+    //====================PositionableAudioSource Virtual Functions Implementation=============
+    /** Tells the source to prepare for playing */
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    /** Fills the block from the source or from memory, wrapping back to the loop start at the exact sample the loop ends */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+    /** Allows the source to release anything it no longer needs after playback has stopped */
+    void releaseResources() override;
+    /** Moves playback to a new position: inside the loop it carries on looping, and anywhere else it ends the loop */
+    void setNextReadPosition(juce::int64 newPosition) override;
+    /** Returns the position of the next sample which will be played */
+    juce::int64 getNextReadPosition() const override;
+    /** Returns the length of the track in samples */
+    juce::int64 getTotalLength() const override;
+    /** Returns true while a loop is active, so the transport doesn't stop at the end of the track */
+    bool isLooping() const override;
+    //==============================================================================
+
+    /**
+     *Loops playback between the start and end positions in samples, or moves the loop if one is active. When the loop
+     *is exited, a loop which returns to the shadow playhead (a slip loop or loop roll) carries on where the track would
+     *have been if it had never looped, and any other loop carries on from the loop's playhead
+     */
+    void setLoop(juce::int64 start, juce::int64 end, bool returnToShadowPlayhead);
+
+    /** Stops looping: playback carries on from the loop's playhead, or from the shadow playhead for a slip loop */
+    void exitLoop();
+
+    /** Stops looping straight away, before playback is moved somewhere else (e.g. to a hot cue) */
+    void cancelLoop();
+
+    /** Returns the start of the active loop in samples, or -1 if no loop is active */
+    juce::int64 getLoopStart() const;
+
+    /** Returns the end of the active loop in samples, or -1 if no loop is active */
+    juce::int64 getLoopEnd() const;
+
+private:
+    /** The loop which playback wraps around */
+    struct Loop
+    {
+        juce::int64 start = -1;
+        juce::int64 end = -1;
+        bool returnToShadowPlayhead = false;
+        bool active = false;
+    };
+
+    /**
+     *The loop and playback state. The audio thread copies it at the start of each block, fills the block from the copy,
+     *and stores the copy back once the block is done, so the lock is never held while the source renders. Any seek the
+     *audio thread makes from its copy is checked against the state first (see seekSourceForBlock)
+     */
+    struct PlaybackState
+    {
+        // The active loop, if any
+        Loop loop;
+
+        // The track position just after the last sample recorded into the ring buffer, and how many samples before it are held
+        juce::int64 recentEnd = 0;
+        juce::int64 numRecentSamples = 0;
+
+        // Whether playback is coming from memory rather than the source, and the track position it has reached there
+        bool playingFromMemory = false;
+        juce::int64 memoryPosition = 0;
+
+        // Where the track would have been if it had never looped, which slip loops return to
+        juce::int64 shadowPosition = 0;
+    };
+
+    /** Returns true if the ring buffer holds all of the active loop's audio, so it can be played from memory */
+    static bool memoryCoversLoop(const PlaybackState& playback);
+
+    /** Returns the number of samples crossfaded at the end of each pass of the loop played from memory */
+    int getFadeLength(const PlaybackState& playback) const;
+
+    /** Copies the audio at the track position from memory into the block, crossfading the end of the loop into its start */
+    void readFromMemory(const juce::AudioSourceChannelInfo& info, juce::int64 position, const PlaybackState& playback);
+
+    /** Records a block which the source has just played from the track position into the ring buffer */
+    void recordFromSource(const juce::AudioSourceChannelInfo& info, juce::int64 position, PlaybackState& playback);
+
+    /** Plays the given number of samples from the source into the shadow buffer, which is never heard */
+    void playShadowSamples(int numSamples);
+
+    /**
+     *Moves the source for the audio thread: to where playback will carry on once the loop is exited if the block is now
+     *playing from memory (see parkSource), or else to the track position. The seek is only made if the message thread
+     *hasn't moved playback since the block's copy of the state was taken, as otherwise it would undo that move. In that
+     *case, the copy is brought up to date instead (apart from the ring buffer, which only the audio thread records into),
+     *and false is returned
+     */
+    bool seekSourceForBlock(PlaybackState& playback, juce::uint32& versionAtStart, juce::int64 position);
+
+    /**
+     *While playing from memory, moves the source to where playback will carry on once the loop is exited: the shadow
+     *playhead for a slip loop, or the end of the audio in memory for any other loop
+     */
+    void parkSource(const PlaybackState& playback);
+
+    // The source which plays the track
+    juce::PositionableAudioSource* source;
+
+    // The loop and playback state, which the audio thread and the message thread both use
+    PlaybackState state;
+
+    // Counts the changes the message thread makes to where playback is (seeking, exiting a loop or starting one). The audio
+    // thread only stores its copy of the playback position back if there were none while it filled the block
+    juce::uint32 stateVersion = 0;
+
+    // The last few seconds the source played, stored by track position (sample n is at n % capacity). Only the audio thread uses it
+    juce::AudioBuffer<float> recentAudio;
+
+    // The number of samples crossfaded at the loop point (unless the loop is too short, or no audio before its start is held)
+    int fadeSamples;
+
+    // Receives the source's audio while it plays silently at the shadow playhead. It is sized in prepareToPlay, with
+    // room for the larger blocks asked for while the deck plays fast, and longer blocks are played into it in parts
+    juce::AudioBuffer<float> shadowBuffer;
+
+    // How many of the expected blocks the shadow buffer holds
+    static constexpr int shadowBufferBlocks = 4;
+
+    // Locks the loop and playback state. The audio thread only holds it while it copies the state and stores it back,
+    // and the message thread only for a few assignments, so neither waits long
+    mutable juce::SpinLock loopLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopSource)
+};
@@ -0,0 +1,257 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.cpp
+    Created: 19 Oct 2026 8:31:14pm
+    Author:  Ophelia
+    Purpose: measures the integrated loudness, loudness range and true peak of a track from its decoded audio (EBU R128)
+
+  ==============================================================================
+*/
+
+#include "LoudnessMeter.h"
+#include <algorithm>
+#include <cmath>
+
+/** Constructor: takes in the sample rate and number of channels of the audio which will be passed to process() */
+LoudnessMeter::LoudnessMeter(double sampleRate, int _numChannels) : numChannels(_numChannels)
+{
+    stepLength = juce::jmax(1, juce::roundToInt(sampleRate / 10.0));
+
+    // Stage 1 of the K-weighting: a high shelf of about +4dB above 1.5kHz
+    Biquad shelf;
+    {
+        double frequency = 1681.974450955533;
+        double gain = 3.999843853973347;
+        double q = 0.7071752369554196;
+        double k = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        double vh = std::pow(10.0, gain / 20.0);
+        double vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k / q + k * k;
+        shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        shelf.b1 = 2.0 * (k * k - vh) / a0;
+        shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // Stage 2 of the K-weighting: a high-pass at about 38Hz (the "RLB" curve)
+    Biquad highPass;
+    {
+        double frequency = 38.13547087602444;
+        double q = 0.5003270373238773;
+        double k = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        double a0 = 1.0 + k / q + k * k;
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    shelfFilters.assign((size_t)numChannels, shelf);
+    highPassFilters.assign((size_t)numChannels, highPass);
+
+    // The oversampling filter is a windowed sinc which cuts off at the original Nyquist frequency. Each phase is
+    // normalised to a gain of 1, so a constant signal comes out at the same level
+    const int numTaps = oversampling * tapsPerPhase;
+    double centre = (numTaps - 1) / 2.0;
+    phaseTaps.resize((size_t)numTaps);
+    maxFilterGain = 0.0f;
+    for (int phase = 0; phase < oversampling; ++phase)
+    {
+        double sum = 0.0;
+        std::vector<double> taps((size_t)tapsPerPhase);
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            int n = phase + tap * oversampling;
+            double x = (n - centre) / oversampling;
+            double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+            double blackman = 0.42 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * (n + 0.5) / numTaps)
+                + 0.08 * std::cos(4.0 * juce::MathConstants<double>::pi * (n + 0.5) / numTaps);
+            taps[(size_t)tap] = sinc * blackman;
+            sum += taps[(size_t)tap];
+        }
+
+        float absoluteSum = 0.0f;
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+        {
+            float normalisedTap = (float)(taps[(size_t)tap] / sum);
+            phaseTaps[(size_t)(phase * tapsPerPhase + tap)] = normalisedTap;
+            absoluteSum += std::abs(normalisedTap);
+        }
+        maxFilterGain = juce::jmax(maxFilterGain, absoluteSum);
+    }
+
+    paddedChannels.assign((size_t)numChannels, std::vector<float>((size_t)tapsPerPhase - 1, 0.0f));
+}
+
+/** Adds the next block of the track's audio (with every channel) to the measurements */
+void LoudnessMeter::process(const float* const* channels, int numSamples)
+{
+    // The block is split where each 100ms step ends, so every channel's filters run over a whole stretch at a time
+    for (int position = 0; position < numSamples;)
+    {
+        int count = juce::jmin(numSamples - position, stepLength - stepSampleCount);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const float* samples = channels[channel] + position;
+            Biquad& shelf = shelfFilters[(size_t)channel];
+            Biquad& highPass = highPassFilters[(size_t)channel];
+
+            double power = 0.0;
+            for (int i = 0; i < count; ++i)
+            {
+                double weighted = highPass.process(shelf.process(samples[i]));
+                power += weighted * weighted;
+            }
+            stepPower += power;
+        }
+
+        stepSampleCount += count;
+        position += count;
+        if (stepSampleCount == stepLength)
+        {
+            stepPowers.push_back(stepPower / stepLength);
+            stepPower = 0.0;
+            stepSampleCount = 0;
+        }
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        findTruePeak(channel, channels[channel], numSamples);
+    }
+}
+
+/** Upsamples the channel's samples 4 times and raises truePeakGain to the highest absolute level found */
+void LoudnessMeter::findTruePeak(int channel, const float* samples, int numSamples)
+{
+    std::vector<float>& padded = paddedChannels[(size_t)channel];
+    const int historyLength = tapsPerPhase - 1;
+    padded.resize((size_t)(historyLength + numSamples));
+    juce::FloatVectorOperations::copy(padded.data() + historyLength, samples, numSamples);
+
+    // Most of a track cannot beat the loudest peak found so far, even with the filter's largest boost, so the
+    // oversampling only runs over the short stretches around samples which are close to it
+    const int stretchLength = 64;
+    for (int stretchStart = 0; stretchStart < numSamples; stretchStart += stretchLength)
+    {
+        int stretchEnd = juce::jmin(numSamples, stretchStart + stretchLength);
+        juce::Range<float> range = juce::FloatVectorOperations::findMinAndMax(padded.data() + stretchStart,
+            stretchEnd - stretchStart + historyLength);
+        float maxLevel = juce::jmax(-range.getStart(), range.getEnd());
+        truePeakGain = juce::jmax(truePeakGain, maxLevel);
+        if (maxLevel * maxFilterGain <= truePeakGain)
+        {
+            continue;
+        }
+
+        for (int i = stretchStart; i < stretchEnd; ++i)
+        {
+            // padded[i + historyLength] is sample i, and each tap reaches one sample further back
+            const float* newest = padded.data() + i + historyLength;
+            for (int phase = 0; phase < oversampling; ++phase)
+            {
+                const float* taps = phaseTaps.data() + phase * tapsPerPhase;
+                float output = 0.0f;
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                {
+                    output += taps[tap] * newest[-tap];
+                }
+                truePeakGain = juce::jmax(truePeakGain, std::abs(output));
+            }
+        }
+    }
+
+    // Keeps the end of the block for the start of the next one
+    std::copy(padded.end() - historyLength, padded.end(), padded.begin());
+    padded.resize((size_t)historyLength);
+}
+
+/** Returns the loudness in LUFS of a mean (K-weighted, channel-summed) power */
+double LoudnessMeter::powerToLoudness(double power)
+{
+    return power > 0.0 ? -0.691 + 10.0 * std::log10(power) : -200.0;
+}
+
+/** Works out the loudness of all of the audio passed in so far */
+LoudnessMeter::Loudness LoudnessMeter::getLoudness() const
+{
+    const double absoluteGate = -70.0;
+
+    Loudness loudness;
+    loudness.integratedLoudness = absoluteGate;
+    loudness.truePeak = juce::Decibels::gainToDecibels((double)truePeakGain, -100.0);
+
+    // Running totals, so the mean power of any window of steps is a single subtraction
+    size_t numSteps = stepPowers.size();
+    std::vector<double> runningTotals(numSteps + 1, 0.0);
+    for (size_t i = 0; i < numSteps; ++i)
+    {
+        runningTotals[i + 1] = runningTotals[i] + stepPowers[i];
+    }
+
+    // Returns the gated mean power (or the gated loudnesses) of the windows of the given number of steps, which start every step
+    auto gateWindows = [&](size_t windowSteps, double relativeGate, std::vector<double>* gatedLoudnesses) -> double
+        {
+            std::vector<double> powers;
+            for (size_t start = 0; start + windowSteps <= numSteps; ++start)
+            {
+                double power = (runningTotals[start + windowSteps] - runningTotals[start]) / (double)windowSteps;
+                if (powerToLoudness(power) > absoluteGate)
+                {
+                    powers.push_back(power);
+                }
+            }
+            if (powers.empty())
+            {
+                return 0.0;
+            }
+
+            double sum = 0.0;
+            for (double power : powers)
+            {
+                sum += power;
+            }
+            double threshold = powerToLoudness(sum / (double)powers.size()) + relativeGate;
+
+            double gatedSum = 0.0;
+            size_t numGated = 0;
+            for (double power : powers)
+            {
+                if (powerToLoudness(power) > threshold)
+                {
+                    gatedSum += power;
+                    ++numGated;
+                    if (gatedLoudnesses != nullptr)
+                    {
+                        gatedLoudnesses->push_back(powerToLoudness(power));
+                    }
+                }
+            }
+            return numGated > 0 ? gatedSum / (double)numGated : 0.0;
+        };
+
+    // Integrated loudness: 400ms blocks (overlapping by 75%), with the relative gate 10 LU below their average
+    double integratedPower = gateWindows(4, -10.0, nullptr);
+    if (integratedPower > 0.0)
+    {
+        loudness.integratedLoudness = powerToLoudness(integratedPower);
+    }
+
+    // Loudness range: 3 second windows, with the relative gate 20 LU below their average
+    std::vector<double> shortTermLoudnesses;
+    gateWindows(30, -20.0, &shortTermLoudnesses);
+    if (shortTermLoudnesses.size() >= 2)
+    {
+        std::sort(shortTermLoudnesses.begin(), shortTermLoudnesses.end());
+        size_t last = shortTermLoudnesses.size() - 1;
+        double low = shortTermLoudnesses[(size_t)std::round(0.10 * (double)last)];
+        double high = shortTermLoudnesses[(size_t)std::round(0.95 * (double)last)];
+        loudness.loudnessRange = high - low;
+    }
+
+    return loudness;
+}
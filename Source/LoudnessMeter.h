@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    LoudnessMeter.h
+    Created: 19 Oct 2026 8:31:14pm
+    Author:  Ophelia
+    Purpose: measures the integrated loudness, loudness range and true peak of a track from its decoded audio (EBU R128)
+
+  ==============================================================================
+  The audio is passed in block by block as it is decoded, alongside the other analysers, but with every
+  channel rather than a mono mix, as loudness adds up the power of the channels.
+
+  - Integrated loudness (LUFS): each channel is K-weighted (a high shelf for how the head boosts high
+    frequencies, and a high-pass for how little the ear hears bass), and the mean power of 400ms blocks is
+    gated: blocks below -70 LUFS are silence, and blocks 10 LU below the average of the rest are quiet parts
+    (e.g. a breakdown), which are left out so they do not make a loud track read as quiet.
+  - Loudness range (LU): the spread between the 10th and 95th percentiles of the 3 second loudness,
+    gated the same way but 20 LU below the average.
+  - True peak (dBTP): the highest level of the audio when it is upsampled 4 times, which catches the peaks
+    between samples that clip a DAC (or the master) when a track is turned up.
+  Attribution: ITU-R BS.1770-4 "Algorithms to measure audio programme loudness and true-peak audio level" and
+  EBU Tech 3342 "Loudness Range", with the K-weighting filters worked out for any sample rate as in libebur128.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class LoudnessMeter
+{
+public:
+    /** The loudness of a track */
+    struct Loudness
+    {
+        // The gated loudness of the whole track in LUFS (-70 for a silent track)
+        double integratedLoudness = 0.0;
+        // How much the loudness varies over the track, in LU
+        double loudnessRange = 0.0;
+        // The highest level between or on the samples in dBTP (-100 for a silent track)
+        double truePeak = 0.0;
+    };
+
+    /** Constructor: takes in the sample rate and number of channels of the audio which will be passed to process() */
+    LoudnessMeter(double sampleRate, int numChannels);
+
+    /** Adds the next block of the track's audio (with every channel) to the measurements */
+    void process(const float* const* channels, int numSamples);
+
+    /** Works out the loudness of all of the audio passed in so far */
+    Loudness getLoudness() const;
+
+private:
+    /** A biquad filter which runs in double precision, as the K-weighting's high-pass is very low for the sample rate */
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+        double z1 = 0.0, z2 = 0.0;
+
+        double process(double input)
+        {
+            double output = b0 * input + z1;
+            z1 = b1 * input - a1 * output + z2;
+            z2 = b2 * input - a2 * output;
+            return output;
+        }
+    };
+
+    /** Upsamples the channel's samples 4 times and raises truePeakGain to the highest absolute level found */
+    void findTruePeak(int channel, const float* samples, int numSamples);
+
+    /** Returns the loudness in LUFS of a mean (K-weighted, channel-summed) power */
+    static double powerToLoudness(double power);
+
+    // The number of samples in each 100ms step: the gating blocks are 4 steps long and the short-term windows 30 steps long
+    int stepLength;
+    int numChannels;
+
+    // The two K-weighting filters for each channel
+    std::vector<Biquad> shelfFilters;
+    std::vector<Biquad> highPassFilters;
+
+    // The summed K-weighted power of the step which is being filled, and the number of samples in it so far
+    double stepPower = 0.0;
+    int stepSampleCount = 0;
+
+    // The mean power of every finished 100ms step
+    std::vector<double> stepPowers;
+
+    // The 4x oversampling filter, split into its 4 phases of tapsPerPhase taps each (phase p's taps at [p * tapsPerPhase])
+    static constexpr int oversampling = 4;
+    static constexpr int tapsPerPhase = 12;
+    std::vector<float> phaseTaps;
+
+    // The most the oversampling filter can boost a sample by, so that stretches which cannot beat the peak so far are skipped
+    float maxFilterGain;
+
+    // The last tapsPerPhase - 1 samples of each channel, followed by the current block, so the filter runs across blocks
+    std::vector<std::vector<float>> paddedChannels;
+
+    // The highest absolute level found so far, as a gain
+    float truePeakGain = 0.0f;
+};
@@ -7,7 +7,9 @@
 */
 
 #include <JuceHeader.h>
+#include <iostream>
 #include "MainComponent.h"
+#include "TrackAnalyser.h"
 
 //==============================================================================
 class NewProjectApplication  : public juce::JUCEApplication
@@ -25,6 +27,25 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        // "--benchmark-analysis <file or folder>" analyses the audio files, prints the cost of each analysis stage and quits,
+        // without opening the window
+        juce::StringArray arguments = juce::StringArray::fromTokens (commandLine, true);
+        int benchmarkIndex = arguments.indexOf ("--benchmark-analysis");
+        if (benchmarkIndex >= 0)
+        {
+            setApplicationReturnValue (runAnalysisBenchmark (arguments[benchmarkIndex + 1].unquoted()));
+            quit();
+            return;
+        }
+
+        // "--run-tests" runs the unit tests and benchmarks in Source/Tests, prints their results and quits, returning 1 if any failed
+        if (arguments.contains ("--run-tests"))
+        {
+            setApplicationReturnValue (runUnitTests());
+            quit();
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -97,6 +118,70 @@ public:
     };
 
 private:
+    /**
+     *Decodes and analyses every audio file in the folder (or the single file) the path points to, one after the other
+     *on this thread, and prints each file's analysis followed by the time spent decoding, mixing down and in each stage.
+     *Returns the application's exit code: 1 if there were no audio files to analyse
+     */
+    int runAnalysisBenchmark (const juce::String& path)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        juce::File target = juce::File::getCurrentWorkingDirectory().getChildFile (path);
+        juce::Array<juce::File> files;
+        if (target.isDirectory())
+            files = target.findChildFiles (juce::File::findFiles, true, formatManager.getWildcardForAllFormats());
+        else if (target.existsAsFile())
+            files.add (target);
+
+        if (files.isEmpty())
+        {
+            std::cout << "No audio files found at " << target.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        TrackAnalyser trackAnalyser (formatManager, [] (std::vector<TrackAnalyser::AnalysisResult>&) {});
+        double startTime = juce::Time::getMillisecondCounterHiRes();
+
+        for (const juce::File& file : files)
+        {
+            TrackAnalyser::AnalysisResult result = trackAnalyser.analyseFileNow (file.getFullPathName());
+            std::cout << file.getFileName() << ": " << juce::String (result.bpm, 2) << " BPM, key " << result.key
+                      << ", " << juce::String (result.integratedLoudness, 1) << " LUFS, " << juce::String (result.truePeak, 1) << " dBTP, "
+                      << (int) result.waveform.getSize() << " byte waveform" << std::endl;
+        }
+
+        std::cout << trackAnalyser.getStageCostReport()
+                  << "Wall time: " << juce::String ((juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0, 2) << " seconds for "
+                  << files.size() << " files" << std::endl;
+        return 0;
+    }
+
+    /** A UnitTestRunner which prints to the console, as a GUI app's log only goes to the debugger */
+    class ConsoleTestRunner : public juce::UnitTestRunner
+    {
+    public:
+        void logMessage (const juce::String& message) override
+        {
+            std::cout << message << std::endl;
+        }
+    };
+
+    /** Runs every unit test and benchmark, printing the results. Returns the application's exit code: 1 if any test failed */
+    int runUnitTests()
+    {
+        ConsoleTestRunner runner;
+        runner.setAssertOnFailure (false);
+        runner.runAllTests();
+
+        int numFailures = 0;
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            numFailures += runner.getResult (i)->failures;
+
+        return numFailures > 0 ? 1 : 0;
+    }
+
     std::unique_ptr<MainWindow> mainWindow;
 };
 
@@ -4,6 +4,7 @@
 #include "DJAudioPlayer.h";
 #include "DeckGUI.h";
 #include "PlaylistComponent.h";
+#include "WaveformCache.h";
 
 //======================================================================================================
 /*
@@ -50,12 +51,16 @@ private:
     juce::AudioFormatManager formatManager;
     /** 
      *If we load 100 different files the program it will cache all of them, and it will throw the first one away
-     *once the number has been exceeded
+     *once the number has been exceeded. Finished waveforms are also saved to disk under the track's content hash,
+     *so they are not worked out again after a restart
     */
-    juce::AudioThumbnailCache thumbCache{ 100 };
+    WaveformCache thumbCache{ 100 };
     /** An AudioSource that mixes together the output of a set of other AudioSources */
     juce::MixerAudioSource mixerSource;
 
+    /** Decodes the cover art shown in the library table and on the decks, on a background thread (shared so each image is only decoded once) */
+    CoverArtCache coverArtCache;
+
     //========================Custom Font Setup==========================================================
     
     /** 
@@ -74,17 +79,17 @@ private:
 
     //================================DeckGUI Instances====================================================
     /**
-     *DeckGUIs set up : each takes a DJAudioPlayer, the formatManager, the string
-     * with the name of the DeckGUI (D1 for Deck GUI 1 and D2 for Deck GUI 2),
+     *DeckGUIs set up : each takes a DJAudioPlayer, the other deck's DJAudioPlayer (to sync to), the formatManager, the thumbnail and cover art caches,
+     * the string with the name of the DeckGUI (D1 for Deck GUI 1 and D2 for Deck GUI 2),
      * and the font
     */
-    DeckGUI deckGUI1{ &player1, formatManager, thumbCache, "D1", techFont };
-    DeckGUI deckGUI2{ &player2, formatManager, thumbCache, "D2", techFont };
+    DeckGUI deckGUI1{ &player1, &player2, formatManager, thumbCache, coverArtCache, "D1", techFont };
+    DeckGUI deckGUI2{ &player2, &player1, formatManager, thumbCache, coverArtCache, "D2", techFont };
 
     //==============================Playlist Component=======================================================
 
     /** Sets up and stores the playlist (music library for loading in and storing audio files from the local drive) */
-    PlaylistComponent playlistComponent{ &deckGUI1, &deckGUI2, techFont };
+    PlaylistComponent playlistComponent{ &deckGUI1, &deckGUI2, coverArtCache, thumbCache, techFont };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
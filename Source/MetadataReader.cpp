@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    MetadataReader.cpp
+    Created: 19 Oct 2026 11:02:51am
+    Author:  Ophelia
+    Purpose: reads the artist/album/genre/BPM/key/year tags of an audio file using id3lib,
+             and finds where its cover art is stored
+
+  ==============================================================================
+*/
+
+#include "MetadataReader.h"
+#include "customHeaderForID3Lib.h"
+
+namespace
+{
+    /**
+     *Converts the text stored in one of id3lib's text fields into a juce::String.
+     *id3lib stores UTF-16 text as big-endian (it removes the byte order mark when parsing),
+     *and single-byte text as either ISO-8859-1 or UTF-8 depending on the field's encoding
+     */
+    juce::String fieldToString(const ID3_Field* field)
+    {
+        juce::String text;
+
+        // Number of bytes stored in the field (two per character for UTF-16 text)
+        size_t numBytes = field->Size();
+
+        if (ID3TE_IS_DOUBLE_BYTE_ENC(field->GetEncoding()))
+        {
+            const char* utf16 = reinterpret_cast<const char*>(field->GetRawUnicodeText());
+            if (utf16 != nullptr)
+            {
+                // Converted straight from id3lib's big-endian UTF-16 into UTF-8, which JUCE stores its strings in.
+                // A UTF-16 character never takes more than 3 bytes in UTF-8 (and a surrogate pair takes 4 for 2 characters)
+                std::vector<char> utf8(numBytes * 3 / 2 + 3);
+                size_t size = dami::utf16BEToUTF8(utf16, numBytes, utf8.data());
+                text = juce::String::fromUTF8(utf8.data(), (int)size);
+            }
+        }
+        else if (field->GetEncoding() == ID3TE_UTF8)
+        {
+            // id3lib 3.8.3 only hands out the raw text of ISO-8859-1 fields, so UTF-8 text is skipped when it is unavailable
+            if (const char* utf8 = field->GetRawText())
+            {
+                text = juce::String::fromUTF8(utf8, (int)numBytes);
+            }
+        }
+        else if (const char* latin1 = field->GetRawText())
+        {
+            // Every ISO-8859-1 character takes at most 2 bytes in UTF-8, and most are plain ASCII which is copied as it is
+            size_t length = strnlen(latin1, numBytes);
+            std::vector<char> utf8(length * 2);
+            size_t size = dami::latin1ToUTF8(latin1, length, utf8.data());
+            text = juce::String::fromUTF8(utf8.data(), (int)size);
+        }
+
+        // Removes the padding spaces that ID3v1 tags add to the end of every item
+        return text.trim();
+    }
+
+    /** Returns the text of the first frame in the tag with the given frame ID, or an empty string if there is no such frame */
+    juce::String getFrameText(const ID3_Tag& tag, ID3_FrameID frameId)
+    {
+        const ID3_Frame* frame = tag.Find(frameId);
+        if (frame == nullptr)
+        {
+            return {};
+        }
+
+        const ID3_Field* field = frame->GetField(ID3FN_TEXT);
+        if (field == nullptr)
+        {
+            return {};
+        }
+
+        return fieldToString(field);
+    }
+
+    /**
+     *Converts the content type (TCON) frame's text into a genre name. Genres are often stored as an index into the
+     *ID3v1 genre list, either on their own, e.g. "(17)" or "17", or followed by a refinement, e.g. "(17)Rock"
+     */
+    juce::String getGenreName(const juce::String& contentType)
+    {
+        juce::String genre = contentType;
+        juce::String genreIndex;
+
+        if (genre.startsWithChar('(') && genre.containsChar(')'))
+        {
+            genreIndex = genre.fromFirstOccurrenceOf("(", false, false).upToFirstOccurrenceOf(")", false, false);
+            genre = genre.fromFirstOccurrenceOf(")", false, false).trim();
+        }
+        else if (genre.containsOnly("0123456789"))
+        {
+            genreIndex = genre;
+            genre = {};
+        }
+
+        // Only looks up the ID3v1 genre list when there is no refinement text to use instead
+        if (genre.isEmpty() && genreIndex.isNotEmpty() && genreIndex.containsOnly("0123456789"))
+        {
+            int index = genreIndex.getIntValue();
+            if (index >= 0 && index < ID3_NR_OF_V1_GENRES)
+            {
+                genre = ID3_v1_genre_description[index];
+            }
+        }
+
+        return genre;
+    }
+
+    /**
+     *Fills in the audio properties from the first frame of the MP3 file linked to the tag. The frame count is taken from
+     *the Xing/Info/VBRI header if the encoder wrote one, and the encoder delay and padding from the LAME header
+     */
+    void readAudioProperties(const ID3_Tag& tag, AudioProperties& audioProperties)
+    {
+        const Mp3_Headerinfo* mp3Info = tag.GetMp3HeaderInfo();
+        if (mp3Info == nullptr || mp3Info->frequency == 0 || mp3Info->samples == 0)
+        {
+            return;
+        }
+
+        audioProperties.sampleRate = mp3Info->frequency;
+        audioProperties.lengthInSeconds = mp3Info->samples / audioProperties.sampleRate;
+        audioProperties.bitrate = mp3Info->vbr_bitrate != 0 ? (int)mp3Info->vbr_bitrate : (int)mp3Info->bitrate;
+        audioProperties.isExact = mp3Info->vbr_header != MP3VBRHEADER_NONE;
+    }
+
+    /**
+     *Finds where the image itself starts inside the data of an attached picture (APIC) frame, which begins with the text
+     *encoding, the MIME type (or a 3 character image format in ID3v2.2 tags), the picture type and a description.
+     *Only the start of the frame is read, so the image is never loaded while scanning. Returns false if the start of the frame
+     *cannot be read
+     */
+    bool findCoverArt(const juce::File& audioFile, ID3_V2Spec spec, size_t frameOffset, size_t frameSize, TrackMetadata& metadata)
+    {
+        juce::FileInputStream stream(audioFile);
+        if (!stream.openedOk() || !stream.setPosition((juce::int64)frameOffset))
+        {
+            return false;
+        }
+
+        // The description is usually short or empty, so any picture whose image does not start within this many bytes is skipped
+        const size_t maxHeaderSize = 512;
+        std::vector<unsigned char> header(juce::jmin(frameSize, maxHeaderSize));
+        size_t numRead = (size_t)juce::jmax(0, stream.read(header.data(), (int)header.size()));
+
+        // The text encoding byte: 1 (UTF-16) and 2 (UTF-16BE) end the description with two null bytes instead of one
+        bool isDoubleByte = numRead > 0 && (header[0] == 1 || header[0] == 2);
+        size_t pos = 1;
+
+        // The image format, which is always 3 characters in ID3v2.2, or a null-terminated MIME type (e.g. "image/jpeg")
+        if (spec < ID3V2_3_0)
+        {
+            pos += 3;
+        }
+        else
+        {
+            while (pos < numRead && header[pos] != 0)
+            {
+                ++pos;
+            }
+            pos += 1;
+        }
+
+        // The picture type (e.g. 3 for the front cover)
+        pos += 1;
+
+        // The description, terminated by a null character in the text encoding
+        if (isDoubleByte)
+        {
+            while (pos + 1 < numRead && (header[pos] != 0 || header[pos + 1] != 0))
+            {
+                pos += 2;
+            }
+            pos += 2;
+        }
+        else
+        {
+            while (pos < numRead && header[pos] != 0)
+            {
+                ++pos;
+            }
+            pos += 1;
+        }
+
+        if (pos > numRead || pos >= frameSize)
+        {
+            return false;
+        }
+
+        metadata.coverArtOffset = (juce::int64)(frameOffset + pos);
+        metadata.coverArtSize = (juce::int64)(frameSize - pos);
+        return true;
+    }
+
+    /**
+     *The only frames readMetadata() uses: id3lib skips every other frame without reading it, and only records
+     *where the cover art is, so the picture can be read when it is first displayed
+     */
+    const ID3_FrameID framesToParse[] = {
+        ID3FID_TITLE,
+        ID3FID_LEADARTIST,
+        ID3FID_BAND,
+        ID3FID_ALBUM,
+        ID3FID_CONTENTTYPE,
+        ID3FID_BPM,
+        ID3FID_INITIALKEY,
+        ID3FID_YEAR
+    };
+}
+
+/** Constructor */
+MetadataReader::MetadataReader()
+{
+}
+
+/** Destructor */
+MetadataReader::~MetadataReader()
+{
+}
+
+/**
+ *Reads the ID3v2 tag (or the ID3v1 tag if there is no ID3v2 tag) of the audio file and returns its metadata.
+ *Files without any ID3 tag (e.g. most WAV/AIFF files) return a TrackMetadata with empty strings.
+ *If audioProperties is given, it is filled in from the first MP3 frame found while the tags are read,
+ *and is left with a length of 0 if the file is not an MP3 file.
+ */
+TrackMetadata MetadataReader::readMetadata(const juce::File& audioFile, AudioProperties* audioProperties)
+{
+    TrackMetadata metadata;
+
+    // Only the tags at the beginning (ID3v2) and end (ID3v1) of the file are parsed, not Lyrics3/MusicMatch tags
+    ID3_Tag tag;
+    tag.SetFramesToParse(framesToParse, sizeof(framesToParse) / sizeof(framesToParse[0]));
+    tag.Link(audioFile.getFullPathName().toRawUTF8(), (flags_t)(ID3TT_ID3V2 | ID3TT_ID3V1));
+
+    // id3lib reads the first MP3 frame after the tags anyway, to find where the audio starts
+    if (audioProperties != nullptr && audioFile.hasFileExtension(".mp3"))
+    {
+        readAudioProperties(tag, *audioProperties);
+    }
+
+    // Skipped pictures which are compressed, or in an unsynchronised tag, are not recorded, as they cannot be read directly
+    size_t pictureOffset = 0;
+    size_t pictureSize = 0;
+    if (tag.GetSkippedFrameData(ID3FID_PICTURE, pictureOffset, pictureSize))
+    {
+        findCoverArt(audioFile, tag.GetSpec(), pictureOffset, pictureSize, metadata);
+    }
+
+    if (tag.NumFrames() == 0)
+    {
+        return metadata;
+    }
+
+    metadata.title = getFrameText(tag, ID3FID_TITLE).toStdString();
+
+    // Falls back on the band (TPE2) frame, as some files only store the album artist
+    juce::String artist = getFrameText(tag, ID3FID_LEADARTIST);
+    if (artist.isEmpty())
+    {
+        artist = getFrameText(tag, ID3FID_BAND);
+    }
+    metadata.artist = artist.toStdString();
+
+    metadata.album = getFrameText(tag, ID3FID_ALBUM).toStdString();
+    metadata.genre = getGenreName(getFrameText(tag, ID3FID_CONTENTTYPE)).toStdString();
+    metadata.bpm = getFrameText(tag, ID3FID_BPM).toStdString();
+    metadata.key = getFrameText(tag, ID3FID_INITIALKEY).toStdString();
+    metadata.year = getFrameText(tag, ID3FID_YEAR).toStdString();
+
+    return metadata;
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    MetadataReader.h
+    Created: 19 Oct 2026 11:02:51am
+    Author:  Ophelia
+    Purpose: reads the artist/album/genre/BPM/key/year tags of an audio file using id3lib,
+             and finds where its cover art is stored
+
+  ==============================================================================
+  Used by the TrackImporter's worker threads, so that the tag data is read once when a track is
+  imported and then stored in the CSV file, instead of reopening the audio file whenever it is needed.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <string>
+
+/** Stores the tag data read from a single audio file (each item is an empty string if the file has no such tag) */
+struct TrackMetadata
+{
+    std::string title;
+    std::string artist;
+    std::string album;
+    std::string genre;
+    std::string bpm;
+    std::string key;
+    std::string year;
+
+    // Where the cover art image (e.g. a JPEG or PNG file) is stored inside the audio file, so that the CoverArtCache
+    // can read it later, only when it is first displayed. Both are 0 if the file has no cover art which can be read directly
+    juce::int64 coverArtOffset = 0;
+    juce::int64 coverArtSize = 0;
+};
+
+/** Stores the audio properties read from the first frame of an MP3 file, without decoding any of the audio */
+struct AudioProperties
+{
+    // The length of the track in seconds
+    double lengthInSeconds = 0.0;
+    // The sample rate in Hz
+    double sampleRate = 0.0;
+    // The average bitrate in bits per second
+    int bitrate = 0;
+    // True if the encoder counted the frames in a Xing/Info/VBRI header, so the length is exact. Otherwise the length
+    // was estimated from the file size and the first frame's bitrate, which is only right if every frame has that bitrate
+    bool isExact = false;
+};
+
+class MetadataReader
+{
+public:
+    /** Constructor */
+    MetadataReader();
+
+    /** Destructor */
+    ~MetadataReader();
+
+    /**
+     *Reads the ID3v2 tag (or the ID3v1 tag if there is no ID3v2 tag) of the audio file and returns its metadata.
+     *Files without any ID3 tag (e.g. most WAV/AIFF files) return a TrackMetadata with empty strings.
+     *The cover art is not read: only its position in the file is stored, so that the scan does not get slower.
+     *If audioProperties is given, it is filled in from the first MP3 frame found while the tags are read,
+     *and is left with a length of 0 if the file is not an MP3 file.
+     */
+    TrackMetadata readMetadata(const juce::File& audioFile, AudioProperties* audioProperties = nullptr);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetadataReader)
+};
@@ -3,11 +3,16 @@
 
 //==============================================================================
 
-/** Constructor: playlist must have access to the two deck GUIs and to the Main Component's custom font */
-PlaylistComponent::PlaylistComponent(DeckGUI* _gui1, DeckGUI* _gui2, juce::Font _techFont) : gui1(_gui1),
+/** Constructor: playlist must have access to the two deck GUIs, the Main Component's cover art cache and its custom font */
+PlaylistComponent::PlaylistComponent(DeckGUI* _gui1, DeckGUI* _gui2, CoverArtCache& _coverArtCache, WaveformCache& _waveformCache, juce::Font _techFont) : gui1(_gui1),
 gui2(_gui2),
+coverArtCache(_coverArtCache),
+waveformCache(_waveformCache),
 techFont(_techFont)
 {
+    // A formatManager to be able to get the duration of each track in seconds and to store this data inside the "Track" object.
+    // The TrackAnalyser decodes with it too, so the formats are registered before any tracks are queued
+    formatManager.registerBasicFormats();
 
     // Initializes the CSVHelper private data member, which either creates or loads the CSV file containing the Audio Tracks' data
     csvHelper = CSVHelper();
@@ -15,6 +20,17 @@ techFont(_techFont)
     // Reads the tracks stored in file (if any) and stores them in the "tracks" vector using a CSV helper method
     tracks = csvHelper.readTracksDataFromCSVFile();
 
+    // Tracks added before content hashes were stored (or whose hashing was interrupted) are hashed in the background
+    queueTracksForHashing(tracks);
+    countDuplicateTracks();
+
+    // Tracks which have not been analysed yet are analysed in the background, after any which are scrolled to or loaded into a deck
+    queueTracksForAnalysis(tracks);
+
+    // Hot cues set on either deck are stored with the loaded track, so they are there the next time it is loaded
+    gui1->onHotCuesChanged = [this](const std::string& filePath, const std::vector<double>& hotCues) { storeHotCues(filePath, hotCues); };
+    gui2->onHotCuesChanged = [this](const std::string& filePath, const std::vector<double>& hotCues) { storeHotCues(filePath, hotCues); };
+
     /** Sets the default tracksToDisplay vector to include all of the tracks
      *(later, the tracksToDisplay vector will be used to show ONLY the tracks that meet the user's
      *search criteria)
@@ -26,16 +42,29 @@ techFont(_techFont)
     tableComponent.getHeader().setStretchToFitActive(true);
 
     //===========================================Add Columns to the TableListBox======================================
+    // Adds (8) column for the track's cover art, as wide as the rows are tall so that the thumbnails are square
+    tableComponent.getHeader().addColumn("", 8, rowHeight, rowHeight, rowHeight, juce::TableHeaderComponent::notResizableOrSortable);
+    // Adds (9) column header for the track's number in the library, which is the order the tracks were added in
+    tableComponent.getHeader().addColumn("#", 9, 40, 30, 60);
     // Adds (1) column header for track title
     tableComponent.getHeader().addColumn("Title", 1, 120, 100, getParentWidth() / 3);
+    // Adds (6) column header for the track's artist tag
+    tableComponent.getHeader().addColumn("Artist", 6, 100, 60, getParentWidth() / 4);
     // Adds (2) column header for track duration
     tableComponent.getHeader().addColumn("Length", 2, 80, 60, getParentWidth() / 5);
+    // Adds (7) column header for the track's BPM tag
+    tableComponent.getHeader().addColumn("BPM", 7, 50, 40, getParentWidth() / 8);
+    // Adds (10) column header for the track's key
+    tableComponent.getHeader().addColumn("Key", 10, 70, 50, getParentWidth() / 8);
     // Adds (3) column header for button which adds track to DeckGUI1 when clicked
-    tableComponent.getHeader().addColumn("", 3, 50);
+    tableComponent.getHeader().addColumn("", 3, 50, 30, -1, juce::TableHeaderComponent::notSortable);
     // Adds (4) column header for button which adds track to DeckGUI2 when clicked
-    tableComponent.getHeader().addColumn("", 4, 50);
+    tableComponent.getHeader().addColumn("", 4, 50, 30, -1, juce::TableHeaderComponent::notSortable);
     // Adds (5) column header for button which deletes track from Tracks vector/playlist
-    tableComponent.getHeader().addColumn("", 5, 50);
+    tableComponent.getHeader().addColumn("", 5, 50, 30, -1, juce::TableHeaderComponent::notSortable);
+
+    // Rows are a little taller than the default, so that the cover art can be seen
+    tableComponent.setRowHeight(rowHeight);
 
     // Set background to black and outline to white for the table component
     tableComponent.setColour(juce::TableListBox::ColourIds::backgroundColourId, juce::Colours::black);
@@ -59,7 +88,7 @@ techFont(_techFont)
     // Set the earch box label
     addAndMakeVisible(searchBoxLabel);
     searchBoxLabel.setJustificationType(juce::Justification::topLeft);
-    searchBoxLabel.setText("Press 'Enter' to submit the search term:", juce::dontSendNotification);
+    searchBoxLabel.setText("Search titles, artists and albums (typos are allowed):", juce::dontSendNotification);
 
     // Add the TextEditor class "Search Box" and the TextEditor listener this component inherits from
     addAndMakeVisible(searchBox);
@@ -86,13 +115,33 @@ techFont(_techFont)
     clearButton.setColour(juce::TextButton::ColourIds::textColourOffId, juce::Colours::black);
     clearButton.addListener(this);
 
-    // A formatManager to be able to get the duration of each track in seconds and to store this data inside the "Track" object
-    formatManager.registerBasicFormats();
+    // The "Write BPM/Key Tags" button is styled like the "Clear Search" button beside it
+    addAndMakeVisible(writeTagsButton);
+    writeTagsButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colour(14, 135, 250));
+    writeTagsButton.setColour(juce::TextButton::ColourIds::textColourOffId, juce::Colours::black);
+    writeTagsButton.addListener(this);
+
+    // The import progress bar is hidden until the user adds some files
+    addChildComponent(importProgressBar);
+
+    // The tag writing progress bar is hidden until the user writes some tags
+    addChildComponent(tagWriteProgressBar);
+
+    // Repaints the table whenever more cover art thumbnails are ready
+    coverArtCache.addChangeListener(this);
 }
 
 /** Destructor: sets table model to nullptr to avoid memory leak */
 PlaylistComponent::~PlaylistComponent()
 {
+    coverArtCache.removeChangeListener(this);
+
+    // Saves any changes which were still waiting to be written
+    if (isTimerRunning())
+    {
+        timerCallback();
+    }
+
     // Attribution: FIXES MEMORY LEAK IN DEBUGGER ON SHUTDOWN https://forum.juce.com/t/issue-with-tablelistbox-and-accessibility/53866
     tableComponent.setModel(nullptr);
 }
@@ -129,12 +178,18 @@ void PlaylistComponent::resized()
     searchBoxLabel.setBounds(getWidth() * 0.05, getHeight() * 0.12, getWidth(), getHeight() * 0.08);
     searchBox.setBounds(getWidth() * 0.05, getHeight() * 0.20, getWidth() * 0.9, getHeight() * 0.05);
 
-    // Places the clear button below the search box/label
-    clearButton.setBounds(getWidth() * 0.1, getHeight() * 0.28, getWidth() * 0.8, getHeight() * 0.05);
+    // Places the clear button below the search box/label, with the write tags button beside it
+    clearButton.setBounds(getWidth() * 0.1, getHeight() * 0.28, getWidth() * 0.38, getHeight() * 0.05);
+    writeTagsButton.setBounds(getWidth() * 0.52, getHeight() * 0.28, getWidth() * 0.38, getHeight() * 0.05);
 
     // Puts the add track button & the actual table storing tracks at the bottom of the Playlist Component, below the title and search box
     addButton.setBounds(getWidth() * 0.78, getHeight() * 0.35, getWidth() * 0.15, getHeight() * 0.15);
+    importProgressBar.setBounds(getWidth() * 0.05, getHeight() * 0.40, getWidth() * 0.7, getHeight() * 0.05);
+    tagWriteProgressBar.setBounds(getWidth() * 0.05, getHeight() * 0.455, getWidth() * 0.7, getHeight() * 0.04);
     tableComponent.setBounds(getWidth() * 0.02, getHeight() * 0.5, getWidth() * 0.96, getHeight() * 0.48);
+
+    // A taller table shows more rows
+    queueVisibleTracksForAnalysis();
 }
 
 //=====================================Implementation of Virtual Functions inherited from TableListBoxModel============================
@@ -198,107 +253,206 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
     // First column: enter track title data and position it on the left of the cell
     if (columnId == 1)
     {
-        g.drawText(tracksToDisplay[rowNumber].getTitle(),
+        // Tracks whose audio is also in another row of the library are shown in orange, with the number of copies on the right
+        auto duplicates = numTracksWithContentHash.find(getDisplayedTrack(rowNumber).getContentHash());
+        if (duplicates != numTracksWithContentHash.end() && duplicates->second > 1)
+        {
+            int labelWidth = juce::jmin(width / 3, 60);
+            g.setColour(juce::Colours::orange);
+            g.drawText(juce::String(duplicates->second) + " copies",
+                width - labelWidth - 2, 0, labelWidth, height,
+                juce::Justification::centredRight,
+                true);
+            g.drawText(getDisplayedTrack(rowNumber).getTitle(),
+                2, 0, width - labelWidth - 6, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+        else
+        {
+            g.drawText(getDisplayedTrack(rowNumber).getTitle(),
+                2, 0, width - 4, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+    }
+
+    // Second column: enter track duration data and position it on the left of the cell
+    if (columnId == 2)
+    {
+        g.drawText(getDisplayedTrack(rowNumber).getDuration(),
             2, 0, width - 4, height,
             juce::Justification::centredLeft,
             true);
     }
 
-    // Second column: enter track duration data and position it on the left of the cell
-    if (columnId == 2)
+    // Artist column: enter the artist tag and position it on the left of the cell
+    if (columnId == 6)
     {
-        g.drawText(tracksToDisplay[rowNumber].getDuration(),
+        g.drawText(getDisplayedTrack(rowNumber).getArtist(),
             2, 0, width - 4, height,
             juce::Justification::centredLeft,
             true);
     }
-}
 
-/**
- *Implementation of a pure virtual function in juce::TableListBoxModel.
- * This is used to create or update a custom component to go in a cell (i.e. the AddToDeckGui and Delete buttons)
- */
-juce::Component* PlaylistComponent::refreshComponentForCell(int rowNumber,
-    int columnId,
-    bool isRowSelected,
-    juce::Component* existingComponentToUpdate)
-{
-    // Column with ID 3: the AddToDeckGui1 (D1) button should go here
-    if (columnId == 3)
+    // BPM column: enter the BPM worked out from the audio (or the BPM tag until the track has been analysed) and position it on the left of the cell
+    if (columnId == 7)
     {
-        // If the pointer to the existingComponent is a nullptr, means no component has been created yet, so create the component!
-        if (existingComponentToUpdate == nullptr)
+        Track& track = getDisplayedTrack(rowNumber);
+        if (track.getAnalysedBpm() > 0.0)
         {
-            // Creates the Load into Deck 1 ImageButton for the 3rd column for each Track (has a "D1" icon)
-            juce::ImageButton* btn = new juce::ImageButton{ "Load into Deck 1" };
+            g.drawText(juce::String(track.getAnalysedBpm(), 1),
+                2, 0, width - 4, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+        else
+        {
+            g.drawText(track.getBpm(),
+                2, 0, width - 4, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+    }
 
-            // Sets the D1 icon for the ImageButton
-            btn->setImages(true, true, true, d1Icon, 1.0, juce::Colour(),
-                juce::Image(), 0.5, juce::Colour(255, 255, 255),
-                juce::Image(), 1.0, juce::Colour(255, 255, 255), 0.0f);
+    // Key column: enter the key worked out from the audio with its Camelot code (or the key tag until the track has been analysed)
+    // and position it on the left of the cell
+    if (columnId == 10)
+    {
+        Track& track = getDisplayedTrack(rowNumber);
+        int analysedKey = KeyDetector::parseKey(juce::String(track.getAnalysedKey()));
+        if (analysedKey >= 0)
+        {
+            g.drawText(KeyDetector::getKeyName(analysedKey) + " (" + KeyDetector::getCamelotCode(analysedKey) + ")",
+                2, 0, width - 4, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+        else
+        {
+            g.drawText(track.getKey(),
+                2, 0, width - 4, height,
+                juce::Justification::centredLeft,
+                true);
+        }
+    }
 
-            // Sets each button's ID to "rowNumber:columnId", so for row 4, column 3, this will be string 4:3
-            juce::String id{ std::to_string(rowNumber) + ":" + std::to_string(columnId) };
-            btn->setComponentID(id);
+    // Cover art column: draws the thumbnail if it has been decoded, otherwise the cache decodes it in the background
+    // and the row is repainted once it is ready, so painting never waits for an image to be read
+    if (columnId == 8)
+    {
+        Track& track = getDisplayedTrack(rowNumber);
+        juce::Image thumbnail = coverArtCache.getThumbnail(juce::File(track.getFilePath()), track.getCoverArtOffset(),
+            track.getCoverArtSize(), rowHeight - 4);
 
-            // Adds a ButtonListener (this class) to every Load into Deck 1 button
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
+        if (thumbnail.isValid())
+        {
+            g.drawImageWithin(thumbnail, 2, 2, width - 4, height - 4, juce::RectanglePlacement::centred);
         }
     }
 
-    // Column with ID 4: the AddToDeckGui1 (D2) button should go here
-    if (columnId == 4)
+    // Number column: the track's position in the library, which counts up in the order the tracks were added
+    if (columnId == 9)
     {
-        // If the pointer to the existingComponent is a nullptr, means no component has been created yet, so create the component!
-        if (existingComponentToUpdate == nullptr)
-        {
-            // Creates the Load into Deck 2 ImageButton for the 4th column for each Track (has a "D2" icon)
-            juce::ImageButton* btn = new juce::ImageButton{ "Load into Deck 2" };
+        g.drawText(juce::String((juce::int64)tracksToDisplay[(size_t)rowNumber] + 1),
+            2, 0, width - 4, height,
+            juce::Justification::centredRight,
+            true);
+    }
+
+    // Load into Deck 1/Deck 2 and delete columns: the icons are painted straight into the cell instead of being ImageButtons,
+    // so scrolling never creates, moves or destroys any components
+    if (columnId == 3 || columnId == 4 || columnId == 5)
+    {
+        const juce::Image& icon = columnId == 3 ? d1Icon : (columnId == 4 ? d2Icon : deleteIcon);
+        g.drawImage(icon, getActionIconBounds(width, height).toFloat(), juce::RectanglePlacement::centred);
+    }
+}
 
-            // Sets the D2 icon for the ImageButton
-            btn->setImages(true, true, true, d2Icon, 1.0, juce::Colour(),
-                juce::Image(), 0.5, juce::Colour(255, 255, 255),
-                juce::Image(), 1.0, juce::Colour(0, 0, 255), 0.0f);
+/**
+ *Implementation of a virtual function in juce::TableListBoxModel, which is called when the user clicks on a cell.
+ *The load and delete "buttons" are painted by paintCell rather than being components, so this checks whether
+ *the click landed on one of their icons
+ */
+void PlaylistComponent::cellClicked(int rowNumber, int columnId, const juce::MouseEvent& event)
+{
+    if (columnId != 3 && columnId != 4 && columnId != 5)
+    {
+        return;
+    }
 
-            // Sets each button's ID to "rowNumber:columnId", so for row 4, column 4, this will be string 4:4
-            juce::String id{ std::to_string(rowNumber) + ":" + std::to_string(columnId) };
-            btn->setComponentID(id);
+    // The event is relative to the whole row, so it is moved to be relative to the clicked cell
+    juce::TableHeaderComponent& header = tableComponent.getHeader();
+    juce::Rectangle<int> cell = header.getColumnPosition(header.getIndexOfColumnId(columnId, true));
+    juce::Point<int> clickInCell(event.x - cell.getX(), event.y);
 
-            // Adds a ButtonListener (this class) to every Load into Deck 2 button
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
+    if (getActionIconBounds(cell.getWidth(), tableComponent.getRowHeight()).contains(clickInCell))
+    {
+        performRowAction(rowNumber, columnId);
     }
+}
 
-    // Column with ID 5: the "bin" icon button to delete the track in the current row should go here
-    if (columnId == 5)
+/**
+ *Implementation of a virtual function in juce::TableListBoxModel, which is called when the user clicks on a column header.
+ *The clicked column becomes the main sort column, and the columns sorted before it break its ties
+ */
+void PlaylistComponent::sortOrderChanged(int newSortColumnId, bool isForwards)
+{
+    TrackSorter::SortKey sortKey;
+    switch (newSortColumnId)
     {
-        // If the pointer to the existingComponent is a nullptr, means no component has been created yet, so create the component!
-        if (existingComponentToUpdate == nullptr)
-        {
-            // Creates the Delete ImageButton for the 5rd column for each Track (has a "Bin" icon)
-            juce::ImageButton* btn = new juce::ImageButton{ "Delete" };
+        case 1:  sortKey = TrackSorter::title;     break;
+        case 6:  sortKey = TrackSorter::artist;    break;
+        case 2:  sortKey = TrackSorter::duration;  break;
+        case 7:  sortKey = TrackSorter::bpm;       break;
+        case 10: sortKey = TrackSorter::key;       break;
+        case 9:  sortKey = TrackSorter::dateAdded; break;
+        default: return;
+    }
 
-            // Sets the "Bin" icon for the ImageButton
-            btn->setImages(true, true, true, deleteIcon, 1.0, juce::Colour(),
-                juce::Image(), 0.5, juce::Colour(255, 255, 255),
-                juce::Image(), 1.0, juce::Colour(255, 255, 255), 0.0f);
+    // Moves the column to the front, so e.g. clicking Artist then Title sorts by title, then by artist for equal titles
+    sortColumns.erase(std::remove_if(sortColumns.begin(), sortColumns.end(),
+        [sortKey](const TrackSorter::SortColumn& column) { return column.sortKey == sortKey; }), sortColumns.end());
+    sortColumns.insert(sortColumns.begin(), TrackSorter::SortColumn{ sortKey, isForwards });
+    if (sortColumns.size() > maxSortColumns)
+    {
+        sortColumns.resize(maxSortColumns);
+    }
 
-            // Sets each button's ID to "rowNumber:columnId", so for row 4, column 5, this will be string 4:5
-            juce::String id{ std::to_string(rowNumber) + ":" + std::to_string(columnId) };
-            btn->setComponentID(id);
+    sortDisplayedTracks();
+    tableComponent.updateContent();
+    tableComponent.repaint();
+    queueVisibleTracksForAnalysis();
+}
 
-            // Adds a ButtonListener (this class) to every Delete button
-            btn->addListener(this);
-            existingComponentToUpdate = btn;
-        }
-    }
+/**
+ *Implementation of a virtual function in juce::TableListBoxModel, which is called when the table is scrolled.
+ *Queues the tracks scrolled to for analysis ahead of the rest of the library
+ */
+void PlaylistComponent::listWasScrolled()
+{
+    queueVisibleTracksForAnalysis();
+}
 
-    // Return the component (a button) which is to be added
-    return existingComponentToUpdate;
+//=====================================Library Table============================
+
+/** Starts timing the frame, then paints the table's background */
+void PlaylistComponent::LibraryTable::paint(juce::Graphics& g)
+{
+#if JUCE_DEBUG
+    frameCounter.start();
+#endif
+    juce::TableListBox::paint(g);
 }
 
+/** Paints the table's outline once every row has been painted, then stops timing the frame */
+void PlaylistComponent::LibraryTable::paintOverChildren(juce::Graphics& g)
+{
+    juce::TableListBox::paintOverChildren(g);
+#if JUCE_DEBUG
+    frameCounter.stop();
+#endif
+}
 
 //=====================================Implementation of Listeners' Virtual Functions============================
 /**
@@ -314,98 +468,38 @@ void PlaylistComponent::buttonClicked(juce::Button* button)
     }
     else if (button == &clearButton)
     {
-        /* Resets the user input to an empty string : this means that the function called loopOverTracksAndDetermineIfToDisplay will
-         * set the "isDisplayed" property for each Track to true */
-        loopOverTracksAndDetermineIfToDisplay(juce::String(""));
-        // Adds all of the tracks which have "isDisplayed" set to true to the "tracksToDisplay" vector
-        addTracksToDisplayToDisplayedVector();
-        // Clears the search box of any user input
+        // Clears the search box of any user input, and displays every track again
         searchBox.clear();
-
-        // Redraws the table
-        tableComponent.updateContent();
-        tableComponent.repaint();
+        searchLibrary(juce::String(""));
     }
-    else
+    else if (button == &writeTagsButton)
     {
-        // Converts JUCE String ComponentID to std::string and then to an integer
-        std::string id = button->getComponentID().toStdString();
-
-        // Attribution: https://stackoverflow.com/questions/15006269/c-get-substring-before-a-certain-char
-        // How to get a substring before a certain char (the row-index/track-index in this case)
-        std::string trackId;
-
-        std::string::size_type index = id.find(':');
-
-        // Get the track (table ROW) id - before the ':' character in the Component's/Button's ID
-        if (index != std::string::npos)
-        {
-            trackId = id.substr(0, index);
-        }
-
-        // Converts the trackId to an integer, so that it can be used as an index to get the correct track from the tracksToDisplay vector
-        int trackIndex = std::stoi(trackId);
-
-        // Get the substring AFTER the ':' to determine whether this button is to load into D1/D2 or to delete the Track in that row
-        // Attribution: https://stackoverflow.com/questions/28163723/c-how-to-get-substring-after-a-character
-        // How to get a substring after a certain char (the column-index/load/delete button in this case)
-        int columnId = std::stoi(id.substr(id.find(':') + 1));
-
-        // If the column ID is 3, load the track in the trackID/row index into DeckGUI1
-        if (columnId == 3)
-        {
-            gui1->loadTrack(tracksToDisplay[trackIndex].getUrl());
-        }
-
-        // If the column ID is 4, load the track in the trackID/row index into DeckGUI2
-        if (columnId == 4)
-        {
-            gui2->loadTrack(tracksToDisplay[trackIndex].getUrl());
-        }
-
-        // If the column ID is 5, then delete the track from the Music Library (the PlaylistComponent class)
-        if (columnId == 5)
-        {
-            // IMPORTANT:
-            // Attribution1 (deleting C++ vector elements): https://www.tutorialspoint.com/cplusplus-program-to-remove-items-from-a-given-vector
-            // Attribution 2: https://iq.opengenus.org/ways-to-remove-elements-from-vector-cpp/
-            tracksToDisplay.erase(tracksToDisplay.begin() + (trackIndex));
-
-            // Also erase the track from the hidden track store (tracks which are not currently displayed)
-            tracks.erase(tracks.begin() + (trackIndex));
-
-            // Updates the CSV file after deleting the track
-            csvHelper.writeTracksDataIntoCSVFile(tracks);
+        writeAnalysedTags();
+    }
+}
 
-            // Updates and repaints the table component when the track is deleted from the PlaylsitComponent
-            tableComponent.updateContent();
-            tableComponent.repaint();
-        }
+/**
+ *Implementation of a TextEditorListener function which is called when the text in the Search Box changes.
+ *Searches the library as the user types, so the results are ready before they have finished typing
+ */
+void PlaylistComponent::textEditorTextChanged(juce::TextEditor& textEditor)
+{
+    if (&textEditor == &searchBox)
+    {
+        searchLibrary(textEditor.getText());
     }
 }
 
 /**
  *Implementation of a TextEditorListener function which is called when user presses the Enter key.
- *Gets the user input from the TextEditor (Search Box) and loops through "tracks" to compare titles/durations to user input
- *Sets the Track's "isDisplayed" property to true if the track data contains the string the user typed into the search box
+ *Searches the library for the text in the Search Box (if it has not already been searched for as it was typed)
  */
 void PlaylistComponent::textEditorReturnKeyPressed(juce::TextEditor& textEditor)
 {
     // Compare the addresses of input and the searchBox member variable
     if (&textEditor == &searchBox)
     {
-        // Get user input from search box
-        juce::String inputtedText = textEditor.getText();
-
-        // Determines which tracks should have isDisplayed set to true based on the user input string
-        loopOverTracksAndDetermineIfToDisplay(inputtedText);
-
-        // Adds the tracks which now have isDisplayed set to true to the "tracksToDisplay" vector
-        addTracksToDisplayToDisplayedVector();
-
-        // Updates table
-        tableComponent.updateContent();
-        tableComponent.repaint();
+        searchLibrary(textEditor.getText());
     }
 }
 
@@ -429,6 +523,23 @@ void PlaylistComponent::mouseUp(const juce::MouseEvent& event)
     }
 }
 
+/** Implementation of a ChangeListener function which is called when the CoverArtCache has decoded more thumbnails */
+void PlaylistComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    // Only the visible rows are repainted, and their thumbnails are now in the cache's memory
+    if (source == &coverArtCache)
+    {
+        tableComponent.repaint();
+    }
+}
+
+/** Implements juce::Timer's inherited pure virtual function: rewrites the CSV file with the changes made since the last save */
+void PlaylistComponent::timerCallback()
+{
+    stopTimer();
+    csvHelper.writeTracksDataIntoCSVFile(tracks);
+}
+
 //============================================= = Drag and Drop functions====================================================
 
 /**
@@ -446,84 +557,407 @@ bool PlaylistComponent::isInterestedInFileDrag(const juce::StringArray& files)
  */
 void PlaylistComponent::filesDropped(const juce::StringArray& files, int x, int y)
 {
-
-    // Make sure user only adds one file
-    if (files.size() == 1)
-    {
-        // Converts a string filename into a file then into a URL
-        juce::URL fileURL = juce::URL{ juce::File{files[0]} };
-
-        // 2nd parameter: "includeGetParameters" --> if this is true and any parameters have been set with the withParameter() method
-        juce::String fileURLJS = fileURL.toString(false);
-
-        // Converts the fileURLString to a standard string
-        std::string fileURLString = fileURLJS.toStdString();
-    }
+    // Any number of files and folders can be dropped: folders are searched for audio files by the TrackImporter
+    importProgressBar.setVisible(true);
+    trackImporter.importFiles(files);
 }
 
-/** Adds a new track which the user selects from the local disk to the private tracks vector and CSV file */
+/**
+ *Lets the user select audio files and/or folders from the local disk, which are passed to the TrackImporter
+ *to be scanned in the background and added to the private tracks vector and CSV file
+ */
 void PlaylistComponent::addNewTrack()
 {
     // File drag-drop for JUCE 6:
     // Attribution: https://docs.juce.com/master/classFileChooser.html#ac888983e4abdd8401ba7d6124ae64ff3
     auto fileChooserFlags =
-        juce::FileBrowserComponent::canSelectFiles;
+        juce::FileBrowserComponent::openMode |
+        juce::FileBrowserComponent::canSelectFiles |
+        juce::FileBrowserComponent::canSelectDirectories |
+        juce::FileBrowserComponent::canSelectMultipleItems;
 
     // Launches out of the main thread
     fChooser.launchAsync(fileChooserFlags, [this](const juce::FileChooser& chooser)
         {
-            auto chosenFile = chooser.getResult();
+            // Stores the full paths of every file/folder the user selected
+            juce::StringArray chosenPaths;
+            for (const juce::File& chosenFile : chooser.getResults())
+            {
+                chosenPaths.add(chosenFile.getFullPathName());
+            }
+
+            // Nothing to import if the user cancelled the FileChooser
+            if (chosenPaths.isEmpty())
+            {
+                return;
+            }
 
-            std::string trackLengthInHHMMSSFormat = "";
+            // The durations are read on the TrackImporter's worker threads, which call addImportedTracks() when they are done
+            importProgressBar.setVisible(true);
+            trackImporter.importFiles(chosenPaths);
+        });
+}
+
+/**
+ *Called by the TrackImporter on the message thread with each batch of scanned audio files.
+ *Adds the batch to the tracks vector, appends it to the CSV file and hides the progress bar once the import is finished
+ */
+void PlaylistComponent::addImportedTracks(std::vector<TrackImporter::ImportResult>& importedFiles)
+{
+    // Stores only this batch's tracks, so that just these rows are appended to the CSV file
+    std::vector<Track> newTracks;
+    newTracks.reserve(importedFiles.size());
 
-            // Gets the duration of the audio track
-            // Attribution: https://forum.juce.com/t/get-track-length-before-it-starts-playing/44838
-            // Read the audio file using the formatManager data member to store the track's length in seconds
-            if (auto reader = formatManager.createReaderFor(chosenFile))
+    for (TrackImporter::ImportResult& importedFile : importedFiles)
+    {
+        TrackMetadata& metadata = importedFile.metadata;
+
+        // Uses the title tag if the file has one, otherwise the file name
+        std::string title = metadata.title.empty() ? importedFile.file.getFileNameWithoutExtension().toStdString() : metadata.title;
+
+        newTracks.push_back(Track
             {
-                double lengthInSeconds = reader->lengthInSamples / reader->sampleRate;
+                // The track index in the tracks vector
+                tracks.size() + newTracks.size(),
+                // Track URL
+                juce::URL{ importedFile.file },
+                // Track title
+                title,
+                // Track extension (e.g. mp3)
+                importedFile.file.getFileExtension().toStdString(),
+                // Track duration in hrs, mins, seconds
+                convertTimeInSecondsToString(importedFile.lengthInSeconds),
+                // Absolute path to the track
+                importedFile.file.getFullPathName().toStdString(),
+                // Tag metadata read by the TrackImporter's worker threads
+                metadata.artist,
+                metadata.album,
+                metadata.genre,
+                metadata.bpm,
+                metadata.key,
+                metadata.year,
+                // Where the cover art is stored in the file, so it can be read when the row is first painted
+                metadata.coverArtOffset,
+                metadata.coverArtSize
+            });
+    }
+
+    // Hides the progress bar once the TrackImporter has no more files left to scan
+    if (!trackImporter.isImporting())
+    {
+        importProgressBar.setVisible(false);
+    }
+
+    // The last call of an import can be empty, as it only tells this component that the import has finished
+    if (newTracks.empty())
+    {
+        return;
+    }
+
+    tracks.insert(tracks.end(), newTracks.begin(), newTracks.end());
+    trackSorter.invalidate();
+    trackSearcher.invalidate();
+
+    // Appends only the new tracks to the CSV File instead of rewriting every track in the library
+    csvHelper.appendTracksDataToCSVFile(newTracks);
+
+    // The new tracks are hashed in the background, and marked as duplicates once their hashes are known
+    queueTracksForHashing(newTracks);
+    queueTracksForAnalysis(newTracks);
+
+    // Batches arrive several times a second, so the user's search is kept (and may be typed while importing),
+    // and the new tracks are shown if they match it
+    addTracksToDisplayToDisplayedVector();
+
+    // Update and repaint the table component once per batch, instead of once per track
+    // Attribution: https://forum.juce.com/t/tablelistboxmodel-and-repaint/4915/2
+    tableComponent.updateContent();
+    tableComponent.repaint();
+    queueVisibleTracksForAnalysis();
+}
+
+/** Passes the files of the given tracks which have not been hashed yet to the TrackHasher */
+void PlaylistComponent::queueTracksForHashing(std::vector<Track>& tracksToHash)
+{
+    juce::StringArray filePaths;
+    for (Track& t : tracksToHash)
+    {
+        // Missing files are skipped rather than hashed to an empty string on every start-up
+        if (t.getContentHash().empty() && juce::File(t.getFilePath()).existsAsFile())
+        {
+            filePaths.add(t.getFilePath());
+        }
+    }
+
+    if (!filePaths.isEmpty())
+    {
+        trackHasher.hashFiles(filePaths);
+    }
+}
 
-                // Call the custom-made convertTimeInSecondsToString() function to get the duration as HH:MM:SS
-                trackLengthInHHMMSSFormat = convertTimeInSecondsToString(lengthInSeconds);
+/**
+ *Called by the TrackHasher on the message thread with each batch of hashed files.
+ *Stores the content hashes in the tracks, saves them to the CSV file and repaints the table to show any new duplicates
+ */
+void PlaylistComponent::addContentHashes(std::vector<TrackHasher::HashResult>& hashedFiles)
+{
+    std::map<std::string, std::string> contentHashOfPath;
+    for (TrackHasher::HashResult& hashedFile : hashedFiles)
+    {
+        if (hashedFile.contentHash.isNotEmpty())
+        {
+            contentHashOfPath[hashedFile.filePath.toStdString()] = hashedFile.contentHash.toStdString();
+        }
+    }
+
+    // The same file can be in the library more than once, so every track with a hashed path is updated
+    bool hasNewHashes = false;
+    for (Track& t : tracks)
+    {
+        auto hashed = contentHashOfPath.find(t.getFilePath());
+        if (hashed != contentHashOfPath.end() && t.getContentHash() != hashed->second)
+        {
+            t.setContentHash(hashed->second);
+            hasNewHashes = true;
+        }
+    }
+
+    if (!hasNewHashes)
+    {
+        return;
+    }
+
+    // The hashes are stored in rows which were already written, so the whole file is rewritten along with any other batches which arrive soon after
+    saveLibrarySoon();
+
+    // Copies the hashes into the displayed tracks without clearing the user's search
+    addTracksToDisplayToDisplayedVector();
+    countDuplicateTracks();
+    tableComponent.repaint();
+}
+
+/**
+ *Rewrites the CSV file a couple of seconds from now, so that the batches which arrive in the meantime
+ *are saved together with a single rewrite
+ */
+void PlaylistComponent::saveLibrarySoon()
+{
+    // The timer isn't restarted, so a steady stream of batches is still saved every couple of seconds
+    if (!isTimerRunning())
+    {
+        startTimer(saveDelayMilliseconds);
+    }
+}
+
+/** Counts how many tracks in the library have each content hash, so that paintCell can mark the duplicates */
+void PlaylistComponent::countDuplicateTracks()
+{
+    numTracksWithContentHash.clear();
+    for (Track& t : tracks)
+    {
+        if (!t.getContentHash().empty())
+        {
+            ++numTracksWithContentHash[t.getContentHash()];
+        }
+    }
+}
+
+/** Passes the files of the given tracks which have not been analysed yet to the TrackAnalyser, to be analysed after any visible or loaded tracks */
+void PlaylistComponent::queueTracksForAnalysis(std::vector<Track>& tracksToAnalyse)
+{
+    juce::StringArray filePaths;
+    for (Track& t : tracksToAnalyse)
+    {
+        // Missing files are skipped, as they would fail to decode on every start-up
+        if (!t.isAnalysed() && juce::File(t.getFilePath()).existsAsFile())
+        {
+            filePaths.add(t.getFilePath());
+        }
+    }
+
+    if (!filePaths.isEmpty())
+    {
+        trackAnalyser.analyseFiles(filePaths, TrackAnalyser::backgroundPriority);
+    }
+}
+
+/** Passes the tracks in the rows the table is showing which have not been analysed yet to the TrackAnalyser, to be analysed ahead of the rest of the library */
+void PlaylistComponent::queueVisibleTracksForAnalysis()
+{
+    // Only the rows inside the table's viewport are queued, however many rows the table has
+    juce::Viewport* viewport = tableComponent.getViewport();
+    if (viewport == nullptr || getNumRows() == 0)
+    {
+        return;
+    }
+
+    int firstRow = viewport->getViewPositionY() / rowHeight;
+    int lastRow = juce::jmin(getNumRows() - 1, (viewport->getViewPositionY() + viewport->getViewHeight()) / rowHeight);
+
+    juce::StringArray filePaths;
+    for (int row = firstRow; row <= lastRow; ++row)
+    {
+        Track& track = getDisplayedTrack(row);
+        if (!track.isAnalysed())
+        {
+            filePaths.add(track.getFilePath());
+        }
+    }
+
+    // The TrackAnalyser skips any track which is already queued at this priority or higher
+    if (!filePaths.isEmpty())
+    {
+        trackAnalyser.analyseFiles(filePaths, TrackAnalyser::visiblePriority);
+    }
+}
 
-                // Free up the memory when done reading the length of the audio file
-                delete reader;
-                reader = nullptr;
+/**
+ *Called by the TrackAnalyser on the message thread with each batch of analysed files.
+ *Stores the beat grids, keys and loudness in the tracks (updating a deck which has one of them loaded), saves their waveforms,
+ *saves them to the CSV file and repaints the table to show the analysed BPMs and keys
+ */
+void PlaylistComponent::addAnalysisResults(std::vector<TrackAnalyser::AnalysisResult>& analysedFiles)
+{
+    // A file which could not be opened or decoded (e.g. it is on a drive which isn't plugged in) is left unanalysed,
+    // so it is tried again the next time it is queued
+    std::map<std::string, TrackAnalyser::AnalysisResult*> resultOfPath;
+    for (TrackAnalyser::AnalysisResult& analysedFile : analysedFiles)
+    {
+        if (analysedFile.wasDecoded)
+        {
+            resultOfPath[analysedFile.filePath.toStdString()] = &analysedFile;
+        }
+    }
+
+    // The same file can be in the library more than once, so every track with an analysed path is updated.
+    // Tracks without a steady beat or key are stored with a BPM of -1, a key of "-" and the loudness of silence,
+    // so they are not analysed again
+    bool hasNewResults = false;
+    for (Track& t : tracks)
+    {
+        auto analysed = resultOfPath.find(t.getFilePath());
+        if (analysed != resultOfPath.end())
+        {
+            double bpm = analysed->second->bpm > 0.0 ? analysed->second->bpm : -1.0;
+            t.setBeatGrid(bpm, analysed->second->firstBeatSeconds);
+            t.setAnalysedKey(analysed->second->key.isNotEmpty() ? analysed->second->key.toStdString() : "-");
+            bool hasLoudness = analysed->second->integratedLoudness != 0.0;
+            t.setLoudness(hasLoudness ? analysed->second->integratedLoudness : -70.0,
+                analysed->second->loudnessRange,
+                hasLoudness ? analysed->second->truePeak : -100.0);
+            hasNewResults = true;
+
+            // A track which is already playing in a deck is brought to the target loudness as soon as its loudness is known
+            gui1->trackAnalysed(t);
+            gui2->trackAnalysed(t);
+
+            // The waveform is saved under the content hash the decks look it up by. A track which has not been hashed yet
+            // has its waveform worked out the usual way when it is loaded
+            if (analysed->second->waveform.getSize() > 0 && !t.getContentHash().empty())
+            {
+                waveformCache.storeWaveform(juce::String(t.getContentHash()).getHexValue64(), analysed->second->waveform);
+                analysed->second->waveform.reset();
             }
+        }
+    }
+
+    if (!hasNewResults)
+    {
+        return;
+    }
+
+    // The results are stored in rows which were already written, so the whole file is rewritten along with any other batches which arrive soon after
+    saveLibrarySoon();
+
+    // The BPM and key sort keys have changed, so a table sorted by them is sorted again without clearing the user's search
+    trackSorter.invalidate();
+    addTracksToDisplayToDisplayedVector();
+    tableComponent.repaint();
+}
+
+/** Called by a deck when the user sets or clears a hot cue: stores the hot cues in every track with the file path, and saves them to the CSV file */
+void PlaylistComponent::storeHotCues(const std::string& filePath, const std::vector<double>& hotCues)
+{
+    bool isInLibrary = false;
+    for (Track& t : tracks)
+    {
+        if (t.getFilePath() == filePath)
+        {
+            t.setHotCues(hotCues);
+            isInLibrary = true;
+        }
+    }
 
-            // Gets the absolute path of each audio file as a string
-            std::string filePath = chosenFile.getFullPathName().toStdString();
-
-            // Adds the new Track's data to the "tracks" vector
-            tracks.push_back(Track
-                {
-                    // The track index in the tracks vector
-                    tracks.size(),
-                    // Track URL
-                    juce::URL{ chosenFile },
-                    // Track title
-                    chosenFile.getFileNameWithoutExtension().toStdString(),
-                    // Track extension (e.g. mp3)
-                    chosenFile.getFileExtension().toStdString(),
-                    // Track duration in hrs, mins, seconds
-                    trackLengthInHHMMSSFormat,
-                    // Absolute path to the track
-                    filePath
-                });
-
-            // Writes the track data for all the tracks after adding the new track into the CSV File
-            csvHelper.writeTracksDataIntoCSVFile(tracks);
-
-            // Displays all the tracks after a new track is added, thus clearing any previous search results
-            loopOverTracksAndDetermineIfToDisplay(juce::String(""));
-            addTracksToDisplayToDisplayedVector();
-            // Clear any search criteria
-            searchBox.clear();
-
-            // Update and repaint the table component whenever a new track is added, so that it is displayed
-            // Attribution: https://forum.juce.com/t/tablelistboxmodel-and-repaint/4915/2
-            tableComponent.updateContent();
-            tableComponent.repaint(); });
+    // Setting several hot cues in a row is saved with a single rewrite
+    if (isInLibrary)
+    {
+        saveLibrarySoon();
+    }
+}
+
+/**
+ *Writes the analysed BPM and key of every analysed MP3 in the library back into the file's tags,
+ *on the TagWriter's background threads, so other DJ software and players see them too
+ */
+void PlaylistComponent::writeAnalysedTags()
+{
+    std::vector<TagWriter::FileEdits> fileEdits;
+    for (Track& t : tracks)
+    {
+        // Only MP3s have ID3 tags, and a track is only written once it has a BPM or a key worked out from its audio
+        juce::File file(t.getFilePath());
+        if (!file.hasFileExtension(".mp3") || !file.existsAsFile())
+        {
+            continue;
+        }
+
+        TagWriter::FileEdits edits{ file, {} };
+        if (t.getAnalysedBpm() > 0.0)
+        {
+            // The BPM tag holds a whole number
+            edits.edits.push_back({ TagWriter::TagField::bpm, juce::String(juce::roundToInt(t.getAnalysedBpm())) });
+        }
+        int analysedKey = KeyDetector::parseKey(juce::String(t.getAnalysedKey()));
+        if (analysedKey >= 0)
+        {
+            // Key tags are written the way other DJ software writes them (e.g. "Am" or "F#")
+            edits.edits.push_back({ TagWriter::TagField::key, KeyDetector::getKeyName(analysedKey) });
+        }
+
+        if (!edits.edits.empty())
+        {
+            fileEdits.push_back(edits);
+        }
+    }
+
+    // The same file can be in the library more than once, but the TagWriter writes each file once
+    if (!fileEdits.empty())
+    {
+        tagWriteProgressBar.setVisible(true);
+        tagWriter.writeTags(fileEdits);
+    }
+}
+
+/** Called by the TagWriter on the message thread once the tags have been written: tells the user how many files were written and which failed */
+void PlaylistComponent::tagsWritten(const TagWriter::WriteReport& report)
+{
+    tagWriteProgressBar.setVisible(false);
+
+    juce::String message = "Wrote the BPM and key tags of " + juce::String(report.numWritten) + " files in "
+        + juce::String(report.secondsTaken, 1) + " seconds (" + juce::String(report.filesPerSecond, 1) + " files per second).";
+
+    // Only the first few failed files are listed, so the message still fits on the screen
+    if (!report.failedFiles.isEmpty())
+    {
+        message << "\n\n" << report.failedFiles.size() << " files could not be written (e.g. they are read-only or missing):";
+        for (int i = 0; i < juce::jmin(report.failedFiles.size(), maxFailedFilesListed); ++i)
+        {
+            message << "\n" << report.failedFiles.getReference(i).getFullPathName();
+        }
+    }
+
+    juce::AlertWindow::showMessageBoxAsync(report.failedFiles.isEmpty() ? juce::AlertWindow::InfoIcon : juce::AlertWindow::WarningIcon,
+        "Write BPM/Key Tags", message);
 }
 
 /**
@@ -570,33 +1004,130 @@ std::string PlaylistComponent::convertTimeInSecondsToString(double lengthInSecon
 }
 
 /**
- * A method which iterates over all the stored tracks and calls the Track's member function called determineIfShouldDisplay,
- * which sets the isDisplayed property to "true" only if the track title/duration contains the input parameter string as a substring
+ *Shows only the tracks whose title, artist or album match the query (allowing for typos), best match first,
+ *or every track if the query is empty
  */
-void PlaylistComponent::loopOverTracksAndDetermineIfToDisplay(juce::String userInput)
+void PlaylistComponent::searchLibrary(const juce::String& query)
 {
-    // Checks if each track contains the typed substring in its title or extension
-    for (Track& t : tracks)
+    // Nothing changes if the query is the same (e.g. Enter is pressed after the text was already searched for as it was typed)
+    juce::String trimmedQuery = query.trim();
+    if (trimmedQuery == searchQuery)
     {
-        t.determineIfShouldDisplay(userInput);
+        return;
     }
+    searchQuery = trimmedQuery;
+
+    addTracksToDisplayToDisplayedVector();
+
+    // Updates table, scrolling back to the best match
+    tableComponent.updateContent();
+    tableComponent.scrollToEnsureRowIsOnscreen(0);
+    tableComponent.repaint();
+    queueVisibleTracksForAnalysis();
 }
 
-/**
- *A method which sets which tracks to display by getting the "isDisplayed" property of every track
- * and adding the desired tracks which have this property to the tracksToDisplay vector
- */
+/*
+ Method which fills the tracksToDisplay vector: with the ranked matches of the current search if there is one,
+ * otherwise with every track, in the order the user sorted the table in
+*/
 void PlaylistComponent::addTracksToDisplayToDisplayedVector()
 {
-    // Clears the current vector of tracks to display
+    // The search results are already in order, from the best match to the worst
+    if (searchQuery.isNotEmpty())
+    {
+        tracksToDisplay = trackSearcher.search(tracks, searchQuery, maxSearchResults);
+        return;
+    }
+
+    // Clears the current vector of tracks to display, and pushes the position of every Track stored in "tracks"
     tracksToDisplay.clear();
+    tracksToDisplay.reserve(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        tracksToDisplay.push_back(i);
+    }
 
-    // Iterates over every Track stored in "tracks", and pushes only the tracks with isDisplayed set to true to the "tracksToDisplay" vector
-    for (Track& t : tracks)
+    // Keeps the rows in the order the user sorted them in
+    sortDisplayedTracks();
+}
+
+/** Sorts the displayed rows by the sort columns the user has chosen (if any), without touching the tracks themselves */
+void PlaylistComponent::sortDisplayedTracks()
+{
+    if (!sortColumns.empty())
     {
-        if (t.getIsDisplayed())
-        {
-            tracksToDisplay.push_back(t);
-        }
+        trackSorter.sort(tracks, tracksToDisplay, sortColumns);
+    }
+}
+
+/** Returns the track shown in the given row of the table */
+Track& PlaylistComponent::getDisplayedTrack(int rowNumber)
+{
+    return tracks[tracksToDisplay[(size_t)rowNumber]];
+}
+
+/**
+ *Returns where the icon of a load/delete column is drawn in a cell of the given size. paintCell draws the icon here,
+ *and cellClicked only acts on clicks inside it, so the icons behave like the buttons they replace
+ */
+juce::Rectangle<int> PlaylistComponent::getActionIconBounds(int width, int height)
+{
+    int iconSize = juce::jmax(0, juce::jmin(width, height) - 4);
+    return juce::Rectangle<int>(iconSize, iconSize).withCentre({ width / 2, height / 2 });
+}
+
+/** Loads the track in the given row into a deck, or deletes it from the library, depending on which action column was clicked */
+void PlaylistComponent::performRowAction(int rowNumber, int columnId)
+{
+    // The row can be out of range if the table was clicked while its content was being updated
+    if (rowNumber < 0 || rowNumber >= getNumRows())
+    {
+        return;
+    }
+
+    Track& track = getDisplayedTrack(rowNumber);
+
+    // A track which is loaded into a deck is about to be mixed, so if it has not been analysed yet it is analysed before any other track
+    if ((columnId == 3 || columnId == 4) && !track.isAnalysed())
+    {
+        trackAnalyser.analyseFiles(juce::StringArray(juce::String(track.getFilePath())), TrackAnalyser::deckPriority);
+    }
+
+    // If the column ID is 3, load the track in this row into DeckGUI1
+    if (columnId == 3)
+    {
+        gui1->loadTrack(track);
+    }
+
+    // If the column ID is 4, load the track in this row into DeckGUI2
+    if (columnId == 4)
+    {
+        gui2->loadTrack(track);
+    }
+
+    // If the column ID is 5, then delete the track from the Music Library (the PlaylistComponent class)
+    if (columnId == 5)
+    {
+        // The row's position in "tracks" is used, so the right track is deleted even when a search is hiding some of the tracks
+        // Attribution1 (deleting C++ vector elements): https://www.tutorialspoint.com/cplusplus-program-to-remove-items-from-a-given-vector
+        // Attribution 2: https://iq.opengenus.org/ways-to-remove-elements-from-vector-cpp/
+        tracks.erase(tracks.begin() + tracksToDisplay[(size_t)rowNumber]);
+        trackSorter.invalidate();
+        trackSearcher.invalidate();
+
+        // The positions of the tracks after the deleted one have changed, so the displayed rows are worked out again
+        addTracksToDisplayToDisplayedVector();
+
+        // Updates the CSV file after deleting the track, which also saves any changes that were waiting to be written
+        stopTimer();
+        csvHelper.writeTracksDataIntoCSVFile(tracks);
+
+        // The deleted track's copies may no longer be duplicates
+        countDuplicateTracks();
+
+        // Updates and repaints the table component when the track is deleted from the PlaylsitComponent
+        tableComponent.updateContent();
+        tableComponent.repaint();
+        queueVisibleTracksForAnalysis();
     }
 }
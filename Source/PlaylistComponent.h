@@ -3,9 +3,19 @@
 #include <JuceHeader.h>
 #include <vector>
 #include <string>
+#include <map>
 #include "Track.h"
 #include "DeckGUI.h"
 #include "CSVHelper.h"
+#include "TrackImporter.h"
+#include "CoverArtCache.h"
+#include "WaveformCache.h"
+#include "TrackHasher.h"
+#include "TrackSorter.h"
+#include "TrackSearcher.h"
+#include "TrackAnalyser.h"
+#include "KeyDetector.h"
+#include "TagWriter.h"
 
 //==============================================================================
 /*
@@ -18,13 +28,19 @@ class PlaylistComponent : public juce::Component,
     // A listener for the text input box: search functionality
     public juce::TextEditor::Listener,
     // A mouse listener to toggle search box's caret when user clicks inside/outside it
-    public juce::MouseListener
+    public juce::MouseListener,
+    // Repaints the table when the CoverArtCache has decoded more thumbnails
+    public juce::ChangeListener,
+    // Saves the library a moment after the background workers change it, instead of after every batch
+    public juce::Timer
 {
 public:
-    /** Constructor: playlist must have access to the two deck GUIs and to the Main Component's custom font */
+    /** Constructor: playlist must have access to the two deck GUIs, the Main Component's cover art and waveform caches and its custom font */
     PlaylistComponent(
         DeckGUI* _gui1,
         DeckGUI* _gui2,
+        CoverArtCache& _coverArtCache,
+        WaveformCache& _waveformCache,
         // Pass in the font from Main Component,
         juce::Font _techFont);
 
@@ -70,13 +86,23 @@ public:
         bool rowIsSelected) override;
 
     /**
-     *Implementation of a pure virtual function in juce::TableListBoxModel.
-     * This is used to create or update a custom component to go in a cell (i.e. the AddToDeckGui and Delete buttons)
+     *Implementation of a virtual function in juce::TableListBoxModel, which is called when the user clicks on a cell.
+     *The load and delete "buttons" are painted by paintCell rather than being components, so this checks whether
+     *the click landed on one of their icons
      */
-    juce::Component* refreshComponentForCell(int rowNumber,
-        int columnId,
-        bool isRowSelected,
-        juce::Component* existingComponentToUpdate) override;
+    void cellClicked(int rowNumber, int columnId, const juce::MouseEvent& event) override;
+
+    /**
+     *Implementation of a virtual function in juce::TableListBoxModel, which is called when the user clicks on a column header.
+     *The clicked column becomes the main sort column, and the columns sorted before it break its ties
+     */
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override;
+
+    /**
+     *Implementation of a virtual function in juce::TableListBoxModel, which is called when the table is scrolled.
+     *Queues the tracks scrolled to for analysis ahead of the rest of the library
+     */
+    void listWasScrolled() override;
 
     //=====================================Implementation of Listeners' Virtual Functions============================
     /**
@@ -85,10 +111,15 @@ public:
      */
     void buttonClicked(juce::Button* button) override;
 
+    /**
+     *Implementation of a TextEditorListener function which is called when the text in the Search Box changes.
+     *Searches the library as the user types, so the results are ready before they have finished typing
+     */
+    void textEditorTextChanged(juce::TextEditor& textEditor) override;
+
     /**
      *Implementation of a TextEditorListener function which is called when user presses the Enter key.
-     *Gets the user input from the TextEditor (Search Box) and loops through "tracks" to compare titles/durations to user input
-     *Sets the Track's "isDisplayed" property to true if the track data contains the string the user typed into the search box
+     *Searches the library for the text in the Search Box (if it has not already been searched for as it was typed)
      */
     void textEditorReturnKeyPressed(juce::TextEditor& textEditor) override;
 
@@ -98,6 +129,12 @@ public:
      */
     void mouseUp(const juce::MouseEvent& event) override;
 
+    /** Implementation of a ChangeListener function which is called when the CoverArtCache has decoded more thumbnails */
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+
+    /** Implements juce::Timer's inherited pure virtual function: rewrites the CSV file with the changes made since the last save */
+    void timerCallback() override;
+
     //============================================Drag and Drop functions====================================================
 
     /**
@@ -115,36 +152,127 @@ public:
     //=========================================================================================================================
 
 private:
+    /**
+     *The library's TableListBox. In debug builds it also times every frame the table paints (its background, every visible
+     *row and its outline) and logs the average every 100 frames, so the cost of scrolling can be compared between libraries
+     *of any size: only the visible rows are ever painted, so it should stay the same from a hundred tracks to a million
+     */
+    class LibraryTable : public juce::TableListBox
+    {
+    public:
+        /** Starts timing the frame, then paints the table's background */
+        void paint(juce::Graphics& g) override;
+
+        /** Paints the table's outline once every row has been painted, then stops timing the frame */
+        void paintOverChildren(juce::Graphics& g) override;
+
+    private:
+#if JUCE_DEBUG
+        // Logs the average, minimum and maximum frame times to the debug output
+        juce::PerformanceCounter frameCounter{ "Library table frame", 100 };
+#endif
+    };
+
     //==================================================Private Functions======================================================
 
-    /** Adds a new track which the user selects from the local disk to the private tracks vector and CSV file */
+    /**
+     *Lets the user select audio files and/or folders from the local disk, which are passed to the TrackImporter
+     *to be scanned in the background and added to the private tracks vector and CSV file
+     */
     void addNewTrack();
 
+    /**
+     *Called by the TrackImporter on the message thread with each batch of scanned audio files.
+     *Adds the batch to the tracks vector, appends it to the CSV file and hides the progress bar once the import is finished
+     */
+    void addImportedTracks(std::vector<TrackImporter::ImportResult>& importedFiles);
+
+    /** Passes the files of the given tracks which have not been hashed yet to the TrackHasher */
+    void queueTracksForHashing(std::vector<Track>& tracksToHash);
+
+    /**
+     *Called by the TrackHasher on the message thread with each batch of hashed files.
+     *Stores the content hashes in the tracks, saves them to the CSV file and repaints the table to show any new duplicates
+     */
+    void addContentHashes(std::vector<TrackHasher::HashResult>& hashedFiles);
+
+    /**
+     *Rewrites the CSV file a couple of seconds from now, so that the batches which arrive in the meantime
+     *are saved together with a single rewrite
+     */
+    void saveLibrarySoon();
+
+    /** Counts how many tracks in the library have each content hash, so that paintCell can mark the duplicates */
+    void countDuplicateTracks();
+
+    /** Passes the files of the given tracks which have not been analysed yet to the TrackAnalyser, to be analysed after any visible or loaded tracks */
+    void queueTracksForAnalysis(std::vector<Track>& tracksToAnalyse);
+
+    /** Passes the tracks in the rows the table is showing which have not been analysed yet to the TrackAnalyser, to be analysed ahead of the rest of the library */
+    void queueVisibleTracksForAnalysis();
+
+    /**
+     *Called by the TrackAnalyser on the message thread with each batch of analysed files.
+     *Stores the beat grids, keys and loudness in the tracks (updating a deck which has one of them loaded), saves their waveforms,
+     *saves them to the CSV file and repaints the table to show the analysed BPMs and keys
+     */
+    void addAnalysisResults(std::vector<TrackAnalyser::AnalysisResult>& analysedFiles);
+
+    /** Called by a deck when the user sets or clears a hot cue: stores the hot cues in every track with the file path, and saves them to the CSV file */
+    void storeHotCues(const std::string& filePath, const std::vector<double>& hotCues);
+
+    /**
+     *Writes the analysed BPM and key of every analysed MP3 in the library back into the file's tags,
+     *on the TagWriter's background threads, so other DJ software and players see them too
+     */
+    void writeAnalysedTags();
+
+    /** Called by the TagWriter on the message thread once the tags have been written: tells the user how many files were written and which failed */
+    void tagsWritten(const TagWriter::WriteReport& report);
+
     /**
      *A helper method converting the duration of the track length in seconds to a string in HH::MM::SS format
      * Returns the HH::MM::SS format string
      */
     std::string convertTimeInSecondsToString(double timeInSeconds);
 
-    /*
-     *A method which sets which tracks to display by getting the "isDisplayed" property of every track
-     * and adding the desired tracks which have this property to the tracksToDisplay vector
+    /**
+     *Shows only the tracks whose title, artist or album match the query (allowing for typos), best match first,
+     *or every track if the query is empty
      */
-    void loopOverTracksAndDetermineIfToDisplay(juce::String userInput);
+    void searchLibrary(const juce::String& query);
 
     /*
-     Method which pushes certain tracks to the tracksToDisplay vector by getting the "isDisplayed" property of every track
-     * and pushing only if this value is "true"
+     Method which fills the tracksToDisplay vector: with the ranked matches of the current search if there is one,
+     * otherwise with every track, in the order the user sorted the table in
     */
     void addTracksToDisplayToDisplayedVector();
 
+    /** Sorts the displayed rows by the sort columns the user has chosen (if any), without touching the tracks themselves */
+    void sortDisplayedTracks();
+
+    /** Returns the track shown in the given row of the table */
+    Track& getDisplayedTrack(int rowNumber);
+
+    /**
+     *Returns where the icon of a load/delete column is drawn in a cell of the given size. paintCell draws the icon here,
+     *and cellClicked only acts on clicks inside it, so the icons behave like the buttons they replace
+     */
+    juce::Rectangle<int> getActionIconBounds(int width, int height);
+
+    /** Loads the track in the given row into a deck, or deletes it from the library, depending on which action column was clicked */
+    void performRowAction(int rowNumber, int columnId);
+
     //==================================================Private Data Members====================================================
     // The TableListBox for storing the track lsibrary
-    juce::TableListBox tableComponent;
+    LibraryTable tableComponent;
+
+    // The height of the table's rows in pixels, which is also the size of the cover art column
+    static constexpr int rowHeight = 32;
 
     // Makes a file chooser in order to add files to the playlist
     // Attribution: https://docs.juce.com/master/classFileChooser.html#ac888983e4abdd8401ba7d6124ae64ff3
-    juce::FileChooser fChooser{ "Select an audio file..." };
+    juce::FileChooser fChooser{ "Select audio files or folders..." };
 
     // Creates a format manager for the PlaylistComponent to get the duration of each track in seconds
     juce::AudioFormatManager formatManager;
@@ -152,20 +280,73 @@ private:
     // Stores all of the tracks loaded into the library
     std::vector<Track> tracks;
 
-    // Stores only the tracks that should be displayed after user searches for specific terms.
-    // The default when program is loaded should be to display all the tracks.
-    std::vector<Track> tracksToDisplay;
+    // Stores the positions in "tracks" of only the tracks that should be displayed after user searches for specific terms.
+    // The default when program is loaded should be to display all the tracks. Only the indices are stored, so that
+    // the rows never copy the tracks, however big the library is
+    std::vector<size_t> tracksToDisplay;
 
     // Pointers to the 2 DeckGUI elements into the PlaylistComponent, to enable loading song from lib functionality
     DeckGUI* gui1;
     DeckGUI* gui2;
 
+    // The cover art thumbnails shown in the first column, which are decoded in the background the first time each row is painted
+    CoverArtCache& coverArtCache;
+
+    // The disk cache of waveform thumbnails, which the waveforms built while the tracks are analysed are saved into
+    WaveformCache& waveformCache;
+
     // The full path to the csv file storing the track data
     std::string fullPathToFile;
 
     // A CSV Helper instance which stores, reads from, writes to and generally parses data to / from the CSV tracksData file
     CSVHelper csvHelper;
 
+    // Scans the files and folders the user adds on a background thread pool, and passes them back to addImportedTracks() in batches
+    TrackImporter trackImporter{ formatManager, [this](std::vector<TrackImporter::ImportResult>& importedFiles) { addImportedTracks(importedFiles); } };
+
+    // Sorts the displayed rows using sort keys which are only worked out again when the library changes
+    TrackSorter trackSorter;
+
+    // The columns the table is sorted by, most recently clicked first (the order tracks were added in if it is empty)
+    std::vector<TrackSorter::SortColumn> sortColumns;
+
+    // The most columns which are kept in sortColumns, as ties are rare after the first few
+    static constexpr size_t maxSortColumns = 3;
+
+    // Finds and ranks the tracks which match the search, using folded text which is only worked out again when the library changes
+    TrackSearcher trackSearcher;
+
+    // What the user searched for (an empty string shows every track)
+    juce::String searchQuery;
+
+    // The most tracks shown for a search: a short search can match most of a large library, and only the best matches are useful
+    static constexpr size_t maxSearchResults = 1000;
+
+    // Hashes the audio of each track on a background thread, and passes the hashes back to addContentHashes() in batches
+    TrackHasher trackHasher{ [this](std::vector<TrackHasher::HashResult>& hashedFiles) { addContentHashes(hashedFiles); } };
+
+    // How long saveLibrarySoon() waits before rewriting the CSV file, so a long hashing or analysis run rewrites it
+    // every couple of seconds rather than for every batch
+    static constexpr int saveDelayMilliseconds = 2000;
+
+    // The number of tracks in the library with each content hash: any hash with a count above 1 is a duplicate
+    std::map<std::string, int> numTracksWithContentHash;
+
+    // Works out the BPM, beat grid, key, loudness and waveform of each track on low-priority background threads, and passes them back to addAnalysisResults() in batches
+    TrackAnalyser trackAnalyser{ formatManager, [this](std::vector<TrackAnalyser::AnalysisResult>& analysedFiles) { addAnalysisResults(analysedFiles); } };
+
+    // Shows the progress of the current import (only visible while files are being imported)
+    juce::ProgressBar importProgressBar{ trackImporter.getProgress() };
+
+    // Writes the analysed BPMs and keys into the files' tags on a background thread pool, and passes the report back to tagsWritten()
+    TagWriter tagWriter{ [this](const TagWriter::WriteReport& report) { tagsWritten(report); } };
+
+    // Shows the progress of writing the tags (only visible while they are being written)
+    juce::ProgressBar tagWriteProgressBar{ tagWriter.getProgress() };
+
+    // The most failed files listed after the tags have been written
+    static constexpr int maxFailedFilesListed = 10;
+
     // Custom font stored here for library title
     juce::Font techFont;
 
@@ -178,6 +359,9 @@ private:
     // Stores the button to clear the search criteria
     juce::TextButton clearButton{ "Clear Search" };
 
+    // Stores the button which writes the analysed BPMs and keys into the files' tags
+    juce::TextButton writeTagsButton{ "Write BPM/Key Tags" };
+
     // Loads the "Add" button's png image from "Source" directory
     juce::File addButtonImageFile = juce::File::getCurrentWorkingDirectory().getChildFile("add.png");
     // Converts the image file with the "Add" icon to a juce Image format
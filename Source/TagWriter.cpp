@@ -0,0 +1,274 @@
+/*
+  ==============================================================================
+
+    TagWriter.cpp
+    Created: 19 Oct 2026 2:47:18pm
+    Author:  Ophelia
+    Purpose: writes edited tags (e.g. analysed BPM/key) back into many audio files at once
+             on a background thread pool and reports how the batch went
+
+  ==============================================================================
+*/
+
+#include "TagWriter.h"
+#include "customHeaderForID3Lib.h"
+#include <algorithm>
+#include <map>
+
+namespace
+{
+    // The space left empty at the end of every tag written, so that later edits (like a re-analysed BPM)
+    // fit in the tag and are written over it, instead of moving the whole audio file along
+    const size_t minTagPadding = 4096;
+
+    /** Returns the id3lib frame which stores the given tag */
+    ID3_FrameID getFrameId(TagWriter::TagField field)
+    {
+        switch (field)
+        {
+            case TagWriter::TagField::title:  return ID3FID_TITLE;
+            case TagWriter::TagField::artist: return ID3FID_LEADARTIST;
+            case TagWriter::TagField::album:  return ID3FID_ALBUM;
+            case TagWriter::TagField::genre:  return ID3FID_CONTENTTYPE;
+            case TagWriter::TagField::bpm:    return ID3FID_BPM;
+            case TagWriter::TagField::key:    return ID3FID_INITIALKEY;
+            case TagWriter::TagField::year:   return ID3FID_YEAR;
+        }
+        return ID3FID_NOFRAME;
+    }
+}
+
+//=========================================Thread Pool Jobs===========================================================
+
+/** A ThreadPoolJob which writes the edits of a chunk of files, one file at a time */
+class TagWriter::WriteJob : public juce::ThreadPoolJob
+{
+public:
+    WriteJob(TagWriter& _owner, std::vector<FileEdits> _files, WriteMode _writeMode) : juce::ThreadPoolJob("WriteJob"),
+        owner(_owner),
+        files(_files),
+        writeMode(_writeMode)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        for (const FileEdits& fileEdits : files)
+        {
+            // Files which have not been started are left alone if the writer is being destroyed
+            if (shouldExit())
+            {
+                break;
+            }
+            owner.addResult(fileEdits.file, writeFile(fileEdits));
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    /** Writes all of the file's edits with a single update, returning false if the file could not be written */
+    bool writeFile(const FileEdits& fileEdits)
+    {
+        // Only MP3 files have ID3 tags: id3lib would write a tag onto the front of any other file and break it
+        if (!fileEdits.file.existsAsFile() || !fileEdits.file.hasFileExtension(".mp3"))
+        {
+            return false;
+        }
+
+        // A file with nothing to edit counts as written
+        if (fileEdits.edits.empty())
+        {
+            return true;
+        }
+
+        std::vector<ID3_FrameID> frameIds;
+        std::vector<std::string> texts;
+        for (const TagEdit& edit : fileEdits.edits)
+        {
+            frameIds.push_back(getFrameId(edit.field));
+            // id3lib takes UTF-8 text, and writes any text which isn't plain ASCII as UTF-16
+            texts.push_back(edit.text.toStdString());
+        }
+
+        // The strings are only pointed to once they have all been added, as adding one can move the others
+        std::vector<const char*> textPointers;
+        for (const std::string& text : texts)
+        {
+            textPointers.push_back(text.c_str());
+        }
+
+        // Another job may be writing an earlier batch's edits to the same file
+        const juce::ScopedLock lock(owner.getFileLock(fileEdits.file));
+
+        if (writeMode == WriteMode::inPlace)
+        {
+            return updateTags(fileEdits.file, frameIds, textPointers);
+        }
+
+        // The copy is made in the same folder, so it can be renamed over the original rather than copied back.
+        // If anything fails, the copy is deleted when tempFile goes out of scope and the original is untouched
+        juce::TemporaryFile tempFile(fileEdits.file);
+        return fileEdits.file.copyFileTo(tempFile.getFile())
+            && updateTags(tempFile.getFile(), frameIds, textPointers)
+            && tempFile.overwriteTargetFileWithTemporary();
+    }
+
+    /** Writes the edits into the file's tag with id3lib, returning false if the tag could not be written */
+    static bool updateTags(const juce::File& file, std::vector<ID3_FrameID>& frameIds, std::vector<const char*>& textPointers)
+    {
+        flags_t tagsWritten = ID3_UpdateTextFrames(file.getFullPathName().toRawUTF8(), frameIds.data(),
+            textPointers.data(), frameIds.size(), minTagPadding);
+        return (tagsWritten & ID3TT_ID3V2) != 0;
+    }
+
+    TagWriter& owner;
+    std::vector<FileEdits> files;
+    WriteMode writeMode;
+};
+
+//=========================================TagWriter===========================================================
+
+/** Constructor: takes in a callback which is called on the message thread when each batch of writes has finished */
+TagWriter::TagWriter(std::function<void(const WriteReport&)> _onBatchWritten) : onBatchWritten(_onBatchWritten)
+{
+}
+
+/** Destructor: waits for any writes in progress, so that no file is left half-written */
+TagWriter::~TagWriter()
+{
+    stopTimer();
+    // The jobs only check whether to exit between files, so the file being written by each one is always finished
+    threadPool.removeAllJobs(true, 10000);
+}
+
+/**
+ *Queues the edits for writing on the thread pool. If a batch is already being written, the
+ *new files are added to it and reported together with it
+ */
+void TagWriter::writeTags(const std::vector<FileEdits>& fileEdits, WriteMode writeMode)
+{
+    if (fileEdits.empty())
+    {
+        return;
+    }
+
+    // The throughput is measured from when the first files of the batch were queued
+    if (!isWriting())
+    {
+        batchStartTime = juce::Time::getMillisecondCounterHiRes();
+    }
+
+    // Each file is written once, with all of its edits: two jobs writing the same file at once would corrupt it
+    std::vector<FileEdits> mergedEdits = mergeEditsByFile(fileEdits);
+    numFilesQueued += (int)mergedEdits.size();
+
+    for (size_t start = 0; start < mergedEdits.size(); start += filesPerJob)
+    {
+        size_t end = juce::jmin(start + filesPerJob, mergedEdits.size());
+        std::vector<FileEdits> chunk(mergedEdits.begin() + start, mergedEdits.begin() + end);
+        threadPool.addJob(new WriteJob(*this, chunk, writeMode), true);
+    }
+
+    // Checks for finished files ten times a second
+    startTimer(100);
+}
+
+/** Returns true while there are files still waiting to be written */
+bool TagWriter::isWriting()
+{
+    // The counters are only reset once the timer has reported the batch
+    return numFilesQueued > 0;
+}
+
+/** Returns a reference to the progress value (between 0 and 1) of the current batch, which can be passed into a juce::ProgressBar */
+double& TagWriter::getProgress()
+{
+    return progress;
+}
+
+/**
+ *Combines the edits to the same file into a single FileEdits, in the order the files first appear.
+ *A later edit to the same tag replaces an earlier one
+ */
+std::vector<TagWriter::FileEdits> TagWriter::mergeEditsByFile(const std::vector<FileEdits>& fileEdits)
+{
+    std::vector<FileEdits> mergedEdits;
+    std::map<juce::File, size_t> indexOfFile;
+
+    for (const FileEdits& edits : fileEdits)
+    {
+        auto found = indexOfFile.find(edits.file);
+        if (found == indexOfFile.end())
+        {
+            indexOfFile[edits.file] = mergedEdits.size();
+            mergedEdits.push_back(edits);
+            continue;
+        }
+
+        std::vector<TagEdit>& merged = mergedEdits[found->second].edits;
+        for (const TagEdit& edit : edits.edits)
+        {
+            auto sameField = std::find_if(merged.begin(), merged.end(), [&edit](const TagEdit& other) { return other.field == edit.field; });
+            if (sameField != merged.end())
+            {
+                sameField->text = edit.text;
+            }
+            else
+            {
+                merged.push_back(edit);
+            }
+        }
+    }
+
+    return mergedEdits;
+}
+
+/** Returns the lock which is held while the file is written, shared by every file whose path hashes to the same lock */
+juce::CriticalSection& TagWriter::getFileLock(const juce::File& file)
+{
+    return fileLocks[(size_t)file.hashCode64() % (size_t)numFileLocks];
+}
+
+/** Records whether a file was written, so that the timerCallback can report it */
+void TagWriter::addResult(const juce::File& file, bool written)
+{
+    if (!written)
+    {
+        const juce::ScopedLock lock(resultsLock);
+        failedFiles.add(file);
+    }
+
+    // Counted after the failure has been stored, so the timer never reports a finished batch with failures missing
+    ++numFilesDone;
+}
+
+/**
+ *Implements juce::Timer's inherited pure virtual function: updates the progress and, once every
+ *queued file has been written, reports the batch on the message thread
+ */
+void TagWriter::timerCallback()
+{
+    if (numFilesDone < numFilesQueued)
+    {
+        progress = numFilesQueued > 0 ? (double)numFilesDone / (double)numFilesQueued : 0.0;
+        return;
+    }
+
+    WriteReport report;
+    {
+        const juce::ScopedLock lock(resultsLock);
+        report.failedFiles.swapWith(failedFiles);
+    }
+    report.numWritten = numFilesDone - report.failedFiles.size();
+    report.secondsTaken = (juce::Time::getMillisecondCounterHiRes() - batchStartTime) / 1000.0;
+    report.filesPerSecond = report.secondsTaken > 0.0 ? numFilesDone / report.secondsTaken : 0.0;
+
+    // Resets the counters ready for the next batch
+    numFilesQueued = 0;
+    numFilesDone = 0;
+    progress = 1.0;
+    stopTimer();
+
+    onBatchWritten(report);
+}
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    TagWriter.h
+    Created: 19 Oct 2026 2:47:18pm
+    Author:  Ophelia
+    Purpose: writes edited tags (e.g. analysed BPM/key) back into many audio files at once
+             on a background thread pool and reports how the batch went
+
+  ==============================================================================
+  Each file's edits are written with a single id3lib update, and no two updates to the same file run
+  at once. By default the file is copied next to itself, the copy is updated, and the copy is then
+  renamed over the original, so if a write fails part of the way (e.g. the drive is unplugged) the
+  original file is left whole. Writing in place can be chosen instead for a large batch: edits which
+  fit in the tag's padding are then written over the old tag without copying the audio, which is much
+  faster, but a failed write can leave the tag damaged. Text which isn't plain ASCII is written as UTF-16.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class TagWriter : private juce::Timer
+{
+public:
+    /** The tags which can be written, matching the items stored in a TrackMetadata */
+    enum class TagField
+    {
+        title,
+        artist,
+        album,
+        genre,
+        bpm,
+        key,
+        year
+    };
+
+    /** A new value for one of a file's tags (an empty text removes the tag from the file) */
+    struct TagEdit
+    {
+        TagField field;
+        juce::String text;
+    };
+
+    /** All of the edits to be written to a single audio file */
+    struct FileEdits
+    {
+        juce::File file;
+        std::vector<TagEdit> edits;
+    };
+
+    /** How each file is written */
+    enum class WriteMode
+    {
+        // The file is updated in a copy which replaces it in one step, so a failed write leaves the original file whole
+        replaceFile,
+        // The file is updated where it is, which only rewrites the tag when the edits fit in its padding, but isn't atomic
+        inPlace
+    };
+
+    /** Describes a finished batch of writes, passed to the onBatchWritten callback */
+    struct WriteReport
+    {
+        // The number of files which were written successfully
+        int numWritten = 0;
+        // The files which could not be written (e.g. read-only files, or files which are not MP3s)
+        juce::Array<juce::File> failedFiles;
+        // The time taken from queueing the batch to the last file being written
+        double secondsTaken = 0.0;
+        // The throughput of the batch, counting failed files as well as written ones
+        double filesPerSecond = 0.0;
+    };
+
+    /** Constructor: takes in a callback which is called on the message thread when each batch of writes has finished */
+    TagWriter(std::function<void(const WriteReport&)> _onBatchWritten);
+
+    /** Destructor: waits for any writes in progress, so that no file is left half-written */
+    ~TagWriter() override;
+
+    /**
+     *Queues the edits for writing on the thread pool. If a batch is already being written, the
+     *new files are added to it and reported together with it
+     */
+    void writeTags(const std::vector<FileEdits>& fileEdits, WriteMode writeMode = WriteMode::replaceFile);
+
+    /** Returns true while there are files still waiting to be written */
+    bool isWriting();
+
+    /** Returns a reference to the progress value (between 0 and 1) of the current batch, which can be passed into a juce::ProgressBar */
+    double& getProgress();
+
+private:
+    /** A ThreadPoolJob which writes the edits of a chunk of files, one file at a time */
+    class WriteJob;
+
+    /**
+     *Combines the edits to the same file into a single FileEdits, in the order the files first appear.
+     *A later edit to the same tag replaces an earlier one
+     */
+    static std::vector<FileEdits> mergeEditsByFile(const std::vector<FileEdits>& fileEdits);
+
+    /** Returns the lock which is held while the file is written, shared by every file whose path hashes to the same lock */
+    juce::CriticalSection& getFileLock(const juce::File& file);
+
+    /** Records whether a file was written, so that the timerCallback can report it */
+    void addResult(const juce::File& file, bool written);
+
+    /**
+     *Implements juce::Timer's inherited pure virtual function: updates the progress and, once every
+     *queued file has been written, reports the batch on the message thread
+     */
+    void timerCallback() override;
+
+    // Called on the message thread when a batch of writes has finished
+    std::function<void(const WriteReport&)> onBatchWritten;
+
+    // The worker threads which write the files. Writes are limited by the disk rather than the CPU,
+    // so a few threads are enough to keep it busy without the writes fighting over it
+    juce::ThreadPool threadPool{ juce::jlimit(1, maxThreads, juce::SystemStats::getNumCpus()) };
+
+    // The files which could not be written in the current batch, locked by resultsLock
+    juce::Array<juce::File> failedFiles;
+    juce::CriticalSection resultsLock;
+
+    // Counts the files queued in the current batch and the files the worker threads have finished with
+    std::atomic<int> numFilesQueued{ 0 };
+    std::atomic<int> numFilesDone{ 0 };
+
+    // Stops two batches writing the same file at once (the edits within a batch are merged by file first)
+    static constexpr int numFileLocks = 64;
+    juce::CriticalSection fileLocks[numFileLocks];
+
+    // When the current batch was queued, in milliseconds, for the throughput in the WriteReport
+    double batchStartTime = 0.0;
+
+    // The progress of the current batch between 0 and 1
+    double progress = 0.0;
+
+    // The most threads used for writing, however many CPU cores there are
+    static constexpr int maxThreads = 4;
+
+    // How many files each WriteJob writes, so that the thread pool is not flooded with thousands of tiny jobs
+    static constexpr int filesPerJob = 16;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TagWriter)
+};
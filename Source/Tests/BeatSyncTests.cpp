@@ -0,0 +1,183 @@
+/*
+  ==============================================================================
+
+    BeatSyncTests.cpp
+    Created: 19 Oct 2026 11:52:40pm
+    Author:  Ophelia
+    Purpose: plays two synced decks offline for ten minutes and checks that the follower's beats stay within a few
+             milliseconds of the leader's, at the same tempo and at half and double the tempo
+
+  ==============================================================================
+  Each deck is modelled the way DJAudioPlayer plays it: the track position moves on by the speed ratio times the
+  block length (resampled from the track's sample rate to the device's), and is read back to the nearest sample, as
+  the transport reports it. The leader's beat clock is taken at the end of its block and carried on to the start of
+  the follower's, as DJAudioPlayer::syncToLeader does. Block lengths change from block to block, as they do when a
+  device is busy, and the two decks take turns at being played first.
+*/
+
+#include <JuceHeader.h>
+#include "../BeatSync.h"
+#include <cmath>
+#include <random>
+
+class BeatSyncTests : public juce::UnitTest
+{
+public:
+    BeatSyncTests() : juce::UnitTest("BeatSync", "DJApp")
+    {
+    }
+
+    void runTest() override
+    {
+        // A follower a few BPM off the leader, and followers at (about) half and double its tempo
+        for (double followerBpm : { 124.3, 64.4, 255.1 })
+        {
+            beginTest("A " + juce::String(followerBpm, 1) + " BPM follower stays locked to a 128 BPM leader for ten minutes");
+
+            DriftResult result = playSyncedDecks(followerBpm);
+            logMessage("Largest phase error after locking on: " + juce::String(result.maxPhaseError * 1000.0, 3) + " ms, at the end: "
+                + juce::String(result.finalPhaseError * 1000.0, 3) + " ms, largest change of speed between blocks: "
+                + juce::String(result.maxRatioStep * 100.0, 4) + "%");
+
+            expectLessThan(result.maxPhaseError, maxLockedPhaseError, "the beats drifted apart");
+            expectLessThan(std::abs(result.finalPhaseError), maxLockedPhaseError, "the beats were apart at the end");
+
+            // The correction is a nudge of the speed rather than a jump, so it can't be heard
+            expectLessThan(result.maxRatioStep, 0.001, "the speed jumped between blocks");
+        }
+
+        beginTest("Matching a follower at half or double the tempo plays it at about the leader's tempo");
+        {
+            BeatSync beatSync;
+            expectWithinAbsoluteError(beatSync.getSpeedRatio(0.0, 128.0 / 60.0, 0.0, 64.0 / 60.0, 0.01), 1.0, 1.0e-9);
+            beatSync.reset();
+            expectWithinAbsoluteError(beatSync.getSpeedRatio(0.0, 128.0 / 60.0, 0.0, 256.0 / 60.0, 0.01), 1.0, 1.0e-9);
+            beatSync.reset();
+            expectWithinAbsoluteError(beatSync.getSpeedRatio(0.0, 128.0 / 60.0, 0.0, 120.0 / 60.0, 0.01), 128.0 / 120.0, 1.0e-9);
+        }
+    }
+
+private:
+    /** The phase errors measured while the decks were synced, in seconds */
+    struct DriftResult
+    {
+        double maxPhaseError = 0.0;
+        double finalPhaseError = 0.0;
+        double maxRatioStep = 0.0;
+    };
+
+    /** A deck's track, and how far through it the deck has played */
+    struct Deck
+    {
+        double bpm;
+        double firstBeatSeconds;
+        double trackSampleRate;
+        double position;
+        double speedRatio = 1.0;
+
+        /** Returns the deck's position in beats, counted along its beat grid from where the transport reports it to be */
+        double getBeat() const
+        {
+            return (std::floor(position) / trackSampleRate - firstBeatSeconds) * bpm / 60.0;
+        }
+
+        /** Plays a block of the device's samples at the deck's speed */
+        void play(int numSamples)
+        {
+            position += speedRatio * numSamples * trackSampleRate / deviceSampleRate;
+        }
+    };
+
+    /**
+     *Plays a 128 BPM leader and a follower of the given tempo for ten minutes, starting the follower part of the way
+     *through a beat, and returns the largest phase error once the follower has had time to lock on. Halfway through,
+     *the leader is sped up by 2% (as if its speed slider was moved), and the follower is given time to lock on again
+     */
+    DriftResult playSyncedDecks(double followerBpm)
+    {
+        Deck leader{ 128.0, 0.37, 44100.0, 44100.0 * 10.0 };
+        Deck follower{ followerBpm, 0.12, 48000.0, 48000.0 * 33.3 };
+
+        BeatSync beatSync;
+        std::mt19937 random(1);
+        std::uniform_int_distribution<int> blockLengths(256, 1024);
+
+        DriftResult result;
+        double previousRatio = 0.0;
+        juce::int64 outputSample = 0;
+
+        // The leader's beat clock, from the end of its last block
+        double leaderClockBeat = 0.0;
+        double leaderClockBeatsPerSecond = 0.0;
+        juce::int64 leaderClockSample = 0;
+
+        for (int block = 0; outputSample < (juce::int64)(runSeconds * deviceSampleRate); ++block)
+        {
+            const int numSamples = blockLengths(random);
+            const double seconds = outputSample / deviceSampleRate;
+
+            // The leader's speed slider is moved halfway through
+            if (seconds >= leaderNudgeSeconds)
+            {
+                leader.speedRatio = 1.02;
+            }
+
+            auto playLeader = [&]
+            {
+                leader.play(numSamples);
+                leaderClockBeat = leader.getBeat();
+                leaderClockBeatsPerSecond = leader.bpm / 60.0 * leader.speedRatio;
+                leaderClockSample = outputSample + numSamples;
+            };
+
+            auto playFollower = [&]
+            {
+                if (leaderClockSample > 0)
+                {
+                    double leaderBeat = leaderClockBeat + (outputSample - leaderClockSample) / deviceSampleRate * leaderClockBeatsPerSecond;
+                    follower.speedRatio = beatSync.getSpeedRatio(leaderBeat, leaderClockBeatsPerSecond, follower.getBeat(),
+                        follower.bpm / 60.0, numSamples / deviceSampleRate);
+
+                    bool isLocked = seconds > lockSeconds && !(seconds > leaderNudgeSeconds && seconds < leaderNudgeSeconds + lockSeconds);
+                    if (isLocked)
+                    {
+                        result.maxPhaseError = juce::jmax(result.maxPhaseError, std::abs(beatSync.getPhaseError()));
+                        result.maxRatioStep = juce::jmax(result.maxRatioStep, std::abs(follower.speedRatio - previousRatio) / follower.speedRatio);
+                    }
+                    previousRatio = follower.speedRatio;
+                }
+                follower.play(numSamples);
+            };
+
+            // The leader's clock is sometimes from this callback and sometimes from the one before, depending on which deck is played first
+            if (block % 2 == 0)
+            {
+                playLeader();
+                playFollower();
+            }
+            else
+            {
+                playFollower();
+                playLeader();
+            }
+
+            outputSample += numSamples;
+        }
+
+        result.finalPhaseError = beatSync.getPhaseError();
+        return result;
+    }
+
+    // The device's sample rate, which both decks are resampled to
+    static constexpr double deviceSampleRate = 44100.0;
+
+    // How long the decks are played for, when the leader is sped up, and how long the follower is given to lock on
+    static constexpr double runSeconds = 600.0;
+    static constexpr double leaderNudgeSeconds = 300.0;
+    static constexpr double lockSeconds = 30.0;
+
+    // The largest phase error allowed once the follower has locked on: a few milliseconds can't be heard as flamming
+    static constexpr double maxLockedPhaseError = 0.003;
+};
+
+static BeatSyncTests beatSyncTests;
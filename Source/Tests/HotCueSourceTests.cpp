@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    HotCueSourceTests.cpp
+    Created: 19 Oct 2026 11:58:14pm
+    Author:  Ophelia
+    Purpose: triggers hot cues whose audio has and hasn't been decoded yet, and checks how soon each is heard
+
+  ==============================================================================
+  The track is a WAV file whose samples count up in a ramp, so the position any sample was played from can be read
+  back from its value. It is played the way a deck plays it, through a BufferingAudioSource reading ahead on a
+  TimeSliceThread, with the audio thread's blocks pulled by hand. Between blocks, the test waits for the decoder to
+  have read ahead (as real time would give it the chance to), except straight after a trigger, where the block has to
+  be filled from whatever is ready at that moment.
+*/
+
+#include <JuceHeader.h>
+#include "../HotCueSource.h"
+#include <memory>
+
+class HotCueSourceTests : public juce::UnitTest
+{
+public:
+    HotCueSourceTests() : juce::UnitTest("HotCueSource", "DJApp")
+    {
+    }
+
+    void runTest() override
+    {
+        juce::TemporaryFile trackFile(".wav");
+        if (!writeRampTrack(trackFile.getFile()))
+        {
+            expect(false, "couldn't write the test track");
+            return;
+        }
+
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        beginTest("A hot cue whose audio has been decoded is heard in the very next block, and carries on seamlessly from the decoder");
+        {
+            // The same background thread decodes the hot cues and reads the track ahead, as it does on a deck
+            juce::TimeSliceThread backgroundThread("Hot cue test read-ahead");
+            backgroundThread.startThread();
+            Deck deck(formatManager, trackFile.getFile(), backgroundThread, backgroundThread);
+
+            deck.hotCues.setHotCue(0, decodedCuePosition);
+            for (int i = 0; i < 500 && !deck.hotCues.isHotCueDecoded(0); ++i)
+            {
+                juce::Thread::sleep(10);
+            }
+            expect(deck.hotCues.isHotCueDecoded(0), "the cue's audio was never decoded");
+
+            // Plays from the start of the track for a while before the cue is pressed
+            for (int i = 0; i < 20; ++i)
+            {
+                deck.playBlock(true);
+            }
+
+            deck.hotCues.triggerHotCue(0);
+            expectEquals(deck.playBlock(false), decodedCuePosition, "the block after the trigger didn't start at the cue");
+
+            bool playedFromMemory = false;
+            double latency = deck.hotCues.takeTriggerLatency(playedFromMemory);
+            logMessage("Decoded cue heard " + juce::String(latency, 3) + " ms after it was triggered");
+            expect(playedFromMemory, "the cue wasn't played from memory");
+            expect(latency >= 0.0 && latency < blockMilliseconds, "the cue took longer than a block to be heard");
+
+            // Well past where the cue's two seconds of memory run out and the decoder takes over
+            juce::int64 expectedPosition = decodedCuePosition + blockSize;
+            for (int i = 0; i < (int)(sampleRate * 3.0) / blockSize; ++i)
+            {
+                expectEquals(deck.playBlock(true), expectedPosition, "playback jumped after the cue");
+                expectedPosition += blockSize;
+            }
+            expectEquals(deck.hotCues.getNextReadPosition(), expectedPosition);
+        }
+
+        beginTest("A hot cue whose audio hasn't been decoded yet is heard from the decoder once it has read ahead from the cue");
+        {
+            // The hot cues' thread is never started, so the cue's audio is never decoded
+            juce::TimeSliceThread readAheadThread("Hot cue test read-ahead");
+            juce::TimeSliceThread hotCueThread("Hot cue test decoding");
+            readAheadThread.startThread();
+            Deck deck(formatManager, trackFile.getFile(), readAheadThread, hotCueThread);
+
+            deck.hotCues.setHotCue(1, undecodedCuePosition);
+            expect(!deck.hotCues.isHotCueDecoded(1));
+
+            for (int i = 0; i < 20; ++i)
+            {
+                deck.playBlock(true);
+            }
+
+            // The decoder only has the cue's audio once it has seeked and read ahead, and is silent where it hasn't
+            deck.hotCues.triggerHotCue(1);
+            deck.playBlock(false);
+            expect(isCueOrSilence(deck.block, undecodedCuePosition), "the block after the trigger was neither the cue nor silent");
+
+            expectEquals(deck.playBlock(true), undecodedCuePosition + blockSize, "the decoder didn't carry on from the cue");
+
+            bool playedFromMemory = true;
+            double latency = deck.hotCues.takeTriggerLatency(playedFromMemory);
+            logMessage("Undecoded cue heard " + juce::String(latency, 3) + " ms after it was triggered");
+            expect(!playedFromMemory, "the cue was played from memory");
+            expect(latency >= 0.0, "the cue was never heard");
+        }
+    }
+
+private:
+    /** A deck's stack of sources playing the track, with its hot cues decoded on the given thread */
+    struct Deck
+    {
+        Deck(juce::AudioFormatManager& formatManager, const juce::File& file, juce::TimeSliceThread& readAheadThread,
+            juce::TimeSliceThread& hotCueThread) :
+                readerSource(formatManager.createReaderFor(file), true),
+                decoder(&readerSource, readAheadThread, false, 65536, 2),
+                hotCues(&decoder, formatManager, juce::URL(file), sampleRate, hotCueThread)
+        {
+            hotCues.prepareToPlay(blockSize, sampleRate);
+            block.setSize(2, blockSize);
+        }
+
+        ~Deck()
+        {
+            hotCues.releaseResources();
+        }
+
+        /**
+         *Plays the next block (first waiting for the decoder to have read ahead, if waitForDecoder is true), and returns
+         *the position of the track it was played from, or silence if it was silent
+         */
+        juce::int64 playBlock(bool waitForDecoder)
+        {
+            juce::AudioSourceChannelInfo info(&block, 0, blockSize);
+            if (waitForDecoder)
+            {
+                decoder.waitForNextAudioBlockReady(info, 2000);
+            }
+            hotCues.getNextAudioBlock(info);
+            return getRampPosition(block);
+        }
+
+        juce::AudioFormatReaderSource readerSource;
+        juce::BufferingAudioSource decoder;
+        HotCueSource hotCues;
+        juce::AudioBuffer<float> block;
+    };
+
+    /** Writes a stereo ten second track of 32 bit float samples, whose samples count up from 0 to 1 over the track */
+    static bool writeRampTrack(const juce::File& file)
+    {
+        juce::WavAudioFormat wavFormat;
+        auto stream = std::make_unique<juce::FileOutputStream>(file);
+        if (stream->failedToOpen())
+        {
+            return false;
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(wavFormat.createWriterFor(stream.get(), sampleRate, 2, 32, {}, 0));
+        if (writer == nullptr)
+        {
+            return false;
+        }
+        stream.release();
+
+        juce::AudioBuffer<float> samples(2, trackLength);
+        for (int i = 0; i < trackLength; ++i)
+        {
+            samples.setSample(0, i, (float)i / (float)trackLength);
+            samples.setSample(1, i, (float)i / (float)trackLength);
+        }
+        return writer->writeFromAudioSampleBuffer(samples, 0, trackLength);
+    }
+
+    /**
+     *Returns the position of the track the block was played from, read back from the ramp in its left channel, silence
+     *if the block is silent, or -1 if the ramp in the block jumps
+     */
+    static juce::int64 getRampPosition(const juce::AudioBuffer<float>& block)
+    {
+        if (block.getMagnitude(0, block.getNumSamples()) == 0.0f)
+        {
+            return silence;
+        }
+
+        // A float holds every position of the track exactly enough to be rounded back to it
+        juce::int64 position = juce::roundToInt(block.getSample(0, 0) * trackLength);
+        for (int i = 1; i < block.getNumSamples(); ++i)
+        {
+            if (juce::roundToInt(block.getSample(0, i) * trackLength) != position + i)
+            {
+                return -1;
+            }
+        }
+        return position;
+    }
+
+    /** Returns true if each of the block's samples is either silent or the ramp's sample from the given position on */
+    static bool isCueOrSilence(const juce::AudioBuffer<float>& block, juce::int64 position)
+    {
+        for (int i = 0; i < block.getNumSamples(); ++i)
+        {
+            float sample = block.getSample(0, i);
+            if (sample != 0.0f && juce::roundToInt(sample * trackLength) != position + i)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The track's sample rate, and the length of the audio blocks pulled from the deck
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int blockSize = 512;
+    static constexpr double blockMilliseconds = 1000.0 * blockSize / sampleRate;
+
+    // The length of the track in samples
+    static constexpr int trackLength = 441000;
+
+    // The position playBlock() returns for a silent block
+    static constexpr juce::int64 silence = -2;
+
+    // The cues, five and seven seconds into the track
+    static constexpr juce::int64 decodedCuePosition = 220500;
+    static constexpr juce::int64 undecodedCuePosition = 308700;
+};
+
+static HotCueSourceTests hotCueSourceTests;
@@ -0,0 +1,219 @@
+/*
+  ==============================================================================
+
+    TrackSearcherTests.cpp
+    Created: 20 Oct 2026 12:21:37am
+    Author:  Ophelia
+    Purpose: checks that searches allow for typos and rank the best matches first, and times searches of a library
+             of 500,000 tracks against the budget of one frame
+
+  ==============================================================================
+  The benchmark's library is made up from a vocabulary of 100,000 made-up words, picked as often as words are in
+  real titles (a few words are in a great many tracks, and most words are in only a few),
+  with 25,000 artists and 50,000 albums shared between the tracks. It is searched for the words of one of its
+  tracks, typed a letter at a time as the search box searches after every key press, with and without typos.
+*/
+
+#include <JuceHeader.h>
+#include "../TrackSearcher.h"
+#include <algorithm>
+
+class TrackSearcherTests : public juce::UnitTest
+{
+public:
+    TrackSearcherTests() : juce::UnitTest("TrackSearcher", "DJApp")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Searches allow for typos and rank the best matches first");
+        {
+            std::vector<Track> tracks;
+            tracks.push_back(makeTrack("One More Time", "Daft Punk", "Discovery"));
+            tracks.push_back(makeTrack("Around the World", "Daft Punk", "Homework"));
+            tracks.push_back(makeTrack("Discovery Channel", "Someone", "One More Album"));
+            tracks.push_back(makeTrack("Crazy in Love", juce::CharPointer_UTF8("Beyonc\xc3\xa9"), "Dangerously in Love"));
+
+            TrackSearcher searcher;
+
+            // A match in the title is ranked above the same match in the album
+            expect(searcher.search(tracks, "one mroe", maxResults) == std::vector<size_t>{ 0, 2 });
+            expect(searcher.search(tracks, "discovery", maxResults) == std::vector<size_t>{ 2, 0 });
+
+            // Equal matches keep the order of the library
+            expect(searcher.search(tracks, "daft pnuk", maxResults) == std::vector<size_t>{ 0, 1 });
+
+            expect(searcher.search(tracks, "beyonce", maxResults) == std::vector<size_t>{ 3 });
+            expect(searcher.search(tracks, "LOVE", 1) == std::vector<size_t>{ 3 });
+            expect(searcher.search(tracks, "xyz", maxResults).empty());
+            expect(searcher.search(tracks, "  ", maxResults).empty());
+        }
+
+        beginTest("Benchmark: searching 500,000 tracks takes less than a frame");
+        {
+            std::vector<Track> tracks = makeLibrary();
+            TrackSearcher searcher;
+
+            // The first search after the library changes folds the text of every track, which the searches after it reuse
+            double startTime = juce::Time::getMillisecondCounterHiRes();
+            searcher.search(tracks, "warm up", maxResults);
+            logMessage("Indexed " + juce::String((int)tracks.size()) + " tracks in "
+                + juce::String(juce::Time::getMillisecondCounterHiRes() - startTime, 1) + " ms");
+
+            double slowestSearch = 0.0;
+            for (const juce::String& query : getBenchmarkQueries(tracks))
+            {
+                // The median of a few runs, so that the test being held up once by another thread doesn't count
+                std::vector<double> times;
+                size_t numResults = 0;
+                for (int run = 0; run < numRuns; ++run)
+                {
+                    startTime = juce::Time::getMillisecondCounterHiRes();
+                    numResults = searcher.search(tracks, query, maxResults).size();
+                    times.push_back(juce::Time::getMillisecondCounterHiRes() - startTime);
+                }
+                std::sort(times.begin(), times.end());
+                double medianTime = times[times.size() / 2];
+
+                logMessage("\"" + query + "\": " + juce::String((int)numResults) + " results in " + juce::String(medianTime, 2) + " ms");
+                slowestSearch = juce::jmax(slowestSearch, medianTime);
+            }
+            logMessage("Slowest search: " + juce::String(slowestSearch, 2) + " ms");
+
+           #if ! JUCE_DEBUG
+            // Debug builds are too slow to be held to the budget, and so is a single core: the budget counts on the
+            // worker threads sharing the library between them, as they do on the machines the app is played on
+            if (juce::SystemStats::getNumCpus() >= minBenchmarkCpus)
+            {
+                expectLessThan(slowestSearch, frameMilliseconds, "a search took longer than a frame");
+            }
+           #endif
+        }
+    }
+
+private:
+    /** Returns a track with the given title, artist and album */
+    static Track makeTrack(const juce::String& title, const juce::String& artist, const juce::String& album)
+    {
+        return Track(0, juce::URL(), title.toStdString(), "mp3", "00:03:30", "", artist.toStdString(), album.toStdString());
+    }
+
+    /** Returns a library of numBenchmarkTracks made-up tracks (see the top of the file) */
+    static std::vector<Track> makeLibrary()
+    {
+        juce::Random random(1);
+        static const char* const syllables[] = { "ka", "lo", "mi", "ne", "ra", "so", "tu", "vi", "da", "fe", "gi", "ho", "ju",
+            "be", "ch", "st", "ar", "en", "on", "ly", "ma", "ri", "ta", "el", "an", "ce", "de", "ol", "us", "ix", "a", "e", "o",
+            "i", "th", "wa", "pe" };
+        const int numSyllables = (int)(sizeof(syllables) / sizeof(syllables[0]));
+
+        std::vector<juce::String> words;
+        for (int i = 0; i < numVocabularyWords; ++i)
+        {
+            juce::String word;
+            for (int s = 1 + random.nextInt(4); s > 0; --s)
+            {
+                word += syllables[random.nextInt(numSyllables)];
+            }
+            words.push_back(word);
+        }
+
+        // The nth most common word is used 1/n times as often as the most common word (Zipf's law)
+        std::vector<double> wordFrequencies;
+        double totalFrequency = 0.0;
+        for (int i = 0; i < numVocabularyWords; ++i)
+        {
+            totalFrequency += 1.0 / (i + 1);
+            wordFrequencies.push_back(totalFrequency);
+        }
+
+        auto makePhrase = [&](int minWords, int maxWords)
+            {
+                juce::StringArray phraseWords;
+                for (int w = minWords + random.nextInt(maxWords - minWords + 1); w > 0; --w)
+                {
+                    double frequency = random.nextDouble() * totalFrequency;
+                    size_t index = (size_t)(std::lower_bound(wordFrequencies.begin(), wordFrequencies.end(), frequency) - wordFrequencies.begin());
+                    const juce::String& word = words[juce::jmin(index, words.size() - 1)];
+                    phraseWords.add(word.substring(0, 1).toUpperCase() + word.substring(1));
+                }
+                return phraseWords.joinIntoString(" ");
+            };
+
+        std::vector<juce::String> artists;
+        for (int i = 0; i < numArtists; ++i)
+        {
+            artists.push_back(makePhrase(1, 3));
+        }
+        std::vector<juce::String> albums;
+        for (int i = 0; i < numAlbums; ++i)
+        {
+            albums.push_back(makePhrase(1, 4));
+        }
+
+        std::vector<Track> tracks;
+        tracks.reserve(numBenchmarkTracks);
+        for (int i = 0; i < numBenchmarkTracks; ++i)
+        {
+            juce::String title = makePhrase(1, 5);
+            if (random.nextInt(6) == 0)
+            {
+                title += " (Remix)";
+            }
+            tracks.push_back(makeTrack(title, artists[(size_t)random.nextInt(numArtists)], albums[(size_t)random.nextInt(numAlbums)]));
+        }
+        return tracks;
+    }
+
+    /**
+     *Returns the searches made while typing the first word of a track's title a letter at a time, then its artist's
+     *first word as well, then the whole title with two letters of its first word swapped, and a word which isn't there.
+     *The track is the first one from benchmarkTrack on whose title starts with a word long enough to have a typo in it
+     */
+    static juce::StringArray getBenchmarkQueries(std::vector<Track>& tracks)
+    {
+        juce::StringArray titleWords;
+        juce::StringArray artistWords;
+        for (size_t t = benchmarkTrack; t < tracks.size() && titleWords[0].length() < 5; ++t)
+        {
+            titleWords = juce::StringArray::fromTokens(juce::String(tracks[t].getTitle()), false);
+            artistWords = juce::StringArray::fromTokens(juce::String(tracks[t].getArtist()), false);
+        }
+
+        juce::StringArray queries;
+        for (int length = 1; length <= titleWords[0].length(); ++length)
+        {
+            queries.add(titleWords[0].substring(0, length));
+        }
+        queries.add(titleWords[0] + " " + artistWords[0]);
+
+        juce::String word = titleWords[0];
+        titleWords.set(0, word.substring(0, 1) + word.substring(2, 3) + word.substring(1, 2) + word.substring(3));
+        queries.add(titleWords.joinIntoString(" "));
+
+        queries.add("xyzzy");
+        return queries;
+    }
+
+    // The number of results the library table shows, and the number of times each search is timed
+    static constexpr size_t maxResults = 1000;
+    static constexpr int numRuns = 5;
+
+    // The size of the benchmark's library, its vocabulary, and the numbers of artists and albums its tracks share
+    static constexpr int numBenchmarkTracks = 500000;
+    static constexpr int numVocabularyWords = 100000;
+    static constexpr int numArtists = 25000;
+    static constexpr int numAlbums = 50000;
+
+    // Where to start looking for a track whose title and artist are searched for
+    static constexpr size_t benchmarkTrack = 12345;
+
+    // The fewest CPU cores the search is held to the budget on
+    static constexpr int minBenchmarkCpus = 4;
+
+    // One frame of a 60 Hz display, which the search box searches within so typing never stutters
+    static constexpr double frameMilliseconds = 1000.0 / 60.0;
+};
+
+static TrackSearcherTests trackSearcherTests;
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    TrackSorterTests.cpp
+    Created: 20 Oct 2026 1:07:52am
+    Author:  Ophelia
+    Purpose: checks the order the library is sorted in, and times sorts of a library of 500,000 tracks against
+             the budget of 100 ms
+
+  ==============================================================================
+  The benchmark's library has titles made up of a few words and sometimes a number, 25,000 artists shared between
+  the tracks, and BPM and key tags written the ways they are in real tags, with some tracks missing each of them.
+  Each column's ranks are worked out by the first sort by that column, which is timed on its own: the budget is
+  for the sorts after it, which are the ones made every time a column header is clicked.
+*/
+
+#include <JuceHeader.h>
+#include "../TrackSorter.h"
+#include <algorithm>
+#include <numeric>
+
+class TrackSorterTests : public juce::UnitTest
+{
+public:
+    TrackSorterTests() : juce::UnitTest("TrackSorter", "DJApp")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest("Sorts ignore case, put numbers in order, keep equal tracks in the order they were added and put empty values last");
+        {
+            std::vector<Track> tracks;
+            tracks.push_back(makeTrack("Track 10", "Bicep", "00:05:10", "122"));
+            tracks.push_back(makeTrack("track 2", "", "00:04:00", ""));
+            tracks.push_back(makeTrack("Alpha", "bicep", "00:06:30", "128.5"));
+            tracks.push_back(makeTrack("", "Aphex Twin", "", "122"));
+
+            TrackSorter sorter;
+            expect(sortIndices(sorter, tracks, { { TrackSorter::title, true } }) == std::vector<size_t>{ 2, 1, 0, 3 });
+            expect(sortIndices(sorter, tracks, { { TrackSorter::title, false } }) == std::vector<size_t>{ 0, 1, 2, 3 });
+            expect(sortIndices(sorter, tracks, { { TrackSorter::bpm, false } }) == std::vector<size_t>{ 2, 0, 3, 1 });
+            expect(sortIndices(sorter, tracks, { { TrackSorter::duration, true } }) == std::vector<size_t>{ 1, 0, 2, 3 });
+
+            // "Bicep" and "bicep" are the same artist, so the next column decides their order
+            expect(sortIndices(sorter, tracks, { { TrackSorter::artist, true }, { TrackSorter::duration, false } })
+                == std::vector<size_t>{ 3, 2, 0, 1 });
+            expect(sortIndices(sorter, tracks, { { TrackSorter::artist, true } }) == std::vector<size_t>{ 3, 0, 2, 1 });
+        }
+
+        beginTest("Benchmark: sorting 500,000 tracks takes well under 100 ms");
+        {
+            std::vector<Track> tracks = makeLibrary();
+            TrackSorter sorter;
+
+            // The first sort by each column works out its ranks, which every sort after it reuses
+            for (TrackSorter::SortKey sortKey : { TrackSorter::title, TrackSorter::artist, TrackSorter::duration, TrackSorter::bpm,
+                TrackSorter::key, TrackSorter::dateAdded })
+            {
+                double startTime = juce::Time::getMillisecondCounterHiRes();
+                sortIndices(sorter, tracks, { { sortKey, true } });
+                logMessage("Ranked " + juce::String(getColumnName(sortKey)) + " in "
+                    + juce::String(juce::Time::getMillisecondCounterHiRes() - startTime, 1) + " ms");
+            }
+
+            const std::vector<std::vector<TrackSorter::SortColumn>> benchmarkSorts = {
+                { { TrackSorter::title, true } },
+                { { TrackSorter::title, false } },
+                { { TrackSorter::artist, true } },
+                { { TrackSorter::bpm, true } },
+                { { TrackSorter::key, false } },
+                { { TrackSorter::dateAdded, false } },
+                // The last three columns clicked, as the table sorts by
+                { { TrackSorter::bpm, false }, { TrackSorter::key, true }, { TrackSorter::artist, true } }
+            };
+
+            double slowestSort = 0.0;
+            for (const std::vector<TrackSorter::SortColumn>& sortColumns : benchmarkSorts)
+            {
+                // The median of a few runs, each from the order the tracks were added in, so that the test being held
+                // up once by another thread doesn't count
+                std::vector<double> times;
+                for (int run = 0; run < numRuns; ++run)
+                {
+                    std::vector<size_t> indices(tracks.size());
+                    std::iota(indices.begin(), indices.end(), (size_t)0);
+
+                    double startTime = juce::Time::getMillisecondCounterHiRes();
+                    sorter.sort(tracks, indices, sortColumns);
+                    times.push_back(juce::Time::getMillisecondCounterHiRes() - startTime);
+                }
+                std::sort(times.begin(), times.end());
+                double medianTime = times[times.size() / 2];
+
+                juce::StringArray columnNames;
+                for (const TrackSorter::SortColumn& column : sortColumns)
+                {
+                    columnNames.add(juce::String(getColumnName(column.sortKey)) + (column.isForwards ? " up" : " down"));
+                }
+                logMessage("Sorted by " + columnNames.joinIntoString(", ") + " in " + juce::String(medianTime, 2) + " ms");
+                slowestSort = juce::jmax(slowestSort, medianTime);
+            }
+            logMessage("Slowest sort: " + juce::String(slowestSort, 2) + " ms");
+
+           #if ! JUCE_DEBUG
+            // Debug builds are too slow to be held to the budget
+            expectLessThan(slowestSort, sortBudgetMilliseconds, "a sort took longer than the budget");
+           #endif
+        }
+    }
+
+private:
+    /** Returns a track with the given title, artist, duration and BPM tag */
+    static Track makeTrack(const juce::String& title, const juce::String& artist, const juce::String& duration,
+        const juce::String& bpm, const juce::String& key = {})
+    {
+        return Track(0, juce::URL(), title.toStdString(), "mp3", duration.toStdString(), "", artist.toStdString(), "", "",
+            bpm.toStdString(), key.toStdString());
+    }
+
+    /** Returns the tracks' indices, in the order the tracks were added, sorted by the columns */
+    static std::vector<size_t> sortIndices(TrackSorter& sorter, std::vector<Track>& tracks,
+        const std::vector<TrackSorter::SortColumn>& sortColumns)
+    {
+        std::vector<size_t> indices(tracks.size());
+        std::iota(indices.begin(), indices.end(), (size_t)0);
+        sorter.sort(tracks, indices, sortColumns);
+        return indices;
+    }
+
+    /** Returns the name of the column the sort key is shown in, for the benchmark's log */
+    static const char* getColumnName(TrackSorter::SortKey sortKey)
+    {
+        static const char* const names[] = { "title", "artist", "duration", "BPM", "key", "date added" };
+        return names[sortKey];
+    }
+
+    /** Returns a library of numBenchmarkTracks made-up tracks (see the top of the file) */
+    static std::vector<Track> makeLibrary()
+    {
+        juce::Random random(1);
+        static const char* const syllables[] = { "ka", "lo", "mi", "ne", "ra", "so", "tu", "vi", "da", "fe", "gi", "ho", "ju",
+            "be", "ch", "st", "ar", "en", "on", "ly", "ma", "ri", "ta", "el", "an", "ce", "de", "ol", "us", "ix", "a", "e", "o",
+            "i", "th", "wa", "pe" };
+        const int numSyllables = (int)(sizeof(syllables) / sizeof(syllables[0]));
+
+        auto makePhrase = [&](int minWords, int maxWords)
+            {
+                juce::StringArray words;
+                for (int w = minWords + random.nextInt(maxWords - minWords + 1); w > 0; --w)
+                {
+                    juce::String word;
+                    for (int s = 1 + random.nextInt(4); s > 0; --s)
+                    {
+                        word += syllables[random.nextInt(numSyllables)];
+                    }
+                    words.add(word.substring(0, 1).toUpperCase() + word.substring(1));
+                }
+                return words.joinIntoString(" ");
+            };
+
+        std::vector<juce::String> artists;
+        for (int i = 0; i < numArtists; ++i)
+        {
+            artists.push_back(makePhrase(1, 3));
+        }
+
+        // Keys are tagged as Camelot codes by some programs and as key names by others
+        static const char* const keys[] = { "8A", "8B", "1A", "12B", "5A", "Am", "C", "F#m", "Bb", "Ebmin", "G major", "" };
+        const int numKeys = (int)(sizeof(keys) / sizeof(keys[0]));
+
+        std::vector<Track> tracks;
+        tracks.reserve(numBenchmarkTracks);
+        for (int i = 0; i < numBenchmarkTracks; ++i)
+        {
+            juce::String title = makePhrase(1, 4);
+            if (random.nextInt(4) == 0)
+            {
+                title += " " + juce::String(1 + random.nextInt(20));
+            }
+
+            juce::String duration = "00:0" + juce::String(2 + random.nextInt(8)) + ":" + juce::String(10 + random.nextInt(50));
+            juce::String bpm = random.nextInt(10) == 0 ? juce::String() : juce::String(70.0 + random.nextInt(1100) / 10.0, 1);
+            tracks.push_back(makeTrack(title, artists[(size_t)random.nextInt(numArtists)], duration, bpm, keys[random.nextInt(numKeys)]));
+        }
+        return tracks;
+    }
+
+    // The number of times each sort is timed
+    static constexpr int numRuns = 5;
+
+    // The size of the benchmark's library, and the number of artists its tracks share
+    static constexpr int numBenchmarkTracks = 500000;
+    static constexpr int numArtists = 25000;
+
+    // The longest a sort may take, which a click on a column header can wait for without the table feeling slow
+    static constexpr double sortBudgetMilliseconds = 100.0;
+};
+
+static TrackSorterTests trackSorterTests;
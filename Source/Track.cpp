@@ -19,13 +19,43 @@ Track::Track(
     std::string _extensionName,
     std::string _duration,
     std::string _filePath,
-    bool _isDisplayed) : rowNumber(_rowNumber),
+    std::string _artist,
+    std::string _album,
+    std::string _genre,
+    std::string _bpm,
+    std::string _key,
+    std::string _year,
+    juce::int64 _coverArtOffset,
+    juce::int64 _coverArtSize,
+    std::string _contentHash,
+    double _analysedBpm,
+    double _firstBeatSeconds,
+    std::string _analysedKey,
+    double _integratedLoudness,
+    double _loudnessRange,
+    double _truePeak,
+    std::vector<double> _hotCues) : rowNumber(_rowNumber),
     url(_url),
     title(_title),
     extensionName(_extensionName),
     duration(_duration),
     filePath(_filePath),
-    isDisplayed(_isDisplayed)
+    artist(_artist),
+    album(_album),
+    genre(_genre),
+    bpm(_bpm),
+    key(_key),
+    year(_year),
+    coverArtOffset(_coverArtOffset),
+    coverArtSize(_coverArtSize),
+    contentHash(_contentHash),
+    analysedBpm(_analysedBpm),
+    firstBeatSeconds(_firstBeatSeconds),
+    analysedKey(_analysedKey),
+    integratedLoudness(_integratedLoudness),
+    loudnessRange(_loudnessRange),
+    truePeak(_truePeak),
+    hotCues(_hotCues)
 {
 }
 
@@ -65,48 +95,123 @@ std::string Track::getFilePath()
 {
     return filePath;
 }
-/** Returns Boolean whihc stores whether the track should be displayed based on the user's searchbox input string */
-bool Track::getIsDisplayed()
+/** Returns track's artist from its tags */
+std::string Track::getArtist()
 {
-    return isDisplayed;
+    return artist;
+}
+/** Returns track's album from its tags */
+std::string Track::getAlbum()
+{
+    return album;
+}
+/** Returns track's genre from its tags */
+std::string Track::getGenre()
+{
+    return genre;
+}
+/** Returns track's BPM (beats per minute) from its tags */
+std::string Track::getBpm()
+{
+    return bpm;
+}
+/** Returns track's musical key from its tags */
+std::string Track::getKey()
+{
+    return key;
+}
+/** Returns track's release year from its tags */
+std::string Track::getYear()
+{
+    return year;
+}
+/** Returns the position of the track's cover art image in the audio file */
+juce::int64 Track::getCoverArtOffset()
+{
+    return coverArtOffset;
+}
+/** Returns the size of the track's cover art image in bytes (0 if the track has no cover art) */
+juce::int64 Track::getCoverArtSize()
+{
+    return coverArtSize;
+}
+/** Returns the content hash of the track's audio (an empty string if it has not been hashed yet) */
+std::string Track::getContentHash()
+{
+    return contentHash;
+}
+/** Returns the track's tempo worked out from its audio: 0 if it has not been analysed yet, or -1 if no steady beat was found */
+double Track::getAnalysedBpm()
+{
+    return analysedBpm;
+}
+/** Returns the time of the track's first beat in seconds, worked out with its analysed BPM */
+double Track::getFirstBeatSeconds()
+{
+    return firstBeatSeconds;
+}
+/** Returns the track's key worked out from its audio as a Camelot code, e.g. "8A" (empty if it has not been analysed yet, or "-" if no key was found) */
+std::string Track::getAnalysedKey()
+{
+    return analysedKey;
+}
+/** Returns the track's integrated loudness in LUFS (EBU R128), or 0 if it has not been analysed yet */
+double Track::getIntegratedLoudness()
+{
+    return integratedLoudness;
+}
+/** Returns how much the track's loudness varies, in LU */
+double Track::getLoudnessRange()
+{
+    return loudnessRange;
+}
+/** Returns the track's true peak (the highest level between its samples) in dBTP */
+double Track::getTruePeak()
+{
+    return truePeak;
+}
+/** Returns the positions of the track's hot cues in seconds, with -1 for a cue which is not set */
+std::vector<double> Track::getHotCues()
+{
+    return hotCues;
+}
+/** Returns true once the TrackAnalyser has worked out the track's beat grid, key and loudness (even if it found no steady beat or key) */
+bool Track::isAnalysed()
+{
+    return analysedBpm != 0.0 && !analysedKey.empty() && integratedLoudness != 0.0;
 }
 
 //========================================================================================================================
 
-/**
- *Determines whether the track info should be displayed (after user searches for specific terms in the search box)
- *and sets the "isDisplayed" function to false if the track does not meet the search input criteria and
- *true if it does. This takes in the search input as a parameter to check if the track meets the search criteria
- *by seeing if the track data includes this substring, and then it calls the isDisplayed setter function.
- */
-void Track::determineIfShouldDisplay(const juce::String& searchInput)
-{
-    // Makes determination of whether track-info contains the entered string case-insensitive
-    juce::String lowerCaseSearchInput = searchInput.toLowerCase();
+/** Setter function for the content hash, called once the TrackHasher has hashed the track's audio */
+void Track::setContentHash(const std::string& _contentHash)
+{
+    contentHash = _contentHash;
+}
+
+/** Setter function for the beat grid, called once the TrackAnalyser has analysed the track's audio */
+void Track::setBeatGrid(double _analysedBpm, double _firstBeatSeconds)
+{
+    analysedBpm = _analysedBpm;
+    firstBeatSeconds = _firstBeatSeconds;
+}
 
-    // Changes the input string to a stringRef JUCE data type because the .contains() method takes a StringRef argument
-    juce::StringRef stringRefSearchInput = juce::StringRef(lowerCaseSearchInput);
+/** Setter function for the analysed key, called once the TrackAnalyser has analysed the track's audio */
+void Track::setAnalysedKey(const std::string& _analysedKey)
+{
+    analysedKey = _analysedKey;
+}
 
-    // Logic to check whether the track's title/duration match the user's search input
-    if (juce::String(title).toLowerCase().contains(stringRefSearchInput) || juce::String(duration).toLowerCase().contains(stringRefSearchInput))
-    {
-        // If the track data contains the entered substring, set isDisplayed bool to "true"
-        setIsDisplayed(true);
-    }
-    // Search box is empty --> display all the tracks
-    else if (searchInput.isEmpty())
-    {
-        setIsDisplayed(true);
-    }
-    else
-    {
-        // If the track data does not contain the entered substring, set isDisplayed bool to "false"
-        setIsDisplayed(false);
-    }
+/** Setter function for the loudness, called once the TrackAnalyser has analysed the track's audio */
+void Track::setLoudness(double _integratedLoudness, double _loudnessRange, double _truePeak)
+{
+    integratedLoudness = _integratedLoudness;
+    loudnessRange = _loudnessRange;
+    truePeak = _truePeak;
 }
 
-/* Setter function for the isDisplayed property */
-void Track::setIsDisplayed(bool shouldTrackBeDisplayed)
+/** Setter function for the hot cues, called when the user sets or clears one on a deck */
+void Track::setHotCues(const std::vector<double>& _hotCues)
 {
-    isDisplayed = shouldTrackBeDisplayed;
+    hotCues = _hotCues;
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <vector>
 
 class Track
 {
@@ -24,8 +25,29 @@ public:
         std::string _extensionName,
         std::string _duration,
         std::string _filePath,
-        // Default: all tracks are displayed before user searches for a specific term
-        bool _isDisplayed = true);
+        // Tag metadata read by the MetadataReader when the track is imported (empty if the file has no tags)
+        std::string _artist = "",
+        std::string _album = "",
+        std::string _genre = "",
+        std::string _bpm = "",
+        std::string _key = "",
+        std::string _year = "",
+        // Where the cover art image is stored inside the audio file (both 0 if it has none)
+        juce::int64 _coverArtOffset = 0,
+        juce::int64 _coverArtSize = 0,
+        // The content hash of the track's audio, worked out by the TrackHasher (empty until it has been hashed)
+        std::string _contentHash = "",
+        // The tempo and first beat worked out by the TrackAnalyser (a BPM of 0 until the track has been analysed)
+        double _analysedBpm = 0.0,
+        double _firstBeatSeconds = 0.0,
+        // The key worked out by the TrackAnalyser as a Camelot code (empty until the track has been analysed)
+        std::string _analysedKey = "",
+        // The loudness worked out by the TrackAnalyser (an integrated loudness of 0 until the track has been analysed)
+        double _integratedLoudness = 0.0,
+        double _loudnessRange = 0.0,
+        double _truePeak = 0.0,
+        // The positions of the track's hot cues in seconds (-1 for a cue which is not set)
+        std::vector<double> _hotCues = {});
     ~Track();
 
     //========================================Getters for the Private Data Members==============================================
@@ -42,21 +64,57 @@ public:
     std::string getDuration();
     /** Returns track's absolute file path */
     std::string getFilePath();
-    /** Returns Boolean whihc stores whether the track should be displayed based on the user's searchbox input string */
-    bool getIsDisplayed();
+    /** Returns track's artist from its tags */
+    std::string getArtist();
+    /** Returns track's album from its tags */
+    std::string getAlbum();
+    /** Returns track's genre from its tags */
+    std::string getGenre();
+    /** Returns track's BPM (beats per minute) from its tags */
+    std::string getBpm();
+    /** Returns track's musical key from its tags */
+    std::string getKey();
+    /** Returns track's release year from its tags */
+    std::string getYear();
+    /** Returns the position of the track's cover art image in the audio file */
+    juce::int64 getCoverArtOffset();
+    /** Returns the size of the track's cover art image in bytes (0 if the track has no cover art) */
+    juce::int64 getCoverArtSize();
+    /** Returns the content hash of the track's audio (an empty string if it has not been hashed yet) */
+    std::string getContentHash();
+    /** Returns the track's tempo worked out from its audio: 0 if it has not been analysed yet, or -1 if no steady beat was found */
+    double getAnalysedBpm();
+    /** Returns the time of the track's first beat in seconds, worked out with its analysed BPM */
+    double getFirstBeatSeconds();
+    /** Returns the track's key worked out from its audio as a Camelot code, e.g. "8A" (empty if it has not been analysed yet, or "-" if no key was found) */
+    std::string getAnalysedKey();
+    /** Returns the track's integrated loudness in LUFS (EBU R128), or 0 if it has not been analysed yet */
+    double getIntegratedLoudness();
+    /** Returns how much the track's loudness varies, in LU */
+    double getLoudnessRange();
+    /** Returns the track's true peak (the highest level between its samples) in dBTP */
+    double getTruePeak();
+    /** Returns the positions of the track's hot cues in seconds, with -1 for a cue which is not set */
+    std::vector<double> getHotCues();
+    /** Returns true once the TrackAnalyser has worked out the track's beat grid, key and loudness (even if it found no steady beat or key) */
+    bool isAnalysed();
 
     //========================================================================================================================
 
-    /**
-     *Determines whether the track info should be displayed (after user searches for specific terms in the search box)
-     *and sets the "isDisplayed" function to false if the track does not meet the search input criteria and
-     *true if it does. This takes in the search input as a parameter to check if the track meets the search criteria
-     *by seeing if the track data includes this substring, and then it calls the isDisplayed setter function.
-     */
-    void determineIfShouldDisplay(const juce::String& searchInput);
+    /** Setter function for the content hash, called once the TrackHasher has hashed the track's audio */
+    void setContentHash(const std::string& _contentHash);
+
+    /** Setter function for the beat grid, called once the TrackAnalyser has analysed the track's audio */
+    void setBeatGrid(double _analysedBpm, double _firstBeatSeconds);
+
+    /** Setter function for the analysed key, called once the TrackAnalyser has analysed the track's audio */
+    void setAnalysedKey(const std::string& _analysedKey);
+
+    /** Setter function for the loudness, called once the TrackAnalyser has analysed the track's audio */
+    void setLoudness(double _integratedLoudness, double _loudnessRange, double _truePeak);
 
-    /* Setter function for the isDisplayed property */
-    void setIsDisplayed(bool shouldTrackBeDisplayed);
+    /** Setter function for the hot cues, called when the user sets or clears one on a deck */
+    void setHotCues(const std::vector<double>& _hotCues);
 
 private:
     /**
@@ -75,6 +133,42 @@ private:
     std::string duration;
     std::string filePath;
 
-    // This stores whether the track should be displayed or not depending on whether user has searched for it (default --> true)
-    bool isDisplayed;
+    /** Tag metadata stored in the CSV file, so the audio file does not have to be reopened to search by it */
+    std::string artist;
+    std::string album;
+    std::string genre;
+    std::string bpm;
+    std::string key;
+    std::string year;
+
+    /** Where the cover art image is stored inside the audio file, so the CoverArtCache only reads the image when it is displayed */
+    juce::int64 coverArtOffset;
+    juce::int64 coverArtSize;
+
+    /**
+     *A hash of the track's audio data (without its tags), which stays the same when the file is renamed or moved.
+     *Used as the key of the caches worked out from the audio, and to find duplicate tracks in the library
+     */
+    std::string contentHash;
+
+    /**
+     *The beat grid worked out from the track's audio: beat n is at firstBeatSeconds + n * 60 / analysedBpm.
+     *Stored separately from the BPM tag, which is often missing or rounded
+     */
+    double analysedBpm;
+    double firstBeatSeconds;
+
+    /** The key worked out from the track's audio, stored separately from the key tag (which many tracks do not have) */
+    std::string analysedKey;
+
+    /**
+     *The EBU R128 loudness worked out from the track's audio, which the decks use to play every track at the same loudness
+     *without clipping its peaks
+     */
+    double integratedLoudness;
+    double loudnessRange;
+    double truePeak;
+
+    /** The hot cues the user has set on the track, which are stored with it so they are there the next time it is loaded */
+    std::vector<double> hotCues;
 };
\ No newline at end of file
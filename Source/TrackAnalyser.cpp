@@ -0,0 +1,528 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.cpp
+    Created: 19 Oct 2026 7:41:52pm
+    Author:  Ophelia
+    Purpose: decodes the library's tracks on low-priority background threads and works out
+             their tempo (BPM), beat grid, key, loudness and waveform, passing the results back to the message thread in batches
+
+  ==============================================================================
+*/
+
+#include "TrackAnalyser.h"
+#include "BeatDetector.h"
+#include "KeyDetector.h"
+#include "LoudnessMeter.h"
+#include <atomic>
+
+//=========================================Analysis Stages===========================================================
+
+namespace
+{
+    // The number of samples in each point of the waveform thumbnail, the same resolution as the WaveformDisplay draws
+    const int samplesPerThumbnailSample = 1000;
+
+    /** Works out the tempo and beat grid from the mono mix */
+    class BeatGridStage : public TrackAnalyser::Stage
+    {
+    public:
+        explicit BeatGridStage(const juce::AudioFormatReader& reader) : beatDetector(reader.sampleRate)
+        {
+        }
+
+        void process(const TrackAnalyser::DecodedBlock& block) override
+        {
+            beatDetector.process(block.monoSamples, block.numSamples);
+        }
+
+        void storeResult(TrackAnalyser::AnalysisResult& result) override
+        {
+            BeatDetector::BeatGrid beatGrid = beatDetector.getBeatGrid();
+            result.bpm = beatGrid.bpm;
+            result.firstBeatSeconds = beatGrid.firstBeatSeconds;
+        }
+
+    private:
+        BeatDetector beatDetector;
+    };
+
+    /** Works out the key from the mono mix */
+    class KeyStage : public TrackAnalyser::Stage
+    {
+    public:
+        explicit KeyStage(const juce::AudioFormatReader& reader) : keyDetector(reader.sampleRate)
+        {
+        }
+
+        void process(const TrackAnalyser::DecodedBlock& block) override
+        {
+            keyDetector.process(block.monoSamples, block.numSamples);
+        }
+
+        void storeResult(TrackAnalyser::AnalysisResult& result) override
+        {
+            result.key = KeyDetector::getCamelotCode(keyDetector.getKey());
+        }
+
+    private:
+        KeyDetector keyDetector;
+    };
+
+    /** Measures the loudness from every channel, as loudness adds up the power of the channels */
+    class LoudnessStage : public TrackAnalyser::Stage
+    {
+    public:
+        explicit LoudnessStage(const juce::AudioFormatReader& reader) : loudnessMeter(reader.sampleRate, (int)reader.numChannels)
+        {
+        }
+
+        void process(const TrackAnalyser::DecodedBlock& block) override
+        {
+            loudnessMeter.process(block.channels.getArrayOfReadPointers(), block.numSamples);
+        }
+
+        void storeResult(TrackAnalyser::AnalysisResult& result) override
+        {
+            LoudnessMeter::Loudness loudness = loudnessMeter.getLoudness();
+            result.integratedLoudness = loudness.integratedLoudness;
+            result.loudnessRange = loudness.loudnessRange;
+            result.truePeak = loudness.truePeak;
+        }
+
+    private:
+        LoudnessMeter loudnessMeter;
+    };
+
+    /**
+     *Builds the waveform thumbnail which the decks draw, so loading the track into a deck does not decode the whole file
+     *a second time to draw it
+     */
+    class WaveformStage : public TrackAnalyser::Stage
+    {
+    public:
+        WaveformStage(const juce::AudioFormatReader& reader, juce::AudioFormatManager& formatManager, juce::AudioThumbnailCache& cache) :
+            thumbnail(samplesPerThumbnailSample, formatManager, cache)
+        {
+            thumbnail.reset((int)reader.numChannels, reader.sampleRate, reader.lengthInSamples);
+        }
+
+        void process(const TrackAnalyser::DecodedBlock& block) override
+        {
+            thumbnail.addBlock(block.position, block.channels, 0, block.numSamples);
+        }
+
+        void storeResult(TrackAnalyser::AnalysisResult& result) override
+        {
+            if (thumbnail.isFullyLoaded())
+            {
+                juce::MemoryOutputStream stream(result.waveform, false);
+                thumbnail.saveTo(stream);
+            }
+        }
+
+    private:
+        juce::AudioThumbnail thumbnail;
+    };
+}
+
+//=========================================Thread Pool Jobs===========================================================
+
+/** A ThreadPoolJob which keeps analysing the next queued file until the queue is empty */
+class TrackAnalyser::AnalysisJob : public juce::ThreadPoolJob
+{
+public:
+    AnalysisJob(TrackAnalyser& _owner) : juce::ThreadPoolJob("AnalysisJob"),
+        owner(_owner)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        // One job per worker thread takes files from the shared queue, so a newly queued deck track
+        // is the next file picked up, instead of waiting behind jobs which were added for the rest of the library
+        juce::String filePath;
+        int priority;
+        while (!shouldExit() && owner.takeNextFile(filePath, priority))
+        {
+            // The rest of the library is spread over every worker thread, so only a deck's track has its stages run at the same time
+            AnalysisResult result = owner.analyseFile(filePath, this, priority == deckPriority);
+            if (!shouldExit())
+            {
+                owner.addAnalysisResult(result);
+            }
+        }
+        return jobHasFinished;
+    }
+
+private:
+    TrackAnalyser& owner;
+};
+
+//=========================================TrackAnalyser===========================================================
+
+/**
+ *Constructor: takes in the formatManager used to decode the audio files and a callback which is
+ *called on the message thread with every batch of files which have been analysed
+ */
+TrackAnalyser::TrackAnalyser(juce::AudioFormatManager& _formatManager, std::function<void(std::vector<AnalysisResult>&)> _onBatchAnalysed) :
+    formatManager(_formatManager),
+    onBatchAnalysed(_onBatchAnalysed)
+{
+    // Below the normal priority of 5, so the audio and message threads always come first
+    threadPool.setThreadPriorities(2);
+    stageThreadPool.setThreadPriorities(2);
+
+    // Decoding and mixing down come first in the stage cost report
+    totalStageMilliseconds.assign(2, 0.0);
+
+    registerStage("beat grid", [](const juce::AudioFormatReader& reader) { return std::make_unique<BeatGridStage>(reader); });
+    registerStage("key", [](const juce::AudioFormatReader& reader) { return std::make_unique<KeyStage>(reader); });
+    registerStage("loudness", [](const juce::AudioFormatReader& reader) { return std::make_unique<LoudnessStage>(reader); });
+    registerStage("waveform", [this](const juce::AudioFormatReader& reader)
+        {
+            return std::make_unique<WaveformStage>(reader, formatManager, thumbnailCache);
+        });
+}
+
+/** Destructor: stops the worker threads before the analyser is destroyed */
+TrackAnalyser::~TrackAnalyser()
+{
+    stopTimer();
+    // Asks the running jobs to exit and waits for them, as the jobs hold a reference to this analyser
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/**
+ *Queues the given files to be analysed with the given priority. Files which are already queued with the same
+ *or a higher priority, or which are being analysed right now, are skipped; files queued with a lower priority move up
+ */
+void TrackAnalyser::analyseFiles(const juce::StringArray& filePaths, Priority priority)
+{
+    const juce::ScopedLock lock(queueLock);
+
+    for (const juce::String& path : filePaths)
+    {
+        auto queued = queuedPriority.find(path);
+        bool isQueued = queued != queuedPriority.end();
+        if ((isQueued && queued->second <= priority) || (!isQueued && pendingPaths.count(path) > 0))
+        {
+            continue;
+        }
+
+        // The most recently loaded or scrolled-to tracks go first, while the rest of the library is analysed in the order it was added
+        if (priority == backgroundPriority)
+        {
+            queues[priority].push_back(path);
+        }
+        else
+        {
+            queues[priority].push_front(path);
+        }
+        queuedPriority[path] = priority;
+        pendingPaths.insert(path);
+    }
+
+    // Starts a job for each idle worker thread, while there are files waiting
+    while (numRunningJobs < threadPool.getNumThreads() && !queuedPriority.empty())
+    {
+        if (numRunningJobs == 0)
+        {
+            busyStartTime = juce::Time::getMillisecondCounterHiRes();
+        }
+        ++numRunningJobs;
+        threadPool.addJob(new AnalysisJob(*this), true);
+    }
+
+    // Passes the results back twice a second, so the library is not rewritten for every single file
+    if (!pendingPaths.empty())
+    {
+        startTimer(500);
+    }
+}
+
+/** Returns how many tracks have been analysed per minute, over the time the worker threads have been busy */
+double TrackAnalyser::getTracksPerMinute()
+{
+    const juce::ScopedLock lock(queueLock);
+
+    double totalMilliseconds = busyMilliseconds;
+    if (numRunningJobs > 0)
+    {
+        totalMilliseconds += juce::Time::getMillisecondCounterHiRes() - busyStartTime;
+    }
+    return totalMilliseconds > 0.0 ? numAnalysedFiles * 60000.0 / totalMilliseconds : 0.0;
+}
+
+/**
+ *Adds a stage to the analysis of every file, whose cost is reported under the given name. The beat grid, key,
+ *loudness and waveform stages are registered by the constructor; only call this before any files are queued
+ */
+void TrackAnalyser::registerStage(const juce::String& name, StageFactory factory)
+{
+    const juce::ScopedLock lock(queueLock);
+
+    stageNames.add(name);
+    stageFactories.push_back(factory);
+    totalStageMilliseconds.push_back(0.0);
+}
+
+/**
+ *Returns a report of the time spent decoding, mixing down and in each stage so far, in total and per minute
+ *of audio, with the share of the analysis time each one took
+ */
+juce::String TrackAnalyser::getStageCostReport()
+{
+    const juce::ScopedLock lock(queueLock);
+
+    juce::StringArray names{ "decode", "mix down" };
+    names.addArray(stageNames);
+
+    double totalMilliseconds = 0.0;
+    for (double milliseconds : totalStageMilliseconds)
+    {
+        totalMilliseconds += milliseconds;
+    }
+
+    juce::String report;
+    report << "Analysed " << juce::String(totalAudioSeconds / 60.0, 1) << " minutes of audio in " << juce::String(totalMilliseconds / 1000.0, 2)
+        << " seconds of analysis time" << juce::newLine;
+    for (int part = 0; part < names.size(); ++part)
+    {
+        double milliseconds = totalStageMilliseconds[(size_t)part];
+        report << "  " << names[part].paddedRight(' ', 12)
+            << juce::String(milliseconds, 1) << " ms, "
+            << juce::String(totalAudioSeconds > 0.0 ? milliseconds * 60.0 / totalAudioSeconds : 0.0, 2) << " ms per minute of audio, "
+            << juce::String(totalMilliseconds > 0.0 ? milliseconds * 100.0 / totalMilliseconds : 0.0, 1) << "%" << juce::newLine;
+    }
+    return report;
+}
+
+/**
+ *Decodes and analyses a file straight away on the calling thread (running its stages one after the other),
+ *for the analysis benchmark. This decodes the whole file, so only call it from a background thread or the command line
+ */
+TrackAnalyser::AnalysisResult TrackAnalyser::analyseFileNow(const juce::String& filePath)
+{
+    return analyseFile(filePath, nullptr, false);
+}
+
+/**
+ *Takes the most urgent file out of the queue along with its priority, returning false (and counting the job as finished)
+ *if the queue is empty
+ */
+bool TrackAnalyser::takeNextFile(juce::String& filePath, int& priority)
+{
+    const juce::ScopedLock lock(queueLock);
+
+    for (priority = 0; priority < numPriorities; ++priority)
+    {
+        std::deque<juce::String>& queue = queues[priority];
+        while (!queue.empty())
+        {
+            filePath = queue.front();
+            queue.pop_front();
+
+            // Skips the files which moved up to a higher priority (and were analysed there or are still queued there)
+            auto queued = queuedPriority.find(filePath);
+            if (queued != queuedPriority.end() && queued->second == priority)
+            {
+                queuedPriority.erase(queued);
+                return true;
+            }
+        }
+    }
+
+    // The last job to finish stops the busy time, so time spent waiting for new files does not count against the throughput
+    if (--numRunningJobs == 0)
+    {
+        busyMilliseconds += juce::Time::getMillisecondCounterHiRes() - busyStartTime;
+    }
+    return false;
+}
+
+/**
+ *Decodes the file once and passes every block to each stage, running the stages at the same time if asked to. This decodes
+ *the whole file, so it is only called from the worker threads (or analyseFileNow()): if a job is given, it stops early
+ *(with wasDecoded left false) once the job is asked to exit
+ */
+TrackAnalyser::AnalysisResult TrackAnalyser::analyseFile(const juce::String& filePath, juce::ThreadPoolJob* job, bool runStagesInParallel)
+{
+    AnalysisResult result;
+    result.filePath = filePath;
+
+    std::unique_ptr<juce::AudioFormatReader> reader{ formatManager.createReaderFor(juce::File(filePath)) };
+    if (reader == nullptr || reader->sampleRate <= 0 || reader->numChannels == 0)
+    {
+        return result;
+    }
+
+    std::vector<std::unique_ptr<Stage>> stages;
+    for (const StageFactory& factory : stageFactories)
+    {
+        stages.push_back(factory(*reader));
+    }
+
+    // The time spent on this file's decoding, mixing down and each stage. Each stage only adds to its own entry,
+    // so the stages can time themselves while they run at the same time
+    std::vector<double> milliseconds(stages.size() + 2, 0.0);
+    std::vector<double> stageMilliseconds(stages.size(), 0.0);
+
+    // The audio is decoded in blocks of about a second, so a whole track is never held in memory.
+    // The mono mix has its own buffer, so the stages which read every channel see them as they were decoded
+    const int blockSize = 1 << 16;
+    int numChannels = (int)reader->numChannels;
+    juce::AudioBuffer<float> block(numChannels, blockSize);
+    juce::AudioBuffer<float> monoBlock(1, numChannels > 1 ? blockSize : 0);
+
+    for (juce::int64 position = 0; position < reader->lengthInSamples; position += blockSize)
+    {
+        if (job != nullptr && job->shouldExit())
+        {
+            return result;
+        }
+
+        double decodeStartTime = juce::Time::getMillisecondCounterHiRes();
+        int numSamples = (int)juce::jmin<juce::int64>(blockSize, reader->lengthInSamples - position);
+        if (!reader->read(&block, 0, numSamples, position, true, true))
+        {
+            return result;
+        }
+
+        double mixDownStartTime = juce::Time::getMillisecondCounterHiRes();
+        milliseconds[0] += mixDownStartTime - decodeStartTime;
+
+        const float* monoSamples = block.getReadPointer(0);
+        if (numChannels > 1)
+        {
+            monoBlock.copyFrom(0, 0, block, 0, 0, numSamples);
+            for (int channel = 1; channel < numChannels; ++channel)
+            {
+                monoBlock.addFrom(0, 0, block, channel, 0, numSamples);
+            }
+            monoBlock.applyGain(0, 0, numSamples, 1.0f / (float)numChannels);
+            monoSamples = monoBlock.getReadPointer(0);
+        }
+        milliseconds[1] += juce::Time::getMillisecondCounterHiRes() - mixDownStartTime;
+
+        // Every stage reads the same decoded block, so the file is only decoded once
+        DecodedBlock decodedBlock{ block, monoSamples, numSamples, position };
+        if (runStagesInParallel && stages.size() > 1)
+        {
+            runStagesOnStageThreads(stages, decodedBlock, stageMilliseconds);
+        }
+        else
+        {
+            for (size_t stage = 0; stage < stages.size(); ++stage)
+            {
+                double stageStartTime = juce::Time::getMillisecondCounterHiRes();
+                stages[stage]->process(decodedBlock);
+                stageMilliseconds[stage] += juce::Time::getMillisecondCounterHiRes() - stageStartTime;
+            }
+        }
+    }
+
+    for (size_t stage = 0; stage < stages.size(); ++stage)
+    {
+        double stageStartTime = juce::Time::getMillisecondCounterHiRes();
+        stages[stage]->storeResult(result);
+        milliseconds[stage + 2] = stageMilliseconds[stage] + juce::Time::getMillisecondCounterHiRes() - stageStartTime;
+    }
+
+    addStageCosts(milliseconds, (double)reader->lengthInSamples / reader->sampleRate);
+    result.wasDecoded = true;
+    return result;
+}
+
+/** Runs every stage on the block on the stage threads, and waits for all of them to finish */
+void TrackAnalyser::runStagesOnStageThreads(std::vector<std::unique_ptr<Stage>>& stages, const DecodedBlock& block, std::vector<double>& stageMilliseconds)
+{
+    std::atomic<int> numRemaining{ (int)stages.size() };
+    juce::WaitableEvent allFinished;
+
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        stageThreadPool.addJob([&stages, &block, &stageMilliseconds, &numRemaining, &allFinished, i]
+            {
+                double stageStartTime = juce::Time::getMillisecondCounterHiRes();
+                stages[i]->process(block);
+                stageMilliseconds[i] += juce::Time::getMillisecondCounterHiRes() - stageStartTime;
+
+                if (--numRemaining == 0)
+                {
+                    allFinished.signal();
+                }
+            });
+    }
+
+    allFinished.wait();
+}
+
+/** Adds the time spent on each part of a file's analysis, and the length of its audio, to the totals in the stage cost report */
+void TrackAnalyser::addStageCosts(const std::vector<double>& milliseconds, double audioSeconds)
+{
+    const juce::ScopedLock lock(queueLock);
+
+    for (size_t part = 0; part < milliseconds.size() && part < totalStageMilliseconds.size(); ++part)
+    {
+        totalStageMilliseconds[part] += milliseconds[part];
+    }
+    totalAudioSeconds += audioSeconds;
+}
+
+/** Stores the result of an analysed file so that the timerCallback can pass it back in the next batch */
+void TrackAnalyser::addAnalysisResult(AnalysisResult result)
+{
+    {
+        const juce::ScopedLock lock(queueLock);
+        ++numAnalysedFiles;
+    }
+
+    const juce::ScopedLock lock(resultsLock);
+    analysedResults.push_back(result);
+}
+
+/**
+ *Implements juce::Timer's inherited pure virtual function: passes every file which the worker threads
+ *have finished analysing to the onBatchAnalysed callback in a single batch, and logs the analysis throughput once the queue is empty
+ */
+void TrackAnalyser::timerCallback()
+{
+    // Takes every stored result in one go, so the worker threads are only blocked for the time it takes to swap two vectors
+    std::vector<AnalysisResult> batch;
+    {
+        const juce::ScopedLock lock(resultsLock);
+        batch.swap(analysedResults);
+    }
+
+    if (batch.empty())
+    {
+        return;
+    }
+
+    bool isQueueEmpty;
+    int numAnalysedSoFar;
+    {
+        const juce::ScopedLock lock(queueLock);
+        for (const AnalysisResult& result : batch)
+        {
+            pendingPaths.erase(result.filePath);
+        }
+
+        isQueueEmpty = pendingPaths.empty();
+        numAnalysedSoFar = numAnalysedFiles;
+        if (isQueueEmpty)
+        {
+            stopTimer();
+        }
+    }
+
+    // The throughput is only logged once the queue has been analysed, rather than for every batch
+    if (isQueueEmpty)
+    {
+        DBG("TrackAnalyser::timerCallback - analysed " << numAnalysedSoFar << " tracks at " << getTracksPerMinute()
+            << " tracks per minute, " << getStageCostReport());
+    }
+
+    onBatchAnalysed(batch);
+}
@@ -0,0 +1,224 @@
+/*
+  ==============================================================================
+
+    TrackAnalyser.h
+    Created: 19 Oct 2026 7:41:52pm
+    Author:  Ophelia
+    Purpose: decodes the library's tracks on low-priority background threads and works out
+             their tempo (BPM), beat grid, key, loudness and waveform, passing the results back to the message thread in batches
+
+  ==============================================================================
+  Analysing a track means decoding all of its audio, which takes far longer than importing or hashing it,
+  so the tracks wait in a queue with three priorities: tracks which were just loaded into a deck are analysed
+  first, then the tracks which are visible in the library table, then the rest of the library. Within the
+  first two priorities, the most recently requested track goes first, as that is the one the user is looking at.
+  The worker threads run below normal priority, so playback and the UI are never slowed down by a large library.
+
+  Each file is decoded once, in blocks of about a second, and every block is passed to each of the registered
+  stages (the BeatDetector, the KeyDetector, the LoudnessMeter and the waveform thumbnail) without being copied,
+  as decoding costs more than all of the analysis put together. The stages only read the blocks, so for a track
+  which was just loaded into a deck they run at the same time on their own threads; the rest of the library is
+  already spread over every worker thread, so its stages run one after the other. The time spent decoding, mixing
+  down and in each stage is added up, so the cost of each part of the analysis can be reported (see getStageCostReport()).
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+class TrackAnalyser : private juce::Timer
+{
+public:
+    /** How urgently a track is needed, from the most urgent to the least */
+    enum Priority
+    {
+        deckPriority = 0,
+        visiblePriority,
+        backgroundPriority,
+        numPriorities
+    };
+
+    /** The analysis of one file, passed back to the message thread */
+    struct AnalysisResult
+    {
+        // The full path of the file which was analysed
+        juce::String filePath;
+        // The tempo in beats per minute, or 0 if the file could not be decoded or has no steady beat
+        double bpm = 0.0;
+        // The time of the first beat in seconds
+        double firstBeatSeconds = 0.0;
+        // The key as a Camelot code (e.g. "8A"), or an empty string if the file could not be decoded or no notes were heard
+        juce::String key;
+        // The integrated loudness in LUFS, or 0 if the file could not be decoded
+        double integratedLoudness = 0.0;
+        // The loudness range in LU
+        double loudnessRange = 0.0;
+        // The true peak in dBTP
+        double truePeak = 0.0;
+        // The waveform thumbnail as saved by juce::AudioThumbnail, or empty if the file could not be decoded to the end
+        juce::MemoryBlock waveform;
+        // False if the file could not be opened or decoded to the end, in which case none of the above was worked out
+        bool wasDecoded = false;
+    };
+
+    /** One decoded block of a file, which every stage reads without copying it */
+    struct DecodedBlock
+    {
+        // Every channel of the block, as it was decoded
+        const juce::AudioBuffer<float>& channels;
+        // The channels mixed down to mono (channel 0 itself for a mono file)
+        const float* monoSamples;
+        // The number of samples in the block
+        int numSamples;
+        // The position of the block's first sample in the file
+        juce::int64 position;
+    };
+
+    /**
+     *A stage of the analysis, which is given every decoded block of a file in order and then stores what it worked out
+     *in the file's AnalysisResult. A new set of stages is made for every file
+     */
+    class Stage
+    {
+    public:
+        virtual ~Stage() = default;
+
+        /** Reads the next decoded block of the file. Only read the block: the other stages may be reading it at the same time */
+        virtual void process(const DecodedBlock& block) = 0;
+
+        /** Stores the stage's analysis in the result, once every block of the file has been read */
+        virtual void storeResult(AnalysisResult& result) = 0;
+    };
+
+    /** Makes a stage for a file, from the reader which gives its sample rate, number of channels and length */
+    using StageFactory = std::function<std::unique_ptr<Stage>(const juce::AudioFormatReader& reader)>;
+
+    /**
+     *Constructor: takes in the formatManager used to decode the audio files and a callback which is
+     *called on the message thread with every batch of files which have been analysed
+     */
+    TrackAnalyser(
+        juce::AudioFormatManager& _formatManager,
+        std::function<void(std::vector<AnalysisResult>&)> _onBatchAnalysed);
+
+    /** Destructor: stops the worker threads before the analyser is destroyed */
+    ~TrackAnalyser() override;
+
+    /**
+     *Queues the given files to be analysed with the given priority. Files which are already queued with the same
+     *or a higher priority, or which are being analysed right now, are skipped; files queued with a lower priority move up
+     */
+    void analyseFiles(const juce::StringArray& filePaths, Priority priority);
+
+    /** Returns how many tracks have been analysed per minute, over the time the worker threads have been busy */
+    double getTracksPerMinute();
+
+    /**
+     *Adds a stage to the analysis of every file, whose cost is reported under the given name. The beat grid, key,
+     *loudness and waveform stages are registered by the constructor; only call this before any files are queued
+     */
+    void registerStage(const juce::String& name, StageFactory factory);
+
+    /**
+     *Returns a report of the time spent decoding, mixing down and in each stage so far, in total and per minute
+     *of audio, with the share of the analysis time each one took
+     */
+    juce::String getStageCostReport();
+
+    /**
+     *Decodes and analyses a file straight away on the calling thread (running its stages one after the other),
+     *for the analysis benchmark. This decodes the whole file, so only call it from a background thread or the command line
+     */
+    AnalysisResult analyseFileNow(const juce::String& filePath);
+
+private:
+    /** A ThreadPoolJob which keeps analysing the next queued file until the queue is empty */
+    class AnalysisJob;
+
+    /**
+     *Takes the most urgent file out of the queue along with its priority, returning false (and counting the job as finished)
+     *if the queue is empty
+     */
+    bool takeNextFile(juce::String& filePath, int& priority);
+
+    /**
+     *Decodes the file once and passes every block to each stage, running the stages at the same time if asked to. This decodes
+     *the whole file, so it is only called from the worker threads (or analyseFileNow()): if a job is given, it stops early
+     *(with wasDecoded left false) once the job is asked to exit
+     */
+    AnalysisResult analyseFile(const juce::String& filePath, juce::ThreadPoolJob* job, bool runStagesInParallel);
+
+    /** Runs every stage on the block on the stage threads, and waits for all of them to finish */
+    void runStagesOnStageThreads(std::vector<std::unique_ptr<Stage>>& stages, const DecodedBlock& block, std::vector<double>& stageMilliseconds);
+
+    /** Adds the time spent on each part of a file's analysis, and the length of its audio, to the totals in the stage cost report */
+    void addStageCosts(const std::vector<double>& milliseconds, double audioSeconds);
+
+    /** Stores the result of an analysed file so that the timerCallback can pass it back in the next batch */
+    void addAnalysisResult(AnalysisResult result);
+
+    /**
+     *Implements juce::Timer's inherited pure virtual function: passes every file which the worker threads
+     *have finished analysing to the onBatchAnalysed callback in a single batch, and logs the analysis throughput once the queue is empty
+     */
+    void timerCallback() override;
+
+    // The reference to the formatManager passed in from the PlaylistComponent (only used for decoding in the worker threads)
+    juce::AudioFormatManager& formatManager;
+
+    // Called on the message thread with each batch of analysed files
+    std::function<void(std::vector<AnalysisResult>&)> onBatchAnalysed;
+
+    // The paths of the files which are queued or being analysed, so that each one is only analysed once at a time
+    std::set<juce::String> pendingPaths;
+
+    // The queued files for each priority. A file which moves up to a higher priority is left in its old queue and
+    // skipped when it is reached there, as queuedPriority no longer matches that queue
+    std::deque<juce::String> queues[numPriorities];
+
+    // The priority of every file which is still queued (files which are being analysed are not in here)
+    std::map<juce::String, int> queuedPriority;
+
+    // The number of AnalysisJobs on the thread pool, which is never more than the number of worker threads
+    int numRunningJobs = 0;
+
+    // The time the worker threads last became busy, and how long they were busy before that (in milliseconds)
+    double busyStartTime = 0.0;
+    double busyMilliseconds = 0.0;
+
+    // The number of files which have been analysed since the analyser was created
+    int numAnalysedFiles = 0;
+
+    // Locks pendingPaths, the queues, queuedPriority, numRunningJobs and the throughput counters, which the worker threads also use
+    juce::CriticalSection queueLock;
+
+    // The name and factory of every registered stage, in the order they were registered
+    juce::StringArray stageNames;
+    std::vector<StageFactory> stageFactories;
+
+    // The time spent on each part of the analysis in milliseconds (decoding, then mixing down, then each stage in stageNames),
+    // and the length of the audio analysed in seconds, locked by queueLock
+    std::vector<double> totalStageMilliseconds;
+    double totalAudioSeconds = 0.0;
+
+    // juce::AudioThumbnail needs a cache to be made, though the waveform stage only builds thumbnails and never looks them up
+    juce::AudioThumbnailCache thumbnailCache{ 1 };
+
+    // Decoding is slow, so half of the CPU cores are used, leaving the rest for playback, the UI and the other background services
+    juce::ThreadPool threadPool{ juce::jmax(1, juce::SystemStats::getNumCpus() / 2) };
+
+    // Runs the stages of a deck's track at the same time, so the track the DJ is waiting for is analysed sooner
+    juce::ThreadPool stageThreadPool{ juce::jmax(1, juce::SystemStats::getNumCpus() / 2) };
+
+    // Stores the results which have been analysed but not yet passed back, locked by resultsLock
+    std::vector<AnalysisResult> analysedResults;
+    juce::CriticalSection resultsLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackAnalyser)
+};
@@ -0,0 +1,363 @@
+/*
+  ==============================================================================
+
+    TrackHasher.cpp
+    Created: 19 Oct 2026 5:48:31pm
+    Author:  Ophelia
+    Purpose: works out a content hash of the audio in each track on a background thread,
+             so that tracks can be recognised after they are renamed or moved, and duplicates can be found
+
+  ==============================================================================
+*/
+
+#include "TrackHasher.h"
+
+namespace
+{
+    /**
+     *Works out a 64-bit xxHash (XXH64, with a seed of 0) of data which is passed in one chunk at a time.
+     *Attribution: the algorithm is described at https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+     */
+    class XXHash64
+    {
+    public:
+        /** Adds the next chunk of data to the hash */
+        void update(const juce::uint8* data, size_t size)
+        {
+            totalLength += size;
+
+            // Data is hashed in 32-byte stripes, so a chunk which does not end on a stripe is finished by the next chunk
+            if (bufferSize + size < stripeSize)
+            {
+                memcpy(buffer + bufferSize, data, size);
+                bufferSize += size;
+                return;
+            }
+            if (bufferSize > 0)
+            {
+                size_t fill = stripeSize - bufferSize;
+                memcpy(buffer + bufferSize, data, fill);
+                processStripe(buffer);
+                data += fill;
+                size -= fill;
+                bufferSize = 0;
+            }
+            while (size >= stripeSize)
+            {
+                processStripe(data);
+                data += stripeSize;
+                size -= stripeSize;
+            }
+            memcpy(buffer, data, size);
+            bufferSize = size;
+        }
+
+        /** Returns the hash of all the data added so far */
+        juce::uint64 digest() const
+        {
+            juce::uint64 hash;
+            if (totalLength >= stripeSize)
+            {
+                hash = rotateLeft(acc[0], 1) + rotateLeft(acc[1], 7) + rotateLeft(acc[2], 12) + rotateLeft(acc[3], 18);
+                for (juce::uint64 value : acc)
+                {
+                    hash = (hash ^ round(0, value)) * prime1 + prime4;
+                }
+            }
+            else
+            {
+                hash = prime5;
+            }
+            hash += totalLength;
+
+            // The last few bytes which did not fill a whole stripe
+            const juce::uint8* p = buffer;
+            size_t remaining = bufferSize;
+            for (; remaining >= 8; p += 8, remaining -= 8)
+            {
+                hash = rotateLeft(hash ^ round(0, juce::ByteOrder::littleEndianInt64(p)), 27) * prime1 + prime4;
+            }
+            if (remaining >= 4)
+            {
+                hash = rotateLeft(hash ^ ((juce::uint64)juce::ByteOrder::littleEndianInt(p) * prime1), 23) * prime2 + prime3;
+                p += 4;
+                remaining -= 4;
+            }
+            for (; remaining > 0; ++p, --remaining)
+            {
+                hash = rotateLeft(hash ^ (*p * prime5), 11) * prime1;
+            }
+
+            // Mixes the bits so that every bit of the data affects every bit of the hash
+            hash ^= hash >> 33;
+            hash *= prime2;
+            hash ^= hash >> 29;
+            hash *= prime3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+    private:
+        static constexpr juce::uint64 prime1 = 11400714785074694791ull;
+        static constexpr juce::uint64 prime2 = 14029467366897019727ull;
+        static constexpr juce::uint64 prime3 = 1609587929392839161ull;
+        static constexpr juce::uint64 prime4 = 9650029242287828579ull;
+        static constexpr juce::uint64 prime5 = 2870177450012600261ull;
+        static constexpr size_t stripeSize = 32;
+
+        static juce::uint64 rotateLeft(juce::uint64 value, int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        static juce::uint64 round(juce::uint64 accumulator, juce::uint64 input)
+        {
+            return rotateLeft(accumulator + input * prime2, 31) * prime1;
+        }
+
+        /** Adds one 32-byte stripe to the four accumulators */
+        void processStripe(const juce::uint8* stripe)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                acc[i] = round(acc[i], juce::ByteOrder::littleEndianInt64(stripe + i * 8));
+            }
+        }
+
+        // The four accumulators, which each hash every fourth 8-byte lane of the data
+        juce::uint64 acc[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+        // The start of a stripe which is waiting for the next chunk of data
+        juce::uint8 buffer[stripeSize];
+        size_t bufferSize = 0;
+        juce::uint64 totalLength = 0;
+    };
+
+    /** Reads numBytes from the given position in the stream, returning false if they could not all be read */
+    bool readAt(juce::FileInputStream& stream, juce::int64 position, void* buffer, int numBytes)
+    {
+        return stream.setPosition(position) && stream.read(buffer, numBytes) == numBytes;
+    }
+
+    /** Reads an ID3v2 "synchsafe" size, which stores 7 bits in each of its 4 bytes */
+    juce::int64 readSynchsafeSize(const juce::uint8* bytes)
+    {
+        return ((juce::int64)bytes[0] << 21) | ((juce::int64)bytes[1] << 14) | ((juce::int64)bytes[2] << 7) | (juce::int64)bytes[3];
+    }
+}
+
+//=========================================Thread Pool Jobs===========================================================
+
+/** A ThreadPoolJob which hashes one audio file */
+class TrackHasher::HashJob : public juce::ThreadPoolJob
+{
+public:
+    HashJob(TrackHasher& _owner, juce::String _filePath) : juce::ThreadPoolJob("HashJob"),
+        owner(_owner),
+        filePath(_filePath)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        HashResult result;
+        result.filePath = filePath;
+        result.contentHash = hashAudioPayload(juce::File(filePath), this);
+
+        owner.addHashResult(result);
+        return jobHasFinished;
+    }
+
+private:
+    TrackHasher& owner;
+    juce::String filePath;
+};
+
+//=========================================TrackHasher===========================================================
+
+/**
+ *Constructor: takes in a callback which is called on the message thread with every batch of files
+ *which have been hashed
+ */
+TrackHasher::TrackHasher(std::function<void(std::vector<HashResult>&)> _onBatchHashed) : onBatchHashed(_onBatchHashed)
+{
+}
+
+/** Destructor: stops the worker thread before the hasher is destroyed */
+TrackHasher::~TrackHasher()
+{
+    stopTimer();
+    // Asks the running job to exit and waits for it, as the jobs hold a reference to this hasher
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/**
+ *Queues the given files to be hashed in the background. Files which are already queued are skipped,
+ *so a track is only read once however many times it is added
+ */
+void TrackHasher::hashFiles(const juce::StringArray& filePaths)
+{
+    for (const juce::String& path : filePaths)
+    {
+        if (pendingPaths.insert(path).second)
+        {
+            threadPool.addJob(new HashJob(*this, path), true);
+        }
+    }
+
+    // Passes the hashes back twice a second, so the library is not rewritten for every single file
+    if (!pendingPaths.empty())
+    {
+        startTimer(500);
+    }
+}
+
+/**
+ *Reads the audio data of the file (skipping its tags) and returns its 64-bit xxHash as 16 hex digits,
+ *or an empty string if the file could not be read. This reads the whole file, so only call it from a background thread:
+ *if a job is given, hashing stops early (and returns an empty string) once the job is asked to exit
+ */
+juce::String TrackHasher::hashAudioPayload(const juce::File& file, juce::ThreadPoolJob* job)
+{
+    juce::FileInputStream stream(file);
+    if (!stream.openedOk())
+    {
+        return {};
+    }
+
+    juce::int64 start, end;
+    findAudioPayload(stream, start, end);
+    if (!stream.setPosition(start))
+    {
+        return {};
+    }
+
+    // xxHash runs much faster than the disk can be read, so the file is read in large chunks to keep the disk busy
+    const int chunkSize = 1 << 20;
+    juce::HeapBlock<juce::uint8> chunk(chunkSize);
+    XXHash64 hash;
+
+    for (juce::int64 remaining = end - start; remaining > 0;)
+    {
+        if (job != nullptr && job->shouldExit())
+        {
+            return {};
+        }
+
+        int numRead = stream.read(chunk, (int)juce::jmin<juce::int64>(remaining, chunkSize));
+        if (numRead <= 0)
+        {
+            return {};
+        }
+        hash.update(chunk, (size_t)numRead);
+        remaining -= numRead;
+    }
+
+    return juce::String::toHexString((juce::int64)hash.digest()).paddedLeft('0', 16);
+}
+
+/**
+ *Finds where the audio data starts and ends in the file, by skipping the ID3v2 tags at the start
+ *and the ID3v1, APEv2 and Lyrics3 tags at the end
+ */
+void TrackHasher::findAudioPayload(juce::FileInputStream& stream, juce::int64& start, juce::int64& end)
+{
+    start = 0;
+    end = stream.getTotalLength();
+
+    // Skips the ID3v2 tags at the start of the file (a file which was retagged by different programs can have more than one).
+    // Attribution: the header layout is described at https://id3.org/id3v2.4.0-structure
+    juce::uint8 header[10];
+    while (end - start >= 10 && readAt(stream, start, header, 10) && memcmp(header, "ID3", 3) == 0 &&
+        header[3] != 0xFF && header[4] != 0xFF && (header[6] | header[7] | header[8] | header[9]) < 0x80)
+    {
+        // The size does not include the 10-byte header, or the 10-byte footer which ID3v2.4 tags can have
+        juce::int64 tagSize = 10 + readSynchsafeSize(header + 6) + ((header[5] & 0x10) ? 10 : 0);
+        start = juce::jmin(start + tagSize, end);
+    }
+
+    // Skips the tags at the end of the file. These are checked again after each one is found, as an ID3v1 tag
+    // can come after an APEv2 or Lyrics3 tag
+    juce::uint8 footer[32];
+    bool foundTag = true;
+    while (foundTag)
+    {
+        foundTag = false;
+
+        // ID3v1: the last 128 bytes start with "TAG"
+        if (end - start >= 128 && readAt(stream, end - 128, footer, 3) && memcmp(footer, "TAG", 3) == 0)
+        {
+            end -= 128;
+            foundTag = true;
+        }
+        // APEv2: a 32-byte footer starting with "APETAGEX", whose size includes the footer but not the header
+        else if (end - start >= 32 && readAt(stream, end - 32, footer, 32) && memcmp(footer, "APETAGEX", 8) == 0)
+        {
+            juce::int64 tagSize = juce::ByteOrder::littleEndianInt(footer + 12);
+            bool hasHeader = (juce::ByteOrder::littleEndianInt(footer + 20) & 0x80000000) != 0;
+            tagSize += hasHeader ? 32 : 0;
+            if (tagSize >= 32 && tagSize <= end - start)
+            {
+                end -= tagSize;
+                foundTag = true;
+            }
+        }
+        // Lyrics3 v2: ends with a 6-digit size (which does not include itself) and "LYRICS200"
+        else if (end - start >= 15 && readAt(stream, end - 15, footer, 15) && memcmp(footer + 6, "LYRICS200", 9) == 0)
+        {
+            juce::String digits(reinterpret_cast<const char*>(footer), 6);
+            juce::int64 tagSize = digits.getLargeIntValue() + 15;
+            if (digits.containsOnly("0123456789") && tagSize <= end - start)
+            {
+                end -= tagSize;
+                foundTag = true;
+            }
+        }
+        // An ID3v2.4 tag at the end of the file, found by its footer ("3DI")
+        else if (end - start >= 10 && readAt(stream, end - 10, footer, 10) && memcmp(footer, "3DI", 3) == 0 &&
+            (footer[6] | footer[7] | footer[8] | footer[9]) < 0x80)
+        {
+            juce::int64 tagSize = 20 + readSynchsafeSize(footer + 6);
+            if (tagSize <= end - start)
+            {
+                end -= tagSize;
+                foundTag = true;
+            }
+        }
+    }
+}
+
+/** Stores the result of a hashed file so that the timerCallback can pass it back in the next batch */
+void TrackHasher::addHashResult(HashResult result)
+{
+    const juce::ScopedLock lock(resultsLock);
+    hashedResults.push_back(result);
+}
+
+/**
+ *Implements juce::Timer's inherited pure virtual function: passes every file which the worker thread
+ *has finished hashing to the onBatchHashed callback in a single batch
+ */
+void TrackHasher::timerCallback()
+{
+    // Takes every stored result in one go, so the worker thread is only blocked for the time it takes to swap two vectors
+    std::vector<HashResult> batch;
+    {
+        const juce::ScopedLock lock(resultsLock);
+        batch.swap(hashedResults);
+    }
+
+    for (const HashResult& result : batch)
+    {
+        pendingPaths.erase(result.filePath);
+    }
+
+    if (pendingPaths.empty())
+    {
+        stopTimer();
+    }
+
+    if (!batch.empty())
+    {
+        onBatchHashed(batch);
+    }
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    TrackHasher.h
+    Created: 19 Oct 2026 5:48:31pm
+    Author:  Ophelia
+    Purpose: works out a content hash of the audio in each track on a background thread,
+             so that tracks can be recognised after they are renamed or moved, and duplicates can be found
+
+  ==============================================================================
+  The hash is a 64-bit xxHash (XXH64) of the audio data only: ID3v2 tags at the start of the file and
+  ID3v1/APEv2/Lyrics3 tags at the end are skipped, so retagging a track does not change its hash, and two
+  copies of the same rip with different tags have the same hash. The hash is stored in the CSV file with
+  the rest of the track's data, and is used as the key of the caches which are worked out from the audio
+  (e.g. the waveform thumbnails), so that they are not worked out again for a moved file or a duplicate.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <set>
+#include <vector>
+
+class TrackHasher : private juce::Timer
+{
+public:
+    /** The content hash of one file, passed back to the message thread */
+    struct HashResult
+    {
+        // The full path of the file which was hashed
+        juce::String filePath;
+        // The hash as 16 hex digits, or an empty string if the file could not be read
+        juce::String contentHash;
+    };
+
+    /**
+     *Constructor: takes in a callback which is called on the message thread with every batch of files
+     *which have been hashed
+     */
+    TrackHasher(std::function<void(std::vector<HashResult>&)> _onBatchHashed);
+
+    /** Destructor: stops the worker thread before the hasher is destroyed */
+    ~TrackHasher() override;
+
+    /**
+     *Queues the given files to be hashed in the background. Files which are already queued are skipped,
+     *so a track is only read once however many times it is added
+     */
+    void hashFiles(const juce::StringArray& filePaths);
+
+    /**
+     *Reads the audio data of the file (skipping its tags) and returns its 64-bit xxHash as 16 hex digits,
+     *or an empty string if the file could not be read. This reads the whole file, so only call it from a background thread:
+     *if a job is given, hashing stops early (and returns an empty string) once the job is asked to exit
+     */
+    static juce::String hashAudioPayload(const juce::File& file, juce::ThreadPoolJob* job = nullptr);
+
+private:
+    /** A ThreadPoolJob which hashes one audio file */
+    class HashJob;
+
+    /**
+     *Finds where the audio data starts and ends in the file, by skipping the ID3v2 tags at the start
+     *and the ID3v1, APEv2 and Lyrics3 tags at the end
+     */
+    static void findAudioPayload(juce::FileInputStream& stream, juce::int64& start, juce::int64& end);
+
+    /** Stores the result of a hashed file so that the timerCallback can pass it back in the next batch */
+    void addHashResult(HashResult result);
+
+    /**
+     *Implements juce::Timer's inherited pure virtual function: passes every file which the worker thread
+     *has finished hashing to the onBatchHashed callback in a single batch
+     */
+    void timerCallback() override;
+
+    // Called on the message thread with each batch of hashed files
+    std::function<void(std::vector<HashResult>&)> onBatchHashed;
+
+    // The paths of the files which are queued on the thread pool, so that each one is only hashed once at a time
+    std::set<juce::String> pendingPaths;
+
+    // Hashing reads every byte of the file, so a single worker thread is used to keep the disk free for playback and importing
+    juce::ThreadPool threadPool{ 1 };
+
+    // Stores the results which have been hashed but not yet passed back, locked by resultsLock
+    std::vector<HashResult> hashedResults;
+    juce::CriticalSection resultsLock;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackHasher)
+};
@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    TrackImporter.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Ophelia
+    Purpose: scans files and folders for audio tracks on a background thread pool
+             and hands the results back to the message thread in batches
+
+  ==============================================================================
+*/
+
+#include "TrackImporter.h"
+
+//=========================================Thread Pool Jobs===========================================================
+
+/** A ThreadPoolJob which expands a folder into the audio files inside it and queues them up for scanning */
+class TrackImporter::FolderScanJob : public juce::ThreadPoolJob
+{
+public:
+    FolderScanJob(TrackImporter& _owner, juce::File _folder) : juce::ThreadPoolJob("FolderScanJob"),
+        owner(_owner),
+        folder(_folder)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        juce::Array<juce::File> audioFiles;
+
+        // Searches the folder and all of its subfolders for files with an extension that one of the registered formats can read
+        for (const juce::DirectoryEntry& entry : juce::RangedDirectoryIterator(folder, true, owner.formatManager.getWildcardForAllFormats(), juce::File::findFiles))
+        {
+            // Stops searching if the importer is being destroyed
+            if (shouldExit())
+            {
+                break;
+            }
+            audioFiles.add(entry.getFile());
+        }
+
+        // Queues the files before marking this folder as done, so the import never looks finished in between
+        owner.queueFilesForScanning(audioFiles);
+        --owner.numFoldersScanning;
+
+        return jobHasFinished;
+    }
+
+private:
+    TrackImporter& owner;
+    juce::File folder;
+};
+
+/** A ThreadPoolJob which opens a chunk of audio files and reads the duration and tags of each one */
+class TrackImporter::FileScanJob : public juce::ThreadPoolJob
+{
+public:
+    FileScanJob(TrackImporter& _owner, juce::Array<juce::File> _files) : juce::ThreadPoolJob("FileScanJob"),
+        owner(_owner),
+        files(_files)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        for (const juce::File& file : files)
+        {
+            // Stops scanning if the importer is being destroyed
+            if (shouldExit())
+            {
+                break;
+            }
+
+            ImportResult result;
+            result.file = file;
+
+            // The tags are read once here and stored in the CSV file, so the file is never reopened to search by them.
+            // For MP3 files the length is read at the same time, from the header the encoder wrote in the first frame
+            AudioProperties audioProperties;
+            result.metadata = metadataReader.readMetadata(file, &audioProperties);
+
+            if (audioProperties.isExact && owner.formatManager.findFormatForFileExtension(file.getFileExtension()) != nullptr)
+            {
+                result.lengthInSeconds = audioProperties.lengthInSeconds;
+                owner.addScannedResult(result);
+            }
+            else
+            {
+                // Attribution: https://forum.juce.com/t/get-track-length-before-it-starts-playing/44838
+                // Only needed for MP3 files without a Xing/Info/VBRI header, whose reader has to scan every frame to count them:
+                // the readers for the other formats only read the file's header, and are deleted as soon as the length is known
+                std::unique_ptr<juce::AudioFormatReader> reader{ owner.formatManager.createReaderFor(file) };
+
+                // Files which none of the registered formats can open are skipped, as they could not be played anyway
+                if (reader != nullptr && reader->sampleRate > 0)
+                {
+                    result.lengthInSeconds = reader->lengthInSamples / reader->sampleRate;
+                    owner.addScannedResult(result);
+                }
+            }
+
+            // Counted after the result has been stored, so the timer never sees a finished import with results missing
+            ++owner.numFilesScanned;
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    TrackImporter& owner;
+    juce::Array<juce::File> files;
+
+    // Each job has its own MetadataReader, so the worker threads never share one
+    MetadataReader metadataReader;
+};
+
+//=========================================TrackImporter===========================================================
+
+/**
+ *Constructor: takes in the formatManager used to open the audio files and a callback which is
+ *called on the message thread with every batch of files which have finished scanning
+ */
+TrackImporter::TrackImporter(
+    juce::AudioFormatManager& _formatManager,
+    std::function<void(std::vector<ImportResult>&)> _onBatchScanned) : formatManager(_formatManager),
+    onBatchScanned(_onBatchScanned)
+{
+}
+
+/** Destructor: stops the worker threads before the importer is destroyed */
+TrackImporter::~TrackImporter()
+{
+    stopTimer();
+    // Asks every running job to exit and waits for them, as the jobs hold a reference to this importer
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/**
+ *Queues the given file paths for importing. Any folders are searched recursively for audio files
+ *which the formatManager can read, so the user can drop in a whole music collection at once
+ */
+void TrackImporter::importFiles(const juce::StringArray& filePaths)
+{
+    // Files which were selected directly are scanned straight away
+    juce::Array<juce::File> selectedFiles;
+
+    for (const juce::String& path : filePaths)
+    {
+        juce::File file{ path };
+
+        // Folders can hold thousands of files, so they are searched on the thread pool instead of the message thread
+        if (file.isDirectory())
+        {
+            ++numFoldersScanning;
+            threadPool.addJob(new FolderScanJob(*this, file), true);
+        }
+        else if (file.existsAsFile())
+        {
+            selectedFiles.add(file);
+        }
+    }
+
+    queueFilesForScanning(selectedFiles);
+
+    // Checks for finished files ten times a second, so the table is not redrawn for every single file
+    startTimer(100);
+}
+
+/** Returns true while there are files still waiting to be scanned or committed to the library */
+bool TrackImporter::isImporting()
+{
+    // The counters are only reset once the timer has committed the last batch of the import
+    return numFoldersScanning > 0 || numFilesQueued > 0;
+}
+
+/**
+ *Returns a reference to the progress value (between 0 and 1) of the current import, which is passed
+ *into the PlaylistComponent's juce::ProgressBar
+ */
+double& TrackImporter::getProgress()
+{
+    return progress;
+}
+
+/** Splits the list of audio files into chunks and adds a FileScanJob to the thread pool for each chunk */
+void TrackImporter::queueFilesForScanning(juce::Array<juce::File>& audioFiles)
+{
+    numFilesQueued += audioFiles.size();
+
+    for (int start = 0; start < audioFiles.size(); start += filesPerJob)
+    {
+        juce::Array<juce::File> chunk;
+        chunk.addArray(audioFiles, start, filesPerJob);
+        threadPool.addJob(new FileScanJob(*this, chunk), true);
+    }
+}
+
+/** Stores the result of a scanned file so that the timerCallback can commit it to the library */
+void TrackImporter::addScannedResult(ImportResult result)
+{
+    const juce::ScopedLock lock(resultsLock);
+    scannedResults.push_back(result);
+}
+
+/**
+ *Implements juce::Timer's inherited pure virtual function: moves all the files which the worker
+ *threads have finished scanning to the library in a single batch and updates the progress bar
+ */
+void TrackImporter::timerCallback()
+{
+    // Checked before taking the results, so that any file counted as scanned already has its result stored
+    bool hasFinished = numFoldersScanning == 0 && numFilesScanned == numFilesQueued;
+
+    // Takes every stored result in one go, so the worker threads are only blocked for the time it takes to swap two vectors
+    std::vector<ImportResult> batch;
+    {
+        const juce::ScopedLock lock(resultsLock);
+        batch.swap(scannedResults);
+    }
+
+    // The worker threads finish in any order, so the batch is sorted by path to keep the library in folder order
+    std::sort(batch.begin(), batch.end(), [](const ImportResult& a, const ImportResult& b)
+        {
+            return a.file.getFullPathName() < b.file.getFullPathName();
+        });
+
+    if (hasFinished)
+    {
+        // Resets the counters ready for the next import
+        numFilesQueued = 0;
+        numFilesScanned = 0;
+        progress = 1.0;
+        stopTimer();
+    }
+    else
+    {
+        progress = numFilesQueued > 0 ? (double)numFilesScanned / (double)numFilesQueued : 0.0;
+    }
+
+    // The PlaylistComponent is also told when the import finishes, even if the last batch is empty, so it can hide the progress bar
+    if (!batch.empty() || hasFinished)
+    {
+        onBatchScanned(batch);
+    }
+}
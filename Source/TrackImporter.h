@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    TrackImporter.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Ophelia
+    Purpose: scans files and folders for audio tracks on a background thread pool
+             and hands the results back to the message thread in batches
+
+  ==============================================================================
+  The PlaylistComponent gives the importer a list of files/folders (from the FileChooser or
+  from drag-and-drop). Folders are expanded recursively, and each audio file is opened on one of
+  the worker threads to read its duration and tags, so the message thread never blocks on disk access.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MetadataReader.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class TrackImporter : private juce::Timer
+{
+public:
+    /** Stores the data read from a single audio file by one of the worker threads */
+    struct ImportResult
+    {
+        // The audio file which was scanned
+        juce::File file;
+        // The length of the audio file in seconds
+        double lengthInSeconds = 0.0;
+        // The file's tag metadata (title, artist, album, genre, BPM, key and year)
+        TrackMetadata metadata;
+    };
+
+    /**
+     *Constructor: takes in the formatManager used to open the audio files and a callback which is
+     *called on the message thread with every batch of files which have finished scanning
+     */
+    TrackImporter(
+        juce::AudioFormatManager& _formatManager,
+        std::function<void(std::vector<ImportResult>&)> _onBatchScanned);
+
+    /** Destructor: stops the worker threads before the importer is destroyed */
+    ~TrackImporter() override;
+
+    /**
+     *Queues the given file paths for importing. Any folders are searched recursively for audio files
+     *which the formatManager can read, so the user can drop in a whole music collection at once
+     */
+    void importFiles(const juce::StringArray& filePaths);
+
+    /** Returns true while there are files still waiting to be scanned or committed to the library */
+    bool isImporting();
+
+    /**
+     *Returns a reference to the progress value (between 0 and 1) of the current import, which is passed
+     *into the PlaylistComponent's juce::ProgressBar
+     */
+    double& getProgress();
+
+private:
+    /** A ThreadPoolJob which expands a folder into the audio files inside it and queues them up for scanning */
+    class FolderScanJob;
+    /** A ThreadPoolJob which opens a chunk of audio files and reads the duration and tags of each one */
+    class FileScanJob;
+
+    /** Splits the list of audio files into chunks and adds a FileScanJob to the thread pool for each chunk */
+    void queueFilesForScanning(juce::Array<juce::File>& audioFiles);
+
+    /** Stores the result of a scanned file so that the timerCallback can commit it to the library */
+    void addScannedResult(ImportResult result);
+
+    /**
+     *Implements juce::Timer's inherited pure virtual function: moves all the files which the worker
+     *threads have finished scanning to the library in a single batch and updates the progress bar
+     */
+    void timerCallback() override;
+
+    // The reference to the formatManager passed in from the PlaylistComponent (only used for reading in the worker threads)
+    juce::AudioFormatManager& formatManager;
+
+    // Called on the message thread with each batch of scanned files
+    std::function<void(std::vector<ImportResult>&)> onBatchScanned;
+
+    // The worker threads which open the audio files: one thread per CPU core
+    juce::ThreadPool threadPool{ juce::jmax(1, juce::SystemStats::getNumCpus()) };
+
+    // Stores the files which have been scanned but not yet committed to the library, locked by resultsLock
+    std::vector<ImportResult> scannedResults;
+    juce::CriticalSection resultsLock;
+
+    // Counts the files queued for scanning in the current import and the files the worker threads have finished with
+    std::atomic<int> numFilesQueued{ 0 };
+    std::atomic<int> numFilesScanned{ 0 };
+
+    // Counts the folders which are still being searched for audio files
+    std::atomic<int> numFoldersScanning{ 0 };
+
+    // The progress of the current import between 0 and 1, displayed by the PlaylistComponent's progress bar
+    double progress = 0.0;
+
+    // How many files each FileScanJob opens, so that the thread pool is not flooded with thousands of tiny jobs
+    static constexpr int filesPerJob = 32;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackImporter)
+};
@@ -0,0 +1,457 @@
+/*
+  ==============================================================================
+
+    TrackSearcher.cpp
+    Created: 19 Oct 2026 6:58:40pm
+    Author:  Ophelia
+    Purpose: finds the tracks whose title, artist or album match what the user typed into the search box,
+             allowing for typos, and ranks them from the best match to the worst
+
+  ==============================================================================
+*/
+
+#include "TrackSearcher.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+/** Constructor: starts one worker thread for each CPU core, which share the work of searching large libraries */
+TrackSearcher::TrackSearcher()
+{
+}
+
+/** Destructor: stops the worker threads */
+TrackSearcher::~TrackSearcher()
+{
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/** Throws away the folded text of the tracks, as the tracks have been added to, deleted or changed */
+void TrackSearcher::invalidate()
+{
+    numIndexedTracks = -1;
+}
+
+/**
+ *Returns the positions in the tracks vector of (at most) maxResults tracks which match the query, best match first.
+ *Tracks are ranked by their number of typos, then by whether the match is in the title, artist or album,
+ *then by how short the matched text is (so an exact title is ranked above a longer title containing it)
+ */
+std::vector<size_t> TrackSearcher::search(std::vector<Track>& tracks, const juce::String& query, size_t maxResults)
+{
+    buildIndex(tracks);
+
+    // Each word of the query is matched on its own, so "daft one more" finds "One More Time" by Daft Punk
+    juce::StringArray words;
+    words.addTokens(juce::String(foldText(query)), " \t", "");
+    words.removeEmptyStrings();
+
+    std::vector<SearchTerm> terms;
+    for (const juce::String& word : words)
+    {
+        std::string bytes = word.toStdString();
+        int length = juce::jmin((int)bytes.size(), maxTermLength);
+
+        SearchTerm term{};
+        for (int i = 0; i < length; ++i)
+        {
+            term.positionsOfByte[(juce::uint8)bytes[(size_t)i]] |= (juce::uint64)1 << i;
+            term.characterBits |= getCharacterBit((juce::uint8)bytes[(size_t)i]);
+        }
+        term.lastPositionBit = (juce::uint64)1 << (length - 1);
+
+        // Short words must be typed exactly, as a single typo in a 3-letter word matches almost every track
+        term.maxTypos = length <= 3 ? 0 : (length <= 7 ? 1 : 2);
+        terms.push_back(term);
+    }
+
+    if (terms.empty())
+    {
+        return {};
+    }
+
+    // Each term is matched against every distinct word once, so each track only has to look up the typos of its words
+    std::vector<std::vector<juce::uint8>> wordTypos(terms.size());
+    size_t numWords = wordCharacterBits.size();
+    for (size_t i = 0; i < terms.size(); ++i)
+    {
+        const SearchTerm& term = terms[i];
+        wordTypos[i].resize(numWords);
+        for (size_t w = 0; w < numWords; ++w)
+        {
+            // Each letter of the term which is nowhere in the word needs a typo, so most words are skipped here
+            wordTypos[i][w] = isMissingTooManyCharacters(term.characterBits & ~wordCharacterBits[w], term.maxTypos)
+                ? (juce::uint8)(term.maxTypos + 1)
+                : (juce::uint8)countTypos(term, wordText.data() + wordStarts[w], wordStarts[w + 1] - wordStarts[w]);
+        }
+    }
+
+    // Large libraries are split into one chunk for each worker thread, which are searched at the same time
+    std::vector<Match> matches;
+    size_t numTracks = (size_t)numIndexedTracks;
+    int numChunks = numTracks < minParallelSearchSize ? 1 : threadPool.getNumThreads();
+    if (numChunks < 2)
+    {
+        searchRange(terms, wordTypos, 0, numTracks, matches);
+    }
+    else
+    {
+        std::vector<std::vector<Match>> chunkMatches((size_t)numChunks);
+        runOnWorkerThreads(numChunks, [&](int chunk)
+            {
+                searchRange(terms, wordTypos, numTracks * (size_t)chunk / (size_t)numChunks,
+                    numTracks * (size_t)(chunk + 1) / (size_t)numChunks, chunkMatches[(size_t)chunk]);
+            });
+        for (std::vector<Match>& chunk : chunkMatches)
+        {
+            matches.insert(matches.end(), chunk.begin(), chunk.end());
+        }
+    }
+
+    // Only the best maxResults matches are put in order, as a short query can match most of the library
+    auto isBetter = [](const Match& a, const Match& b)
+        {
+            return a.score != b.score ? a.score < b.score : a.trackIndex < b.trackIndex;
+        };
+    if (matches.size() > maxResults)
+    {
+        std::nth_element(matches.begin(), matches.begin() + (std::ptrdiff_t)maxResults, matches.end(), isBetter);
+        matches.resize(maxResults);
+    }
+    std::sort(matches.begin(), matches.end(), isBetter);
+
+    std::vector<size_t> results;
+    results.reserve(matches.size());
+    for (const Match& match : matches)
+    {
+        results.push_back(match.trackIndex);
+    }
+
+    return results;
+}
+
+/** Folds the title, artist and album of every track and splits them into words, if this has not been done since the library last changed */
+void TrackSearcher::buildIndex(std::vector<Track>& tracks)
+{
+    if (numIndexedTracks == (juce::int64)tracks.size())
+    {
+        return;
+    }
+
+    wordText.clear();
+    wordStarts.clear();
+    wordCharacterBits.clear();
+    fieldWords.clear();
+    fieldStarts.clear();
+    fieldStarts.reserve(tracks.size() * numFields + 1);
+    fieldLengths.clear();
+    fieldLengths.reserve(tracks.size() * numFields);
+    fieldCharacterBits.clear();
+    fieldCharacterBits.reserve(tracks.size() * numFields);
+
+    // A hash table of the distinct words, which is only needed while the words are being collected (see addWord)
+    std::vector<juce::uint32> wordSlots(initialWordSlots, 0);
+
+    for (Track& track : tracks)
+    {
+        for (const std::string& field : { track.getTitle(), track.getArtist(), track.getAlbum() })
+        {
+            fieldStarts.push_back((juce::uint32)fieldWords.size());
+            std::string folded = foldText(juce::String(field));
+            fieldLengths.push_back((juce::uint16)juce::jmin(folded.size(), (size_t)999));
+
+            juce::uint64 characterBits = 0;
+            for (char byte : folded)
+            {
+                characterBits |= getCharacterBit((juce::uint8)byte);
+            }
+            fieldCharacterBits.push_back(characterBits);
+
+            // The words are split at spaces and tabs, as the query is
+            for (size_t wordStart = 0; wordStart < folded.size();)
+            {
+                size_t wordEnd = folded.find_first_of(" \t", wordStart);
+                if (wordEnd == std::string::npos)
+                {
+                    wordEnd = folded.size();
+                }
+
+                if (wordEnd > wordStart)
+                {
+                    fieldWords.push_back(addWord(folded.data() + wordStart, wordEnd - wordStart, wordSlots));
+                }
+                wordStart = wordEnd + 1;
+            }
+        }
+    }
+    fieldStarts.push_back((juce::uint32)fieldWords.size());
+    wordStarts.push_back((juce::uint32)wordText.size());
+
+    numIndexedTracks = (juce::int64)tracks.size();
+}
+
+/**
+ *Returns the number of the word, adding it to the distinct words if it is new. wordSlots is an open-addressing hash
+ *table of the distinct words, which holds each word's number plus one (so an empty slot is 0)
+ */
+juce::uint32 TrackSearcher::addWord(const char* bytes, size_t length, std::vector<juce::uint32>& wordSlots)
+{
+    size_t mask = wordSlots.size() - 1;
+    size_t slot = hashWord(bytes, length) & mask;
+    for (; wordSlots[slot] != 0; slot = (slot + 1) & mask)
+    {
+        size_t number = wordSlots[slot] - 1;
+        size_t wordEnd = number + 1 < wordStarts.size() ? wordStarts[number + 1] : wordText.size();
+        if (wordEnd - wordStarts[number] == length && std::memcmp(wordText.data() + wordStarts[number], bytes, length) == 0)
+        {
+            return (juce::uint32)number;
+        }
+    }
+
+    juce::uint32 number = (juce::uint32)wordStarts.size();
+    wordStarts.push_back((juce::uint32)wordText.size());
+    wordText.append(bytes, length);
+
+    juce::uint64 characterBits = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        characterBits |= getCharacterBit((juce::uint8)bytes[i]);
+    }
+    wordCharacterBits.push_back(characterBits);
+
+    // The table is kept at most half full, so that a word is found within a few slots of where its hash points
+    if (wordStarts.size() * 2 <= wordSlots.size())
+    {
+        wordSlots[slot] = number + 1;
+        return number;
+    }
+
+    wordSlots.assign(wordSlots.size() * 2, 0);
+    mask = wordSlots.size() - 1;
+    for (size_t w = 0; w < wordStarts.size(); ++w)
+    {
+        size_t wordEnd = w + 1 < wordStarts.size() ? wordStarts[w + 1] : wordText.size();
+        slot = hashWord(wordText.data() + wordStarts[w], wordEnd - wordStarts[w]) & mask;
+        while (wordSlots[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        wordSlots[slot] = (juce::uint32)w + 1;
+    }
+    return number;
+}
+
+/** Returns the FNV-1a hash of the word's bytes */
+juce::uint32 TrackSearcher::hashWord(const char* bytes, size_t length)
+{
+    juce::uint32 hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ (juce::uint8)bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ *Scores the tracks in the range [begin, end) against the terms, adding the ones which match to the matches.
+ *wordTypos holds the number of typos of each term in each distinct word
+ */
+void TrackSearcher::searchRange(const std::vector<SearchTerm>& terms, const std::vector<std::vector<juce::uint8>>& wordTypos,
+    size_t begin, size_t end, std::vector<Match>& matches) const
+{
+    for (size_t t = begin; t < end; ++t)
+    {
+        juce::uint32 score = 0;
+        bool isMatch = true;
+
+        for (size_t i = 0; i < terms.size(); ++i)
+        {
+            const SearchTerm& term = terms[i];
+            const juce::uint8* typosInWord = wordTypos[i].data();
+
+            // Finds the field with the fewest typos, preferring the title, then the artist, then the album
+            int bestTypos = term.maxTypos + 1;
+            int bestField = 0;
+            juce::uint32 bestLength = 0;
+            for (int f = 0; f < numFields && bestTypos > 0; ++f)
+            {
+                size_t field = t * numFields + (size_t)f;
+
+                // Each letter of the term which is nowhere in the field needs a typo, so most fields are skipped here
+                if (isMissingTooManyCharacters(term.characterBits & ~fieldCharacterBits[field], term.maxTypos))
+                {
+                    continue;
+                }
+
+                int typos = term.maxTypos + 1;
+                for (juce::uint32 w = fieldStarts[field]; w < fieldStarts[field + 1] && typos > 0; ++w)
+                {
+                    typos = juce::jmin(typos, (int)typosInWord[fieldWords[w]]);
+                }
+                if (typos < bestTypos)
+                {
+                    bestTypos = typos;
+                    bestField = f;
+                    bestLength = fieldLengths[field];
+                }
+            }
+
+            if (bestTypos > term.maxTypos)
+            {
+                isMatch = false;
+                break;
+            }
+            score += (juce::uint32)bestTypos * 10000 + (juce::uint32)bestField * 1000 + bestLength;
+        }
+
+        if (isMatch)
+        {
+            matches.push_back(Match{ score, (juce::uint32)t });
+        }
+    }
+}
+
+/**
+ *Returns the least number of typos needed for the term to appear somewhere in the text (Myers' algorithm),
+ *stopping early if the term is found without any typos
+ */
+int TrackSearcher::countTypos(const SearchTerm& term, const char* text, size_t length)
+{
+    // Bit i of these says whether the number of typos for the first i + 1 letters of the word goes up (or down)
+    // by one from the first i letters, for a match ending at the current letter of the text
+    juce::uint64 positiveVertical = ~(juce::uint64)0;
+    juce::uint64 negativeVertical = 0;
+
+    // The previous letter's diagonal and matching positions, which are needed to spot two swapped letters
+    juce::uint64 previousDiagonal = 0;
+    juce::uint64 previousEqual = 0;
+
+    // Before any text has been read, every letter of the word is missing
+    int typos = juce::countNumberOfBits(term.lastPositionBit * 2 - 1);
+    int fewestTypos = typos;
+
+    for (size_t i = 0; i < length && fewestTypos > 0; ++i)
+    {
+        juce::uint64 equal = term.positionsOfByte[(juce::uint8)text[i]];
+        juce::uint64 swapped = (((~previousDiagonal) & equal) << 1) & previousEqual;
+        juce::uint64 diagonal = (((equal & positiveVertical) + positiveVertical) ^ positiveVertical) | equal | negativeVertical | swapped;
+        juce::uint64 positiveHorizontal = negativeVertical | ~(diagonal | positiveVertical);
+        juce::uint64 negativeHorizontal = positiveVertical & diagonal;
+
+        if (positiveHorizontal & term.lastPositionBit)
+        {
+            ++typos;
+        }
+        else if (negativeHorizontal & term.lastPositionBit)
+        {
+            --typos;
+        }
+
+        // Nothing is shifted into the first bit, as the match can start anywhere in the text
+        positiveHorizontal <<= 1;
+        negativeHorizontal <<= 1;
+        positiveVertical = negativeHorizontal | ~(diagonal | positiveHorizontal);
+        negativeVertical = positiveHorizontal & diagonal;
+        previousDiagonal = diagonal;
+        previousEqual = equal;
+
+        fewestTypos = juce::jmin(fewestTypos, typos);
+    }
+
+    return fewestTypos;
+}
+
+/** Returns the text in lower case, with the accents taken off Latin letters (so "Beyoncé" can be found by typing "beyonce") */
+std::string TrackSearcher::foldText(const juce::String& text)
+{
+    // The letters without accents of the lower case Latin-1 letters from U+00E0 (a with a grave accent) to U+00FF,
+    // or a space for the division sign, which is left as it is
+    static const char* const latin1Letters = "aaaaaaaceeeeiiiidnooooo ouuuuyty";
+
+    juce::String lowerCase = text.toLowerCase();
+    std::string folded;
+    folded.reserve((size_t)lowerCase.getNumBytesAsUTF8());
+
+    for (juce::String::CharPointerType p = lowerCase.getCharPointer(); !p.isEmpty();)
+    {
+        juce::juce_wchar character = p.getAndAdvance();
+        if (character >= 0xE0 && character <= 0xFF && latin1Letters[character - 0xE0] != ' ')
+        {
+            folded += latin1Letters[character - 0xE0];
+        }
+        else if (character == 0xDF)
+        {
+            // A German sharp s
+            folded += "ss";
+        }
+        else if (character < 0x80)
+        {
+            folded += (char)character;
+        }
+        else
+        {
+            // Any other character is kept as its UTF-8 bytes
+            char bytes[8] = {};
+            juce::CharPointer_UTF8 writer(bytes);
+            writer.write(character);
+            folded += bytes;
+        }
+    }
+
+    return folded;
+}
+
+/**
+ *Returns the bit which stands for the byte in a 64-bit set of characters. A track can only match a word if the
+ *track's set has all but maxTypos of the word's bits, which rules out most tracks without reading their text
+ */
+juce::uint64 TrackSearcher::getCharacterBit(juce::uint8 byte)
+{
+    // Letters and digits have a bit each, and every other byte shares the remaining 28 bits
+    int bit;
+    if (byte >= 'a' && byte <= 'z')
+    {
+        bit = byte - 'a';
+    }
+    else if (byte >= '0' && byte <= '9')
+    {
+        bit = 26 + byte - '0';
+    }
+    else
+    {
+        bit = 36 + byte % 28;
+    }
+    return (juce::uint64)1 << bit;
+}
+
+/** Returns true if more than maxTypos bits are set in missingCharacterBits (the bits of a term's letters which a field or word doesn't have) */
+bool TrackSearcher::isMissingTooManyCharacters(juce::uint64 missingCharacterBits, int maxTypos)
+{
+    // Clears the lowest set bit once for each typo allowed, which is quicker than counting every bit
+    for (int i = 0; i < maxTypos; ++i)
+    {
+        missingCharacterBits &= missingCharacterBits - 1;
+    }
+    return missingCharacterBits != 0;
+}
+
+/** Runs numJobs jobs on the worker threads, passing each one its number, and waits for all of them to finish */
+void TrackSearcher::runOnWorkerThreads(int numJobs, std::function<void(int)> job)
+{
+    std::atomic<int> numRemaining{ numJobs };
+    juce::WaitableEvent allFinished;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        threadPool.addJob([&job, &numRemaining, &allFinished, i]
+            {
+                job(i);
+                if (--numRemaining == 0)
+                {
+                    allFinished.signal();
+                }
+            });
+    }
+
+    allFinished.wait();
+}
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    TrackSearcher.h
+    Created: 19 Oct 2026 6:58:40pm
+    Author:  Ophelia
+    Purpose: finds the tracks whose title, artist or album match what the user typed into the search box,
+             allowing for typos, and ranks them from the best match to the worst
+
+  ==============================================================================
+  Every word of the search must appear in a word of the title, artist or album of a track, with up to one typo
+  (a missing, extra or wrong letter, or two letters swapped around) in words of 4 to 7 letters and up to two
+  in longer words. The number of typos is worked out with Myers' bit-parallel algorithm, which compares each
+  letter of the track's text against every letter of the word at once, using one 64-bit integer per word,
+  with Hyyrö's change to count swapped letters as a single typo.
+  Attribution: G. Myers, "A fast bit-vector algorithm for approximate string matching based on dynamic programming",
+  Journal of the ACM 46(3), 1999, and H. Hyyrö, "A bit-vector algorithm for computing Levenshtein and Damerau
+  edit distances", Nordic Journal of Computing 10(1), 2003.
+
+  The text of every track is folded (lower case, without accents) and split into words the first time the library
+  is searched, and kept until the library changes. Each distinct word is stored once, and every field is stored as the
+  numbers of its words, so a search only runs Myers' algorithm once for each distinct word in the library (far fewer
+  than the words of every track, as titles, artists and albums share most of their words), and then looks up the
+  typos of each track's words.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Track.h"
+
+class TrackSearcher
+{
+public:
+    /** Constructor: starts one worker thread for each CPU core, which share the work of searching large libraries */
+    TrackSearcher();
+
+    /** Destructor: stops the worker threads */
+    ~TrackSearcher();
+
+    /** Throws away the folded text of the tracks, as the tracks have been added to, deleted or changed */
+    void invalidate();
+
+    /**
+     *Returns the positions in the tracks vector of (at most) maxResults tracks which match the query, best match first.
+     *Tracks are ranked by their number of typos, then by whether the match is in the title, artist or album,
+     *then by how short the matched text is (so an exact title is ranked above a longer title containing it)
+     */
+    std::vector<size_t> search(std::vector<Track>& tracks, const juce::String& query, size_t maxResults);
+
+private:
+    /** One word of the query, ready to be matched against the tracks' text */
+    struct SearchTerm
+    {
+        // For every byte value, the bits of the positions in the word which hold that byte
+        juce::uint64 positionsOfByte[256];
+        // The bit of the word's last letter
+        juce::uint64 lastPositionBit;
+        // The bits (see getCharacterBit) of every letter in the word
+        juce::uint64 characterBits;
+        // The number of typos allowed in the word
+        int maxTypos;
+    };
+
+    /** A track which matches the query, and its score (lower is better) */
+    struct Match
+    {
+        juce::uint32 score;
+        juce::uint32 trackIndex;
+    };
+
+    /** Folds the title, artist and album of every track and splits them into words, if this has not been done since the library last changed */
+    void buildIndex(std::vector<Track>& tracks);
+
+    /**
+     *Returns the number of the word, adding it to the distinct words if it is new. wordSlots is an open-addressing hash
+     *table of the distinct words, which holds each word's number plus one (so an empty slot is 0)
+     */
+    juce::uint32 addWord(const char* bytes, size_t length, std::vector<juce::uint32>& wordSlots);
+
+    /** Returns the FNV-1a hash of the word's bytes */
+    static juce::uint32 hashWord(const char* bytes, size_t length);
+
+    /**
+     *Scores the tracks in the range [begin, end) against the terms, adding the ones which match to the matches.
+     *wordTypos holds the number of typos of each term in each distinct word
+     */
+    void searchRange(const std::vector<SearchTerm>& terms, const std::vector<std::vector<juce::uint8>>& wordTypos,
+        size_t begin, size_t end, std::vector<Match>& matches) const;
+
+    /**
+     *Returns the least number of typos needed for the term to appear somewhere in the text (Myers' algorithm,
+     *counting swapped letters as one typo), stopping early if the term is found without any typos
+     */
+    static int countTypos(const SearchTerm& term, const char* text, size_t length);
+
+    /** Returns the text in lower case, with the accents taken off Latin letters (so "Beyoncé" can be found by typing "beyonce") */
+    static std::string foldText(const juce::String& text);
+
+    /**
+     *Returns the bit which stands for the byte in a 64-bit set of characters. A field can only match a word if the
+     *field's set has all but maxTypos of the word's bits, which rules out most fields without reading their text
+     */
+    static juce::uint64 getCharacterBit(juce::uint8 byte);
+
+    /** Returns true if more than maxTypos bits are set in missingCharacterBits (the bits of a term's letters which a field or word doesn't have) */
+    static bool isMissingTooManyCharacters(juce::uint64 missingCharacterBits, int maxTypos);
+
+    /** Runs numJobs jobs on the worker threads, passing each one its number, and waits for all of them to finish */
+    void runOnWorkerThreads(int numJobs, std::function<void(int)> job);
+
+    // The fields of a track which are searched, in the order they are ranked: a match in the title beats one in the album
+    static constexpr int numFields = 3;
+
+    // Words longer than this are cut short, as Myers' algorithm keeps one bit for each letter of the word in a 64-bit integer
+    static constexpr int maxTermLength = 64;
+
+    // The size of the hash table of distinct words when the index starts to be built (a power of two, which it doubles from)
+    static constexpr size_t initialWordSlots = 4096;
+
+    // Libraries smaller than this are searched on the message thread, as starting the worker threads would take longer
+    static constexpr size_t minParallelSearchSize = 20000;
+
+    // Every distinct folded word of the tracks' fields, one after the other
+    std::string wordText;
+
+    // Where each word starts in wordText: word w starts at wordStarts[w], and ends where the next word starts
+    std::vector<juce::uint32> wordStarts;
+
+    // The bits (see getCharacterBit) of every character in each word
+    std::vector<juce::uint64> wordCharacterBits;
+
+    // The numbers of the words of every track's fields, one field after the other
+    std::vector<juce::uint32> fieldWords;
+
+    // Where each field's words start in fieldWords: field f of track t starts at fieldStarts[t * numFields + f], and ends where the next field starts
+    std::vector<juce::uint32> fieldStarts;
+
+    // The length of each folded field (up to 999 letters, as longer fields are not told apart when ranking), in the same order as fieldStarts
+    std::vector<juce::uint16> fieldLengths;
+
+    // The bits (see getCharacterBit) of every character in each field, in the same order as fieldStarts
+    std::vector<juce::uint64> fieldCharacterBits;
+
+    // The number of tracks which the text block was built from, or -1 if it needs to be built again
+    juce::int64 numIndexedTracks = -1;
+
+    // Shares the searching of large libraries between the CPU cores
+    juce::ThreadPool threadPool{ juce::jmax(1, juce::SystemStats::getNumCpus()) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackSearcher)
+};
@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    TrackSorter.cpp
+    Created: 19 Oct 2026 6:31:05pm
+    Author:  Ophelia
+    Purpose: sorts the rows of the music library by one or more columns, using sort keys
+             which are worked out once for every track instead of comparing strings in every sort
+
+  ==============================================================================
+*/
+
+#include "TrackSorter.h"
+#include "KeyDetector.h"
+#include <algorithm>
+#include <atomic>
+
+/** Constructor: starts one worker thread for each CPU core, which share the work of sorting large libraries */
+TrackSorter::TrackSorter()
+{
+}
+
+/** Destructor: stops the worker threads */
+TrackSorter::~TrackSorter()
+{
+    threadPool.removeAllJobs(true, 5000);
+}
+
+/** Throws away the ranks worked out so far, as the tracks have been added to, deleted or changed */
+void TrackSorter::invalidate()
+{
+    for (std::vector<juce::uint32>& keyRanks : ranks)
+    {
+        keyRanks.clear();
+    }
+}
+
+/**
+ *Sorts the indices (of tracks shown in the table) by the given columns: the first column decides the order,
+ *and each column after it only orders the tracks which are equal in all of the columns before it. Tracks which
+ *are equal in every column stay in the order they were added, so the sort is stable. Empty values
+ *(e.g. a track without a BPM tag) always go to the bottom, whichever direction the column is sorted in
+ */
+void TrackSorter::sort(std::vector<Track>& tracks, std::vector<size_t>& indices, const std::vector<SortColumn>& sortColumns)
+{
+    if (indices.empty())
+    {
+        return;
+    }
+    for (const SortColumn& column : sortColumns)
+    {
+        computeRanks(tracks, column.sortKey);
+    }
+
+    // Each track is sorted as one 64-bit integer: the value being sorted by in the top half, and the track's index in the
+    // bottom half. The first pass puts the tracks in the order they were added, which decides between tracks equal in every column
+    std::vector<juce::uint64> keys(indices.size());
+    std::vector<juce::uint64> scratch(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        keys[i] = (juce::uint64)indices[i] << 32 | (juce::uint32)indices[i];
+    }
+    radixSort(keys, scratch);
+
+    // The columns are sorted by from the last to the first, and each pass keeps the order of the tracks it finds equal,
+    // so each column only orders the tracks which are equal in all of the columns before it
+    for (auto column = sortColumns.rbegin(); column != sortColumns.rend(); ++column)
+    {
+        const juce::uint32* keyRanks = ranks[column->sortKey].data();
+        for (juce::uint64& key : keys)
+        {
+            juce::uint32 trackIndex = (juce::uint32)key;
+            juce::uint32 rank = keyRanks[trackIndex];
+
+            // Turning the rank round sorts the column backwards, while empty values stay at the bottom
+            if (!column->isForwards && rank != emptyValue)
+            {
+                rank = emptyValue - 1 - rank;
+            }
+            key = (juce::uint64)rank << 32 | trackIndex;
+        }
+        radixSort(keys, scratch);
+    }
+
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = (juce::uint32)keys[i];
+    }
+}
+
+/** Works out the rank of every track for the given key, if it has not been worked out since the library last changed */
+void TrackSorter::computeRanks(std::vector<Track>& tracks, SortKey sortKey)
+{
+    std::vector<juce::uint32>& keyRanks = ranks[sortKey];
+    if (keyRanks.size() == tracks.size())
+    {
+        return;
+    }
+    keyRanks.assign(tracks.size(), juce::uint32(emptyValue));
+
+    // The tracks were added in the order they are stored in
+    if (sortKey == dateAdded)
+    {
+        for (size_t i = 0; i < tracks.size(); ++i)
+        {
+            keyRanks[i] = (juce::uint32)i;
+        }
+        return;
+    }
+
+    // Durations, BPMs and keys are already numbers, so they do not need to be sorted to be ranked
+    if (sortKey == duration || sortKey == bpm || sortKey == key)
+    {
+        for (size_t i = 0; i < tracks.size(); ++i)
+        {
+            keyRanks[i] = getNumericValue(tracks[i], sortKey);
+        }
+        return;
+    }
+
+    // Text is ranked by sorting the collation keys once: every later sort by this column only compares the ranks
+    std::vector<std::string> collationKeys(tracks.size());
+    std::vector<size_t> order;
+    order.reserve(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        std::string text = sortKey == title ? tracks[i].getTitle() : tracks[i].getArtist();
+        if (!text.empty())
+        {
+            collationKeys[i] = getCollationKey(text);
+            order.push_back(i);
+        }
+    }
+
+    parallelSort(order, [&collationKeys](size_t a, size_t b)
+        {
+            return collationKeys[a] < collationKeys[b];
+        });
+
+    // Equal text has equal ranks, so the next column (or the order the tracks were added in) decides their order
+    juce::uint32 rank = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (i > 0 && collationKeys[order[i]] != collationKeys[order[i - 1]])
+        {
+            ++rank;
+        }
+        keyRanks[order[i]] = rank;
+    }
+}
+
+/** Returns a numeric value which sorts in the same order as the track's duration, BPM or key, or emptyValue if it has none */
+juce::uint32 TrackSorter::getNumericValue(Track& track, SortKey sortKey)
+{
+    if (sortKey == duration)
+    {
+        // The duration is stored as HH:MM:SS
+        juce::StringArray parts;
+        parts.addTokens(juce::String(track.getDuration()), ":", "");
+        if (parts.size() != 3)
+        {
+            return emptyValue;
+        }
+        return (juce::uint32)(parts[0].getIntValue() * 3600 + parts[1].getIntValue() * 60 + parts[2].getIntValue());
+    }
+
+    // Keys are sorted round the Camelot wheel rather than alphabetically, so that keys which mix well are next to each other.
+    // The key worked out from the audio is used if the track has been analysed, as it is shown in place of the tag
+    if (sortKey == key)
+    {
+        int keyNumber = KeyDetector::parseKey(juce::String(track.getAnalysedKey()));
+        if (keyNumber < 0)
+        {
+            keyNumber = KeyDetector::parseKey(juce::String(track.getKey()));
+        }
+        return keyNumber < 0 ? emptyValue : (juce::uint32)KeyDetector::getCamelotRank(keyNumber);
+    }
+
+    // BPMs can have decimals (e.g. 127.5), so they are stored in hundredths of a beat.
+    // The BPM worked out from the audio is used if the track has been analysed, as it is shown in place of the tag
+    double beatsPerMinute = track.getAnalysedBpm() > 0.0 ? track.getAnalysedBpm() : juce::String(track.getBpm()).getDoubleValue();
+    if (beatsPerMinute <= 0.0 || beatsPerMinute > 10000.0)
+    {
+        return emptyValue;
+    }
+    return (juce::uint32)juce::roundToInt(beatsPerMinute * 100.0);
+}
+
+/**
+ *Returns a string which sorts in the same order as the track's title or artist when compared byte by byte:
+ *it ignores case, and pads every number with zeros so that "Track 2" sorts before "Track 10"
+ */
+std::string TrackSorter::getCollationKey(const std::string& text)
+{
+    juce::String lowerCase = juce::String(text).toLowerCase();
+    juce::String collationKey;
+    collationKey.preallocateBytes(lowerCase.getNumBytesAsUTF8() + 16);
+
+    for (juce::String::CharPointerType p = lowerCase.getCharPointer(); !p.isEmpty();)
+    {
+        if (p.isDigit())
+        {
+            juce::String number;
+            while (p.isDigit())
+            {
+                number += p.getAndAdvance();
+            }
+            // Numbers longer than 10 digits are rare enough to be left as they are
+            collationKey += number.paddedLeft('0', 10);
+        }
+        else
+        {
+            collationKey += p.getAndAdvance();
+        }
+    }
+
+    // UTF-8 bytes sort in the same order as the characters they encode
+    return collationKey.toStdString();
+}
+
+/**
+ *Sorts the range with the comparator, splitting large ranges into one chunk for each worker thread.
+ *The chunks are sorted at the same time and then merged
+ */
+template <typename LessThan>
+void TrackSorter::parallelSort(std::vector<size_t>& range, LessThan lessThan)
+{
+    int numChunks = threadPool.getNumThreads();
+    if (range.size() < minParallelSortSize || numChunks < 2)
+    {
+        std::sort(range.begin(), range.end(), lessThan);
+        return;
+    }
+
+    std::vector<size_t> chunkStarts((size_t)numChunks + 1);
+    for (int i = 0; i <= numChunks; ++i)
+    {
+        chunkStarts[(size_t)i] = range.size() * (size_t)i / (size_t)numChunks;
+    }
+
+    runOnWorkerThreads(numChunks, [&](int chunk)
+        {
+            std::sort(range.begin() + chunkStarts[(size_t)chunk], range.begin() + chunkStarts[(size_t)chunk + 1], lessThan);
+        });
+
+    // Merges neighbouring pairs of sorted runs (which double in length each time) until only one run is left.
+    // The pairs in each pass do not overlap, so they are merged at the same time too
+    for (int runLength = 1; runLength < numChunks; runLength *= 2)
+    {
+        int numMerges = (numChunks + 2 * runLength - 1) / (2 * runLength);
+        runOnWorkerThreads(numMerges, [&, runLength](int merge)
+            {
+                int first = merge * 2 * runLength;
+                int middle = juce::jmin(first + runLength, numChunks);
+                int last = juce::jmin(first + 2 * runLength, numChunks);
+                if (middle < last)
+                {
+                    std::inplace_merge(range.begin() + chunkStarts[(size_t)first], range.begin() + chunkStarts[(size_t)middle],
+                        range.begin() + chunkStarts[(size_t)last], lessThan);
+                }
+            });
+    }
+}
+
+/**
+ *Sorts the keys by their top 32 bits, keeping the order of keys whose top 32 bits are equal (a least significant digit
+ *first radix sort, radixBits at a time). scratch must be the same size as keys, and is overwritten
+ */
+void TrackSorter::radixSort(std::vector<juce::uint64>& keys, std::vector<juce::uint64>& scratch)
+{
+    const juce::uint64 digitMask = (1 << radixBits) - 1;
+    std::vector<size_t> bucketStarts((size_t)1 << radixBits);
+
+    for (int shift = 32; shift < 64; shift += radixBits)
+    {
+        std::fill(bucketStarts.begin(), bucketStarts.end(), (size_t)0);
+        for (juce::uint64 key : keys)
+        {
+            ++bucketStarts[(size_t)((key >> shift) & digitMask)];
+        }
+
+        // A digit which every key has in common doesn't change their order (small ranks, such as keys or BPMs, have a lot of these)
+        if (bucketStarts[(size_t)((keys[0] >> shift) & digitMask)] == keys.size())
+        {
+            continue;
+        }
+
+        size_t start = 0;
+        for (size_t& bucketStart : bucketStarts)
+        {
+            size_t count = bucketStart;
+            bucketStart = start;
+            start += count;
+        }
+        for (juce::uint64 key : keys)
+        {
+            scratch[bucketStarts[(size_t)((key >> shift) & digitMask)]++] = key;
+        }
+        keys.swap(scratch);
+    }
+}
+
+/** Runs numJobs jobs on the worker threads, passing each one its number, and waits for all of them to finish */
+void TrackSorter::runOnWorkerThreads(int numJobs, std::function<void(int)> job)
+{
+    std::atomic<int> numRemaining{ numJobs };
+    juce::WaitableEvent allFinished;
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        threadPool.addJob([&job, &numRemaining, &allFinished, i]
+            {
+                job(i);
+                if (--numRemaining == 0)
+                {
+                    allFinished.signal();
+                }
+            });
+    }
+
+    allFinished.wait();
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    TrackSorter.h
+    Created: 19 Oct 2026 6:31:05pm
+    Author:  Ophelia
+    Purpose: sorts the rows of the music library by one or more columns, using sort keys
+             which are worked out once for every track instead of comparing strings in every sort
+
+  ==============================================================================
+  Each column's sort key is a "rank" for every track: the position of the track's value when all of the
+  values in that column are in order (equal values share a rank). Ranks are worked out the first time
+  a column is sorted and kept until the library changes, so sorting again (or in the other direction, or
+  by more columns) only sorts integers, and the tracks themselves are never copied or moved: only the
+  table's array of indices into the tracks is sorted. The integers are sorted with a radix sort, a column at a
+  time from the last column to the first, which reads each rank once per column instead of once per comparison.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <vector>
+#include "Track.h"
+
+class TrackSorter
+{
+public:
+    /** The values which the library can be sorted by */
+    enum SortKey
+    {
+        title,
+        artist,
+        duration,
+        bpm,
+        key,
+        // The order the tracks were added to the library in (their position in the tracks vector)
+        dateAdded,
+        numSortKeys
+    };
+
+    /** One of the columns which the library is sorted by, and its direction */
+    struct SortColumn
+    {
+        SortKey sortKey;
+        bool isForwards;
+    };
+
+    /** Constructor: starts one worker thread for each CPU core, which share the work of sorting large libraries */
+    TrackSorter();
+
+    /** Destructor: stops the worker threads */
+    ~TrackSorter();
+
+    /** Throws away the ranks worked out so far, as the tracks have been added to, deleted or changed */
+    void invalidate();
+
+    /**
+     *Sorts the indices (of tracks shown in the table) by the given columns: the first column decides the order,
+     *and each column after it only orders the tracks which are equal in all of the columns before it. Tracks which
+     *are equal in every column stay in the order they were added, so the sort is stable. Empty values
+     *(e.g. a track without a BPM tag) always go to the bottom, whichever direction the column is sorted in
+     */
+    void sort(std::vector<Track>& tracks, std::vector<size_t>& indices, const std::vector<SortColumn>& sortColumns);
+
+private:
+    /** Works out the rank of every track for the given key, if it has not been worked out since the library last changed */
+    void computeRanks(std::vector<Track>& tracks, SortKey sortKey);
+
+    /** Returns a numeric value which sorts in the same order as the track's duration, BPM or key, or emptyValue if it has none */
+    static juce::uint32 getNumericValue(Track& track, SortKey sortKey);
+
+    /**
+     *Returns a string which sorts in the same order as the track's title or artist when compared byte by byte:
+     *it ignores case, and pads every number with zeros so that "Track 2" sorts before "Track 10"
+     */
+    static std::string getCollationKey(const std::string& text);
+
+    /**
+     *Sorts the range with the comparator, splitting large ranges into one chunk for each worker thread.
+     *The chunks are sorted at the same time and then merged
+     */
+    template <typename LessThan>
+    void parallelSort(std::vector<size_t>& range, LessThan lessThan);
+
+    /**
+     *Sorts the keys by their top 32 bits, keeping the order of keys whose top 32 bits are equal (a least significant digit
+     *first radix sort, radixBits at a time). scratch must be the same size as keys, and is overwritten
+     */
+    static void radixSort(std::vector<juce::uint64>& keys, std::vector<juce::uint64>& scratch);
+
+    /** Runs numJobs jobs on the worker threads, passing each one its number, and waits for all of them to finish */
+    void runOnWorkerThreads(int numJobs, std::function<void(int)> job);
+
+    // The rank given to tracks without a value, which sorts them after all other tracks
+    static constexpr juce::uint32 emptyValue = 0xFFFFFFFF;
+
+    // The number of bits of the ranks sorted by in each pass of the radix sort: 3 passes cover a rank, and the counts of
+    // each digit's 2048 values fit in the CPU's fastest cache
+    static constexpr int radixBits = 11;
+
+    // Libraries smaller than this are sorted on the message thread, as starting the worker threads would take longer
+    static constexpr size_t minParallelSortSize = 50000;
+
+    // The rank of every track for each sort key, or an empty vector if it has not been worked out yet
+    std::vector<juce::uint32> ranks[numSortKeys];
+
+    // Shares the sorting of large libraries between the CPU cores
+    juce::ThreadPool threadPool{ juce::jmax(1, juce::SystemStats::getNumCpus()) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackSorter)
+};
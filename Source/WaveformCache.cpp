@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    WaveformCache.cpp
+    Created: 19 Oct 2026 6:07:12pm
+    Author:  Ophelia
+    Purpose: an AudioThumbnailCache which also saves the finished waveform thumbnails to disk,
+             so a track's waveform is only worked out once across restarts
+
+  ==============================================================================
+*/
+
+#include "WaveformCache.h"
+
+/** Constructor: keeps up to maxNumThumbnailsInMemory thumbnails in memory, and creates the folder which stores them on disk */
+WaveformCache::WaveformCache(int maxNumThumbnailsInMemory) : juce::AudioThumbnailCache(maxNumThumbnailsInMemory)
+{
+    diskCacheFolder = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile(ProjectInfo::projectName)
+        .getChildFile("WaveformThumbnails");
+    diskCacheFolder.createDirectory();
+}
+
+/** Destructor */
+WaveformCache::~WaveformCache()
+{
+}
+
+/**
+ *Overrides juce::AudioThumbnailCache's virtual function: called when a thumbnail which is not in memory is needed,
+ *and loads it from the disk cache if it was saved there. Returns true if it was loaded
+ */
+bool WaveformCache::loadNewThumbnail(juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode)
+{
+    juce::FileInputStream stream(getThumbnailFile(hashCode));
+    return stream.openedOk() && thumbnail.loadFrom(stream);
+}
+
+/** Overrides juce::AudioThumbnailCache's virtual function: called when a thumbnail has finished, and saves it to disk */
+void WaveformCache::saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode)
+{
+    // Written to a temporary file which then replaces the thumbnail file, so that a half-written thumbnail is never loaded
+    juce::File thumbnailFile = getThumbnailFile(hashCode);
+    juce::TemporaryFile tempFile(thumbnailFile);
+    {
+        juce::FileOutputStream stream(tempFile.getFile());
+        if (!stream.openedOk())
+        {
+            return;
+        }
+        thumbnail.saveTo(stream);
+    }
+    tempFile.overwriteTargetFileWithTemporary();
+}
+
+/**
+ *Saves a waveform thumbnail which was built somewhere else (e.g. by the TrackAnalyser, while it decoded the track) to the disk cache
+ *under the given hash code, so a deck which loads the track later finds it instead of decoding the track again
+ */
+void WaveformCache::storeWaveform(juce::int64 hashCode, const juce::MemoryBlock& thumbnailData)
+{
+    // Written the same way as saveNewlyFinishedThumbnail(), so that a half-written thumbnail is never loaded
+    juce::File thumbnailFile = getThumbnailFile(hashCode);
+    juce::TemporaryFile tempFile(thumbnailFile);
+    if (!tempFile.getFile().replaceWithData(thumbnailData.getData(), thumbnailData.getSize()))
+    {
+        return;
+    }
+    tempFile.overwriteTargetFileWithTemporary();
+}
+
+/** Returns the file on disk which stores the thumbnail with the given hash code */
+juce::File WaveformCache::getThumbnailFile(juce::int64 hashCode) const
+{
+    return diskCacheFolder.getChildFile(juce::String::toHexString(hashCode).paddedLeft('0', 16) + ".thumb");
+}
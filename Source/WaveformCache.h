@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    WaveformCache.h
+    Created: 19 Oct 2026 6:07:12pm
+    Author:  Ophelia
+    Purpose: an AudioThumbnailCache which also saves the finished waveform thumbnails to disk,
+             so a track's waveform is only worked out once across restarts
+
+  ==============================================================================
+  The thumbnails are saved under their hash code, which the WaveformDisplay takes from the track's content hash
+  (see TrackHasher), so a saved waveform is still found after the file is renamed or moved, and is shared
+  by duplicate copies of a track.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class WaveformCache : public juce::AudioThumbnailCache
+{
+public:
+    /** Constructor: keeps up to maxNumThumbnailsInMemory thumbnails in memory, and creates the folder which stores them on disk */
+    explicit WaveformCache(int maxNumThumbnailsInMemory);
+
+    /** Destructor */
+    ~WaveformCache() override;
+
+    /**
+     *Saves a waveform thumbnail which was built somewhere else (e.g. by the TrackAnalyser, while it decoded the track) to the disk cache
+     *under the given hash code, so a deck which loads the track later finds it instead of decoding the track again
+     */
+    void storeWaveform(juce::int64 hashCode, const juce::MemoryBlock& thumbnailData);
+
+protected:
+    /**
+     *Overrides juce::AudioThumbnailCache's virtual function: called when a thumbnail which is not in memory is needed,
+     *and loads it from the disk cache if it was saved there. Returns true if it was loaded
+     */
+    bool loadNewThumbnail(juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode) override;
+
+    /** Overrides juce::AudioThumbnailCache's virtual function: called when a thumbnail has finished, and saves it to disk */
+    void saveNewlyFinishedThumbnail(const juce::AudioThumbnailBase& thumbnail, juce::int64 hashCode) override;
+
+private:
+    /** Returns the file on disk which stores the thumbnail with the given hash code */
+    juce::File getThumbnailFile(juce::int64 hashCode) const;
+
+    // The folder which stores the thumbnails, named after their hash codes
+    juce::File diskCacheFolder;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformCache)
+};
@@ -2,6 +2,58 @@
 #include <JuceHeader.h>
 #include "WaveformDisplay.h"
 
+namespace
+{
+    /**
+     *An InputSource which reads the audio file through a URLInputSource, but whose hashCode (the key of the thumbnail
+     *in the AudioThumbnailCache) is the track's content hash instead of a hash of its URL
+     */
+    class ContentHashInputSource : public juce::InputSource
+    {
+    public:
+        ContentHashInputSource(const juce::URL& _url, juce::int64 _contentHashCode) : source(_url),
+            contentHashCode(_contentHashCode)
+        {
+        }
+
+        juce::InputStream* createInputStream() override
+        {
+            return source.createInputStream();
+        }
+
+        juce::InputStream* createInputStreamFor(const juce::String& relatedItemPath) override
+        {
+            return source.createInputStreamFor(relatedItemPath);
+        }
+
+        juce::int64 hashCode() const override
+        {
+            return contentHashCode;
+        }
+
+    private:
+        juce::URLInputSource source;
+        juce::int64 contentHashCode;
+    };
+
+    /**
+     *Returns the InputSource for a track's thumbnail. Tracks which have not been hashed yet are keyed by their path
+     *and modification time, so that the waveform saved to the disk cache is not reused after the file has changed
+     */
+    juce::InputSource* createThumbnailSource(const juce::URL& audioURL, const juce::String& contentHash)
+    {
+        if (contentHash.isNotEmpty())
+        {
+            return new ContentHashInputSource(audioURL, contentHash.getHexValue64());
+        }
+        if (audioURL.isLocalFile())
+        {
+            return new juce::FileInputSource(audioURL.getLocalFile(), true);
+        }
+        return new juce::URLInputSource(audioURL);
+    }
+}
+
 //==============================================================================
 WaveformDisplay::WaveformDisplay(
     juce::AudioFormatManager& formatManagerToUse,
@@ -88,8 +140,12 @@ void WaveformDisplay::resized()
 {
 }
 
-/* Loads the URL selected by the user into the thumbnail as well as into the audio player*/
-void WaveformDisplay::loadURL(juce::URL audioURL)
+/**
+ *Loads the URL selected by the user into the thumbnail as well as into the audio player.
+ *If the track's content hash is given, it is used as the thumbnail's key in the cache, so the waveform
+ *of a moved or duplicate file is found in the cache instead of being worked out again
+ */
+void WaveformDisplay::loadURL(juce::URL audioURL, const juce::String& contentHash)
 {
 
     // Clears the (drawer) audioThumb in case it drew anything previously
@@ -101,8 +157,8 @@ void WaveformDisplay::loadURL(juce::URL audioURL)
      * input source and call setSource on the thumbnail.
      * This function returns "true" if audioURL stream actually loads.
      */
-    fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL)); // Class-scope variable
-    fileLoaded = audioThumbPlayed.setSource(new juce::URLInputSource(audioURL));
+    fileLoaded = audioThumb.setSource(createThumbnailSource(audioURL, contentHash)); // Class-scope variable
+    fileLoaded = audioThumbPlayed.setSource(createThumbnailSource(audioURL, contentHash));
 }
 
 /**Virtual method inherited from ChangeListener to implement automatic waveform drawing*/
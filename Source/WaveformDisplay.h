@@ -25,8 +25,12 @@ public:
     /** Called when this component's size has been changed */
     void resized() override;
 
-    /* Loads the URL selected by the user into the thumbnail as well as into the audio player*/
-    void loadURL(juce::URL audioURL);
+    /**
+     *Loads the URL selected by the user into the thumbnail as well as into the audio player.
+     *If the track's content hash is given, it is used as the thumbnail's key in the cache, so the waveform
+     *of a moved or duplicate file is found in the cache instead of being worked out again
+     */
+    void loadURL(juce::URL audioURL, const juce::String& contentHash = {});
 
     /**Virtual method inherited from ChangeListener to implement automatic waveform drawing*/
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
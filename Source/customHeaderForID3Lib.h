@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+    All header files for the vendored id3lib external library (reads ID3 tag metadata) in here
+    customHeaderForID3Lib.h
+    Created: 19 Oct 2026 11:02:51am
+    Author:  Ophelia
+    Attribution: id3lib-3.8.3/id3lib-3.8.3/libprj/win32.readme.first.txt
+  ==============================================================================
+  The id3lib "include" folder is added to the Header Search Paths in the Projucer, and the
+  static library is built from id3lib-3.8.3/id3lib-3.8.3/libprj/id3lib.dsp (which needs
+  zlib/prj/zlib.dsp). ID3LIB_LINKOPTION=1 (static linking) is set in the Projucer's preprocessor definitions.
+*/
+
+#pragma once
+#include <id3/globals.h>
+#include <id3/tag.h>
+#include <id3/field.h>
+#include <id3/misc_support.h>
+#include <id3/utils.h>
+
+// Links the static id3lib (and the zlib it uses to decompress compressed frames) built by libprj/id3lib.dsp
+#if defined (_MSC_VER)
+  #if defined (_DEBUG)
+    #pragma comment(lib, "id3libD.lib")
+    #pragma comment(lib, "zlibD.lib")
+  #else
+    #pragma comment(lib, "id3lib.lib")
+    #pragma comment(lib, "zlib.lib")
+  #endif
+#endif
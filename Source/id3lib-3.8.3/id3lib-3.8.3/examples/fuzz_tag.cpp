@@ -0,0 +1,131 @@
+// $Id$
+
+// A fuzzing harness for the tag parser.  Each input is linked from memory as
+// if it were a whole file, so the ID3v2, ID3v1, Lyrics3 and MusicMatch parsers
+// all see it, and then every field of every frame is read and the tag is
+// rendered again.
+//
+// With libFuzzer, build it with ID3_LIBFUZZER defined:
+//
+//   clang++ -g -O1 -fsanitize=fuzzer,address -DID3_LIBFUZZER fuzz_tag.cpp libid3.a -lz -o fuzztag
+//   ./fuzztag corpus/
+//
+// Otherwise it has a main() which reads each file named on the command line
+// (or stdin if there are none), which is what AFL expects:
+//
+//   afl-fuzz -i seeds/ -o findings/ ./fuzztag @@
+//
+// The .tag files in this directory make a good seed corpus.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include "id3/tag.h"
+#include "id3/io_strings.h"
+
+using dami::BString;
+
+static void readFields(ID3_Frame* frame)
+{
+  ID3_Frame::Iterator* iter = frame->CreateIterator();
+  ID3_Field* field = NULL;
+  while (NULL != (field = iter->GetNext()))
+  {
+    switch (field->GetType())
+    {
+      case ID3FTY_INTEGER:
+        field->Get();
+        break;
+      case ID3FTY_BINARY:
+        field->GetRawBinary();
+        break;
+      case ID3FTY_TEXTSTRING:
+        for (size_t i = 0; i < field->GetNumTextItems(); ++i)
+        {
+          if (ID3TE_IS_DOUBLE_BYTE_ENC(field->GetEncoding()))
+          {
+            field->GetRawUnicodeTextItem(i);
+          }
+          else
+          {
+            field->GetRawTextItem(i);
+          }
+        }
+        // converting the text back and forth runs it through the converters
+        if (field->GetEncoding() == ID3TE_UTF16)
+        {
+          field->SetEncoding(ID3TE_ISO8859_1);
+          field->SetEncoding(ID3TE_UTF16);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  delete iter;
+}
+
+static void fuzzOne(const uchar* data, size_t size)
+{
+  BString buffer(data, size);
+  dami::io::BStringReader reader(buffer);
+  ID3_Tag tag;
+  tag.Link(reader);
+
+  ID3_Tag::Iterator* iter = tag.CreateIterator();
+  ID3_Frame* frame = NULL;
+  while (NULL != (frame = iter->GetNext()))
+  {
+    readFields(frame);
+  }
+  delete iter;
+
+  BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  tag.Render(writer, ID3TT_ID3V2);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uchar* data, size_t size)
+{
+  fuzzOne(data, size);
+  return 0;
+}
+
+#if !defined(ID3_LIBFUZZER)
+
+static void fuzzFile(FILE* file)
+{
+  BString data;
+  uchar buf[4096];
+  size_t size;
+  while ((size = fread(buf, 1, sizeof(buf), file)) > 0)
+  {
+    data.append(buf, size);
+  }
+  fuzzOne(data.data(), data.size());
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    fuzzFile(stdin);
+    return 0;
+  }
+  for (int i = 1; i < argc; ++i)
+  {
+    FILE* file = fopen(argv[i], "rb");
+    if (NULL == file)
+    {
+      perror(argv[i]);
+      return 1;
+    }
+    fuzzFile(file);
+    fclose(file);
+  }
+  return 0;
+}
+
+#endif /* !ID3_LIBFUZZER */
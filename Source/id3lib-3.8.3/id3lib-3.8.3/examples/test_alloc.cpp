@@ -0,0 +1,141 @@
+// $Id$
+
+// Counts the allocations made while linking each of the example tags, and
+// times how many tags a second can be linked.  Also checks that a tag renders
+// the same after it has been copied and had its frames' ids changed back and
+// forth, which frees and remakes each frame's fields.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <new>
+#include <time.h>
+#include <stdlib.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/io_strings.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+
+static size_t numAllocs = 0;
+
+void* operator new(size_t size)
+{
+  ++numAllocs;
+  void* p = malloc(size ? size : 1);
+  if (NULL == p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) throw ()
+{
+  free(p);
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete[](void* p) throw ()
+{
+  free(p);
+}
+
+static dami::BString render(const ID3_Tag& tag)
+{
+  dami::BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  tag.Render(writer, ID3TT_ID3V2);
+  return rendered;
+}
+
+int main(int argc, char* argv[])
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  const char* defaults[] =
+  {
+    "221-compressed.tag", "230-compressed.tag", "230-picture.tag",
+    "230-syncedlyrics.tag", "230-unicode.tag", "ozzy.tag", "thatspot.tag"
+  };
+  std::vector<const char*> files;
+  if (argc > 1)
+  {
+    files.assign(argv + 1, argv + argc);
+  }
+  else
+  {
+    files.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+  }
+
+  bool ok = true;
+  size_t totalAllocs = 0, totalFrames = 0;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    size_t before = numAllocs;
+    size_t numFrames = 0;
+    {
+      ID3_Tag tag(files[i]);
+      numFrames = tag.NumFrames();
+    }
+    size_t allocs = numAllocs - before;
+    totalAllocs += allocs;
+    totalFrames += numFrames;
+    cout << files[i] << ": " << allocs << " allocations for " << numFrames
+         << " frames" << endl;
+
+    ID3_Tag tag(files[i]);
+    dami::BString original = render(tag);
+    ID3_Tag copy(tag);
+    ID3_Tag::Iterator* iter = copy.CreateIterator();
+    ID3_Frame* frame = NULL;
+    while (NULL != (frame = iter->GetNext()))
+    {
+      // an unknown frame's id can't be set back again
+      if (frame->GetID() == ID3FID_NOFRAME)
+      {
+        continue;
+      }
+      ID3_Frame old(*frame);
+      frame->SetID(ID3FID_COMMENT);
+      *frame = old;
+    }
+    delete iter;
+    if (render(copy) != original)
+    {
+      cerr << "*** " << files[i] << ": renders differently after copying" << endl;
+      ok = false;
+    }
+  }
+  cout << "total: " << totalAllocs << " allocations for " << totalFrames
+       << " frames" << endl;
+
+  const size_t rounds = 500;
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+      ID3_Tag tag(files[i]);
+    }
+  }
+  double secs = double(clock() - start) / CLOCKS_PER_SEC;
+  cout << rounds * files.size() / secs << " tags a second" << endl;
+
+  if (!ok)
+  {
+    cerr << "*** allocation test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
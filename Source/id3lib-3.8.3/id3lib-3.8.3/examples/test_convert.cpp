@@ -0,0 +1,236 @@
+// $Id$
+
+// Checks the conversions between latin-1, utf-8 and utf-16 text, both
+// directly and through a text field's encoding, and that unicode text reads
+// back the same after it has been rendered.  Also times the conversions
+// against converting a character at a time.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <string.h>
+#include <time.h>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/utils.h"
+#include "id3/io_strings.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using dami::String;
+
+static bool ok = true;
+
+static void check(bool cond, const char* what)
+{
+  if (!cond)
+  {
+    cerr << "*** " << what << endl;
+    ok = false;
+  }
+}
+
+static String toUTF8(const String& utf16)
+{
+  String utf8(utf16.size() / 2 * 3, '\0');
+  utf8.resize(dami::utf16BEToUTF8(utf16.data(), utf16.size(), &utf8[0]));
+  return utf8;
+}
+
+static String toUTF16(const String& utf8)
+{
+  String utf16(utf8.size() * 2, '\0');
+  utf16.resize(dami::utf8ToUTF16BE(utf8.data(), utf8.size(), &utf16[0]));
+  return utf16;
+}
+
+static String toLatin1(const String& utf8)
+{
+  String latin1(utf8.size(), '\0');
+  latin1.resize(dami::utf8ToLatin1(utf8.data(), utf8.size(), &latin1[0]));
+  return latin1;
+}
+
+// the naive conversion which the word-at-a-time one is timed against
+static size_t slowLatin1ToUTF8(const char* source, size_t len, char* target)
+{
+  size_t size = 0;
+  for (size_t i = 0; i < len; ++i)
+  {
+    unsigned char ch = source[i];
+    if (ch < 0x80)
+    {
+      target[size++] = ch;
+    }
+    else
+    {
+      target[size++] = 0xC0 | (ch >> 6);
+      target[size++] = 0x80 | (ch & 0x3F);
+    }
+  }
+  return size;
+}
+
+static void checkConversions()
+{
+  // every latin-1 character survives a trip through utf-8 and utf-16
+  String latin1;
+  for (int ch = 1; ch < 256; ++ch)
+  {
+    latin1 += static_cast<char>(ch);
+  }
+  String utf16 = dami::convert(latin1, ID3TE_ISO8859_1, ID3TE_UTF16);
+  check(utf16.size() == latin1.size() * 2, "latin-1 to utf-16 size");
+  check(dami::convert(utf16, ID3TE_UTF16, ID3TE_ISO8859_1) == latin1,
+        "latin-1 through utf-16");
+  String utf8 = dami::convert(latin1, ID3TE_ISO8859_1, ID3TE_UTF8);
+  check(utf8.size() == 127 + 128 * 2, "latin-1 to utf-8 size");
+  check(dami::convert(utf8, ID3TE_UTF8, ID3TE_ISO8859_1) == latin1,
+        "latin-1 through utf-8");
+  check(toUTF8(utf16) == utf8, "utf-16 to utf-8");
+  check(toUTF16(utf8) == utf16, "utf-8 to utf-16");
+
+  // a character outside the basic plane needs a surrogate pair in utf-16
+  const char clef8[] = "G \xF0\x9D\x84\x9E clef";
+  const char clef16[] = "\0G\0 \xD8\x34\xDD\x1E\0 \0c\0l\0e\0f";
+  String clef(clef16, sizeof(clef16) - 1);
+  check(toUTF16(clef8) == clef, "utf-8 to surrogate pair");
+  check(toUTF8(clef) == clef8, "surrogate pair to utf-8");
+  check(dami::convert(clef, ID3TE_UTF16, ID3TE_ISO8859_1) == "G ? clef",
+        "surrogate pair to latin-1");
+
+  // invalid utf-8 (a stray continuation byte, an overlong form and a
+  // truncated character) is replaced rather than passed through
+  check(toUTF8(toUTF16("a\x80" "b\xC0\xAF" "c\xE2\x82")) ==
+        "a\xEF\xBF\xBD" "b\xEF\xBF\xBD\xEF\xBF\xBD" "c\xEF\xBF\xBD\xEF\xBF\xBD",
+        "invalid utf-8");
+  check(toLatin1("caf\xC3\xA9 \xE2\x82\xAC") == "caf\xE9 ?", "utf-8 to latin-1");
+
+  // an unpaired surrogate is replaced too
+  const char lone[] = "\xDC\x00\0a";
+  check(toUTF8(String(lone, sizeof(lone) - 1)) == "\xEF\xBF\xBD" "a",
+        "unpaired surrogate");
+}
+
+static dami::BString render(const ID3_Tag& tag)
+{
+  dami::BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  tag.Render(writer, ID3TT_ID3V2);
+  return rendered;
+}
+
+static void checkTag()
+{
+  // the TXXX frame in this tag is stored as little-endian utf-16
+  ID3_Tag tag("230-unicode.tag");
+  ID3_Frame* frame = tag.Find(ID3FID_USERTEXT);
+  check(NULL != frame, "230-unicode.tag has no TXXX frame");
+  if (NULL == frame)
+  {
+    return;
+  }
+  ID3_Field* desc = frame->GetField(ID3FN_DESCRIPTION);
+  ID3_Field* text = frame->GetField(ID3FN_TEXT);
+  check(desc->GetEncoding() == ID3TE_UTF16, "TXXX isn't in unicode");
+
+  // the tag reads back the same after it's rendered with a BOM in this
+  // machine's byte order
+  dami::BString rendered = render(tag);
+  ID3_Tag reparsed;
+  reparsed.Parse(rendered.data(), rendered.size());
+  check(render(reparsed) == rendered, "unicode tag renders differently");
+
+  desc->SetEncoding(ID3TE_ISO8859_1);
+  text->SetEncoding(ID3TE_ISO8859_1);
+  check(strcmp(desc->GetRawText(), "example text frame") == 0,
+        "TXXX description");
+  check(strcmp(text->GetRawText(),
+               "This text and the description should be in Unicode.") == 0,
+        "TXXX text");
+
+  // setting accented text in unicode survives a render too
+  text->Set("Caf\xE9");
+  text->SetEncoding(ID3TE_UTF16);
+  rendered = render(tag);
+  ID3_Tag accented;
+  accented.Parse(rendered.data(), rendered.size());
+  frame = accented.Find(ID3FID_USERTEXT);
+  check(NULL != frame, "TXXX frame lost");
+  if (NULL != frame)
+  {
+    text = frame->GetField(ID3FN_TEXT);
+    check(text->GetEncoding() == ID3TE_UTF16, "TXXX text lost its encoding");
+    text->SetEncoding(ID3TE_ISO8859_1);
+    check(strcmp(text->GetRawText(), "Caf\xE9") == 0, "accented text");
+  }
+}
+
+static void timeConversions()
+{
+  // mostly ASCII, like most tags, with the odd accented character
+  String latin1;
+  while (latin1.size() < 1024 * 1024)
+  {
+    latin1 += "Sigur R\xF3s - Hopp\xEDpolla (Live at the Royal Albert Hall) ";
+  }
+  String utf8(latin1.size() * 2, '\0');
+  const size_t rounds = 50;
+  double mb = double(latin1.size()) * rounds / (1024 * 1024);
+
+  clock_t start = clock();
+  size_t size = 0;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    size += slowLatin1ToUTF8(latin1.data(), latin1.size(), &utf8[0]);
+  }
+  double slow = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    size -= dami::latin1ToUTF8(latin1.data(), latin1.size(), &utf8[0]);
+  }
+  double fast = double(clock() - start) / CLOCKS_PER_SEC;
+  check(size == 0, "latin-1 to utf-8 size differs from the naive one");
+  cout << "latin-1 to utf-8: " << mb / fast << " MB/s (a character at a time: "
+       << mb / slow << " MB/s)" << endl;
+
+  String utf16 = dami::convert(latin1, ID3TE_ISO8859_1, ID3TE_UTF16);
+  start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    dami::utf16BEToUTF8(utf16.data(), utf16.size(), &utf8[0]);
+  }
+  double secs = double(clock() - start) / CLOCKS_PER_SEC;
+  cout << "utf-16 to utf-8: " << mb / secs << " MB/s" << endl;
+
+  const size_t tagRounds = 2000;
+  start = clock();
+  for (size_t r = 0; r < tagRounds; ++r)
+  {
+    ID3_Tag tag("230-unicode.tag");
+  }
+  secs = double(clock() - start) / CLOCKS_PER_SEC;
+  cout << tagRounds / secs << " unicode tags a second" << endl;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  checkConversions();
+  checkTag();
+  timeConversions();
+
+  if (!ok)
+  {
+    cerr << "*** conversion test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
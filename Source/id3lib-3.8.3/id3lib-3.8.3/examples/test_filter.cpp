@@ -0,0 +1,229 @@
+// $Id$
+
+// Checks that a tag linked with ID3_Tag::SetFramesToParse() has the same
+// wanted frames as a fully parsed one and none of the others, and that it
+// finds where a skipped picture's data is in the file.  Then times both kinds
+// of parse on the bundled tags and on a file with a large picture.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <string.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+#include "id3/io_strings.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+
+// the frames a music library reads from every file it imports
+static const ID3_FrameID wanted[] =
+{
+  ID3FID_TITLE, ID3FID_LEADARTIST, ID3FID_ALBUM, ID3FID_BPM,
+  ID3FID_INITIALKEY, ID3FID_SONGLEN
+};
+static const size_t numWanted = sizeof(wanted) / sizeof(wanted[0]);
+
+static bool isWanted(ID3_FrameID id)
+{
+  for (size_t i = 0; i < numWanted; ++i)
+  {
+    if (wanted[i] == id)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// collects the rendered bytes of the tag's frames with the wanted ids, in
+// list order
+static std::vector<dami::BString> wantedFrames(const ID3_Tag& tag, size_t& others)
+{
+  std::vector<dami::BString> frames;
+  others = 0;
+  ID3_Tag::ConstIterator* iter = tag.CreateIterator();
+  const ID3_Frame* frame = NULL;
+  while (NULL != (frame = iter->GetNext()))
+  {
+    if (!isWanted(frame->GetID()))
+    {
+      ++others;
+      continue;
+    }
+    dami::BString rendered;
+    dami::io::BStringWriter writer(rendered);
+    frame->Render(writer);
+    frames.push_back(rendered);
+  }
+  delete iter;
+  return frames;
+}
+
+static bool checkFilter(const char* file)
+{
+  ID3_Tag full;
+  full.Link(file, ID3TT_ID3V2);
+  ID3_Tag filtered;
+  filtered.SetFramesToParse(wanted, numWanted);
+  filtered.Link(file, ID3TT_ID3V2);
+
+  size_t fullOthers = 0, filteredOthers = 0;
+  if (wantedFrames(full, fullOthers) != wantedFrames(filtered, filteredOthers))
+  {
+    cerr << "*** " << file << ": the filtered parse found different frames" << endl;
+    return false;
+  }
+  if (filteredOthers != 0)
+  {
+    cerr << "*** " << file << ": the filtered parse kept unwanted frames" << endl;
+    return false;
+  }
+  if (full.GetPrependedBytes() != filtered.GetPrependedBytes())
+  {
+    cerr << "*** " << file << ": the filtered parse found a different tag size" << endl;
+    return false;
+  }
+  // skipped frames would be lost if the tag was written back
+  if (fullOthers != 0 && filtered.Update() != ID3TT_NONE)
+  {
+    cerr << "*** " << file << ": updated a tag with skipped frames" << endl;
+    return false;
+  }
+  return true;
+}
+
+// checks that the data of the skipped picture frame is found in the file
+static bool checkSkippedData(const char* file)
+{
+  ID3_Tag full;
+  full.Link(file, ID3TT_ID3V2);
+  const ID3_Frame* picture = full.Find(ID3FID_PICTURE);
+  ID3_Tag filtered;
+  filtered.SetFramesToParse(wanted, numWanted);
+  filtered.Link(file, ID3TT_ID3V2);
+
+  size_t offset = 0, size = 0;
+  if (!filtered.GetSkippedFrameData(ID3FID_PICTURE, offset, size))
+  {
+    cerr << "*** " << file << ": the skipped picture wasn't found" << endl;
+    return false;
+  }
+
+  // a frame renders as its 10 byte header followed by its data
+  dami::BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  picture->Render(writer);
+
+  std::vector<char> data(size);
+  ifstream in(file, ios::in | ios::binary);
+  in.seekg(offset);
+  in.read(&data[0], size);
+  if (!in || rendered.size() != size + 10 ||
+      memcmp(rendered.data() + 10, &data[0], size) != 0)
+  {
+    cerr << "*** " << file << ": the skipped picture's data isn't at "
+         << offset << endl;
+    return false;
+  }
+
+  // text frames are parsed, so aren't recorded
+  if (filtered.GetSkippedFrameData(ID3FID_TITLE, offset, size))
+  {
+    cerr << "*** " << file << ": found data for a parsed frame" << endl;
+    return false;
+  }
+  return true;
+}
+
+// returns the average time in microseconds of linking to the file
+static double timeLink(const char* file, bool filter, size_t rounds)
+{
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    ID3_Tag tag;
+    if (filter)
+    {
+      tag.SetFramesToParse(wanted, numWanted);
+    }
+    tag.Link(file, ID3TT_ID3V2);
+  }
+  clock_t end = clock();
+  return 1e6 * (end - start) / CLOCKS_PER_SEC / rounds;
+}
+
+static void report(const char* file, size_t rounds)
+{
+  double full = timeLink(file, false, rounds);
+  double filtered = timeLink(file, true, rounds);
+  cout << file << ": full parse " << full << " us, filtered parse "
+       << filtered << " us" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  const char* defaults[] =
+  {
+    "230-picture.tag", "230-syncedlyrics.tag", "230-unicode.tag",
+    "thatspot.tag"
+  };
+  std::vector<const char*> files;
+  if (argc > 1)
+  {
+    files.assign(argv + 1, argv + argc);
+  }
+  else
+  {
+    files.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    ok = checkFilter(files[i]) && ok;
+    report(files[i], 2000);
+  }
+
+  // a tag like the ones on most bought music: a few text frames and a large
+  // cover picture
+  const char* big = "test-filter.tag";
+  {
+    ID3_Tag tag;
+    tag.Link(big);
+    tag.Strip(ID3TT_ALL);
+    tag.Clear();
+
+    ID3_Frame frame(ID3FID_PICTURE);
+    frame.GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+    frame.GetField(ID3FN_PICTURETYPE)->Set(3);
+    std::vector<uchar> picture(1024 * 1024, 0x55);
+    frame.GetField(ID3FN_DATA)->Set(&picture[0], picture.size());
+    tag.AddFrame(frame);
+
+    ID3_AddTitle(&tag, "Title", true);
+    ID3_AddArtist(&tag, "Artist", true);
+    ID3_AddAlbum(&tag, "Album", true);
+    tag.SetPadding(false);
+    tag.Update(ID3TT_ID3V2);
+  }
+  ok = checkFilter(big) && ok;
+  ok = checkSkippedData(big) && ok;
+  report(big, 50);
+
+  if (!ok)
+  {
+    cerr << "*** SetFramesToParse() test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+// $Id$
+
+// Checks that ID3_Tag::Find() returns the frames of each frame ID in list
+// order, starting from the cursor and wrapping back to the first frame, and
+// times how long lookups take on the bundled tags and on a tag with many
+// frames.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+
+// the frames a music library reads from every file it imports, plus a couple
+// of frames that usually aren't there
+static const ID3_FrameID lookups[] =
+{
+  ID3FID_TITLE, ID3FID_LEADARTIST, ID3FID_BAND, ID3FID_ALBUM,
+  ID3FID_CONTENTTYPE, ID3FID_BPM, ID3FID_INITIALKEY, ID3FID_YEAR,
+  ID3FID_COMMENT, ID3FID_PICTURE, ID3FID_TRACKNUM, ID3FID_LYRICIST
+};
+static const size_t numLookups = sizeof(lookups) / sizeof(lookups[0]);
+
+// compares Find()'s results for every frame ID against a search of the frame
+// list which starts at the cursor and wraps back to the first frame
+static bool checkFind(const ID3_Tag& tag, const char* name)
+{
+  std::vector<const ID3_Frame*> frames;
+  ID3_Tag::ConstIterator* iter = tag.CreateIterator();
+  const ID3_Frame* frame = NULL;
+  while (NULL != (frame = iter->GetNext()))
+  {
+    frames.push_back(frame);
+  }
+  delete iter;
+
+  // Link(), AddFrame() and RemoveFrame() all leave the cursor at the first frame
+  size_t cursor = 0;
+  for (size_t round = 0; round < 3; ++round)
+  {
+    for (int id = ID3FID_NOFRAME; id < ID3FID_LASTFRAMEID; ++id)
+    {
+      const ID3_Frame* expected = NULL;
+      for (size_t i = 0; i < frames.size(); ++i)
+      {
+        size_t cur = (cursor + i) % frames.size();
+        if (frames[cur]->GetID() == id)
+        {
+          expected = frames[cur];
+          cursor = cur + 1;
+          break;
+        }
+      }
+
+      if (tag.Find(static_cast<ID3_FrameID>(id)) != expected)
+      {
+        cerr << "*** " << name << ": Find() found the wrong frame for frame id "
+             << id << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// returns the average time in nanoseconds of a single Find()
+static double timeFind(const ID3_Tag& tag, size_t rounds)
+{
+  size_t found = 0;
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    for (size_t i = 0; i < numLookups; ++i)
+    {
+      if (tag.Find(lookups[i]))
+      {
+        ++found;
+      }
+    }
+  }
+  clock_t end = clock();
+  if (found == (size_t) -1)
+  {
+    cout << found << endl; // stop the lookups from being optimised away
+  }
+  return 1e9 * (end - start) / CLOCKS_PER_SEC / (rounds * numLookups);
+}
+
+int main(int argc, char* argv[])
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  const char* defaults[] =
+  {
+    "221-compressed.tag", "230-compressed.tag", "230-picture.tag",
+    "230-syncedlyrics.tag", "230-unicode.tag", "thatspot.tag", "ozzy.tag"
+  };
+  std::vector<const char*> files;
+  if (argc > 1)
+  {
+    files.assign(argv + 1, argv + argc);
+  }
+  else
+  {
+    files.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    ID3_Tag tag(files[i]);
+    ok = checkFind(tag, files[i]) && ok;
+    cout << files[i] << ": " << tag.NumFrames() << " frames, "
+         << timeFind(tag, 200000) << " ns per Find()" << endl;
+  }
+
+  // a tag with lots of frames, like one with a large number of comments,
+  // with the title frame last
+  ID3_Tag big;
+  ID3_Frame frame;
+  frame.SetID(ID3FID_COMMENT);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    frame.GetField(ID3FN_TEXT)->Set("comment");
+    big.AddFrame(frame);
+  }
+  frame.SetID(ID3FID_TITLE);
+  frame.GetField(ID3FN_TEXT)->Set("title");
+  big.AddFrame(frame);
+
+  ok = checkFind(big, "501 frames") && ok;
+  cout << "501 frames: " << timeFind(big, 20000) << " ns per Find()" << endl;
+
+  // removing a frame should leave the rest findable in the same order
+  delete big.RemoveFrame(big.Find(ID3FID_TITLE));
+  delete big.RemoveFrame(big.Find(ID3FID_COMMENT));
+  ok = (big.Find(ID3FID_TITLE) == NULL) && ok;
+  ok = checkFind(big, "after RemoveFrame()") && ok;
+
+  if (!ok)
+  {
+    cerr << "*** Find() test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
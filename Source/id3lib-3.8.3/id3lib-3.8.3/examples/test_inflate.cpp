@@ -0,0 +1,212 @@
+// $Id$
+
+// Checks that io::CompressedReader gives back exactly the data that was
+// compressed, however it is read, skipped or rewound, that io::CompressedWriter
+// writes the same bytes as zlib's compress(), and that compressed frames much
+// larger than the reader's window survive a render and a parse.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <stdlib.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/io_decorators.h"
+#include "id3/io_strings.h"
+#include "zlib.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using namespace dami;
+
+// half random bytes and half runs, so it compresses, but not to nothing
+static BString makeData(size_t size)
+{
+  BString data;
+  data.reserve(size);
+  while (data.size() < size)
+  {
+    size_t run = 1 + rand() % 64;
+    uchar ch = static_cast<uchar>(rand() % 256);
+    for (size_t i = 0; i < run && data.size() < size; ++i)
+    {
+      data += (rand() % 2 == 0) ? ch : static_cast<uchar>(rand() % 256);
+    }
+  }
+  return data;
+}
+
+static BString compressData(const BString& data)
+{
+  uLongf size = data.size() + data.size() / 10 + 12;
+  std::vector<uchar> buf(size + 1);
+  ::compress(&buf[0], &size, data.data(), data.size());
+  return BString(&buf[0], size);
+}
+
+static bool checkReader(const BString& data, const char* name)
+{
+  BString compressed = compressData(data);
+  bool ok = true;
+
+  // in chunks of various sizes
+  static const size_t chunks[] = { 1, 7, 1000, 20000, 1000000 };
+  for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+  {
+    io::BStringReader bsr(compressed);
+    io::CompressedReader cr(bsr, data.size());
+    BString inflated;
+    std::vector<uchar> buf(chunks[c]);
+    while (!cr.atEnd())
+    {
+      size_t numRead = cr.readChars(&buf[0], chunks[c]);
+      if (numRead == 0)
+      {
+        break;
+      }
+      inflated.append(&buf[0], numRead);
+    }
+    if (inflated != data)
+    {
+      cerr << "*** " << name << ": wrong data read in chunks of " << chunks[c]
+           << endl;
+      ok = false;
+    }
+  }
+
+  // skipping forwards, peeking, and going back to the start
+  {
+    io::BStringReader bsr(compressed);
+    io::CompressedReader cr(bsr, data.size());
+    size_t skip = data.size() / 2;
+    cr.skipChars(skip);
+    const uchar* view = cr.peekChars(100);
+    if (data.size() >= skip + 100 &&
+        (NULL == view || BString(view, 100) != data.substr(skip, 100)))
+    {
+      cerr << "*** " << name << ": peekChars() after skipChars() is wrong" << endl;
+      ok = false;
+    }
+    cr.setCur(0);
+    if (io::readAllBinary(cr) != data)
+    {
+      cerr << "*** " << name << ": wrong data after rewinding" << endl;
+      ok = false;
+    }
+  }
+
+  // and the compressed data should have been used up
+  {
+    io::BStringReader bsr(compressed);
+    {
+      io::CompressedReader cr(bsr, data.size());
+      cr.readChar();
+    }
+    if (!bsr.atEnd())
+    {
+      cerr << "*** " << name << ": compressed data left over" << endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static bool checkWriter(const BString& data, const char* name)
+{
+  BString written;
+  {
+    io::BStringWriter bsw(written);
+    io::CompressedWriter cw(bsw);
+    for (size_t i = 0; i < data.size(); i += 1000)
+    {
+      size_t len = (data.size() - i < 1000) ? data.size() - i : 1000;
+      cw.writeChars(data.data() + i, len);
+    }
+    cw.flush();
+    if (cw.getOrigSize() != data.size())
+    {
+      cerr << "*** " << name << ": wrong original size" << endl;
+      return false;
+    }
+  }
+
+  // incompressible data is written as it is
+  BString compressed = compressData(data);
+  BString expected = compressed.size() < data.size() ? compressed : data;
+  if (written != expected)
+  {
+    cerr << "*** " << name << ": CompressedWriter differs from compress()" << endl;
+    return false;
+  }
+  return true;
+}
+
+static bool checkFrame(const BString& data, const char* name)
+{
+  const char* file = "test-inflate.tag";
+  {
+    ID3_Tag tag;
+    tag.Link(file);
+    tag.Strip(ID3TT_ALL);
+    tag.Clear();
+    ID3_Frame frame(ID3FID_PICTURE);
+    frame.GetField(ID3FN_MIMETYPE)->Set("image/png");
+    frame.GetField(ID3FN_DATA)->Set(data.data(), data.size());
+    frame.SetCompression(true);
+    tag.AddFrame(frame);
+    tag.SetPadding(false);
+    tag.Update(ID3TT_ID3V2);
+  }
+
+  clock_t start = clock();
+  ID3_Tag tag(file);
+  double usecs = 1e6 * (clock() - start) / CLOCKS_PER_SEC;
+  const ID3_Frame* frame = tag.Find(ID3FID_PICTURE);
+  const ID3_Field* fld = frame ? frame->GetField(ID3FN_DATA) : NULL;
+  if (NULL == fld || fld->Size() != data.size() ||
+      BString(fld->GetRawBinary(), fld->Size()) != data)
+  {
+    cerr << "*** " << name << ": the compressed frame changed" << endl;
+    return false;
+  }
+  cout << name << ": linked in " << usecs << " us" << endl;
+  return true;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  srand(1);
+  bool ok = true;
+  static const size_t sizes[] = { 0, 1, 100, 16 * 1024, 16 * 1024 + 1, 1000000 };
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+  {
+    BString data = makeData(sizes[s]);
+    ok = checkReader(data, "compressible data") && ok;
+    ok = checkWriter(data, "compressible data") && ok;
+  }
+
+  BString random;
+  for (size_t i = 0; i < 100000; ++i)
+  {
+    random += static_cast<uchar>(rand() % 256);
+  }
+  ok = checkWriter(random, "random data") && ok;
+
+  ok = checkFrame(makeData(1000000), "1 MB compressed picture") && ok;
+  ok = checkFrame(random, "100K incompressible picture") && ok;
+
+  if (!ok)
+  {
+    cerr << "*** compression test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
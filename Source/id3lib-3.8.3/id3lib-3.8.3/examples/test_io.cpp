@@ -14,6 +14,9 @@
 using std::cout;
 using std::endl;
 using std::cerr;
+using std::cin;
+using std::hex;
+using std::dec;
 
 using namespace dami;
 
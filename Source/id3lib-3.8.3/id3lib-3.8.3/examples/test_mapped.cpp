@@ -0,0 +1,111 @@
+// $Id$
+
+// Checks that linking a file, which reads it through an ID3_MappedFileReader,
+// finds the same tag as reading it through an ID3_IFStreamReader, and times
+// both.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/readers.h"
+#include "id3/io_strings.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+
+static dami::BString render(const ID3_Tag& tag)
+{
+  dami::BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  tag.Render(writer, ID3TT_ID3V2);
+  return rendered;
+}
+
+static void linkStream(ID3_Tag& tag, const char* file)
+{
+  ifstream stream(file, ios::in | ios::binary);
+  ID3_IFStreamReader reader(stream);
+  tag.Link(reader);
+}
+
+static double timeLink(const char* file, bool mapped, size_t rounds)
+{
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    ID3_Tag tag;
+    if (mapped)
+    {
+      tag.Link(file);
+    }
+    else
+    {
+      linkStream(tag, file);
+    }
+  }
+  clock_t end = clock();
+  return 1e6 * (end - start) / CLOCKS_PER_SEC / rounds;
+}
+
+int main(int argc, char* argv[])
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  const char* defaults[] =
+  {
+    "230-picture.tag", "230-syncedlyrics.tag", "230-unicode.tag",
+    "thatspot.tag", "crc53865.mp3"
+  };
+  std::vector<const char*> files;
+  if (argc > 1)
+  {
+    files.assign(argv + 1, argv + argc);
+  }
+  else
+  {
+    files.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    ID3_MappedFileReader reader(files[i]);
+    if (!reader.isOpen())
+    {
+      cerr << "*** " << files[i] << ": couldn't map the file" << endl;
+      ok = false;
+      continue;
+    }
+    reader.close();
+
+    ID3_Tag mapped, streamed;
+    mapped.Link(files[i]);
+    linkStream(streamed, files[i]);
+    if (mapped.NumFrames() != streamed.NumFrames() ||
+        mapped.GetPrependedBytes() != streamed.GetPrependedBytes() ||
+        mapped.GetAppendedBytes() != streamed.GetAppendedBytes() ||
+        render(mapped) != render(streamed))
+    {
+      cerr << "*** " << files[i] << ": the mapped file has a different tag" << endl;
+      ok = false;
+    }
+
+    cout << files[i] << ": stream " << timeLink(files[i], false, 2000)
+         << " us, mapped " << timeLink(files[i], true, 2000) << " us" << endl;
+  }
+
+  if (!ok)
+  {
+    cerr << "*** ID3_MappedFileReader test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
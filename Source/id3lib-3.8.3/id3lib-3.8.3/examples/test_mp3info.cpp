@@ -0,0 +1,321 @@
+// $Id$
+
+// Checks the frame count, length and bitrate which linking a file finds in
+// the first mp3 frame: from a xing header with a lame header, a lame "info"
+// header, a vbri header, or estimated from the size of a file with none of
+// them, for mpeg 1 and 2, with and without a crc.  Then times reading the
+// length of a folder of mixed files from their headers against counting
+// every frame, as a decoder has to when there is no header.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using std::string;
+
+// mpeg 1 layer III bitrates, in kbit/s
+static const unsigned int bitrates[16] =
+{
+  0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0
+};
+
+static void putI4(string& data, size_t pos, unsigned int x)
+{
+  data[pos]     = static_cast<char>((x >> 24) & 0xFF);
+  data[pos + 1] = static_cast<char>((x >> 16) & 0xFF);
+  data[pos + 2] = static_cast<char>((x >> 8) & 0xFF);
+  data[pos + 3] = static_cast<char>(x & 0xFF);
+}
+
+// a layer III frame of \c size bytes: mpeg 1 (version 3) or 2 (version 2),
+// stereo (mode 0) or mono (mode 3)
+static string makeFrame(int version, int bitrateIndex, int mode, bool crc,
+                        size_t size)
+{
+  string frame(size, '\x11');
+  frame[0] = '\xFF';
+  frame[1] = static_cast<char>(0xE0 | (version << 3) | (1 << 1) | (crc ? 0 : 1));
+  frame[2] = static_cast<char>(bitrateIndex << 4);
+  frame[3] = static_cast<char>(mode << 6);
+  return frame;
+}
+
+// the size of an mpeg 1 layer III frame at 44.1KHz, without padding
+static size_t frameSize(int bitrateIndex)
+{
+  return 144 * bitrates[bitrateIndex] * 1000 / 44100;
+}
+
+// \c numFrames mpeg 1 frames at 44.1KHz.  If \c vbr they cycle through
+// several bitrates, and otherwise they are all 128 kbit/s
+static string makeAudio(size_t numFrames, bool vbr)
+{
+  static const int vbrIndexes[] = { 9, 11, 7, 14, 10, 5 };
+  string audio;
+  for (size_t i = 0; i < numFrames; ++i)
+  {
+    int index = vbr ? vbrIndexes[i % 6] : 9;
+    audio += makeFrame(3, index, 0, false, frameSize(index));
+  }
+  return audio;
+}
+
+// a first frame holding a xing (or "info") header with every field, and a
+// lame header with the encoder delay and padding
+static string makeXingFrame(const char* id, size_t frames, size_t bytes,
+                            size_t delay, size_t padding)
+{
+  string frame = makeFrame(3, 9, 0, false, frameSize(9));
+  const size_t xing = 4 + 32;
+  frame.replace(xing, 4, id);
+  putI4(frame, xing + 4, 0x0F);
+  putI4(frame, xing + 8, frames);
+  putI4(frame, xing + 12, bytes);
+  frame.replace(xing + 120, 9, "LAME3.99r");
+  frame[xing + 120 + 21] = static_cast<char>(delay >> 4);
+  frame[xing + 120 + 22] = static_cast<char>(((delay & 0x0F) << 4) | (padding >> 8));
+  frame[xing + 120 + 23] = static_cast<char>(padding & 0xFF);
+  return frame;
+}
+
+static string makeVbriFrame(size_t frames, size_t bytes)
+{
+  string frame = makeFrame(3, 9, 0, false, frameSize(9));
+  const size_t vbri = 4 + 32;
+  frame.replace(vbri, 4, "VBRI");
+  putI4(frame, vbri + 10, bytes);
+  putI4(frame, vbri + 14, frames);
+  return frame;
+}
+
+static void writeFile(const char* name, const string& audio, bool tagged)
+{
+  {
+    ofstream out(name, ios::out | ios::binary | ios::trunc);
+    out.write(audio.data(), audio.size());
+  }
+  if (tagged)
+  {
+    ID3_Tag tag(name);
+    ID3_AddTitle(&tag, "Title", true);
+    tag.Update(ID3TT_ID3V2);
+  }
+}
+
+static bool check(const char* name, const string& audio, Mp3_VbrHeader vbrHeader,
+                  size_t frames, size_t samplesPerFrame, size_t samples,
+                  size_t vbrBitrate)
+{
+  const char* file = "test-mp3info.mp3";
+  writeFile(file, audio, true);
+  ID3_Tag tag(file);
+  const Mp3_Headerinfo* info = tag.GetMp3HeaderInfo();
+  remove(file);
+  if (NULL == info)
+  {
+    cerr << "*** " << name << ": no mp3 header found" << endl;
+    return false;
+  }
+  if (info->vbr_header != vbrHeader || info->frames != frames ||
+      info->samples_per_frame != samplesPerFrame || info->samples != samples ||
+      info->vbr_bitrate != vbrBitrate)
+  {
+    cerr << "*** " << name << ": found header " << info->vbr_header << ", "
+         << info->frames << " frames of " << info->samples_per_frame
+         << " samples, " << info->samples << " samples, vbr bitrate "
+         << info->vbr_bitrate << endl;
+    return false;
+  }
+  return true;
+}
+
+// counts every frame after the tag, as a decoder has to without a vbr header
+static size_t countFrames(const char* name)
+{
+  ifstream in(name, ios::in | ios::binary);
+  string data;
+  char buf[65536];
+  while (in)
+  {
+    in.read(buf, sizeof(buf));
+    data.append(buf, in.gcount());
+  }
+
+  // skip the id3v2 tag, whose size is in the last 4 bytes of its header
+  size_t pos = 0;
+  if (data.size() >= 10 && data.compare(0, 3, "ID3") == 0)
+  {
+    pos = 10 + ((data[6] & 0x7F) << 21 | (data[7] & 0x7F) << 14 |
+                (data[8] & 0x7F) << 7 | (data[9] & 0x7F));
+  }
+  size_t frames = 0;
+  while (pos + 4 <= data.size() && (data[pos] & 0xFF) == 0xFF &&
+         (data[pos + 1] & 0xE0) == 0xE0)
+  {
+    size_t size = frameSize((data[pos + 2] >> 4) & 0x0F);
+    if (size == 0)
+    {
+      break;
+    }
+    pos += size;
+    ++frames;
+  }
+  return frames;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  bool ok = true;
+  const size_t numFrames = 1000;
+
+  // a vbr file with a xing and a lame header
+  {
+    string audio = makeAudio(numFrames, true);
+    string first = makeXingFrame("Xing", numFrames, audio.size(), 576, 1000);
+    size_t bitrate = static_cast<size_t>(
+      (audio.size() * 8.0 * 44100) / (numFrames * 1152.0));
+    bitrate -= bitrate % 1000;
+    ok = check("xing", first + audio, MP3VBRHEADER_XING, numFrames, 1152,
+               numFrames * 1152 - 576 - 1000, bitrate) && ok;
+  }
+
+  // a cbr file with a lame info header
+  {
+    string audio = makeAudio(numFrames, false);
+    string first = makeXingFrame("Info", numFrames, audio.size(), 576, 1200);
+    ok = check("info", first + audio, MP3VBRHEADER_INFO, numFrames, 1152,
+               numFrames * 1152 - 576 - 1200, 0) && ok;
+  }
+
+  // a vbr file with a vbri header
+  {
+    string audio = makeAudio(numFrames, true);
+    string first = makeVbriFrame(numFrames, audio.size());
+    size_t bitrate = static_cast<size_t>(
+      (audio.size() * 8.0 * 44100) / (numFrames * 1152.0));
+    bitrate -= bitrate % 1000;
+    ok = check("vbri", first + audio, MP3VBRHEADER_VBRI, numFrames, 1152,
+               numFrames * 1152, bitrate) && ok;
+  }
+
+  // a cbr file with no header, estimated from its size
+  {
+    string audio = makeAudio(numFrames, false);
+    size_t samples = static_cast<size_t>(audio.size() * 8.0 * 44100 / 128000);
+    ok = check("no header", audio, MP3VBRHEADER_NONE, numFrames, 1152, samples,
+               0) && ok;
+  }
+
+  // a crc moves the xing header along by two bytes
+  {
+    string first = makeFrame(3, 9, 0, true, frameSize(9));
+    first.replace(4 + 32 + 2, 4, "Xing");
+    putI4(first, 4 + 32 + 2 + 4, 0x01);
+    putI4(first, 4 + 32 + 2 + 8, numFrames);
+    string audio = makeAudio(numFrames, false);
+    // without a byte count, the bitrate is from the size of the whole file
+    size_t bitrate = static_cast<size_t>(
+      ((first.size() + audio.size()) * 8.0 * 44100) / (numFrames * 1152.0));
+    bitrate -= bitrate % 1000;
+    ok = check("crc", first + audio, MP3VBRHEADER_XING, numFrames, 1152,
+               numFrames * 1152, bitrate) && ok;
+  }
+
+  // mpeg 2 mono has 576 samples in a frame, and its xing header straight after
+  // 9 bytes of side info.  128 kbit/s at 22.05KHz is 72 * 128000 / 22050 bytes
+  {
+    const size_t size = 72 * 128000 / 22050;
+    string first = makeFrame(2, 12, 3, false, size);
+    first.replace(4 + 9, 4, "Xing");
+    putI4(first, 4 + 9 + 4, 0x01);
+    putI4(first, 4 + 9 + 8, numFrames);
+    string audio;
+    for (size_t i = 0; i < numFrames; ++i)
+    {
+      audio += makeFrame(2, 12, 3, false, size);
+    }
+    size_t bitrate = static_cast<size_t>(
+      ((first.size() + audio.size()) * 8.0 * 22050) / (numFrames * 576.0));
+    bitrate -= bitrate % 1000;
+    ok = check("mpeg 2", first + audio, MP3VBRHEADER_XING, numFrames, 576,
+               numFrames * 576, bitrate) && ok;
+  }
+
+  // a folder of mixed files of around 5 minutes each
+  std::vector<string> files;
+  const size_t folderFrames = 11500;
+  for (size_t i = 0; i < 12; ++i)
+  {
+    char name[32];
+    sprintf(name, "test-mp3info-%lu.mp3", static_cast<unsigned long>(i));
+    files.push_back(name);
+    string audio = makeAudio(folderFrames, i % 3 != 2);
+    switch (i % 3)
+    {
+      case 0:
+        audio = makeXingFrame("Xing", folderFrames, audio.size(), 576, 1000) + audio;
+        break;
+      case 1:
+        audio = makeVbriFrame(folderFrames, audio.size()) + audio;
+        break;
+      default:
+        audio = makeXingFrame("Info", folderFrames, audio.size(), 576, 1000) + audio;
+        break;
+    }
+    writeFile(name, audio, true);
+  }
+
+  clock_t start = clock();
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    ID3_Tag tag(files[i].c_str());
+    const Mp3_Headerinfo* info = tag.GetMp3HeaderInfo();
+    if (NULL == info || info->frames != folderFrames)
+    {
+      cerr << "*** " << files[i] << ": wrong frame count from the header" << endl;
+      ok = false;
+    }
+  }
+  double headers = 1e3 * (clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    // the first frame holds the header, and isn't counted in it
+    if (countFrames(files[i].c_str()) != folderFrames + 1)
+    {
+      cerr << "*** " << files[i] << ": wrong number of frames counted" << endl;
+      ok = false;
+    }
+  }
+  double counted = 1e3 * (clock() - start) / CLOCKS_PER_SEC;
+
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    remove(files[i].c_str());
+  }
+  cout << files.size() << " files: length from the headers " << headers
+       << " ms, from counting the frames " << counted << " ms" << endl;
+
+  if (!ok)
+  {
+    cerr << "*** mp3 info test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,305 @@
+// $Id$
+
+// Times how fast the example tags, and a few large tags made up here, are
+// linked from memory, and counts the allocations made for each one.  Then
+// links thousands of randomly damaged copies of the example tags, which
+// should never crash the parser (build with -fsanitize=address to catch
+// reads past the end as well).  fuzz_tag.cpp does the same under a real
+// fuzzer.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <new>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/io_strings.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using dami::BString;
+using dami::String;
+
+static size_t numAllocs = 0;
+
+// the blocks are allocated and freed through pointers, so that gcc doesn't
+// inline malloc() or free() into a new or delete expression and then warn
+// that they don't match (-Wmismatched-new-delete): it can't tell that new and
+// delete are replaced
+static void* (* volatile allocateBlock)(size_t) = malloc;
+static void (* volatile freeBlock)(void*) = free;
+
+void* operator new(size_t size)
+{
+  ++numAllocs;
+  void* p = allocateBlock(size ? size : 1);
+  if (NULL == p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) throw ()
+{
+  freeBlock(p);
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete[](void* p) throw ()
+{
+  freeBlock(p);
+}
+
+struct Input
+{
+  String name;
+  BString data;
+};
+
+static BString render(const ID3_Tag& tag)
+{
+  BString rendered;
+  dami::io::BStringWriter writer(rendered);
+  tag.Render(writer, ID3TT_ID3V2);
+  return rendered;
+}
+
+static size_t link(const BString& data)
+{
+  dami::io::BStringReader reader(data);
+  ID3_Tag tag;
+  tag.Link(reader);
+  return tag.NumFrames();
+}
+
+static bool readFile(const char* name, BString& data)
+{
+  FILE* file = fopen(name, "rb");
+  if (NULL == file)
+  {
+    return false;
+  }
+  uchar buf[4096];
+  size_t size;
+  while ((size = fread(buf, 1, sizeof(buf), file)) > 0)
+  {
+    data.append(buf, size);
+  }
+  fclose(file);
+  return true;
+}
+
+// the same numbers on every platform, so a crash can be reproduced
+static unsigned int nextRandom(unsigned int& seed)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) & 0x7FFF;
+}
+
+// a tag with lots of small text frames, like a heavily tagged track
+static BString manyFrames(bool unsync, bool compress)
+{
+  ID3_Tag tag;
+  char text[128];
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    ID3_Frame* frame = new ID3_Frame(i % 2 ? ID3FID_COMMENT : ID3FID_USERTEXT);
+    sprintf(text, "description %lu", static_cast<unsigned long>(i));
+    frame->GetField(ID3FN_DESCRIPTION)->Set(text);
+    sprintf(text, "The quick brown fox jumps over the lazy dog, %lu times",
+            static_cast<unsigned long>(i));
+    frame->GetField(ID3FN_TEXT)->Set(text);
+    if (i % 4 == 0)
+    {
+      frame->GetField(ID3FN_TEXTENC)->Set(ID3TE_UTF16);
+      frame->GetField(ID3FN_DESCRIPTION)->SetEncoding(ID3TE_UTF16);
+      frame->GetField(ID3FN_TEXT)->SetEncoding(ID3TE_UTF16);
+    }
+    frame->SetCompression(compress);
+    tag.AttachFrame(frame);
+  }
+  tag.SetUnsync(unsync);
+  return render(tag);
+}
+
+// a tag with one large picture, like most tags with cover art
+static BString bigPicture()
+{
+  BString picture(2 * 1024 * 1024, '\0');
+  unsigned int seed = 1;
+  for (size_t i = 0; i < picture.size(); ++i)
+  {
+    picture[i] = static_cast<uchar>(nextRandom(seed));
+  }
+  ID3_Tag tag;
+  ID3_Frame* frame = new ID3_Frame(ID3FID_PICTURE);
+  frame->GetField(ID3FN_MIMETYPE)->Set("image/jpeg");
+  frame->GetField(ID3FN_PICTURETYPE)->Set(3);
+  frame->GetField(ID3FN_DATA)->Set(picture.data(), picture.size());
+  tag.AttachFrame(frame);
+  return render(tag);
+}
+
+// an ID3v2.4 extended header which says it has more than one flag byte
+static BString extendedHeader()
+{
+  const uchar header[] =
+  {
+    'I', 'D', '3', 4, 0, 0x40, 0, 0, 0, 30,
+    0, 0, 0, 9, 4, 0x70, 0x70, 0x70, 0x70,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+  };
+  return BString(header, sizeof(header));
+}
+
+static void benchmark(const Input& input)
+{
+  // small tags are linked thousands of times, and large ones at least 20,
+  // so that each takes around a second at most
+  size_t rounds = 2000;
+  if (input.data.size() * rounds > 16 * 1024 * 1024)
+  {
+    rounds = dami::max<size_t>(20, 16 * 1024 * 1024 / input.data.size());
+  }
+
+  size_t before = numAllocs;
+  size_t numFrames = 0;
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    numFrames = link(input.data);
+  }
+  double secs = double(clock() - start) / CLOCKS_PER_SEC;
+  if (secs <= 0)
+  {
+    secs = 1.0 / CLOCKS_PER_SEC;
+  }
+  double mb = double(input.data.size()) * rounds / (1024 * 1024);
+
+  cout << input.name << ": " << input.data.size() << " bytes, " << numFrames
+       << " frames, " << mb / secs << " MB/s, " << rounds / secs
+       << " tags/s, " << (numAllocs - before) / rounds
+       << " allocations a tag" << endl;
+}
+
+// damages a copy of the tag in a few random places
+static BString mutate(const BString& data, unsigned int& seed)
+{
+  BString mutated(data);
+  size_t numChanges = 1 + nextRandom(seed) % 8;
+  for (size_t i = 0; i < numChanges && !mutated.empty(); ++i)
+  {
+    size_t pos = nextRandom(seed) % mutated.size();
+    switch (nextRandom(seed) % 5)
+    {
+      case 0:
+        mutated[pos] = static_cast<uchar>(nextRandom(seed));
+        break;
+      case 1:
+        mutated[pos] ^= static_cast<uchar>(1 << (nextRandom(seed) % 8));
+        break;
+      case 2:
+        mutated[pos] = (nextRandom(seed) % 2) ? 0xFF : 0x00;
+        break;
+      case 3:
+        mutated.resize(pos);
+        break;
+      default:
+        mutated.insert(pos, 1 + nextRandom(seed) % 16, static_cast<uchar>(nextRandom(seed)));
+        break;
+    }
+  }
+  return mutated;
+}
+
+int main(int argc, char* argv[])
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  const char* defaults[] =
+  {
+    "221-compressed.tag", "230-compressed.tag", "230-picture.tag",
+    "230-syncedlyrics.tag", "230-unicode.tag", "ozzy.tag", "thatspot.tag"
+  };
+  std::vector<const char*> files;
+  if (argc > 1)
+  {
+    files.assign(argv + 1, argv + argc);
+  }
+  else
+  {
+    files.assign(defaults, defaults + sizeof(defaults) / sizeof(defaults[0]));
+  }
+
+  std::vector<Input> samples;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    Input input;
+    input.name = files[i];
+    if (!readFile(files[i], input.data))
+    {
+      cerr << "*** can't read " << files[i] << endl;
+      return 1;
+    }
+    samples.push_back(input);
+  }
+
+  std::vector<Input> inputs(samples);
+  Input input;
+  input.name = "2000 frames";
+  input.data = manyFrames(false, false);
+  inputs.push_back(input);
+  input.name = "2000 frames, unsynced";
+  input.data = manyFrames(true, false);
+  inputs.push_back(input);
+  input.name = "2000 frames, compressed";
+  input.data = manyFrames(false, true);
+  inputs.push_back(input);
+  input.name = "2 MB picture";
+  input.data = bigPicture();
+  inputs.push_back(input);
+
+  for (size_t i = 0; i < inputs.size(); ++i)
+  {
+    benchmark(inputs[i]);
+  }
+
+  bool ok = true;
+  if (link(inputs[files.size()].data) != 2000)
+  {
+    cerr << "*** the 2000 frame tag didn't link" << endl;
+    ok = false;
+  }
+  link(extendedHeader());
+
+  const size_t mutations = 1000;
+  unsigned int seed = 1;
+  for (size_t i = 0; i < samples.size(); ++i)
+  {
+    for (size_t m = 0; m < mutations; ++m)
+    {
+      link(mutate(samples[i].data, seed));
+    }
+  }
+  cout << "linked " << mutations * samples.size() << " damaged tags" << endl;
+
+  if (!ok)
+  {
+    cerr << "*** parse test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
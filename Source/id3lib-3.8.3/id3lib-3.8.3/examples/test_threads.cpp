@@ -0,0 +1,211 @@
+// $Id$
+
+// Links and updates tags from several threads at once, as a batch tag writer
+// does.  Each thread has files of its own, half of them with an extended
+// header (with and without a crc), which used to be the size of the last
+// extended header parsed by any thread.  Every thread checks that each of its
+// tags reads back with the right size and frames, and that the audio after
+// the tag is untouched, after every update.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using std::string;
+
+static const int numThreads = 8;
+static const int numUpdates = 40;
+static const size_t minPadding = 1024;
+
+struct ThreadState
+{
+  int index;
+  int numErrors;
+};
+
+static string readFile(const string& name)
+{
+  ifstream in(name.c_str(), ios::in | ios::binary);
+  string data;
+  char buf[4096];
+  while (in)
+  {
+    in.read(buf, sizeof(buf));
+    data.append(buf, in.gcount());
+  }
+  return data;
+}
+
+static void appendSyncSafe(string& data, size_t size)
+{
+  data += static_cast<char>((size >> 21) & 0x7F);
+  data += static_cast<char>((size >> 14) & 0x7F);
+  data += static_cast<char>((size >> 7) & 0x7F);
+  data += static_cast<char>(size & 0x7F);
+}
+
+static void appendBE(string& data, size_t value, size_t numBytes)
+{
+  for (size_t i = numBytes; i > 0; --i)
+  {
+    data += static_cast<char>((value >> (8 * (i - 1))) & 0xFF);
+  }
+}
+
+// the "audio" after the tag, which starts with an mp3 frame header like a real
+// mp3 file, and differs from thread to thread
+static string makeAudio(int index)
+{
+  string audio("\xFF\xFB\x90\x64");
+  for (size_t i = audio.size(); i < 64 * 1024; ++i)
+  {
+    audio += static_cast<char>(1 + (i + index) % 251);
+  }
+  return audio;
+}
+
+// writes an id3v2.3 tag with a title and some padding, and an extended header
+// of 10 bytes, of 14 bytes (with a crc) or none, before the audio
+static void makeFile(const string& name, const string& title,
+                     size_t extendedBytes, const string& audio)
+{
+  string frames("TIT2");
+  appendBE(frames, title.size() + 1, 4);
+  frames += string(2, '\0');
+  frames += '\0';
+  frames += title;
+
+  const size_t padding = 256;
+  string extended;
+  if (extendedBytes > 0)
+  {
+    appendBE(extended, extendedBytes - 4, 4);
+    appendBE(extended, extendedBytes == 14 ? 0x8000 : 0, 2);
+    appendBE(extended, padding, 4);
+    if (extendedBytes == 14)
+    {
+      appendBE(extended, 0, 4);
+    }
+  }
+
+  string tag("ID3\x03\x00", 5);
+  tag += static_cast<char>(extendedBytes > 0 ? 0x40 : 0);
+  appendSyncSafe(tag, extended.size() + frames.size() + padding);
+  tag += extended + frames + string(padding, '\0');
+
+  ofstream out(name.c_str(), ios::out | ios::binary | ios::trunc);
+  out.write(tag.data(), tag.size());
+  out.write(audio.data(), audio.size());
+}
+
+static string getText(const ID3_Tag& tag, ID3_FrameID id)
+{
+  string text;
+  char* str = ID3_GetString(tag.Find(id), ID3FN_TEXT);
+  if (str)
+  {
+    text = str;
+    ID3_FreeString(str);
+  }
+  return text;
+}
+
+static int checkFile(const string& name, const string& title, const string& bpm,
+                     const string& audio)
+{
+  int numErrors = 0;
+  ID3_Tag tag(name.c_str());
+  if (getText(tag, ID3FID_TITLE) != title || getText(tag, ID3FID_BPM) != bpm)
+  {
+    cerr << "*** " << name << ": read back the wrong frames" << endl;
+    ++numErrors;
+  }
+
+  string data = readFile(name);
+  size_t tagSize = tag.GetPrependedBytes();
+  if (tagSize == 0 || data.size() != tagSize + audio.size() ||
+      data.compare(tagSize, string::npos, audio) != 0)
+  {
+    cerr << "*** " << name << ": the tag size or the audio is wrong" << endl;
+    ++numErrors;
+  }
+  return numErrors;
+}
+
+static void* run(void* arg)
+{
+  ThreadState* state = static_cast<ThreadState*>(arg);
+  char name[64];
+  char title[64];
+  sprintf(name, "test-threads-%d.mp3", state->index);
+  sprintf(title, "Thread %d title", state->index);
+
+  // the threads use every kind of extended header at the same time
+  static const size_t extendedBytes[] = { 0, 10, 14 };
+  string audio = makeAudio(state->index);
+  makeFile(name, title, extendedBytes[state->index % 3], audio);
+  state->numErrors += checkFile(name, title, "", audio);
+
+  for (int i = 0; i < numUpdates && state->numErrors == 0; ++i)
+  {
+    char bpm[16];
+    sprintf(bpm, "%d", 100 + state->index * numUpdates + i);
+    const ID3_FrameID ids[] = { ID3FID_BPM, ID3FID_TITLE };
+    const char* texts[] = { bpm, title };
+    if (!(ID3_UpdateTextFrames(name, ids, texts, 2, minPadding) & ID3TT_ID3V2))
+    {
+      cerr << "*** " << name << ": the update wasn't written" << endl;
+      ++state->numErrors;
+    }
+    state->numErrors += checkFile(name, title, bpm, audio);
+  }
+
+  remove(name);
+  return NULL;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  pthread_t threads[numThreads];
+  ThreadState states[numThreads];
+  for (int i = 0; i < numThreads; ++i)
+  {
+    states[i].index = i;
+    states[i].numErrors = 0;
+    if (pthread_create(&threads[i], NULL, run, &states[i]) != 0)
+    {
+      cerr << "*** couldn't start a thread" << endl;
+      return 1;
+    }
+  }
+
+  int numErrors = 0;
+  for (int i = 0; i < numThreads; ++i)
+  {
+    pthread_join(threads[i], NULL);
+    numErrors += states[i].numErrors;
+  }
+
+  cout << numThreads << " threads made " << numUpdates << " updates each"
+       << endl;
+  if (numErrors > 0)
+  {
+    cerr << "*** threads test failed with " << numErrors << " errors" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,239 @@
+// $Id$
+
+// Checks that io::UnsyncedWriter and io::UnsyncedReader produce exactly the
+// same bytes as the original one-character-at-a-time unsynchronisation, for
+// data full of 0xFF, 0x00 and 0xE0+ bytes written and read in chunks of
+// various sizes, and measures the throughput of both.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <stdlib.h>
+#include <sstream>
+#include <vector>
+#include "id3/id3lib_streams.h"
+#include "id3/io_decorators.h"
+#include "id3/io_strings.h"
+#include "id3/readers.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using namespace dami;
+
+// the unsynchronisation as UnsyncedWriter::writeChar() does it
+static BString unsyncByteByByte(const BString& data, size_t& numSyncs)
+{
+  BString unsynced;
+  numSyncs = 0;
+  int last = 0;
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    unsigned char ch = data[i];
+    if (last == 0xFF && (ch == 0x00 || ch >= 0xE0))
+    {
+      unsynced += static_cast<unsigned char>(0);
+      ++numSyncs;
+    }
+    unsynced += ch;
+    last = ch;
+  }
+  if (last == 0xFF)
+  {
+    unsynced += static_cast<unsigned char>(0);
+    ++numSyncs;
+  }
+  return unsynced;
+}
+
+// the resynchronisation as UnsyncedReader::readChar() does it
+static BString resyncByteByByte(const BString& data)
+{
+  BString synced;
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    synced += data[i];
+    if (data[i] == 0xFF && i + 1 < data.size() && data[i + 1] == 0x00)
+    {
+      ++i;
+    }
+  }
+  return synced;
+}
+
+static BString unsync(const BString& data, size_t chunk, size_t& numSyncs)
+{
+  BString unsynced;
+  io::BStringWriter sw(unsynced);
+  io::UnsyncedWriter uw(sw);
+  for (size_t i = 0; i < data.size(); i += chunk)
+  {
+    size_t len = (data.size() - i < chunk) ? data.size() - i : chunk;
+    uw.writeChars(data.data() + i, len);
+  }
+  uw.flush();
+  numSyncs = uw.getNumSyncs();
+  return unsynced;
+}
+
+static BString resync(ID3_Reader& reader, size_t chunk)
+{
+  BString synced;
+  io::UnsyncedReader ur(reader);
+  std::vector<uchar> buf(chunk);
+  while (!ur.atEnd())
+  {
+    size_t numRead = ur.readChars(&buf[0], chunk);
+    synced.append(&buf[0], numRead);
+  }
+  return synced;
+}
+
+// random bytes, mostly the ones the unsynchronisation cares about
+static BString makeData(size_t size, bool syncHeavy)
+{
+  static const uchar special[] = { 0xFF, 0xFF, 0x00, 0xE0, 0xFE };
+  BString data;
+  data.reserve(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (syncHeavy && rand() % 2 == 0)
+    {
+      data += special[rand() % sizeof(special)];
+    }
+    else
+    {
+      data += static_cast<uchar>(rand() % 256);
+    }
+  }
+  return data;
+}
+
+static bool check(const BString& data, const char* name)
+{
+  static const size_t chunks[] = { 1, 2, 3, 7, 64, 1024, 100000 };
+  size_t expectedSyncs = 0;
+  BString expected = unsyncByteByByte(data, expectedSyncs);
+  BString expectedSynced = resyncByteByByte(expected);
+
+  for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+  {
+    size_t numSyncs = 0;
+    BString unsynced = unsync(data, chunks[c], numSyncs);
+    if (unsynced != expected || numSyncs != expectedSyncs)
+    {
+      cerr << "*** " << name << ": UnsyncedWriter differs in chunks of "
+           << chunks[c] << endl;
+      return false;
+    }
+
+    // from memory, where the sync bytes are found in bulk...
+    io::BStringReader bsr(unsynced);
+    BString synced = resync(bsr, chunks[c]);
+    // ...and from a stream, where they are found a character at a time
+    std::istringstream stream(std::string(unsynced.begin(), unsynced.end()));
+    ID3_IStreamReader isr(stream);
+    BString streamed = resync(isr, chunks[c]);
+    if (synced != expectedSynced || streamed != expectedSynced)
+    {
+      cerr << "*** " << name << ": UnsyncedReader differs in chunks of "
+           << chunks[c] << endl;
+      return false;
+    }
+    if (synced != data)
+    {
+      cerr << "*** " << name << ": data changed in a round trip in chunks of "
+           << chunks[c] << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+static void report(const BString& data, const char* name, size_t rounds)
+{
+  size_t numSyncs = 0;
+  BString unsynced;
+
+  // a character at a time, as the reader and writer used to work
+  clock_t start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    unsynced.erase();
+    io::BStringWriter sw(unsynced);
+    io::UnsyncedWriter uw(sw);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+      uw.writeChar(data[i]);
+    }
+    uw.flush();
+  }
+  double oldWrite = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    io::BStringReader bsr(unsynced);
+    io::UnsyncedReader ur(bsr);
+    BString synced;
+    while (!ur.atEnd())
+    {
+      synced += static_cast<uchar>(ur.readChar());
+    }
+  }
+  double oldRead = double(clock() - start) / CLOCKS_PER_SEC;
+
+  // in bulk
+  start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    unsynced = unsync(data, data.size(), numSyncs);
+  }
+  double newWrite = double(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    io::BStringReader bsr(unsynced);
+    io::UnsyncedReader ur(bsr);
+    io::readAllBinary(ur);
+  }
+  double newRead = double(clock() - start) / CLOCKS_PER_SEC;
+
+  double mb = double(data.size()) * rounds / (1024 * 1024);
+  cout << name << ": unsync " << mb / oldWrite << " -> " << mb / newWrite
+       << " MB/s, resync " << mb / oldRead << " -> " << mb / newRead
+       << " MB/s" << endl;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  srand(1);
+  bool ok = true;
+  for (size_t size = 0; size < 64; ++size)
+  {
+    for (size_t i = 0; i < 20; ++i)
+    {
+      ok = check(makeData(size, true), "short data") && ok;
+    }
+  }
+  ok = check(makeData(100000, true), "sync-heavy data") && ok;
+  ok = check(makeData(100000, false), "random data") && ok;
+
+  // like a large jpeg: random data, with a 0xFF roughly every 256 bytes
+  BString picture = makeData(4 * 1024 * 1024, false);
+  report(picture, "4 MB of random data", 5);
+
+  if (!ok)
+  {
+    cerr << "*** unsynchronisation test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
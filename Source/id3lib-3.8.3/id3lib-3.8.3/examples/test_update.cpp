@@ -0,0 +1,205 @@
+// $Id$
+
+// Checks that edits which fit in a tag's padding are written over the old tag
+// without the file changing size, that a tag which outgrows its padding is
+// moved with the audio intact and at least the minimum padding, and that
+// ID3_UpdateTextFrames() makes several edits in one write.  Times an update
+// in place against one which has to copy the audio.
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <time.h>
+#include <string>
+#include "id3/id3lib_streams.h"
+#include "id3/tag.h"
+#include "id3/misc_support.h"
+
+using std::cout;
+using std::endl;
+using std::cerr;
+using std::string;
+
+static const char* file = "test-update.mp3";
+
+static string readFile(const char* name)
+{
+  ifstream in(name, ios::in | ios::binary);
+  string data;
+  char buf[4096];
+  while (in)
+  {
+    in.read(buf, sizeof(buf));
+    data.append(buf, in.gcount());
+  }
+  return data;
+}
+
+// writes a file with no tag and \c size bytes of "audio", which starts with an
+// mp3 frame header like a real mp3 file
+static string makeFile(size_t size)
+{
+  string audio("\xFF\xFB\x90\x64");
+  audio.reserve(size);
+  for (size_t i = audio.size(); i < size; ++i)
+  {
+    audio += static_cast<char>(1 + i % 251);
+  }
+  ofstream out(file, ios::out | ios::binary | ios::trunc);
+  out.write(audio.data(), audio.size());
+  return audio;
+}
+
+static bool checkAudio(const string& audio, size_t tagSize, const char* step)
+{
+  string data = readFile(file);
+  if (data.size() != tagSize + audio.size() ||
+      data.compare(tagSize, string::npos, audio) != 0)
+  {
+    cerr << "*** " << step << ": the audio changed" << endl;
+    return false;
+  }
+  return true;
+}
+
+static string getText(const ID3_Tag& tag, ID3_FrameID id)
+{
+  string text;
+  char* str = ID3_GetString(tag.Find(id), ID3FN_TEXT);
+  if (str)
+  {
+    text = str;
+    ID3_FreeString(str);
+  }
+  return text;
+}
+
+// the size of the tag without any padding
+static size_t unpaddedSize(const ID3_Tag& tag)
+{
+  ID3_Tag copy(tag);
+  copy.SetPadding(false);
+  return copy.Size();
+}
+
+static double timeUpdate(const ID3_FrameID id, const char* text,
+                         size_t minPadding)
+{
+  const ID3_FrameID ids[] = { id };
+  const char* texts[] = { text };
+  clock_t start = clock();
+  ID3_UpdateTextFrames(file, ids, texts, 1, minPadding);
+  return 1e3 * (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+  ID3D_INIT_DOUT();
+  ID3D_INIT_WARNING();
+  ID3D_INIT_NOTICE();
+
+  bool ok = true;
+  const size_t minPadding = 8192;
+  string audio = makeFile(1024 * 1024);
+
+  // the first write leaves at least the minimum padding
+  size_t tagSize = 0;
+  {
+    ID3_Tag tag;
+    tag.SetMinPadding(minPadding);
+    tag.Link(file);
+    ID3_AddTitle(&tag, "Title", true);
+    ID3_AddArtist(&tag, "Artist", true);
+    tag.Update(ID3TT_ID3V2);
+    tagSize = tag.GetPrependedBytes();
+    if (tagSize < unpaddedSize(tag) + minPadding)
+    {
+      cerr << "*** first write: only " << tagSize << " bytes for the tag" << endl;
+      ok = false;
+    }
+    ok = checkAudio(audio, tagSize, "first write") && ok;
+  }
+
+  // several edits which fit in the padding are written over the old tag
+  {
+    const ID3_FrameID ids[] = { ID3FID_BPM, ID3FID_INITIALKEY, ID3FID_TITLE };
+    const char* texts[] = { "128", "Am", "A longer title than before" };
+    if (ID3_UpdateTextFrames(file, ids, texts, 3, minPadding) != ID3TT_ID3V2)
+    {
+      cerr << "*** ID3_UpdateTextFrames() didn't write the tag" << endl;
+      ok = false;
+    }
+    ok = checkAudio(audio, tagSize, "edits in the padding") && ok;
+
+    ID3_Tag tag(file);
+    if (getText(tag, ID3FID_BPM) != "128" ||
+        getText(tag, ID3FID_INITIALKEY) != "Am" ||
+        getText(tag, ID3FID_TITLE) != texts[2] ||
+        getText(tag, ID3FID_LEADARTIST) != "Artist")
+    {
+      cerr << "*** edits in the padding: wrong frames" << endl;
+      ok = false;
+    }
+  }
+
+  // removing a frame is also written in place
+  {
+    const ID3_FrameID ids[] = { ID3FID_INITIALKEY };
+    const char* texts[] = { NULL };
+    ID3_UpdateTextFrames(file, ids, texts, 1, minPadding);
+    ok = checkAudio(audio, tagSize, "removing a frame") && ok;
+    ID3_Tag tag(file);
+    if (tag.Find(ID3FID_INITIALKEY) != NULL)
+    {
+      cerr << "*** removing a frame: the frame is still there" << endl;
+      ok = false;
+    }
+  }
+
+  // a tag which outgrows its padding moves the audio, and leaves the
+  // minimum padding again
+  {
+    string comment(3 * minPadding, 'c');
+    ID3_Tag tag;
+    tag.SetMinPadding(minPadding);
+    tag.Link(file);
+    ID3_AddComment(&tag, comment.c_str(), true);
+    tag.Update(ID3TT_ID3V2);
+    size_t newTagSize = tag.GetPrependedBytes();
+    if (newTagSize < unpaddedSize(tag) + minPadding)
+    {
+      cerr << "*** growing the tag: only " << newTagSize << " bytes for the tag"
+           << endl;
+      ok = false;
+    }
+    ok = checkAudio(audio, newTagSize, "growing the tag") && ok;
+  }
+
+  // a file the size of a long track
+  audio = makeFile(16 * 1024 * 1024);
+  {
+    ID3_Tag tag;
+    tag.SetMinPadding(minPadding);
+    tag.Link(file);
+    ID3_AddTitle(&tag, "Title", true);
+    tag.Update(ID3TT_ID3V2);
+  }
+  double inPlace = timeUpdate(ID3FID_BPM, "126", minPadding);
+  double moved = timeUpdate(ID3FID_COMMENT, string(2 * minPadding, 'c').c_str(),
+                            minPadding);
+  {
+    ID3_Tag tag(file);
+    ok = checkAudio(audio, tag.GetPrependedBytes(), "16 MB file") && ok;
+  }
+  cout << "16 MB file: update in place " << inPlace << " ms, moving the audio "
+       << moved << " ms" << endl;
+
+  remove(file);
+  if (!ok)
+  {
+    cerr << "*** update test failed" << endl;
+    return 1;
+  }
+  return 0;
+}
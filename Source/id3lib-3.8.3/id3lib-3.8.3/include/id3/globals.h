@@ -518,6 +518,14 @@ ID3_ENUM(Mp3_Crc)
   MP3CRC_OK = 1
 };
 
+ID3_ENUM(Mp3_VbrHeader)
+{
+  MP3VBRHEADER_NONE = 0,
+  MP3VBRHEADER_XING,            // vbr, frame count from a xing header
+  MP3VBRHEADER_INFO,            // cbr, frame count from a lame info header
+  MP3VBRHEADER_VBRI             // vbr, frame count from a fraunhofer vbri header
+};
+
 ID3_STRUCT(Mp3_Headerinfo)
 {
   Mpeg_Layers layer;
@@ -535,6 +543,11 @@ ID3_STRUCT(Mp3_Headerinfo)
   bool privatebit;
   bool copyrighted;
   bool original;
+  Mp3_VbrHeader vbr_header;     // where frames came from, if not estimated
+  uint32 samples_per_frame;
+  uint32 samples;               // nr of samples in song, less encoder delay
+  uint32 encoder_delay;         // samples added by the encoder at the start
+  uint32 encoder_padding;       // and at the end, from a lame header
 };
 
 #define ID3_NR_OF_V1_GENRES 148
@@ -32,6 +32,9 @@
 #include "io_helpers.h"
 #include "id3/utils.h" // has <config.h> "id3/id3lib_streams.h" "id3/globals.h" "id3/id3lib_strings.h"
 
+// zlib's stream state, so that zlib.h isn't needed to use the decorators
+struct z_stream_s;
+
 namespace dami
 {
   namespace io
@@ -77,6 +80,10 @@ namespace dami
 
       bool inWindow() { return this->inWindow(this->getCur()); }
 
+      // the reader underneath can end early, e.g. a damaged compressed frame
+      // which inflates to less than its header said
+      bool atEnd() { return SUPER::atEnd() || _reader.atEnd(); }
+
       int_type readChar();
       int_type peekChar();
 
@@ -85,6 +92,8 @@ namespace dami
       { 
         return this->readChars((char_type*) buf, len); 
       }
+      size_type skipChars(size_type len);
+      const char_type* peekChars(size_type len);
 
       void close() { ; }
     };
@@ -139,14 +148,68 @@ namespace dami
      public:
       UnsyncedReader(ID3_Reader& reader) : SUPER(reader) { }
       int_type readChar();
+
+      /**
+       * Read \c len resynced characters into the array \c buf.  If the
+       * underlying reader holds its data in memory, the data is scanned for
+       * 0xFF bytes with memchr() and the runs between them are copied in bulk;
+       * otherwise the characters are read one at a time.
+       */
+      size_type readChars(char_type buf[], size_type len);
+      size_type readChars(char buf[], size_type len)
+      { 
+        return this->readChars((char_type*) buf, len); 
+      }
     };
 
-    class ID3_CPP_EXPORT CompressedReader : public ID3_MemoryReader
+    /**
+     * Decompress the rest of a reader, which holds \c newSize bytes once
+     * decompressed.  The data is inflated as it is read, into a window of at
+     * most 16K, so fields can be parsed without the whole frame being
+     * decompressed first.  Nothing is inflated until the first read.  Moving
+     * back before the window starts inflating again from the beginning.
+     * When the reader is destroyed, the underlying reader is left at the end
+     * of the compressed data.
+     */
+    class ID3_CPP_EXPORT CompressedReader : public ID3_Reader
     {
-      char_type* _uncompressed;
+      typedef ID3_Reader SUPER;
+
+      ID3_Reader& _reader;
+      pos_type _compressedBeg, _compressedEnd;
+      // the compressed data, if the underlying reader holds it in memory
+      const char_type* _compressed;
+      // otherwise, a buffer for the compressed data read from it
+      char_type* _in;
+      z_stream_s* _stream;
+      char_type* _window;
+      size_type _windowSize;
+      // the positions of the first and last+1 inflated bytes in the window
+      pos_type _winBeg, _winEnd;
+      pos_type _cur, _end;
+
+      void restart();
+      bool inflateMore();
+      bool fill(size_type len);
+
      public:
       CompressedReader(ID3_Reader& reader, size_type newSize);
       virtual ~CompressedReader();
+
+      void close() { ; }
+      pos_type getBeg() { return 0; }
+      pos_type getCur() { return _cur; }
+      pos_type getEnd() { return _end; }
+      pos_type setCur(pos_type pos);
+
+      int_type peekChar();
+      const char_type* peekChars(size_type len);
+      size_type readChars(char_type buf[], size_type len);
+      size_type readChars(char buf[], size_type len)
+      {
+        return this->readChars(reinterpret_cast<char_type *>(buf), len);
+      }
+      size_type skipChars(size_type len);
     };
 
     class ID3_CPP_EXPORT UnsyncedWriter : public ID3_Writer
@@ -167,9 +230,10 @@ namespace dami
       void flush();
 
       /**
-       * Write \c len characters into the array \c buf.  Since the stream needs
-       * might have been unsynced, this function copies the characters one at a
-       * time.
+       * Write \c len characters from the array \c buf.  The characters are
+       * scanned for 0xFF bytes with memchr(), and the runs between them are
+       * written in bulk, with a 0x00 sync byte added after each 0xFF that
+       * needs one.
        */
       size_type writeChars(const char_type[], size_type len);
       size_type writeChars(const char buf[], size_type len)
@@ -184,6 +248,12 @@ namespace dami
       pos_type getEnd() { return _writer.getEnd(); }
     };
 
+    /**
+     * Compress everything written to it, and write it to the underlying
+     * writer when flushed.  The data is deflated as it is written, so only
+     * the compressed data is held.  If it turns out no smaller than the
+     * original, it is inflated again and written uncompressed.
+     */
     class CompressedWriter : public ID3_Writer
     {
       typedef ID3_Writer SUPER;
@@ -191,10 +261,13 @@ namespace dami
       ID3_Writer& _writer;
       BString _data;
       size_type _origSize;
+      z_stream_s* _stream;
+
+      void deflateData(int flush);
      public:
 
       explicit CompressedWriter(ID3_Writer& writer)
-        : _writer(writer), _data(), _origSize(0) 
+        : _writer(writer), _data(), _origSize(0), _stream(NULL)
       { ; }
       virtual ~CompressedWriter() { this->flush(); }
       
@@ -208,7 +281,7 @@ namespace dami
         return this->writeChars(reinterpret_cast<const char_type*>(buf), len);
       }
 
-      pos_type getCur() { return _data.size(); }
+      pos_type getCur() { return _origSize; }
       void close() { ; }
     };
   };
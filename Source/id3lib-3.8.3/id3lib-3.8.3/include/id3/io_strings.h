@@ -108,6 +108,15 @@ namespace dami
         _cur += size;
         return size;
       }
+
+      virtual const char_type* peekChars(size_type len)
+      {
+        if (_cur <= _string.size() && len <= _string.size() - _cur)
+        {
+          return reinterpret_cast<const char_type*>(_string.data()) + _cur;
+        }
+        return NULL;
+      }
     };
 
     class ID3_CPP_EXPORT BStringReader : public ID3_Reader
@@ -178,6 +187,15 @@ namespace dami
         _cur += size;
         return size;
       }
+
+      virtual const char_type* peekChars(size_type len)
+      {
+        if (_cur <= _string.size() && len <= _string.size() - _cur)
+        {
+          return _string.data() + _cur;
+        }
+        return NULL;
+      }
     };
 
     class ID3_CPP_EXPORT StringWriter : public ID3_Writer
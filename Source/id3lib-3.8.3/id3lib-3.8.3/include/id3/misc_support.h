@@ -132,6 +132,19 @@ ID3_C_EXPORT char *ID3_GetDescriptionOfPicType(ID3_Tag*, ID3_PictureType pictype
 //following routine courtesy of John George
 ID3_C_EXPORT size_t ID3_RemovePictureType(ID3_Tag*, ID3_PictureType pictype);
 
+// sets the text of any text frame from utf-8 text, replacing any frames with
+// that id, or removes them if the text is NULL or empty.  Text which isn't
+// plain ascii is written as utf-16
+ID3_C_EXPORT ID3_Frame* ID3_SetText(ID3_Tag*, ID3_FrameID, const char*);
+
+// makes several ID3_SetText() edits to a file's tag, and writes them all with
+// a single Update()
+ID3_C_EXPORT flags_t    ID3_UpdateTextFrames(const char* fileName,
+                                             const ID3_FrameID ids[],
+                                             const char* const texts[],
+                                             size_t numEdits,
+                                             size_t minPadding = 0);
+
 
 #endif /* _ID3LIB_MISC_SUPPORT_H_ */
 
@@ -78,6 +78,16 @@ class ID3_CPP_EXPORT ID3_Reader
    ** position.  Returns END_OF_READER if there isn't a character to read.
    **/
   virtual int_type peekChar() = 0;
+
+  /**
+   ** Return a pointer to the next \c len characters without advancing the
+   ** internal position, if the reader holds them in memory one after another.
+   ** Returns NULL otherwise (the default), or if there are fewer than \c len
+   ** characters left.  Callers can then copy data straight out of the reader
+   ** instead of reading it into a buffer first.  The pointer is only valid
+   ** until the reader is next used.
+   **/
+  virtual const char_type* peekChars(size_type len) { return NULL; }
   
   /** Read up to \c len characters into buf and advance the internal position
    ** accordingly.  Returns the number of characters read into buf.  Note that
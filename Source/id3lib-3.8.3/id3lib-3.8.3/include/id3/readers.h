@@ -70,6 +70,21 @@ class ID3_CPP_EXPORT ID3_IStreamReader : public ID3_Reader
   /** Set the value of the internal position for reading.
    **/
   virtual pos_type setCur(pos_type pos) { _stream.seekg(pos); return pos; }
+
+  /** Seek past \c len chars rather than reading them in, so that skipping a
+   ** large frame doesn't read it from the disk.
+   **/
+  virtual size_type skipChars(size_type len)
+  {
+    pos_type cur = this->getCur(), end = this->getEnd();
+    size_type size = (cur < end) ? end - cur : 0;
+    if (len < size)
+    {
+      size = len;
+    }
+    this->setCur(cur + size);
+    return size;
+  }
 };
   
 class ID3_CPP_EXPORT ID3_IFStreamReader : public ID3_IStreamReader
@@ -155,6 +170,53 @@ class ID3_CPP_EXPORT ID3_MemoryReader : public ID3_Reader
     _cur = _beg + size;
     return this->getCur();
   }
+
+  virtual size_type skipChars(size_type len)
+  {
+    size_type size = _end - _cur;
+    if (len < size)
+    {
+      size = len;
+    }
+    _cur += size;
+    return size;
+  }
+
+  virtual const char_type* peekChars(size_type len)
+  {
+    if (len <= size_type(_end - _cur))
+    {
+      return _cur;
+    }
+    return NULL;
+  }
+};
+
+/** Reads a file through a read-only memory mapping of it.  Reads are copies
+ ** out of the mapping rather than stream calls and seeks, and peekChars() can
+ ** hand out pointers straight into the file, which makes scanning the tags of
+ ** many files much cheaper.  Only the pages that are read are loaded from the
+ ** disk.  isOpen() is false if the file couldn't be opened or mapped (e.g.
+ ** it's empty, or memory mapping isn't available), in which case the file
+ ** should be read with an ID3_IFStreamReader instead.
+ **/
+class ID3_CPP_EXPORT ID3_MappedFileReader : public ID3_MemoryReader
+{
+  void*  _map;     // the start of the mapping, or NULL
+  size_t _size;    // the size of the mapping
+#if defined WIN32
+  void*  _file;    // HANDLE of the file
+  void*  _mapping; // HANDLE of the file mapping object
+#endif
+ public:
+  ID3_MappedFileReader(const char* name);
+  virtual ~ID3_MappedFileReader();
+
+  bool isOpen() const { return NULL != _map; }
+
+  /** Unmap the file.  Any pointers returned by peekChars() become invalid.
+   **/
+  virtual void close();
 };
 
 #endif /* _ID3LIB_READERS_H_ */
@@ -75,6 +75,7 @@ public:
   bool       GetExperimental() const;
 
   bool       SetPadding(bool);
+  bool       SetMinPadding(size_t);
 
   void       AddFrame(const ID3_Frame&);
   void       AddFrame(const ID3_Frame*);
@@ -88,6 +89,8 @@ public:
 
   size_t     Link(const char *fileInfo, flags_t = (flags_t) ID3TT_ALL);
   size_t     Link(ID3_Reader &reader, flags_t = (flags_t) ID3TT_ALL);
+  void       SetFramesToParse(const ID3_FrameID *, size_t);
+  bool       GetSkippedFrameData(ID3_FrameID, size_t& offset, size_t& size) const;
   flags_t    Update(flags_t = (flags_t) ID3TT_ALL);
   flags_t    Strip(flags_t = (flags_t) ID3TT_ALL);
 
@@ -87,6 +87,20 @@ namespace dami
   size_t ID3_C_EXPORT ucslen(const unicode_t *unicode);
   String ID3_C_EXPORT convert(String data, ID3_TextEnc, ID3_TextEnc);
 
+  // text conversions between latin-1, utf-8 and big-endian utf-16 (without a
+  // BOM).  Each writes to target, which must have room for twice as many
+  // bytes as source (half as many again for utf-16 to utf-8), and returns the
+  // number of bytes written.  Characters which don't fit in latin-1 become
+  // '?', and invalid utf-8 or utf-16 becomes U+FFFD
+  size_t ID3_C_EXPORT latin1ToUTF16BE(const char* source, size_t len, char* target);
+  size_t ID3_C_EXPORT utf16BEToLatin1(const char* source, size_t len, char* target);
+  size_t ID3_C_EXPORT latin1ToUTF8(const char* source, size_t len, char* target);
+  size_t ID3_C_EXPORT utf8ToLatin1(const char* source, size_t len, char* target);
+  size_t ID3_C_EXPORT utf16BEToUTF8(const char* source, size_t len, char* target);
+  size_t ID3_C_EXPORT utf8ToUTF16BE(const char* source, size_t len, char* target);
+  // swaps the bytes of each utf-16 character, between big- and little-endian
+  void ID3_C_EXPORT swapUTF16(char* text, size_t len);
+
   // file utils
   size_t ID3_C_EXPORT getFileSize(fstream&);
   size_t ID3_C_EXPORT getFileSize(ifstream&);
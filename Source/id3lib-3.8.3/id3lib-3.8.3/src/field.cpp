@@ -37,7 +37,7 @@ using namespace dami;
 
 // This is used for unimplemented frames so that their data is preserved when
 // parsing and rendering
-static ID3_FieldDef ID3FD_Unimplemented[] =
+static const ID3_FieldDef ID3FD_Unimplemented[] =
 {
   {
     ID3FN_DATA,                         // FIELD NAME
@@ -53,7 +53,7 @@ static ID3_FieldDef ID3FD_Unimplemented[] =
 
 const ID3_FieldDef* ID3_FieldDef::DEFAULT = ID3FD_Unimplemented;
 
-static ID3_FieldDef ID3FD_URL[] =
+static const ID3_FieldDef ID3FD_URL[] =
 {
   {
     ID3FN_URL,                          // FIELD NAME
@@ -67,7 +67,7 @@ static ID3_FieldDef ID3FD_URL[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_UserURL[] =
+static const ID3_FieldDef ID3FD_UserURL[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -99,7 +99,7 @@ static ID3_FieldDef ID3FD_UserURL[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_Text[] =
+static const ID3_FieldDef ID3FD_Text[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -123,7 +123,7 @@ static ID3_FieldDef ID3FD_Text[] =
 };
 
 
-static ID3_FieldDef ID3FD_UserText[] =
+static const ID3_FieldDef ID3FD_UserText[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -156,7 +156,7 @@ static ID3_FieldDef ID3FD_UserText[] =
 };
 
 
-static ID3_FieldDef ID3FD_GeneralText[] =
+static const ID3_FieldDef ID3FD_GeneralText[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -197,7 +197,7 @@ static ID3_FieldDef ID3FD_GeneralText[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_TermsOfUse[] =
+static const ID3_FieldDef ID3FD_TermsOfUse[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -229,7 +229,7 @@ static ID3_FieldDef ID3FD_TermsOfUse[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_LinkedInfo[] =
+static const ID3_FieldDef ID3FD_LinkedInfo[] =
 {
   {
     ID3FN_ID,                           // FIELD NAME
@@ -270,7 +270,7 @@ static ID3_FieldDef ID3FD_LinkedInfo[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_Picture[] =
+static const ID3_FieldDef ID3FD_Picture[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -329,7 +329,7 @@ static ID3_FieldDef ID3FD_Picture[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_GEO[] =
+static const ID3_FieldDef ID3FD_GEO[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -379,7 +379,7 @@ static ID3_FieldDef ID3FD_GEO[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_UFI[] =
+static const ID3_FieldDef ID3FD_UFI[] =
 {
   {
     ID3FN_OWNER,                        // FIELD NAME
@@ -402,7 +402,7 @@ static ID3_FieldDef ID3FD_UFI[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_PlayCounter[] =
+static const ID3_FieldDef ID3FD_PlayCounter[] =
 {
   {
     ID3FN_COUNTER,                      // FIELD NAME
@@ -416,7 +416,7 @@ static ID3_FieldDef ID3FD_PlayCounter[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_Popularimeter[] =
+static const ID3_FieldDef ID3FD_Popularimeter[] =
 {
   {
     ID3FN_EMAIL,                        // FIELD NAME
@@ -448,7 +448,7 @@ static ID3_FieldDef ID3FD_Popularimeter[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_Private[] =
+static const ID3_FieldDef ID3FD_Private[] =
 {
   {
     ID3FN_OWNER,                        // FIELD NAME
@@ -472,7 +472,7 @@ static ID3_FieldDef ID3FD_Private[] =
 };
 
 
-static ID3_FieldDef ID3FD_Registration[] =
+static const ID3_FieldDef ID3FD_Registration[] =
 {
   {
     ID3FN_OWNER,                        // FIELD NAME
@@ -504,7 +504,7 @@ static ID3_FieldDef ID3FD_Registration[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_InvolvedPeople[] =
+static const ID3_FieldDef ID3FD_InvolvedPeople[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -527,7 +527,7 @@ static ID3_FieldDef ID3FD_InvolvedPeople[] =
   { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_CDM[] =
+static const ID3_FieldDef ID3FD_CDM[] =
 {
   {
     ID3FN_DATA,                         // FIELD NAME
@@ -537,10 +537,11 @@ static ID3_FieldDef ID3FD_CDM[] =
     ID3V2_2_1,                          // ENDING SPEC
     ID3FF_NONE,                         // FLAGS
     ID3FN_NOFIELD                       // LINKED FIELD
-  }
+  },
+  { ID3FN_NOFIELD }
 };
 
-static ID3_FieldDef ID3FD_SyncLyrics[] =
+static const ID3_FieldDef ID3FD_SyncLyrics[] =
 {
   {
     ID3FN_TEXTENC,                      // FIELD NAME
@@ -604,7 +605,7 @@ static ID3_FieldDef ID3FD_SyncLyrics[] =
  * Currently unused
  */
 #if defined _UNDEFINED_
-static ID3_FieldDef ID3FD_Volume[] =
+static const ID3_FieldDef ID3FD_Volume[] =
 {
   {
     ID3FN_VOLUMEADJ,                    // FIELD NAME
@@ -743,6 +744,9 @@ static ID3_FieldDef ID3FD_Volume[] =
 // RVRB  REV  ID3FID_REVERB            Reverb
 // SYTC  STC  ID3FID_SYNCEDTEMPO       Synchronized tempo codes
 //       CRM  ID3FID_METACRYPTO        Encrypted meta frame
+//
+// Only ever read, so tags may be parsed and rendered on several threads at
+// once.  It isn't const because ID3_FrameInfo hands out its ids as char*.
 static  ID3_FrameDef ID3_FrameDefs[] =
 {
   //                          short  long   tag    file
@@ -62,7 +62,7 @@ size_t ID3_FieldImpl::SetBinary(BString data) //< data to assign to this field.
     size = data.size();
     if (fixed == 0)
     {
-      _binary = data;
+      _binary.swap(data);
     }
     else
     {
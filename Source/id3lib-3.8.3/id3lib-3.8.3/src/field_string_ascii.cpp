@@ -169,7 +169,8 @@ size_t ID3_FieldImpl::SetText_i(String data)
   }
   else
   {
-    _text = data;
+    // data is our own copy, so take its buffer rather than copying it again
+    _text.swap(data);
   }
   ID3D_NOTICE( "SetText_i: text = \"" << _text << "\"" );
   _changed = true;
@@ -331,6 +332,8 @@ bool ID3_FieldImpl::ParseText(ID3_Reader& reader)
   ID3D_NOTICE( "ID3_Field::ParseText(): reader.getEnd() = " << reader.getEnd() );
   this->Clear();
 
+  // only text fields are parsed as text, so the type checks in SetText() and
+  // AddText() are skipped, along with the copies of the text they make
   ID3_TextEnc enc = this->GetEncoding();
   size_t fixed_size = this->Size();
   if (fixed_size)
@@ -338,7 +341,7 @@ bool ID3_FieldImpl::ParseText(ID3_Reader& reader)
     ID3D_NOTICE( "ID3_Field::ParseText(): fixed size string" );
     // The string is of fixed length
     String text = readEncodedText(reader, fixed_size, enc);
-    this->SetText(text);
+    this->SetText_i(text);
     ID3D_NOTICE( "ID3_Field::ParseText(): fixed size string = " << text );
   }
   else if (_flags & ID3FF_LIST)
@@ -349,7 +352,7 @@ bool ID3_FieldImpl::ParseText(ID3_Reader& reader)
     while (!reader.atEnd())
     {
       String text = readEncodedString(reader, enc);
-      this->AddText(text);
+      this->AddText_i(text);
       ID3D_NOTICE( "ID3_Field::ParseText(): adding string = " << text );
     }
   }
@@ -357,7 +360,7 @@ bool ID3_FieldImpl::ParseText(ID3_Reader& reader)
   {
     ID3D_NOTICE( "ID3_Field::ParseText(): null terminated string" );
     String text = readEncodedString(reader, enc);
-    this->SetText(text);
+    this->SetText_i(text);
     ID3D_NOTICE( "ID3_Field::ParseText(): null terminated string = " << text );
   }
   else
@@ -365,7 +368,7 @@ bool ID3_FieldImpl::ParseText(ID3_Reader& reader)
     ID3D_NOTICE( "ID3_Field::ParseText(): last field string" );
     String text = readEncodedText(reader, reader.remainingBytes(), enc);
     // not null terminated.
-    this->AddText(text);
+    this->AddText_i(text);
     ID3D_NOTICE( "ID3_Field::ParseText(): last field string = " << text );
   }
 
@@ -29,6 +29,7 @@
 #endif
 
 //#include <string.h>
+#include <new>
 #include "tag.h"
 #include "frame_impl.h"
 #include "field_impl.h"
@@ -39,6 +40,7 @@ ID3_FrameImpl::ID3_FrameImpl(ID3_FrameID id)
   : _changed(false),
     _bitset(),
     _fields(),
+    _field_block(NULL),
     _encryption_id('\0'),
     _grouping_id('\0')
 {
@@ -50,6 +52,7 @@ ID3_FrameImpl::ID3_FrameImpl(const ID3_FrameHeader &hdr)
   : _changed(false),
     _bitset(),
     _fields(),
+    _field_block(NULL),
     _hdr(hdr),
     _encryption_id('\0'),
     _grouping_id('\0')
@@ -61,6 +64,7 @@ ID3_FrameImpl::ID3_FrameImpl(const ID3_Frame& frame)
   : _changed(false),
     _bitset(),
     _fields(),
+    _field_block(NULL),
     _encryption_id('\0'),
     _grouping_id('\0')
 {
@@ -76,8 +80,10 @@ bool ID3_FrameImpl::_ClearFields()
 {
   for (iterator fi = _fields.begin(); fi != _fields.end(); ++fi)
   {
-    delete (ID3_FieldImpl*) *fi;
+    static_cast<ID3_FieldImpl*>(*fi)->~ID3_FieldImpl();
   }
+  ::operator delete(_field_block);
+  _field_block = NULL;
 
   _fields.clear();
   _bitset.reset();
@@ -97,23 +103,35 @@ void ID3_FrameImpl::Clear()
 void ID3_FrameImpl::_InitFields()
 {
   const ID3_FrameDef* info = _hdr.GetFrameDef();
+  // log this if there's no frame def
+  const ID3_FieldDef* defs = (NULL == info) ? ID3_FieldDef::DEFAULT : info->aeFieldDefs;
+  size_t numFields = 0;
   if (NULL == info)
   {
-    // log this
-    ID3_Field* fld = new ID3_FieldImpl(ID3_FieldDef::DEFAULT[0]);
-    _fields.push_back(fld);
-    _bitset.set(fld->GetID());
+    numFields = 1;
   }
   else
   {
-    
-    for (size_t i = 0; info->aeFieldDefs[i]._id != ID3FN_NOFIELD; ++i)
+    while (defs[numFields]._id != ID3FN_NOFIELD)
     {
-      ID3_Field* fld = new ID3_FieldImpl(info->aeFieldDefs[i]);
-      _fields.push_back(fld);
-      _bitset.set(fld->GetID());
+      ++numFields;
     }
-    
+  }
+
+  // a frame's fields are made and freed together, so rather than allocating
+  // each one on its own they share a single block.  Parsing a tag allocates
+  // two blocks per frame (this and the vector) however many fields it has
+  _fields.reserve(numFields);
+  _field_block = static_cast<ID3_FieldImpl*>(::operator new(numFields * sizeof(ID3_FieldImpl)));
+  for (size_t i = 0; i < numFields; ++i)
+  {
+    ID3_Field* fld = new (&_field_block[i]) ID3_FieldImpl(defs[i]);
+    _fields.push_back(fld);
+    _bitset.set(fld->GetID());
+  }
+
+  if (info)
+  {
     _changed = true;
   }
 }
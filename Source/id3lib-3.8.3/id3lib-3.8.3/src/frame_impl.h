@@ -38,6 +38,8 @@
 #include "id3/id3lib_frame.h"
 #include "header_frame.h"
 
+class ID3_FieldImpl;
+
 class ID3_FrameImpl
 {
   typedef std::bitset<ID3FN_LASTFIELDID> Bitset;
@@ -129,6 +131,7 @@ private:
   mutable bool        _changed;    // frame changed since last parse/render?
   Bitset      _bitset;             // which fields are present?
   Fields      _fields;
+  ID3_FieldImpl* _field_block;     // where the fields live, all in one block
   ID3_FrameHeader _hdr;            // 
   uchar       _encryption_id;      // encryption id
   uchar       _grouping_id;        // grouping id
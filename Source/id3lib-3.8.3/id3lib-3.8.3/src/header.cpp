@@ -33,7 +33,9 @@
 
 bool ID3_Header::SetSpec(ID3_V2Spec spec)
 {
-  static ID3_Header::Info _spec_info[] =
+  // shared by every header, and so never written to: a header keeps the size
+  // of its own extended header in _extended_bytes
+  static const ID3_Header::Info _spec_info[] =
   {
   // Warning, EXT SIZE are minimum sizes, they can be bigger
   // SIZEOF SIZEOF SIZEOF IS EXT EXT  EXPERIM
@@ -50,12 +52,17 @@ bool ID3_Header::SetSpec(ID3_V2Spec spec)
     changed = _spec != ID3V2_UNKNOWN;
     _spec = ID3V2_UNKNOWN;
     _info = NULL;
+    _extended_bytes = 0;
   }
   else
   {
     changed = _spec != spec;
     _spec = spec;
     _info = &_spec_info[_spec - ID3V2_EARLIEST];
+    if (changed)
+    {
+      _extended_bytes = _info->extended_bytes;
+    }
   }
   _changed = _changed || changed;
   return changed;
@@ -51,6 +51,7 @@ public:
   ID3_Header() 
     : _spec (ID3V2_UNKNOWN),
       _data_size (0),
+      _extended_bytes (0),
       _changed (false)
   { 
     this->Clear();
@@ -102,7 +103,8 @@ protected:
   ID3_V2Spec      _spec;             // which version of the spec 
   size_t          _data_size;        // how big is the data?
   ID3_Flags       _flags;            // header flags
-  Info*     _info;             // header info w.r.t. id3v2 spec
+  const Info*     _info;             // header info w.r.t. id3v2 spec
+  size_t          _extended_bytes;   // size of this tag's extended header
   bool            _changed;          // has the header changed since parsing
 }
 ;
@@ -68,6 +68,9 @@ public:
   bool GetEncryption() const  { return _flags.test(ENCRYPTION); }
   bool GetGrouping() const    { return _flags.test(GROUPING); }
   bool GetReadOnly() const    { return _flags.test(READONLY); }
+  // are there any flags (compression, encryption or grouping, or v2.4's
+  // unsynchronisation and data length) which change how the data is stored?
+  bool HasFormatFlags() const { return (_flags.get() & 0xFF) != 0; }
   void                SetUnknownFrame(const char*);
 
 protected:
@@ -56,7 +56,7 @@ size_t ID3_TagHeader::Size() const
 
   if (_info->is_extended)
   {
-    bytesUsed += _info->extended_bytes;
+    bytesUsed += _extended_bytes;
   }
 
   return bytesUsed;
@@ -124,7 +124,7 @@ bool ID3_TagHeader::Parse(ID3_Reader& reader)
   {
     //couldn't find anything about this in the draft specifying 2.2.1 -> http://www.id3.org/pipermail/id3v2/2000-April/000126.html
     _flags.set(HEADER_FLAG_EXTENDED, false);
-    _info->extended_bytes = 0;
+    _extended_bytes = 0;
     // rest is checked at ParseExtended()
   }
   et.setExitPos(reader.getCur());
@@ -152,10 +152,10 @@ void ID3_TagHeader::ParseExtended(ID3_Reader& reader)
       //skip over crc data, we are not using it anyway
       reader.setCur(reader.getCur()+4); //Crc
       //io::readBENumber(reader, 4); //Crc
-      _info->extended_bytes = 14;
+      _extended_bytes = 14;
     }
     else
-      _info->extended_bytes = 10;
+      _extended_bytes = 10;
   }
   if (this->GetSpec() == ID3V2_4_0)
   {
@@ -164,20 +164,24 @@ void ID3_TagHeader::ParseExtended(ID3_Reader& reader)
     Number of flag bytes       $01
     Extended Flags             $xx
 */
-    uint16 i;
     uint16 extrabytes;
 
     io::readUInt28(reader);
     const int extflagbytes = reader.readChar(); //Number of flag bytes
-    ID3_Flags* extflags[1]; // ID3V2_4_0 has 1 flag byte, extflagbytes should be equal to 1
-    for (i = 0; i < extflagbytes; ++i)
+    // ID3V2_4_0 has 1 flag byte, extflagbytes should be equal to 1, so only
+    // the first flag byte is kept and any others are skipped
+    ID3_Flags extflags;
+    for (int i = 0; i < extflagbytes && !reader.atEnd(); ++i)
     {
-      extflags[i] = new ID3_Flags;
-      extflags[i]->set(reader.readChar()); //flags
+      ID3_Reader::int_type flags = reader.readChar(); //flags
+      if (i == 0)
+      {
+        extflags.set(static_cast<ID3_Flags::TYPE>(flags));
+      }
     }
     extrabytes = 0;
-    //extflags[0]->test(EXT_HEADER_FLAG_BIT1); // ID3V2_4_0 ext header flag bit 1 *should* be 0
-    if (extflags[0]->test(EXT_HEADER_FLAG_BIT2))
+    //extflags.test(EXT_HEADER_FLAG_BIT1); // ID3V2_4_0 ext header flag bit 1 *should* be 0
+    if (extflags.test(EXT_HEADER_FLAG_BIT2))
     {
       // ID3V2_4_0 ext header flag bit 2 = Tag is an update
       // read size
@@ -188,7 +192,7 @@ void ID3_TagHeader::ParseExtended(ID3_Reader& reader)
       reader.setCur(reader.getCur() + extheaderflagdatasize);
       //reader.readChars(buf, extheaderflagdatasize); //buf should be at least 127 bytes = max extended header flagdata size
     }
-   if (extflags[0]->test(EXT_HEADER_FLAG_BIT3))
+   if (extflags.test(EXT_HEADER_FLAG_BIT3))
    {
       // ID3V2_4_0 ext header flag bit 3 = CRC data present
       // read size
@@ -199,7 +203,7 @@ void ID3_TagHeader::ParseExtended(ID3_Reader& reader)
       reader.setCur(reader.getCur() + extheaderflagdatasize);
       //reader.readChars(buf, extheaderflagdatasize); //buf should be at least 127 bytes = max extended header flagdata size
     }
-    if (extflags[0]->test(EXT_HEADER_FLAG_BIT4))
+    if (extflags.test(EXT_HEADER_FLAG_BIT4))
     {
       // ID3V2_4_0 ext header flag bit 4 = Tag restrictions
       // read size
@@ -210,15 +214,15 @@ void ID3_TagHeader::ParseExtended(ID3_Reader& reader)
       reader.setCur(reader.getCur() + extheaderflagdatasize);
       //reader.readChars(buf, extheaderflagdatasize); //buf should be at least 127 bytes = max extended header flagdata size
     }
-    _info->extended_bytes = 5 + extflagbytes + extrabytes;
+    _extended_bytes = 5 + extflagbytes + extrabytes;
   }
   // a bit unorthodox, but since we are not using any of the extended header, but were merely
   // parsing it to get the cursor right, we delete it. Be Gone !
   _flags.set(HEADER_FLAG_EXTENDED, false);
   if (_info)
   {
-    _data_size -= _info->extended_bytes;
-    _info->extended_bytes = 0;
+    _data_size -= _extended_bytes;
+    _extended_bytes = 0;
   }//else there is a tag with a higher or lower version than supported
 }
 
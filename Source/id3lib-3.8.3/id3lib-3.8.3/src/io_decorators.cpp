@@ -30,6 +30,7 @@
 
 
 
+#include <string.h>
 #include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 #include "zlib.h"
 
@@ -144,6 +145,29 @@ ID3_Reader::size_type io::WindowedReader::readChars(char_type buf[], size_type l
   return size;
 }
 
+ID3_Reader::size_type io::WindowedReader::skipChars(size_type len)
+{
+  // let the underlying reader skip however it can, so that a file or memory
+  // reader seeks past the window rather than reading everything in it
+  pos_type cur = this->getCur();
+  size_type size = 0;
+  if (this->inWindow(cur))
+  {
+    size = _reader.skipChars(min<size_type>(len, _end - cur));
+  }
+  return size;
+}
+
+const ID3_Reader::char_type* io::WindowedReader::peekChars(size_type len)
+{
+  pos_type cur = this->getCur();
+  if (this->getBeg() <= cur && cur <= _end && len <= _end - cur)
+  {
+    return _reader.peekChars(len);
+  }
+  return NULL;
+}
+
 ID3_Reader::size_type io::CharReader::readChars(char_type buf[], size_type len)
 {
   size_type numChars = 0;
@@ -196,23 +220,258 @@ ID3_Reader::int_type io::UnsyncedReader::readChar()
   return ch;
 }
 
+ID3_Reader::size_type io::UnsyncedReader::readChars(char_type buf[], size_type len)
+{
+  // the sync bytes can only be found in bulk if the data is all in memory
+  size_type avail = this->remainingBytes();
+  const char_type* data = NULL;
+  if (avail != size_type(-1))
+  {
+    data = _reader.peekChars(avail);
+  }
+  if (NULL == data)
+  {
+    return SUPER::readChars(buf, len);
+  }
+
+  ID3D_NOTICE( "UnsyncedReader::readChars(): len = " << len );
+  size_type numChars = 0, pos = 0;
+  while (numChars < len && pos < avail)
+  {
+    // copy everything up to and including the next 0xFF in one go
+    size_type run = min<size_type>(len - numChars, avail - pos);
+    const char_type* ff = 
+      static_cast<const char_type*>(::memchr(data + pos, 0xFF, run));
+    if (ff != NULL)
+    {
+      run = ff - (data + pos) + 1;
+    }
+    if (buf != NULL)
+    {
+      ::memcpy(buf + numChars, data + pos, run);
+    }
+    numChars += run;
+    pos += run;
+
+    // then drop the sync byte after it, if there is one
+    if (ff != NULL && pos < avail && data[pos] == 0x00)
+    {
+      ID3D_NOTICE( "UnsyncedReader::readChars(): found sync at pos " << 
+                   this->getCur() + pos );
+      ++pos;
+    }
+  }
+  _reader.skipChars(pos);
+  ID3D_NOTICE( "UnsyncedReader::readChars(): numChars = " << numChars );
+  return numChars;
+}
+
+namespace
+{
+  // the most data a CompressedReader holds inflated at once
+  const ID3_Reader::size_type WINDOW_SIZE = 16 * 1024;
+  // the size of the chunks compressed data is read and written in
+  const ID3_Reader::size_type CHUNK_SIZE = 4 * 1024;
+}
+
 io::CompressedReader::CompressedReader(ID3_Reader& reader, size_type newSize)
-  : _uncompressed(new char_type[newSize])
+  : _reader(reader),
+    _compressedBeg(reader.getCur()),
+    _compressedEnd(reader.getEnd()),
+    _compressed(NULL),
+    _in(NULL),
+    _stream(new z_stream),
+    _window(NULL),
+    _windowSize(newSize < WINDOW_SIZE ? newSize : WINDOW_SIZE),
+    _winBeg(0),
+    _winEnd(0),
+    _cur(0),
+    _end(newSize)
 {
   size_type oldSize = reader.remainingBytes();
-  
-  BString binary = readBinary(reader, oldSize);
-  
-  ::uncompress(_uncompressed,
-               reinterpret_cast<luint*>(&newSize),
-               reinterpret_cast<const uchar*>(binary.data()),
-               oldSize);
-  this->setBuffer(_uncompressed, newSize);
+  if (oldSize != size_type(-1))
+  {
+    _compressed = reader.peekChars(oldSize);
+  }
+  if (NULL == _compressed)
+  {
+    _in = new char_type[CHUNK_SIZE];
+  }
+  _window = new char_type[_windowSize > 0 ? _windowSize : 1];
+
+  ::memset(_stream, 0, sizeof(z_stream));
+  if (::inflateInit(_stream) != Z_OK)
+  {
+    ID3D_WARNING( "io::CompressedReader: error initialising zlib" );
+    _end = 0;
+  }
+  this->restart();
 }
 
 io::CompressedReader::~CompressedReader()
 { 
-  delete [] _uncompressed; 
+  ::inflateEnd(_stream);
+  delete _stream;
+  delete [] _window;
+  delete [] _in;
+  // the compressed data has all been used up, however much was inflated
+  _reader.setCur(_compressedEnd);
+}
+
+void io::CompressedReader::restart()
+{
+  ::inflateReset(_stream);
+  _winBeg = _winEnd = 0;
+  if (_compressed != NULL)
+  {
+    _stream->next_in = const_cast<Bytef*>(_compressed);
+    _stream->avail_in = _compressedEnd - _compressedBeg;
+  }
+  else
+  {
+    _stream->next_in = NULL;
+    _stream->avail_in = 0;
+    _reader.setCur(_compressedBeg);
+  }
+}
+
+// inflates more data into the window, after what's already there.  Returns
+// false if there's no more to inflate
+bool io::CompressedReader::inflateMore()
+{
+  if (_stream->avail_in == 0)
+  {
+    if (NULL == _in)
+    {
+      return false;
+    }
+    size_type numRead = _reader.readChars(_in, CHUNK_SIZE);
+    if (numRead == 0)
+    {
+      return false;
+    }
+    _stream->next_in = _in;
+    _stream->avail_in = numRead;
+  }
+
+  size_type space = _windowSize - (_winEnd - _winBeg);
+  if (_end - _winEnd < space)
+  {
+    space = _end - _winEnd;
+  }
+  _stream->next_out = _window + (_winEnd - _winBeg);
+  _stream->avail_out = space;
+  int result = ::inflate(_stream, Z_NO_FLUSH);
+  size_type numInflated = space - _stream->avail_out;
+  _winEnd += numInflated;
+  if (result == Z_STREAM_END || (result != Z_OK && numInflated == 0))
+  {
+    if (result != Z_STREAM_END)
+    {
+      ID3D_WARNING( "io::CompressedReader: error decompressing" );
+    }
+    return numInflated > 0;
+  }
+  return true;
+}
+
+// makes the \c len bytes at the current position available in the window, or
+// as many of them as there are.  Returns false if that isn't all of them
+bool io::CompressedReader::fill(size_type len)
+{
+  if (_cur < _winBeg)
+  {
+    this->restart();
+  }
+  if (len > _end - _cur)
+  {
+    len = _end - _cur;
+  }
+  while (_winEnd - _cur < len || _winEnd < _cur)
+  {
+    if (_winEnd - _winBeg == _windowSize)
+    {
+      // slide the window forward, keeping whatever is left to be read
+      size_type keep = (_cur < _winEnd) ? _winEnd - _cur : 0;
+      if (keep == _windowSize)
+      {
+        return false;
+      }
+      ::memmove(_window, _window + _windowSize - keep, keep);
+      _winBeg = _winEnd - keep;
+    }
+    if (!this->inflateMore())
+    {
+      // the data was shorter than the frame said it would be
+      _end = _winEnd;
+      if (_cur > _end)
+      {
+        _cur = _end;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+ID3_Reader::pos_type io::CompressedReader::setCur(pos_type pos)
+{
+  // the data in between is only inflated when it's needed
+  _cur = (pos < _end) ? pos : _end;
+  return _cur;
+}
+
+ID3_Reader::int_type io::CompressedReader::peekChar()
+{
+  if (this->atEnd() || !this->fill(1))
+  {
+    return END_OF_READER;
+  }
+  return _window[_cur - _winBeg];
+}
+
+const ID3_Reader::char_type* io::CompressedReader::peekChars(size_type len)
+{
+  if (len > _end - _cur || !this->fill(len))
+  {
+    return NULL;
+  }
+  return _window + (_cur - _winBeg);
+}
+
+ID3_Reader::size_type io::CompressedReader::readChars(char_type buf[], size_type len)
+{
+  size_type numChars = 0;
+  while (numChars < len && !this->atEnd())
+  {
+    size_type size = len - numChars;
+    if (size > _windowSize)
+    {
+      size = _windowSize;
+    }
+    this->fill(size);
+    if (_winEnd <= _cur)
+    {
+      break;
+    }
+    if (size > _winEnd - _cur)
+    {
+      size = _winEnd - _cur;
+    }
+    if (buf != NULL)
+    {
+      ::memcpy(buf + numChars, _window + (_cur - _winBeg), size);
+    }
+    numChars += size;
+    _cur += size;
+  }
+  return numChars;
+}
+
+ID3_Reader::size_type io::CompressedReader::skipChars(size_type len)
+{
+  pos_type cur = _cur;
+  return this->setCur(len < _end - cur ? cur + len : _end) - cur;
 }
 
 ID3_Writer::int_type io::UnsyncedWriter::writeChar(char_type ch)
@@ -241,50 +500,92 @@ io::UnsyncedWriter::writeChars(const char_type buf[], size_type len)
 {
   pos_type beg = this->getCur();
   ID3D_NOTICE( "UnsyncedWriter::writeChars(): len = " << len );
-  for (size_t i = 0; i < len; ++i)
+  size_type i = 0;
+  while (i < len && !this->atEnd())
   {
-    if (this->atEnd())
+    // a 0xFF followed by 0x00 or by 0xE0 or above needs a sync byte in between
+    if (_last == 0xFF && (buf[i] == 0x00 || buf[i] >= 0xE0))
+    {
+      _writer.writeChar('\0');
+      _last = '\0';
+      _numSyncs++;
+    }
+
+    // write everything up to and including the next 0xFF in one go
+    size_type run = len - i;
+    const char_type* ff = 
+      static_cast<const char_type*>(::memchr(buf + i, 0xFF, run));
+    if (ff != NULL)
+    {
+      run = ff - (buf + i) + 1;
+    }
+    size_type numWritten = _writer.writeChars(buf + i, run);
+    if (numWritten == 0)
+    {
+      break;
+    }
+    i += numWritten;
+    _last = buf[i - 1];
+    if (numWritten < run)
     {
       break;
     }
-    this->writeChar(buf[i]);
   }
   size_type numChars = this->getCur() - beg;
-  ID3D_NOTICE( "CharWriter::writeChars(): numChars = " << numChars );
+  ID3D_NOTICE( "UnsyncedWriter::writeChars(): numChars = " << numChars );
   return numChars;
 }
 
+// deflates the data waiting in the zlib stream and adds it to the compressed
+// data
+void io::CompressedWriter::deflateData(int flush)
+{
+  char_type out[CHUNK_SIZE];
+  int result = Z_OK;
+  do
+  {
+    _stream->next_out = out;
+    _stream->avail_out = CHUNK_SIZE;
+    result = ::deflate(_stream, flush);
+    _data.append(out, CHUNK_SIZE - _stream->avail_out);
+  }
+  while (_stream->avail_out == 0 && result != Z_STREAM_ERROR);
+  if (result == Z_STREAM_ERROR)
+  {
+    ID3D_WARNING("io::CompressedWriter: error compressing");
+  }
+}
+
 void io::CompressedWriter::flush()
 {
-  if (_data.size() == 0)
+  if (NULL == _stream)
   {
     return;
   }
-  const char_type* data = reinterpret_cast<const char_type*>(_data.data());
+  this->deflateData(Z_FINISH);
+  ::deflateEnd(_stream);
+  delete _stream;
+  _stream = NULL;
+
   size_type dataSize = _data.size();
-  _origSize = dataSize;
-  // The zlib documentation specifies that the destination size needs to
-  // be an unsigned long at least 0.1% larger than the source buffer,
-  // plus 12 bytes
-  unsigned long newDataSize = dataSize + (dataSize / 10) + 12;
-  char_type* newData = new char_type[newDataSize];
-  if (::compress(newData, &newDataSize, data, dataSize) != Z_OK)
-  {
-    // log this
-    ID3D_WARNING("io::CompressedWriter: error compressing");
-    _writer.writeChars(data, dataSize);
-  }
-  else if (newDataSize < dataSize)
+  if (dataSize < _origSize)
   {
-    ID3D_NOTICE("io::CompressedWriter: compressed size = " << newDataSize << ", original size = " << dataSize ); 
-    _writer.writeChars(newData, newDataSize);
+    ID3D_NOTICE("io::CompressedWriter: compressed size = " << dataSize << ", original size = " << _origSize ); 
+    _writer.writeChars(_data.data(), dataSize);
   }
   else
   {
-    ID3D_NOTICE("io::CompressedWriter: no compression!compressed size = " << newDataSize << ", original size = " << dataSize ); 
-    _writer.writeChars(data, dataSize);
+    ID3D_NOTICE("io::CompressedWriter: no compression!compressed size = " << dataSize << ", original size = " << _origSize ); 
+    // the original data isn't kept, so get it back from the compressed data
+    ID3_MemoryReader mr(_data.data(), dataSize);
+    CompressedReader cr(mr, _origSize);
+    char_type buf[CHUNK_SIZE];
+    size_type numRead = 0;
+    while ((numRead = cr.readChars(buf, CHUNK_SIZE)) > 0)
+    {
+      _writer.writeChars(buf, numRead);
+    }
   }
-  delete [] newData;
   _data.erase();
 }
 
@@ -292,7 +593,16 @@ ID3_Writer::size_type
 io::CompressedWriter::writeChars(const char_type buf[], size_type len)
 { 
   ID3D_NOTICE("io::CompressedWriter: writing chars: " << len );
-  _data.append(buf, len);
+  if (NULL == _stream)
+  {
+    _stream = new z_stream;
+    ::memset(_stream, 0, sizeof(z_stream));
+    ::deflateInit(_stream, Z_DEFAULT_COMPRESSION);
+    _origSize = 0;
+  }
+  _stream->next_in = const_cast<Bytef*>(buf);
+  _stream->avail_in = len;
+  this->deflateData(Z_NO_FLUSH);
+  _origSize += len;
   return len;
 }
-
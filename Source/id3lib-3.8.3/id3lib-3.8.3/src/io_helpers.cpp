@@ -49,6 +49,14 @@ String io::readString(ID3_Reader& reader)
 
 String io::readText(ID3_Reader& reader, size_t len)
 {
+  // copy the text straight out of the reader if it's in memory
+  const ID3_Reader::char_type* view = reader.peekChars(len);
+  if (NULL != view)
+  {
+    reader.skipChars(len);
+    return String(reinterpret_cast<const String::value_type *>(view), len);
+  }
+
   String str;
   str.reserve(len);
   const size_t SIZE = 1024;
@@ -57,6 +65,12 @@ String io::readText(ID3_Reader& reader, size_t len)
   while (remaining > 0 && !reader.atEnd())
   {
     size_t numRead = reader.readChars(buf, min(remaining, SIZE));
+    // a window can end past the data it's over (e.g. a damaged compressed
+    // frame), so stop once nothing more can be read
+    if (numRead == 0)
+    {
+      break;
+    }
     remaining -= numRead;
     str.append(reinterpret_cast<String::value_type *>(buf), numRead);
   }
@@ -125,6 +139,28 @@ namespace
 String io::readUnicodeString(ID3_Reader& reader)
 {
   String unicode;
+  // if the rest of the reader is in memory, find the null character and copy
+  // the string in one go
+  size_t remaining = reader.remainingBytes();
+  const ID3_Reader::char_type* view = reader.peekChars(remaining);
+  if (NULL != view)
+  {
+    size_t len = 0;
+    while (len + 1 < remaining && !isNull(view[len], view[len + 1]))
+    {
+      len += 2;
+    }
+    size_t start = (len >= 2 && isBOM(view[0], view[1])) ? 2 : 0;
+    unicode.assign(reinterpret_cast<const char*>(view) + start, len - start);
+    if (start && view[0] == 0xFF)
+    {
+      swapUTF16(&unicode[0], unicode.size());
+    }
+    // skip the null character too, unless the string ran to the end
+    reader.skipChars(len + 1 < remaining ? len + 2 : len);
+    return unicode;
+  }
+
   ID3_Reader::char_type ch1, ch2;
   if (!readTwoChars(reader, ch1, ch2) || isNull(ch1, ch2))
   {
@@ -158,35 +194,22 @@ String io::readUnicodeString(ID3_Reader& reader)
 
 String io::readUnicodeText(ID3_Reader& reader, size_t len)
 {
-  String unicode;
-  ID3_Reader::char_type ch1, ch2;
-  if (!readTwoChars(reader, ch1, ch2))
-  {
-    return unicode;
-  }
-  len -= 2;
-  int bom = isBOM(ch1, ch2);
-  if (!bom)
+  // read the whole text at once, then take off the BOM and put the characters
+  // in big-endian order
+  String unicode = readText(reader, len);
+  if (unicode.size() < 2)
   {
-    unicode += ch1;
-    unicode += ch2;
-    unicode += readText(reader, len);
+    return String();
   }
-  else if (bom == 1)
+  unicode.resize((unicode.size() / 2) * 2);
+  int bom = isBOM(unicode[0], unicode[1]);
+  if (bom)
   {
-    unicode = readText(reader, len);
+    unicode.erase(0, 2);
   }
-  else
+  if (bom == -1)
   {
-    for (size_t i = 0; i < len; i += 2)
-    {
-      if (!readTwoChars(reader, ch1, ch2))
-      {
-        break;
-      }
-      unicode += ch2;
-      unicode += ch1;
-    }
+    swapUTF16(&unicode[0], unicode.size());
   }
   return unicode;
 }
@@ -198,6 +221,14 @@ BString io::readAllBinary(ID3_Reader& reader)
 
 BString io::readBinary(ID3_Reader& reader, size_t len)
 {
+  // copy the data straight out of the reader if it's in memory
+  const ID3_Reader::char_type* view = reader.peekChars(len);
+  if (NULL != view)
+  {
+    reader.skipChars(len);
+    return BString(reinterpret_cast<const BString::value_type *>(view), len);
+  }
+
   BString binary;
   binary.reserve(len);
   
@@ -207,6 +238,12 @@ BString io::readBinary(ID3_Reader& reader, size_t len)
   while (!reader.atEnd() && remaining > 0)
   {
     size_t numRead = reader.readChars(buf, min(remaining, SIZE));
+    // a window can end past the data it's over (e.g. a damaged compressed
+    // frame), so stop once nothing more can be read
+    if (numRead == 0)
+    {
+      break;
+    }
     remaining -= numRead;
     binary.append(reinterpret_cast<BString::value_type *>(buf), numRead);
   }
@@ -231,6 +268,17 @@ uint32 io::readLENumber(ID3_Reader& reader, size_t len)
 uint32 io::readBENumber(ID3_Reader& reader, size_t len)
 {
   uint32 val = 0;
+
+  const ID3_Reader::char_type* view = reader.peekChars(len);
+  if (NULL != view)
+  {
+    for (size_t i = 0; i < len; ++i)
+    {
+      val = val * 256 + view[i];
+    }
+    reader.skipChars(len);
+    return val;
+  }
   
   for (ID3_Reader::size_type i = 0; i < len && !reader.atEnd(); ++i)
   {
@@ -358,17 +406,19 @@ size_t io::writeUnicodeText(ID3_Writer& writer, String data, bool bom)
   {
     return 0;
   }
+  String text;
+  text.reserve(size + 2);
   if (bom)
   {
-    // Write the BOM: 0xFEFF
+    // Write the BOM: 0xFEFF, followed by the characters in the same byte order
     unicode_t BOM = 0xFEFF;
-    writer.writeChars((const unsigned char*) &BOM, 2);
-    for (size_t i = 0; i < size; i += 2)
-    {
-      unicode_t ch = (data[i] << 8) | data[i+1];
-      writer.writeChars((const unsigned char*) &ch, 2);
-    }
+    text.append(reinterpret_cast<const char*>(&BOM), 2);
   }
+  text.append(data, 0, size);
+  if (bom && static_cast<unsigned char>(text[0]) == 0xFF)
+  {
+    swapUTF16(&text[2], size);
+  }
+  writer.writeChars(text.data(), text.size());
   return writer.getCur() - beg;
 }
-
@@ -1170,3 +1170,90 @@ ID3_Frame *ID3_GetSyncLyrics(const ID3_Tag* tag, const char* lang,
   return frmExist;
 }
 
+
+ID3_Frame* ID3_SetText(ID3_Tag *tag, ID3_FrameID id, const char *text)
+{
+  if (NULL == tag)
+  {
+    return NULL;
+  }
+
+  // only frames with a text field can be set
+  ID3_Frame* frame = new ID3_Frame(id);
+  if (NULL == frame->GetField(ID3FN_TEXT))
+  {
+    delete frame;
+    return NULL;
+  }
+
+  ID3_Frame* old = NULL;
+  while ((old = tag->Find(id)))
+  {
+    delete tag->RemoveFrame(old);
+  }
+
+  if (NULL == text || strlen(text) == 0)
+  {
+    delete frame;
+    return NULL;
+  }
+
+  // the text is utf-8.  Plain ascii is written as iso-8859-1, which every
+  // player reads, and anything else as utf-16, as an id3v2.3 tag can't hold
+  // utf-8
+  size_t len = strlen(text);
+  bool isAscii = true;
+  for (size_t i = 0; i < len && isAscii; ++i)
+  {
+    isAscii = static_cast<unsigned char>(text[i]) < 0x80;
+  }
+  if (isAscii)
+  {
+    frame->GetField(ID3FN_TEXT)->Set(text);
+  }
+  else
+  {
+    // utf-16 never takes more than twice as many bytes as utf-8, and the
+    // buffer is null-terminated for ID3_Field::Set()
+    unicode_t* unicode = new unicode_t[len + 1];
+    size_t size = dami::utf8ToUTF16BE(text, len, reinterpret_cast<char*>(unicode));
+    unicode[size / 2] = NULL_UNICODE;
+    if (ID3_Field* enc = frame->GetField(ID3FN_TEXTENC))
+    {
+      enc->Set(ID3TE_UTF16);
+    }
+    frame->GetField(ID3FN_TEXT)->SetEncoding(ID3TE_UTF16);
+    frame->GetField(ID3FN_TEXT)->Set(unicode);
+    delete [] unicode;
+  }
+  tag->AttachFrame(frame);
+  return frame;
+}
+
+flags_t ID3_UpdateTextFrames(const char *fileName, const ID3_FrameID ids[],
+                             const char* const texts[], size_t numEdits,
+                             size_t minPadding)
+{
+  if (NULL == fileName || (numEdits > 0 && (NULL == ids || NULL == texts)))
+  {
+    return ID3TT_NONE;
+  }
+
+  ID3_Tag tag;
+  tag.SetMinPadding(minPadding);
+  tag.Link(fileName);
+  for (size_t i = 0; i < numEdits; ++i)
+  {
+    ID3_SetText(&tag, ids[i], texts[i]);
+  }
+
+  // if the edits fit in the tag's padding, only the tag is written; the
+  // audio is only copied if the tag has grown past its padding.  An id3v1 tag
+  // is kept in step, but not added if the file didn't have one
+  flags_t tags = ID3TT_ID3V2;
+  if (tag.HasTagType(ID3TT_ID3V1))
+  {
+    tags |= ID3TT_ID3V1;
+  }
+  return tag.Update(tags);
+}
@@ -55,6 +55,11 @@ public:
   bool Copyrighted() const { return _mp3_header_output->copyrighted; };
   bool Original() const { return _mp3_header_output->original; };
   uint32 Seconds() const { return _mp3_header_output->time; };
+  Mp3_VbrHeader VbrHeader() const { return _mp3_header_output->vbr_header; };
+  uint32 SamplesPerFrame() const { return _mp3_header_output->samples_per_frame; };
+  uint32 Samples() const { return _mp3_header_output->samples; };
+  uint32 EncoderDelay() const { return _mp3_header_output->encoder_delay; };
+  uint32 EncoderPadding() const { return _mp3_header_output->encoder_padding; };
 
 private:
 
@@ -25,6 +25,7 @@
 // id3lib.  These files are distributed with id3lib at
 // http://download.sourceforge.net/id3lib/
 
+#include <string.h>
 #include "mp3_header.h"
 
 #define FRAMES_FLAG     0x0001
@@ -32,7 +33,7 @@
 #define TOC_FLAG        0x0004
 #define SCALE_FLAG      0x0008
 
-static int ExtractI4(unsigned char *buf)
+static int ExtractI4(const unsigned char *buf)
 {
   int x;
   // big endian extract
@@ -231,6 +232,7 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   char buf[HEADERSIZE+1]; //+1 to hold the \0 char
   ID3_Reader::pos_type beg = reader.getCur() ;
   ID3_Reader::pos_type end = beg + HEADERSIZE ;
+  const ID3_Reader::pos_type frame_beg = beg;
   reader.setCur(beg);
   int bitrate_index;
 
@@ -246,6 +248,11 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   _mp3_header_output->frames = 0;
   _mp3_header_output->time = 0;
   _mp3_header_output->vbr_bitrate = 0;
+  _mp3_header_output->vbr_header = MP3VBRHEADER_NONE;
+  _mp3_header_output->samples_per_frame = 0;
+  _mp3_header_output->samples = 0;
+  _mp3_header_output->encoder_delay = 0;
+  _mp3_header_output->encoder_padding = 0;
 
   reader.readChars(buf, HEADERSIZE);
   buf[HEADERSIZE]='\0';
@@ -403,10 +410,10 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
         _mp3_header_output->framesize = 144 * _mp3_header_output->bitrate / _mp3_header_output->frequency + (_tmpheader->padding_bit ? 1 : 0);
         break;
       case MPEGLAYER_III: // Layer 3
-        if(_mp3_header_output->version == MPEGVERSION_2_5)
+        if(_mp3_header_output->version == MPEGVERSION_1)
           _mp3_header_output->framesize = 144 * _mp3_header_output->bitrate / _mp3_header_output->frequency + (_tmpheader->padding_bit ? 1 : 0); //Mpeg1
         else
-          _mp3_header_output->framesize =  72000 * _mp3_header_output->bitrate / _mp3_header_output->frequency + (_tmpheader->padding_bit ? 1 : 0); //Mpeg2 + Mpeg2.5
+          _mp3_header_output->framesize =  72 * _mp3_header_output->bitrate / _mp3_header_output->frequency + (_tmpheader->padding_bit ? 1 : 0); //Mpeg2 + Mpeg2.5
         break;
     }
 //    if (_mp3_header_output->layer == MPEGLAYER_I)
@@ -417,6 +424,21 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   else
     _mp3_header_output->framesize = 0; //unable to determine
 
+  switch(_mp3_header_output->layer)
+  {
+    case MPEGLAYER_I:
+      _mp3_header_output->samples_per_frame = 384;
+      break;
+    case MPEGLAYER_II:
+      _mp3_header_output->samples_per_frame = 1152;
+      break;
+    case MPEGLAYER_III: // Mpeg2 + Mpeg2.5 frames are half as long
+      _mp3_header_output->samples_per_frame = (_mp3_header_output->version == MPEGVERSION_1) ? 1152 : 576;
+      break;
+    default:
+      break;
+  }
+
   const size_t CRCSIZE = 2;
   size_t sideinfo_len;
 
@@ -425,8 +447,8 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   else                /* MPEG 2 */
     sideinfo_len = (_mp3_header_output->channelmode == MP3CHANNELMODE_SINGLE_CHANNEL) ? 4 + 9 : 4 + 17;
 
-  int vbr_header_offest = beg + sideinfo_len;
-  int vbr_frames = 0;
+  // the xing header comes after the side info, and the crc if there is one
+  const size_t vbr_header_offset = sideinfo_len + (_tmpheader->protection_bit ? 0 : CRCSIZE);
 
   sideinfo_len += 2; // add two for the crc itself
 
@@ -460,101 +482,120 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
       _mp3_header_output->crc = MP3CRC_OK;
   }
 
-  // read xing/vbr header if present
-  // derived from code in vbrheadersdk.zip 
+  // read the xing (or lame "info") or vbri header, and the lame header which
+  // follows a xing header, if present.  They are all in the first frame, so
+  // it's read with a single read, however large the file is.
+  // derived from code in vbrheadersdk.zip
   // from http://www.xingtech.com/developer/mp3/
+  // and from http://gabriel.mp3-tech.org/mp3infotag.html
 
   const size_t VBR_HEADER_MIN_SIZE = 8;     // "xing" + flags are fixed
-  const size_t VBR_HEADER_MAX_SIZE = 116;   // frames, bytes, toc and scale are optional
-
-  if (mp3size >= vbr_header_offest + VBR_HEADER_MIN_SIZE) 
+  const size_t LAME_HEADER_OFFSET = 120;    // from the start of the xing header
+  const size_t LAME_HEADER_SIZE = 24;       // up to the encoder delay and padding
+  const size_t VBRI_HEADER_OFFSET = 4 + 32; // always after mpeg1 stereo side info
+  const size_t VBRI_HEADER_SIZE = 18;       // up to the frame count
+  const size_t FIRST_FRAME_MAX_SIZE = 4 + 32 + CRCSIZE + LAME_HEADER_OFFSET + LAME_HEADER_SIZE;
+
+  uchar firstframe[FIRST_FRAME_MAX_SIZE];
+  reader.setCur(frame_beg);
+  size_t firstframe_size = reader.readChars(firstframe,
+    (mp3size < FIRST_FRAME_MAX_SIZE) ? mp3size : FIRST_FRAME_MAX_SIZE);
+
+  Mp3_VbrHeader vbr_header = MP3VBRHEADER_NONE;
+  uint32 vbr_frames = 0;
+  uint32 vbr_filesize = 0;
+  const uchar *pvbrdata = firstframe + vbr_header_offset;
+
+  if (firstframe_size >= vbr_header_offset + VBR_HEADER_MIN_SIZE &&
+      (memcmp(pvbrdata, "Xing", 4) == 0 || memcmp(pvbrdata, "Info", 4) == 0))
   {
-    char vbrheaderdata[VBR_HEADER_MAX_SIZE+1]; //+1 to hold the 0 char
-    unsigned char *pvbrdata = (unsigned char *)vbrheaderdata;
-    int vbr_filesize = 0;
-    int vbr_scale = 0;
-    int vbr_flags = 0;
-
-    // get fixed part of vbr header 
-    // and check if valid
-
-    beg = vbr_header_offest;
-    reader.setCur(beg);
-    reader.readChars(vbrheaderdata, VBR_HEADER_MIN_SIZE);
-    vbrheaderdata[VBR_HEADER_MIN_SIZE] = '\0';
+    const uchar *xing = pvbrdata;
 
-    if (pvbrdata[0] == 'X' &&
-        pvbrdata[1] == 'i' &&
-        pvbrdata[2] == 'n' &&
-        pvbrdata[3] == 'g')
-    {
-      // get vbr flags
-      pvbrdata += 4;
-      vbr_flags = ExtractI4(pvbrdata);
-      pvbrdata += 4;
+    // get vbr flags
+    pvbrdata += 4;
+    int vbr_flags = ExtractI4(pvbrdata);
+    pvbrdata += 4;
 
-      //  read entire vbr header
-      int vbr_header_size = VBR_HEADER_MIN_SIZE
+    size_t vbr_header_size = VBR_HEADER_MIN_SIZE
                            + ((vbr_flags & FRAMES_FLAG)? 4:0)
                            + ((vbr_flags & BYTES_FLAG)? 4:0)
                            + ((vbr_flags & TOC_FLAG)? 100:0)
                            + ((vbr_flags & SCALE_FLAG)? 4:0);
 
-      if (mp3size >= vbr_header_offest + vbr_header_size) 
+    // get frames and bytes; the toc and scale aren't used
+    if (firstframe_size >= vbr_header_offset + vbr_header_size)
+    {
+      if (vbr_flags & FRAMES_FLAG)
+      {
+        vbr_frames = ExtractI4(pvbrdata);
+        pvbrdata +=4;
+      }
+
+      if (vbr_flags & BYTES_FLAG)
+      {
+        vbr_filesize = ExtractI4(pvbrdata);
+        pvbrdata +=4;
+      }
+      // lame writes "Info" instead of "Xing" when every frame has the same bitrate
+      vbr_header = (xing[0] == 'X') ? MP3VBRHEADER_XING : MP3VBRHEADER_INFO;
+    }
+
+    // the lame header has the number of samples the encoder added at the start
+    // and end of the song, for gapless playback.  ffmpeg writes it too
+    if (firstframe_size >= vbr_header_offset + LAME_HEADER_OFFSET + LAME_HEADER_SIZE)
+    {
+      const uchar *lame = xing + LAME_HEADER_OFFSET;
+      if (memcmp(lame, "LAME", 4) == 0 || memcmp(lame, "Lavf", 4) == 0 ||
+          memcmp(lame, "Lavc", 4) == 0)
       {
-        reader.readChars(&vbrheaderdata[VBR_HEADER_MIN_SIZE], vbr_header_size - VBR_HEADER_MIN_SIZE); 
-        vbrheaderdata[vbr_header_size] = '\0';
-
-        // get frames, bytes, toc and scale
-
-        if (vbr_flags & FRAMES_FLAG)
-        {
-          vbr_frames = ExtractI4(pvbrdata); 
-          pvbrdata +=4;
-        }
-
-        if (vbr_flags & BYTES_FLAG)
-        {
-          vbr_filesize = ExtractI4(pvbrdata); 
-          pvbrdata +=4;
-        }
-
-        if (vbr_flags & TOC_FLAG)
-        {
-          // seek offsets
-          // we are not using
-          // for(i=0;i<100;i++) seek_offsets[i] = pvbrdata[i];
-
-          pvbrdata +=100;
-        }
-
-        if (vbr_flags & SCALE_FLAG)
-        {
-          vbr_scale = ExtractI4(pvbrdata); 
-          pvbrdata +=4;
-        }
-
-        if (vbr_frames > 0)
-        {
-          _mp3_header_output->vbr_bitrate = (((vbr_filesize!=0) ? vbr_filesize : mp3size) / vbr_frames) * _mp3_header_output->frequency / 144;
-          _mp3_header_output->vbr_bitrate -= _mp3_header_output->vbr_bitrate%1000;   // round the bitrate:
-        }
+        _mp3_header_output->encoder_delay = (lame[21] << 4) | (lame[22] >> 4);
+        _mp3_header_output->encoder_padding = ((lame[22] & 0x0F) << 8) | lame[23];
       }
     }
   }
+  else if (firstframe_size >= VBRI_HEADER_OFFSET + VBRI_HEADER_SIZE &&
+           memcmp(firstframe + VBRI_HEADER_OFFSET, "VBRI", 4) == 0)
+  {
+    // "VBRI", version, delay and quality, then bytes and frames
+    const uchar *vbri = firstframe + VBRI_HEADER_OFFSET;
+    vbr_filesize = ExtractI4(vbri + 10);
+    vbr_frames = ExtractI4(vbri + 14);
+    vbr_header = MP3VBRHEADER_VBRI;
+  }
 
-  if (_mp3_header_output->framesize > 0 && mp3size >= _mp3_header_output->framesize) // this means bitrate is not none too
+  const uint32 samples_per_frame = _mp3_header_output->samples_per_frame;
+  if (vbr_frames > 0 && samples_per_frame > 0)
   {
-    if (vbr_frames == 0)
-      _mp3_header_output->frames = fto_nearest_i((float)mp3size / _mp3_header_output->framesize);
-    else
-      _mp3_header_output->frames = vbr_frames;
+    // the encoder counted the frames, so the length is exact
+    _mp3_header_output->vbr_header = vbr_header;
+    _mp3_header_output->frames = vbr_frames;
+
+    double samples = (double)vbr_frames * samples_per_frame;
+    uint32 gap = _mp3_header_output->encoder_delay + _mp3_header_output->encoder_padding;
+    if (samples > gap)
+      samples -= gap;
+    _mp3_header_output->samples = (uint32)samples;
+    _mp3_header_output->time = fto_nearest_i((float)(samples / _mp3_header_output->frequency));
+
+    if (vbr_header != MP3VBRHEADER_INFO)
+    {
+      // bitrate is bytes * 8 over the length of the frames
+      double vbr_bytes = (vbr_filesize != 0) ? vbr_filesize : mp3size;
+      _mp3_header_output->vbr_bitrate = (uint32)(vbr_bytes * 8 * _mp3_header_output->frequency /
+                                                 ((double)vbr_frames * samples_per_frame));
+      _mp3_header_output->vbr_bitrate -= _mp3_header_output->vbr_bitrate%1000;   // round the bitrate:
+    }
+  }
+  else if (_mp3_header_output->framesize > 0 && mp3size >= _mp3_header_output->framesize) // this means bitrate is not none too
+  {
+    // estimated from the size of the file, which is only right if every frame
+    // has the same bitrate as the first
+    _mp3_header_output->frames = fto_nearest_i((float)mp3size / _mp3_header_output->framesize);
 
     // bitrate becomes byterate (per second) if divided by 8
-    if (_mp3_header_output->vbr_bitrate == 0)
-      _mp3_header_output->time = fto_nearest_i( (float)mp3size / (_mp3_header_output->bitrate / 8) );
-    else
-      _mp3_header_output->time = fto_nearest_i( (float)mp3size / (_mp3_header_output->vbr_bitrate / 8) );
+    _mp3_header_output->time = fto_nearest_i( (float)mp3size / (_mp3_header_output->bitrate / 8) );
+    _mp3_header_output->samples = (uint32)((double)mp3size * 8 * _mp3_header_output->frequency /
+                                           _mp3_header_output->bitrate);
   }
   else
   {
@@ -564,5 +605,3 @@ bool Mp3Info::Parse(ID3_Reader& reader, size_t mp3size)
   //if we got to here it's okay
   return true;
 }
-
-
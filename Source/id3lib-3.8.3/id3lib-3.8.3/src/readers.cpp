@@ -27,6 +27,18 @@
 #include "readers.h"
 #include "id3/utils.h" // has <config.h> "id3/id3lib_streams.h" "id3/globals.h" "id3/id3lib_strings.h"
 
+#if defined WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#elif defined HAVE_SYS_MMAN_H
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 using namespace dami;
 
 ID3_Reader::size_type
@@ -38,3 +50,103 @@ ID3_MemoryReader::readChars(char_type buf[], size_type len)
   return size;
 }
 
+
+ID3_MappedFileReader::ID3_MappedFileReader(const char* name)
+  : _map(NULL),
+    _size(0)
+#if defined WIN32
+    , _file(INVALID_HANDLE_VALUE),
+    _mapping(NULL)
+#endif
+{
+  if (NULL == name)
+  {
+    return;
+  }
+#if defined WIN32
+  _file = ::CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (INVALID_HANDLE_VALUE == _file)
+  {
+    return;
+  }
+  LARGE_INTEGER size;
+  // empty files can't be mapped, and positions are only 32 bits
+  if (!::GetFileSizeEx(_file, &size) || size.QuadPart == 0 ||
+      size.QuadPart >= static_cast<pos_type>(-1))
+  {
+    this->close();
+    return;
+  }
+  _mapping = ::CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (NULL == _mapping)
+  {
+    this->close();
+    return;
+  }
+  _map = ::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+  if (NULL == _map)
+  {
+    this->close();
+    return;
+  }
+  _size = static_cast<size_t>(size.QuadPart);
+#elif defined HAVE_SYS_MMAN_H
+  int fd = ::open(name, O_RDONLY);
+  if (fd < 0)
+  {
+    return;
+  }
+  struct stat st;
+  // empty files can't be mapped, and positions are only 32 bits
+  if (::fstat(fd, &st) == 0 && st.st_size > 0 &&
+      static_cast<unsigned long long>(st.st_size) < static_cast<pos_type>(-1))
+  {
+    void* map = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED != map)
+    {
+      _map = map;
+      _size = st.st_size;
+    }
+  }
+  // the mapping keeps the file open
+  ::close(fd);
+#endif
+  if (NULL != _map)
+  {
+    this->setBuffer(static_cast<const char_type*>(_map), _size);
+  }
+}
+
+ID3_MappedFileReader::~ID3_MappedFileReader()
+{
+  this->close();
+}
+
+void ID3_MappedFileReader::close()
+{
+#if defined WIN32
+  if (NULL != _map)
+  {
+    ::UnmapViewOfFile(_map);
+  }
+  if (NULL != _mapping)
+  {
+    ::CloseHandle(_mapping);
+    _mapping = NULL;
+  }
+  if (INVALID_HANDLE_VALUE != _file)
+  {
+    ::CloseHandle(_file);
+    _file = INVALID_HANDLE_VALUE;
+  }
+#elif defined HAVE_SYS_MMAN_H
+  if (NULL != _map)
+  {
+    ::munmap(_map, _size);
+  }
+#endif
+  _map = NULL;
+  _size = 0;
+  this->setBuffer(NULL, 0);
+}
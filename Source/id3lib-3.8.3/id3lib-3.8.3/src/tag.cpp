@@ -455,6 +455,31 @@ bool ID3_Tag::SetPadding(bool pad)
   return _impl->SetPadding(pad);
 }
 
+/** Sets the least amount of padding to leave in the tag whenever it has to be
+ ** written somewhere new: the first time a file is tagged, or when the tag has
+ ** grown past the end of its padding.  Later edits which fit in the padding
+ ** are then written over the old tag, instead of the whole file being
+ ** rewritten.
+ **
+ ** The padding is still rounded up so the file is an even multiple of 2K, and
+ ** an existing tag isn't shrunk until its padding is more than 4K over the
+ ** minimum.  It has no effect if padding is switched off with SetPadding().
+ **
+ ** By default, there is no minimum padding.
+ **
+ ** \code
+ **   // leave room for a few more frames before the file is rewritten
+ **   myTag.SetMinPadding(4096);
+ ** \endcode
+ **
+ ** \param padding The least padding to leave, in bytes.
+ ** \return Whether the minimum padding changed.
+ **/
+bool ID3_Tag::SetMinPadding(size_t padding)
+{
+  return _impl->SetMinPadding(padding);
+}
+
 bool ID3_Tag::SetExperimental(bool exp)
 {
   return _impl->SetExperimental(exp);
@@ -714,6 +739,49 @@ size_t ID3_Tag::Link(ID3_Reader &reader, flags_t flags)
   return _impl->Link(reader, flags);
 }
 
+/** Restricts the ID3v2 frames parsed by later calls to Link() or Parse() to
+ ** the given frame ids.  Other frames are skipped by their size, without
+ ** reading, decompressing or allocating their data, which makes reading a few
+ ** text frames from files with large pictures much faster.
+ **
+ ** \code
+ **   const ID3_FrameID ids[] = { ID3FID_TITLE, ID3FID_LEADARTIST };
+ **   ID3_Tag myTag;
+ **   myTag.SetFramesToParse(ids, 2);
+ **   myTag.Link("mysong.mp3");
+ ** \endcode
+ **
+ ** The filter lasts until Clear() is called, or until it is replaced by
+ ** another call to SetFramesToParse().  Passing NULL parses every frame again.
+ ** ID3v1 and other tag types are parsed as usual.  A tag which has skipped
+ ** any frames can't be written back to the file: Update() does nothing.
+ **
+ ** @param ids The ids of the frames to parse, or NULL to parse every frame.
+ ** @param numIds The number of ids in the array.
+ **/
+void ID3_Tag::SetFramesToParse(const ID3_FrameID *ids, size_t numIds)
+{
+  _impl->SetFramesToParse(ids, numIds);
+}
+
+/** Finds where the data of the first frame with the given id, skipped by the
+ ** last Link() or Parse() because of SetFramesToParse(), is in the file (or
+ ** the reader or buffer the tag was parsed from).  The data can then be read
+ ** from the file later, when it is needed, without linking the tag again.
+ **
+ ** Only frames whose data is stored as it is are found: not those in an
+ ** unsynchronised tag, or which are compressed, encrypted or grouped.
+ **
+ ** @param id The id of the skipped frame.
+ ** @param offset Set to where the frame's data starts, after its header.
+ ** @param size Set to the size of the frame's data.
+ ** @return Whether a skipped frame with the id was found.
+ **/
+bool ID3_Tag::GetSkippedFrameData(ID3_FrameID id, size_t& offset, size_t& size) const
+{
+  return _impl->GetSkippedFrameData(id, offset, size);
+}
+
 flags_t ID3_Tag::Update(flags_t flags)
 {
   return _impl->Update(flags);
@@ -38,6 +38,7 @@ using namespace dami;
 
 #if defined HAVE_UNISTD_H
 #  include <unistd.h>
+#  include <fcntl.h>
 #endif
 
 #if defined HAVE_SYS_STAT_H
@@ -114,6 +115,73 @@ static int truncate(const char *path, size_t length)
 
 #endif
 
+// the size of the buffer the audio is copied through when a tag has grown
+#define ID3_COPYBUFSIZE (1024 * 1024)
+
+// Appends everything in the file \c from after the first \c offset bytes to
+// the end of the file \c to.  Returns false if it couldn't all be copied.
+static bool copyFileData(const char *from, size_t offset, const char *to)
+{
+#if defined HAVE_UNISTD_H
+  int in = ::open(from, O_RDONLY);
+  int out = ::open(to, O_WRONLY);
+  bool ok = in >= 0 && out >= 0 &&
+            ::lseek(in, offset, SEEK_SET) == static_cast<off_t>(offset) &&
+            ::lseek(out, 0, SEEK_END) >= 0;
+
+#  if defined HAVE_COPY_FILE_RANGE
+  // let the kernel copy the data, so it doesn't pass through this process.
+  // Not every kernel and file system supports it, so if it fails part way,
+  // the rest is copied through the buffer below
+  ssize_t numCopied = 0;
+  while (ok && (numCopied = ::copy_file_range(in, NULL, out, NULL, 1 << 30, 0)) > 0)
+  {
+    ;
+  }
+#  endif
+
+  char *buffer = ok ? new char[ID3_COPYBUFSIZE] : NULL;
+  ssize_t numRead = 0;
+  while (ok && (numRead = ::read(in, buffer, ID3_COPYBUFSIZE)) > 0)
+  {
+    for (ssize_t numWritten = 0, i = 0; ok && i < numRead; i += numWritten)
+    {
+      numWritten = ::write(out, buffer + i, numRead - i);
+      ok = numWritten > 0;
+    }
+  }
+  ok = ok && numRead == 0;
+  delete [] buffer;
+
+  if (in >= 0)
+  {
+    ::close(in);
+  }
+  if (out >= 0)
+  {
+    ok = (::close(out) == 0) && ok;
+  }
+  return ok;
+#else
+  ifstream in(from, ios::in | ios::binary);
+  ofstream out(to, ios::out | ios::binary | ios::app);
+  if (!in || !out)
+  {
+    return false;
+  }
+  in.seekg(offset, ios::beg);
+  char *buffer = new char[ID3_COPYBUFSIZE];
+  while (in)
+  {
+    in.read(buffer, ID3_COPYBUFSIZE);
+    out.write(buffer, in.gcount());
+  }
+  delete [] buffer;
+  out.close();
+  return !out.fail();
+#endif
+}
+
 size_t ID3_TagImpl::Link(const char *fileInfo, bool parseID3v1, bool parseLyrics3)
 {
   flags_t tt = ID3TT_NONE;
@@ -248,13 +316,14 @@ size_t RenderV2ToFile(const ID3_TagImpl& tag, fstream& file)
     createFile(sTempFile, tmpOut);
 
     tmpOut.write(tagData, tagSize);
-    file.seekg(tag.GetPrependedBytes(), ios::beg);
-    char *tmpBuffer[BUFSIZ];
-    while (!file.eof())
+    tmpOut.close();
+    // then the audio after the old tag, in large chunks.  If that fails, the
+    // original file is left as it was
+    if (!copyFileData(filename.c_str(), tag.GetPrependedBytes(), sTempFile))
     {
-      file.read((char *)tmpBuffer, BUFSIZ);
-      size_t nBytes = file.gcount();
-      tmpOut.write((char *)tmpBuffer, nBytes);
+      ID3D_WARNING( "RenderV2ToFile: couldn't copy the audio to the temp file" );
+      remove(sTempFile);
+      return 0;
     }
 
 #else //((defined(__GNUC__) && __GNUC__ >= 3  ) || !defined(HAVE_MKSTEMP))
@@ -298,22 +367,35 @@ size_t RenderV2ToFile(const ID3_TagImpl& tag, fstream& file)
     file.close();
 
     // the following sets the permissions of the new file
-    // to be the same as the original
+    // to be the same as the original, before it takes the original's place
 #if defined(HAVE_SYS_STAT_H)
     struct stat fileStat;
     if(stat(filename.c_str(), &fileStat) == 0)
     {
-#endif //defined(HAVE_SYS_STAT_H)
-      remove(filename.c_str());
-      rename(sTempFile, filename.c_str());
-#if defined(HAVE_SYS_STAT_H)
-      chmod(filename.c_str(), fileStat.st_mode);
+      chmod(sTempFile, fileStat.st_mode);
     }
 #endif //defined(HAVE_SYS_STAT_H)
 
+    // rename() replaces the old file in one step, so anyone opening it sees
+    // either the old file or the new one, and a crash can't lose both.
+    // Windows won't rename over an existing file, though
+#if defined WIN32
+    remove(filename.c_str());
+#endif
+    bool renamed = rename(sTempFile, filename.c_str()) == 0;
+    if (!renamed)
+    {
+      ID3D_WARNING( "RenderV2ToFile: couldn't replace the file with the temp file" );
+      remove(sTempFile);
+    }
+
 //    file = tmpOut;
     file.clear();//to clear the eof mark
     openWritableFile(filename, file);
+    if (!renamed)
+    {
+      return 0;
+    }
   }
 
   return tagSize;
@@ -324,6 +406,14 @@ flags_t ID3_TagImpl::Update(flags_t ulTagFlag)
 {
   flags_t tags = ID3TT_NONE;
 
+  // frames left out by SetFramesToParse() aren't in the tag, so rendering it
+  // would remove them from the file
+  if (this->GetSkippedFrames())
+  {
+    ID3D_WARNING( "ID3_TagImpl::Update(): not updating a tag with skipped frames" );
+    return tags;
+  }
+
   fstream file;
   String filename = this->GetFileName();
   ID3_Err err = openWritableFile(filename, file);
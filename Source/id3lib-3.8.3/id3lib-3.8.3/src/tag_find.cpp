@@ -24,6 +24,7 @@
 // id3lib.  These files are distributed with id3lib at
 // http://download.sourceforge.net/id3lib/
 
+#include <string.h>
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
 
 using namespace dami;
@@ -58,182 +59,176 @@ ID3_TagImpl::iterator ID3_TagImpl::Find(const ID3_Frame *frame)
   return cur;
 }
 
-ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id) const
+const ID3_TagImpl::IndexEntries* ID3_TagImpl::FindIndexEntries(ID3_FrameID id) const
 {
-  ID3_Frame *frame = NULL;
+  if (id < ID3FID_NOFRAME || id >= ID3FID_LASTFRAMEID || _index[id].empty())
+  {
+    return NULL;
+  }
+  return &_index[id];
+}
 
-  // reset the cursor if it isn't set
+size_t ID3_TagImpl::CursorEntry(const IndexEntries& entries) const
+{
+  // Find the first entry at or after the cursor.  This is where a search of
+  // the whole frame list would have found its first frame with this ID.  If
+  // the cursor is past the last of them the search wraps back to the first.
   if (_frames.end() == _cursor)
   {
-    _cursor = _frames.begin();
+    return 0;
   }
+  size_t lo = 0, hi = entries.size();
+  while (lo < hi)
+  {
+    size_t mid = lo + (hi - lo) / 2;
+    if (entries[mid].seq < _cursor_seq)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return lo == entries.size() ? 0 : lo;
+}
+
+ID3_Frame* ID3_TagImpl::MoveCursorPast(const IndexEntry& entry) const
+{
+  // We've found a valid frame.  Set the cursor to be the next element
+  const_iterator next = entry.frame;
+  _cursor = ++next;
+  _cursor_seq = entry.seq + 1;
+  return *entry.frame;
+}
 
+// The searches below begin with the first frame with the right ID at or after
+// the cursor, look at each successive one, and wrap to the first one if
+// necessary.  This finds the same frames in the same order as a search of the
+// whole frame list starting from the cursor, without looking at frames with
+// other IDs.
+
+ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id) const
+{
+  const IndexEntries* entries = this->FindIndexEntries(id);
+  if (NULL == entries)
+  {
+    return NULL;
+  }
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+  size_t start = this->CursorEntry(*entries), count = entries->size();
+  for (size_t i = 0; i < count; ++i)
   {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
+    const IndexEntry& entry = (*entries)[(start + i) % count];
+    ID3_Frame* cur = *entry.frame;
+    if ((cur != NULL) && (cur->GetID() == id))
     {
-      if ((*cur != NULL) && ((*cur)->GetID() == id))
-      {
-        // We've found a valid frame.  Set the cursor to be the next element
-        frame = *cur;
-        _cursor = ++cur;
-        break;
-      }
+      return this->MoveCursorPast(entry);
     }
   }
 
-  return frame;
+  return NULL;
 }
 
 ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, String data) const
 {
-  ID3_Frame *frame = NULL;
   ID3D_NOTICE( "Find: looking for comment with data = " << data.c_str() );
-
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
+  const IndexEntries* entries = this->FindIndexEntries(id);
+  if (NULL == entries)
   {
-    _cursor = _frames.begin();
-    ID3D_NOTICE( "Find: resetting cursor" );
+    return NULL;
   }
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+  size_t start = this->CursorEntry(*entries), count = entries->size();
+  for (size_t i = 0; i < count; ++i)
   {
-    ID3D_NOTICE( "Find: iCount = " << iCount );
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
+    const IndexEntry& entry = (*entries)[(start + i) % count];
+    ID3_Frame* cur = *entry.frame;
+    ID3D_NOTICE( "Find: frame = 0x" << hex << (uint32) cur << dec );
+    if ((cur != NULL) && (cur->GetID() == id) && cur->Contains(fldID))
     {
-      ID3D_NOTICE( "Find: frame = 0x" << hex << (uint32) *cur << dec );
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          (*cur)->Contains(fldID))
+      ID3_Field* fld = cur->GetField(fldID);
+      if (NULL == fld)
       {
-        ID3_Field* fld = (*cur)->GetField(fldID);
-        if (NULL == fld)
-        {
-          continue;
-          ID3D_NOTICE( "Find: didn't have the right field" );
-        }
-
-        String text( NULL == fld->GetRawText() ? "" : fld->GetRawText() , fld->Size()); //PHF
-        ID3D_NOTICE( "Find: text = " << text.c_str() );
-
-        if (text == data)
-        {
-          // We've found a valid frame.  Set cursor to be the next element
-          frame = *cur;
-          _cursor = ++cur;
-          break;
-        }
+        ID3D_NOTICE( "Find: didn't have the right field" );
+        continue;
+      }
+
+      // compare the field's text in place rather than copying it into a
+      // String first, as most frames won't match
+      const char* text = fld->GetRawText();
+      size_t size = (NULL == text) ? 0 : fld->Size();
+      if (size == data.size() &&
+          (0 == size || 0 == ::memcmp(text, data.data(), size)))
+      {
+        return this->MoveCursorPast(entry);
       }
     }
   }
 
-  return frame;
+  return NULL;
 }
 
 ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, WString data) const
 {
-  ID3_Frame *frame = NULL;
-
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
+  const IndexEntries* entries = this->FindIndexEntries(id);
+  if (NULL == entries)
   {
-    _cursor = _frames.begin();
+    return NULL;
   }
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+  size_t start = this->CursorEntry(*entries), count = entries->size();
+  for (size_t i = 0; i < count; ++i)
   {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
+    const IndexEntry& entry = (*entries)[(start + i) % count];
+    ID3_Frame* cur = *entry.frame;
+    if ((cur != NULL) && (cur->GetID() == id) && cur->Contains(fldID))
     {
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          (*cur)->Contains(fldID))
+      ID3_Field* fld = cur->GetField(fldID);
+      if (NULL == fld)
       {
-        ID3_Field* fld = (*cur)->GetField(fldID);
-        if (NULL == fld)
-        {
-          continue;
-        }
-        WString text = toWString(fld->GetRawUnicodeText(), fld->Size());
-
-        if (text == data)
-        {
-          // We've found a valid frame.  Set cursor to be the next element
-          frame = *cur;
-          _cursor = ++cur;
-          break;
-        }
+        continue;
+      }
+
+      // compare the field's text in place rather than copying it into a
+      // WString first, as most frames won't match
+      const unicode_t* text = fld->GetRawUnicodeText();
+      size_t size = (NULL == text) ? 0 : fld->Size();
+      bool matches = (size == data.size());
+      for (size_t j = 0; matches && j < size; ++j)
+      {
+        matches = (static_cast<WString::value_type>(text[j]) == data[j]);
+      }
+      if (matches)
+      {
+        return this->MoveCursorPast(entry);
       }
     }
   }
 
-  return frame;
+  return NULL;
 }
 
 ID3_Frame *ID3_TagImpl::Find(ID3_FrameID id, ID3_FieldID fldID, uint32 data) const
 {
-  ID3_Frame *frame = NULL;
-
-  // reset the cursor if it isn't set
-  if (_frames.end() == _cursor)
+  const IndexEntries* entries = this->FindIndexEntries(id);
+  if (NULL == entries)
   {
-    _cursor = _frames.begin();
+    return NULL;
   }
 
-  for (int iCount = 0; iCount < 2 && frame == NULL; iCount++)
+  size_t start = this->CursorEntry(*entries), count = entries->size();
+  for (size_t i = 0; i < count; ++i)
   {
-    // We want to cycle through the list to find the matching frame.  We
-    // should begin from the cursor, search each successive frame, wrapping
-    // if necessary.  The enclosing loop and the assignment statments below
-    // ensure that we first begin at the cursor and search to the end of the
-    // list and, if unsuccessful, start from the beginning of the list and
-    // search to the cursor.
-    const_iterator
-      begin  = (0 == iCount ? _cursor       : _frames.begin()),
-      end    = (0 == iCount ? _frames.end() : _cursor);
-    // search from the cursor to the end
-    for (const_iterator cur = begin; cur != end; ++cur)
+    const IndexEntry& entry = (*entries)[(start + i) % count];
+    ID3_Frame* cur = *entry.frame;
+    if ((cur != NULL) && (cur->GetID() == id) &&
+        (cur->GetField(fldID)->Get() == data))
     {
-      if ((*cur != NULL) && ((*cur)->GetID() == id) &&
-          ((*cur)->GetField(fldID)->Get() == data))
-      {
-        // We've found a valid frame.  Set the cursor to be the next element
-        frame = *cur;
-        _cursor = ++cur;
-        break;
-      }
+      return this->MoveCursorPast(entry);
     }
   }
 
-  return frame;
+  return NULL;
 }
 
@@ -35,6 +35,23 @@
 
 using namespace dami;
 
+namespace
+{
+  template <typename Entries>
+  bool eraseIndexEntry(Entries& entries, const ID3_Frame *frame)
+  {
+    for (typename Entries::iterator ei = entries.begin(); ei != entries.end(); ++ei)
+    {
+      if (*ei->frame == frame)
+      {
+        entries.erase(ei);
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
 size_t ID3_TagImpl::IsV2Tag(ID3_Reader& reader)
 {
   io::ExitTrigger et(reader);
@@ -91,6 +108,8 @@ size_t ID3_TagImpl::IsV2Tag(ID3_Reader& reader)
 ID3_TagImpl::ID3_TagImpl(const char *name)
   : _frames(),
     _cursor(_frames.begin()),
+    _cursor_seq(0),
+    _next_seq(0),
     _file_name(),
     _file_size(0),
     _prepended_bytes(0),
@@ -108,6 +127,8 @@ ID3_TagImpl::ID3_TagImpl(const char *name)
 ID3_TagImpl::ID3_TagImpl(const ID3_Tag &tag)
   : _frames(),
     _cursor(_frames.begin()),
+    _cursor_seq(0),
+    _next_seq(0),
     _file_name(),
     _file_size(0),
     _prepended_bytes(0),
@@ -134,13 +155,20 @@ void ID3_TagImpl::Clear()
     }
   }
   _frames.clear();
+  this->ClearIndex();
   _cursor = _frames.begin();
+  _cursor_seq = 0;
   _is_padded = true;
+  _min_padding = 0;
 
   _hdr.Clear();
   _hdr.SetSpec(ID3V2_LATEST);
 
   _tags_to_parse.clear();
+  _frames_to_parse.clear();
+  _is_frame_filtered = false;
+  _skipped_frames = false;
+  _skipped_frame_data.clear();
   if (_mp3_info)
     delete _mp3_info; // Also deletes _mp3_header
 
@@ -175,7 +203,9 @@ bool ID3_TagImpl::AttachFrame(ID3_Frame *frame)
   }
 
   _frames.push_back(frame);
+  this->IndexFrame(--_frames.end());
   _cursor = _frames.begin();
+  _cursor_seq = 0;
 
   _changed = true;
   return true;
@@ -190,14 +220,106 @@ ID3_Frame* ID3_TagImpl::RemoveFrame(const ID3_Frame *frame)
   if (fi != _frames.end())
   {
     frm = *fi;
+    this->UnindexFrame(frm);
     _frames.erase(fi);
     _cursor = _frames.begin();
+    _cursor_seq = 0;
     _changed = true;
   }
 
   return frm;
 }
 
+void ID3_TagImpl::IndexFrame(iterator fi)
+{
+  ID3_FrameID id = (*fi)->GetID();
+  if (id < ID3FID_NOFRAME || id >= ID3FID_LASTFRAMEID)
+  {
+    return;
+  }
+
+  // frames are appended to the list, so appending to the index keeps each
+  // frame ID's entries in list order
+  IndexEntry entry;
+  entry.seq = _next_seq++;
+  entry.frame = fi;
+  _index[id].push_back(entry);
+}
+
+void ID3_TagImpl::UnindexFrame(const ID3_Frame *frame)
+{
+  // look under the frame's current ID first.  If its ID has been changed since
+  // it was attached it is indexed under another one, so fall back to the rest.
+  ID3_FrameID id = frame->GetID();
+  if (id >= ID3FID_NOFRAME && id < ID3FID_LASTFRAMEID &&
+      eraseIndexEntry(_index[id], frame))
+  {
+    return;
+  }
+  for (size_t i = 0; i < ID3FID_LASTFRAMEID; ++i)
+  {
+    if (eraseIndexEntry(_index[i], frame))
+    {
+      return;
+    }
+  }
+}
+
+void ID3_TagImpl::ClearIndex()
+{
+  for (size_t i = 0; i < ID3FID_LASTFRAMEID; ++i)
+  {
+    _index[i].clear();
+  }
+  _next_seq = 0;
+}
+
+void ID3_TagImpl::SetFramesToParse(const ID3_FrameID *ids, size_t numIds)
+{
+  _frames_to_parse.assign(ID3FID_LASTFRAMEID, false);
+  _is_frame_filtered = (NULL != ids);
+  for (size_t i = 0; _is_frame_filtered && i < numIds; ++i)
+  {
+    if (ids[i] > ID3FID_NOFRAME && ids[i] < ID3FID_LASTFRAMEID)
+    {
+      _frames_to_parse[ids[i]] = true;
+    }
+  }
+}
+
+bool ID3_TagImpl::IsFrameToParse(ID3_FrameID id) const
+{
+  if (!_is_frame_filtered)
+  {
+    return true;
+  }
+  return id > ID3FID_NOFRAME && id < ID3FID_LASTFRAMEID &&
+         _frames_to_parse[id];
+}
+
+void ID3_TagImpl::SetSkippedFrameData(ID3_FrameID id, size_t offset, size_t size)
+{
+  size_t offsetFound, sizeFound;
+  if (!this->GetSkippedFrameData(id, offsetFound, sizeFound))
+  {
+    SkippedFrameData data = { id, offset, size };
+    _skipped_frame_data.push_back(data);
+  }
+}
+
+bool ID3_TagImpl::GetSkippedFrameData(ID3_FrameID id, size_t& offset, size_t& size) const
+{
+  for (size_t i = 0; i < _skipped_frame_data.size(); ++i)
+  {
+    if (_skipped_frame_data[i].id == id)
+    {
+      offset = _skipped_frame_data[i].offset;
+      size = _skipped_frame_data[i].size;
+      return true;
+    }
+  }
+  return false;
+}
 
 bool ID3_TagImpl::HasChanged() const
 {
@@ -300,6 +422,18 @@ bool ID3_TagImpl::SetPadding(bool pad)
   return changed;
 }
 
+bool ID3_TagImpl::SetMinPadding(size_t padding)
+{
+  bool changed = (_min_padding != padding);
+  _changed = changed || _changed;
+  if (changed)
+  {
+    _min_padding = padding;
+  }
+
+  return changed;
+}
+
 
 ID3_TagImpl &
 ID3_TagImpl::operator=( const ID3_Tag &rTag )
@@ -30,6 +30,7 @@
 #define _ID3LIB_TAG_IMPL_H_
 
 #include <list>
+#include <vector>
 #include <stdio.h>
 #include "tag.h" // has frame.h, field.h
 #include "header_tag.h"
@@ -76,6 +77,16 @@ class ID3_TagImpl
 public:
   typedef Frames::iterator       iterator;
   typedef Frames::const_iterator const_iterator;
+private:
+  // An entry in the frame ID index.  Frames are only ever appended to _frames,
+  // so the attach sequence numbers increase along the list and can be compared
+  // to find out which of two frames comes first.
+  struct IndexEntry
+  {
+    uint32   seq;   // when the frame was attached, relative to the other frames
+    iterator frame; // where the frame is in _frames
+  };
+  typedef std::vector<IndexEntry> IndexEntries;
 public:
   ID3_TagImpl(const char *name = NULL);
   ID3_TagImpl(const ID3_Tag &tag);
@@ -90,6 +101,7 @@ public:
   bool       SetExtended(bool);
   bool       SetExperimental(bool);
   bool       SetPadding(bool);
+  bool       SetMinPadding(size_t);
 
   bool       GetUnsync() const;
   bool       GetExtended() const;
@@ -105,6 +117,13 @@ public:
 
   size_t     Link(const char *fileInfo, flags_t = (flags_t) ID3TT_ALL);
   size_t     Link(ID3_Reader &reader, flags_t = (flags_t) ID3TT_ALL);
+  void       SetFramesToParse(const ID3_FrameID *, size_t);
+  bool       ParsesAllFrames() const { return !_is_frame_filtered; }
+  bool       IsFrameToParse(ID3_FrameID) const;
+  void       SetSkippedFrames(bool b) { _skipped_frames = b; }
+  bool       GetSkippedFrames() const { return _skipped_frames; }
+  void       SetSkippedFrameData(ID3_FrameID, size_t offset, size_t size);
+  bool       GetSkippedFrameData(ID3_FrameID, size_t& offset, size_t& size) const;
   flags_t    Update(flags_t = (flags_t) ID3TT_ALL);
   flags_t    Strip(flags_t = (flags_t) ID3TT_ALL);
 
@@ -150,16 +169,33 @@ protected:
 
   void       RenderExtHeader(uchar *);
 
+  void       IndexFrame(iterator);
+  void       UnindexFrame(const ID3_Frame *);
+  void       ClearIndex();
+  const IndexEntries* FindIndexEntries(ID3_FrameID) const;
+  size_t     CursorEntry(const IndexEntries&) const;
+  ID3_Frame* MoveCursorPast(const IndexEntry&) const;
+
   void       ParseFile();
   void       ParseReader(ID3_Reader &reader);
 
 private:
   ID3_TagHeader _hdr;          // information relevant to the tag header
   bool       _is_padded;       // add padding to tags?
+  size_t     _min_padding;     // least padding to leave when the tag moves
 
   Frames     _frames;
 
   mutable const_iterator   _cursor;  // which frame in list are we at
+  mutable uint32     _cursor_seq; // attach sequence number of the frame at _cursor
+
+  // The frames of each frame ID, in list order, so that Find() only looks at
+  // frames with the right ID instead of walking the whole list.  Kept up to
+  // date by AttachFrame(), RemoveFrame() and Clear().  A frame whose ID is
+  // changed with ID3_Frame::SetID() after being attached is still indexed
+  // under its old ID until it is removed and attached again.
+  IndexEntries _index[ID3FID_LASTFRAMEID];
+  uint32     _next_seq;        // sequence number for the next attached frame
   mutable bool       _changed; // has tag changed since last parse or render?
 
   // file-related member variables
@@ -169,6 +205,19 @@ private:
   size_t     _appended_bytes;  // number of tag bytes at end of file
   bool       _is_file_writable;// is the associated file (via Link) writable?
   ID3_Flags  _tags_to_parse;   // which tag types should attempt to be parsed
+  std::vector<bool> _frames_to_parse; // which id3v2 frames to parse, if filtered
+  bool       _is_frame_filtered;// are id3v2 frames not in _frames_to_parse skipped?
+  bool       _skipped_frames;  // were any frames skipped when parsing?
+
+  // Where the data of the first skipped frame of each id is in the file, for
+  // frames whose data can be read straight out of it
+  struct SkippedFrameData
+  {
+    ID3_FrameID id;
+    size_t     offset;
+    size_t     size;
+  };
+  std::vector<SkippedFrameData> _skipped_frame_data;
   ID3_Flags  _file_tags;       // which tag types does the file contain
   Mp3Info    *_mp3_info;   // class used to retrieve _mp3_header
 };
@@ -36,12 +36,59 @@
 #include "tag_impl.h" //has <stdio.h> "tag.h" "header_tag.h" "frame.h" "field.h" "spec.h" "id3lib_strings.h" "utils.h"
 //#include "id3/io_decorators.h" //has "readers.h" "io_helpers.h" "utils.h"
 #include "io_strings.h"
+#include "header_frame.h"
 
 using namespace dami;
 
 namespace
 {
-  bool parseFrames(ID3_TagImpl& tag, ID3_Reader& rdr)
+  // Reads the header of the frame at the reader's position and, if the tag
+  // isn't parsing frames with that id, moves the reader past the frame without
+  // reading, decompressing or allocating its data.  Returns false (leaving the
+  // reader where it was) if the frame should be parsed as usual.  If the
+  // reader's positions are the file's, where the data is gets recorded too.
+  bool skipFrame(ID3_TagImpl& tag, ID3_Reader& rdr, bool isFile)
+  {
+    if (tag.ParsesAllFrames())
+    {
+      return false;
+    }
+    ID3_Reader::pos_type beg = rdr.getCur();
+    io::ExitTrigger et(rdr);
+    ID3_FrameHeader hdr;
+    hdr.SetSpec(tag.GetSpec());
+    if (!hdr.Parse(rdr) || rdr.getCur() == beg)
+    {
+      return false;
+    }
+
+    // v2.2.1 compressed frames hold other frames, which may be wanted
+    ID3_FrameID id = hdr.GetFrameID();
+    if (id == ID3FID_METACOMPRESSION || tag.IsFrameToParse(id))
+    {
+      return false;
+    }
+
+    ID3_Reader::pos_type end = rdr.getCur() + hdr.GetDataSize();
+    if (rdr.getEnd() < end)
+    {
+      // let the full parse deal with the truncated frame
+      return false;
+    }
+    ID3D_NOTICE( "id3::v2::skipFrame(): skipping " << hdr.GetTextID() <<
+                 ", dataSize = " << hdr.GetDataSize() );
+    tag.SetSkippedFrames(true);
+    if (isFile && !hdr.HasFormatFlags())
+    {
+      tag.SetSkippedFrameData(id, rdr.getCur(), hdr.GetDataSize());
+    }
+    et.setExitPos(end);
+    return true;
+  }
+
+  // isFile is false when the frames are read from a resynchronised or
+  // decompressed copy of the tag, whose positions aren't the file's
+  bool parseFrames(ID3_TagImpl& tag, ID3_Reader& rdr, bool isFile)
   {
     ID3_Reader::pos_type beg = rdr.getCur();
     io::ExitTrigger et(rdr, beg);
@@ -54,6 +101,12 @@ namespace
       ID3D_NOTICE( "id3::v2::parseFrames(): rdr.getCur() = " << rdr.getCur() );
       ID3D_NOTICE( "id3::v2::parseFrames(): rdr.getEnd() = " << rdr.getEnd() );
       last_pos = rdr.getCur();
+      if (skipFrame(tag, rdr, isFile))
+      {
+        totalSize += rdr.getCur() - last_pos;
+        et.setExitPos(rdr.getCur());
+        continue;
+      }
       ID3_Frame* f = new ID3_Frame;
       f->SetSpec(tag.GetSpec());
       bool goodParse = f->Parse(rdr);
@@ -106,7 +159,7 @@ namespace
             uint32 newSize = io::readBENumber(mr, sizeof(uint32));
             size_t oldSize = f->GetDataSize() - sizeof(uint32) - 1;
             io::CompressedReader cr(mr, newSize);
-            parseFrames(tag, cr);
+            parseFrames(tag, cr, false);
             if (!cr.atEnd())
             {
               // hmm.  it didn't parse the entire uncompressed data.  wonder
@@ -167,17 +220,17 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
   if (!hdr.GetUnsync())
   {
     tag.SetUnsync(false);
-    parseFrames(tag, wr);
+    parseFrames(tag, wr, true);
   }
   else
   {
     // The buffer has been unsynced.  It will have to be resynced to be
-    // readable.  This has to be done a character at a time.
+    // readable.
     //
     // The original reader may be reading in characters from a file.  Doing
     // this a character at a time is quite slow.  To improve performance, read
     // in the entire buffer into a string, then create an UnsyncedReader from
-    // the string.
+    // the string, which lets it find the sync bytes in bulk.
     //
     // It might be better to implement a BufferedReader so that the details
     // of this can be abstracted away behind a class
@@ -196,7 +249,7 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
     // character at a time for every call
     BString synced = io::readAllBinary(ur);
     io::BStringReader sr(synced);
-    parseFrames(tag, sr);
+    parseFrames(tag, sr, false);
   }
 
   return true;
@@ -204,6 +257,16 @@ bool id3::v2::parse(ID3_TagImpl& tag, ID3_Reader& reader)
 
 void ID3_TagImpl::ParseFile()
 {
+  // Reading through a memory mapping saves a system call for every seek and
+  // read, and lets binary fields be copied straight out of the file
+  ID3_MappedFileReader mapped(this->GetFileName().c_str());
+  if (mapped.isOpen())
+  {
+    ParseReader(mapped);
+    mapped.close();
+    return;
+  }
+
   ifstream file;
   if (ID3E_NoError != openReadableFile(this->GetFileName(), file))
   {
@@ -225,6 +288,7 @@ void ID3_TagImpl::ParseReader(ID3_Reader &reader)
   wr.setBeg(wr.getCur());
 
   _file_tags.clear();
+  _skipped_frame_data.clear();
   _file_size = reader.getEnd();
 
   ID3_Reader::pos_type beg  = wr.getBeg();
@@ -201,16 +201,20 @@ size_t ID3_TagImpl::PaddingSize(size_t curSize) const
     
   // if the old tag was large enough to hold the new tag, then we will simply
   // pad out the difference - that way the new tag can be written without
-  // shuffling the rest of the song file around
+  // shuffling the rest of the song file around.  A tag only shrinks once it
+  // has more than 4K of padding on top of the minimum padding
   if ((this->GetPrependedBytes()-ID3_TagHeader::SIZE > 0) &&
       (this->GetPrependedBytes()-ID3_TagHeader::SIZE >= curSize) && 
-      (this->GetPrependedBytes()-ID3_TagHeader::SIZE - curSize) < ID3_PADMAX)
+      (this->GetPrependedBytes()-ID3_TagHeader::SIZE - curSize) <
+        ID3_PADMAX + _min_padding)
   {
     newSize = this->GetPrependedBytes()-ID3_TagHeader::SIZE;
   }
   else
   {
-    luint tempSize = curSize + ID3_GetDataSize(*this) +
+    // the tag is being written somewhere new, so leave at least the minimum
+    // padding for it to grow into next time
+    luint tempSize = curSize + _min_padding + ID3_GetDataSize(*this) +
                      this->GetAppendedBytes() + ID3_TagHeader::SIZE;
     
     // this method of automatic padding rounds the COMPLETE FILE up to the
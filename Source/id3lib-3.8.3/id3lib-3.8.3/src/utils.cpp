@@ -25,6 +25,7 @@
 // http://download.sourceforge.net/id3lib/
 
 #include <ctype.h>
+#include <string.h>
 
 #if (defined(__GNUC__) && __GNUC__ == 2)
 #define NOCREATE ios::nocreate
@@ -37,56 +38,6 @@
 
 #include "id3/utils.h" // has <config.h> "id3/id3lib_streams.h" "id3/globals.h" "id3/id3lib_strings.h"
 
-#if defined HAVE_ICONV_H
-// check if we have all unicodes
-#if (defined(ID3_ICONV_FORMAT_UTF16BE) && defined(ID3_ICONV_FORMAT_UTF16) && defined(ID3_ICONV_FORMAT_UTF8) && defined(ID3_ICONV_FORMAT_ASCII))
-# include <iconv.h>
-# include <errno.h>
-#else
-# undef HAVE_ICONV_H
-#endif
-#endif
-
-  // converts an ASCII string into a Unicode one
-dami::String mbstoucs(dami::String data)
-{
-  size_t size = data.size();
-  dami::String unicode(size * 2, '\0');
-  for (size_t i = 0; i < size; ++i)
-  {
-    unicode[i*2+1] = toascii(data[i]);
-  }
-  return unicode;
-}
-
-// converts a Unicode string into ASCII
-dami::String ucstombs(dami::String data)
-{
-  size_t size = data.size() / 2;
-  dami::String ascii(size, '\0');
-  for (size_t i = 0; i < size; ++i)
-  {
-    ascii[i] = toascii(data[i*2+1]);
-  }
-  return ascii;
-}
-
-dami::String oldconvert(dami::String data, ID3_TextEnc sourceEnc, ID3_TextEnc targetEnc)
-{
-  dami::String target;
-#define ID3_IS_ASCII(enc)      ((enc) == ID3TE_ASCII || (enc) == ID3TE_ISO8859_1 || (enc) == ID3TE_UTF8)
-#define ID3_IS_UNICODE(enc)    ((enc) == ID3TE_UNICODE || (enc) == ID3TE_UTF16 || (enc) == ID3TE_UTF16BE)
-  if (ID3_IS_ASCII(sourceEnc) && ID3_IS_UNICODE(targetEnc))
-  {
-    target = mbstoucs(data);
-  }
-  else if (ID3_IS_UNICODE(sourceEnc) && ID3_IS_ASCII(targetEnc))
-  {
-    target = ucstombs(data);
-  }
-  return target;
-}
-
 using namespace dami;
 
 size_t dami::renderNumber(uchar *buffer, uint32 val, size_t size)
@@ -113,102 +64,322 @@ String dami::renderNumber(uint32 val, size_t size)
 }
 
 
-#if defined(HAVE_ICONV_H)
-
-namespace 
+namespace
 {
-  String convert_i(iconv_t cd, String source)
+  // every byte's high bit, which is clear in all of a word's bytes if they're
+  // all ASCII
+  const size_t HIGH_BITS = ~static_cast<size_t>(0) / 0xFF * 0x80;
+
+  // the length of the run of ASCII characters at the start of the text,
+  // checked a word at a time
+  size_t asciiLength(const char* text, size_t len)
   {
-    String target;
-    size_t source_size = source.size();
-#if defined(ID3LIB_ICONV_OLDSTYLE)
-    const char* source_str = source.data();
-#else
-    char *source_str = new char[source.size()+1];
-    source.copy(source_str, String::npos);
-    source_str[source.length()] = 0;
-#endif
+    size_t i = 0;
+    for (; i + sizeof(size_t) <= len; i += sizeof(size_t))
+    {
+      size_t word;
+      ::memcpy(&word, text + i, sizeof(word));
+      if (word & HIGH_BITS)
+      {
+        break;
+      }
+    }
+    while (i < len && !(text[i] & 0x80))
+    {
+      ++i;
+    }
+    return i;
+  }
 
-#define ID3LIB_BUFSIZ 1024
-    char buf[ID3LIB_BUFSIZ];
-    char* target_str = buf;
-    size_t target_size = ID3LIB_BUFSIZ;
-    
-    do
+  // decodes the utf-8 character at text[i] and moves i past it.  A byte which
+  // doesn't start a valid character decodes as U+FFFD on its own
+  uint32 decodeUTF8(const uchar* text, size_t len, size_t& i)
+  {
+    uint32 ch = text[i++];
+    size_t more = 0;
+    uint32 least = 0;
+    if (ch < 0x80)
     {
-      errno = 0;
-      size_t nconv = iconv(cd, 
-                           &source_str, &source_size, 
-                           &target_str, &target_size);
-      if (nconv == (size_t) -1 && errno != EINVAL && errno != E2BIG)
+      return ch;
+    }
+    else if ((ch & 0xE0) == 0xC0)
+    {
+      ch &= 0x1F, more = 1, least = 0x80;
+    }
+    else if ((ch & 0xF0) == 0xE0)
+    {
+      ch &= 0x0F, more = 2, least = 0x800;
+    }
+    else if ((ch & 0xF8) == 0xF0)
+    {
+      ch &= 0x07, more = 3, least = 0x10000;
+    }
+    else
+    {
+      return 0xFFFD;
+    }
+    if (i + more > len)
+    {
+      return 0xFFFD;
+    }
+    for (size_t j = 0; j < more; ++j)
+    {
+      if ((text[i + j] & 0xC0) != 0x80)
       {
-// errno is probably EILSEQ here, which means either an invalid byte sequence or a valid but unconvertible byte sequence 
-        return target;
+        return 0xFFFD;
       }
-      target.append(buf, ID3LIB_BUFSIZ - target_size);
-      target_str = buf;
-      target_size = ID3LIB_BUFSIZ;
+      ch = (ch << 6) | (text[i + j] & 0x3F);
     }
-    while (source_size > 0);
-    return target;
+    // overlong forms, surrogates and values past the last code point are
+    // invalid too
+    if (ch < least || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF))
+    {
+      return 0xFFFD;
+    }
+    i += more;
+    return ch;
   }
 
-  const char* getFormat(ID3_TextEnc enc)
+  // decodes the big-endian utf-16 character at text[i] and moves i past it.
+  // An unpaired surrogate decodes as U+FFFD
+  uint32 decodeUTF16BE(const uchar* text, size_t len, size_t& i)
   {
-    const char* format = NULL;
-    switch (enc)
+    uint32 ch = (text[i] << 8) | text[i + 1];
+    i += 2;
+    if (ch < 0xD800 || ch > 0xDFFF)
     {
-      case ID3TE_ASCII:
-        format = ID3_ICONV_FORMAT_ASCII;
-        break;
+      return ch;
+    }
+    if (ch <= 0xDBFF && i + 2 <= len)
+    {
+      uint32 low = (text[i] << 8) | text[i + 1];
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        i += 2;
+        return 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+      }
+    }
+    return 0xFFFD;
+  }
 
-      case ID3TE_UTF16:
-        format = ID3_ICONV_FORMAT_UTF16;
-        break;
-        
-      case ID3TE_UTF16BE:
-        format = ID3_ICONV_FORMAT_UTF16BE;
-        break;
-        
-      case ID3TE_UTF8:
-        format = ID3_ICONV_FORMAT_UTF8;
-        break;
-        
-      default:
-        break;
+  size_t encodeUTF8(uint32 ch, char* target)
+  {
+    if (ch < 0x80)
+    {
+      target[0] = static_cast<char>(ch);
+      return 1;
     }
-    return format;
+    if (ch < 0x800)
+    {
+      target[0] = static_cast<char>(0xC0 | (ch >> 6));
+      target[1] = static_cast<char>(0x80 | (ch & 0x3F));
+      return 2;
+    }
+    if (ch < 0x10000)
+    {
+      target[0] = static_cast<char>(0xE0 | (ch >> 12));
+      target[1] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+      target[2] = static_cast<char>(0x80 | (ch & 0x3F));
+      return 3;
+    }
+    target[0] = static_cast<char>(0xF0 | (ch >> 18));
+    target[1] = static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+    target[2] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+    target[3] = static_cast<char>(0x80 | (ch & 0x3F));
+    return 4;
+  }
+
+  size_t encodeUTF16BE(uint32 ch, char* target)
+  {
+    if (ch < 0x10000)
+    {
+      target[0] = static_cast<char>(ch >> 8);
+      target[1] = static_cast<char>(ch & 0xFF);
+      return 2;
+    }
+    ch -= 0x10000;
+    uint32 high = 0xD800 + (ch >> 10), low = 0xDC00 + (ch & 0x3FF);
+    target[0] = static_cast<char>(high >> 8);
+    target[1] = static_cast<char>(high & 0xFF);
+    target[2] = static_cast<char>(low >> 8);
+    target[3] = static_cast<char>(low & 0xFF);
+    return 4;
   }
 }
-#endif
 
-String dami::convert(String data, ID3_TextEnc sourceEnc, ID3_TextEnc targetEnc)
+size_t dami::latin1ToUTF16BE(const char* source, size_t len, char* target)
 {
-  String target;
-  if ((sourceEnc != targetEnc) && (data.size() > 0 ))
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  for (size_t i = 0; i < len; ++i)
   {
-#if !defined HAVE_ICONV_H
-    target = oldconvert(data, sourceEnc, targetEnc);
-#else
-    const char* targetFormat = getFormat(targetEnc);
-    const char* sourceFormat = getFormat(sourceEnc);
-   
-    iconv_t cd = iconv_open (targetFormat, sourceFormat);
-    if (cd != (iconv_t) -1)
+    target[i * 2] = '\0';
+    target[i * 2 + 1] = static_cast<char>(src[i]);
+  }
+  return len * 2;
+}
+
+size_t dami::utf16BEToLatin1(const char* source, size_t len, char* target)
+{
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  len &= ~static_cast<size_t>(1);
+  size_t size = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    // four latin-1 characters at a time, while their high bytes are clear
+    for (; i + 8 <= len && (src[i] | src[i + 2] | src[i + 4] | src[i + 6]) == 0;
+         i += 8, size += 4)
     {
-      target = convert_i(cd, data);
-      if (target.size() == 0)
-      {
-        //try it without iconv
-        target = oldconvert(data, sourceEnc, targetEnc);
-      }
+      target[size]     = static_cast<char>(src[i + 1]);
+      target[size + 1] = static_cast<char>(src[i + 3]);
+      target[size + 2] = static_cast<char>(src[i + 5]);
+      target[size + 3] = static_cast<char>(src[i + 7]);
     }
-    else
+    if (i >= len)
     {
-      target = oldconvert(data, sourceEnc, targetEnc);
+      break;
     }
-    iconv_close (cd);
-#endif
+    uint32 ch = decodeUTF16BE(src, len, i);
+    target[size++] = ch <= 0xFF ? static_cast<char>(ch) : '?';
+  }
+  return size;
+}
+
+size_t dami::latin1ToUTF8(const char* source, size_t len, char* target)
+{
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  size_t size = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    size_t ascii = asciiLength(source + i, len - i);
+    ::memcpy(target + size, source + i, ascii);
+    i += ascii;
+    size += ascii;
+    if (i < len)
+    {
+      size += encodeUTF8(src[i++], target + size);
+    }
+  }
+  return size;
+}
+
+size_t dami::utf8ToLatin1(const char* source, size_t len, char* target)
+{
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  size_t size = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    size_t ascii = asciiLength(source + i, len - i);
+    ::memcpy(target + size, source + i, ascii);
+    i += ascii;
+    size += ascii;
+    if (i < len)
+    {
+      uint32 ch = decodeUTF8(src, len, i);
+      target[size++] = ch <= 0xFF ? static_cast<char>(ch) : '?';
+    }
+  }
+  return size;
+}
+
+size_t dami::utf16BEToUTF8(const char* source, size_t len, char* target)
+{
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  len &= ~static_cast<size_t>(1);
+  size_t size = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    // four ASCII characters at a time
+    for (; i + 8 <= len && (src[i] | src[i + 2] | src[i + 4] | src[i + 6]) == 0 &&
+           ((src[i + 1] | src[i + 3] | src[i + 5] | src[i + 7]) & 0x80) == 0;
+         i += 8, size += 4)
+    {
+      target[size]     = static_cast<char>(src[i + 1]);
+      target[size + 1] = static_cast<char>(src[i + 3]);
+      target[size + 2] = static_cast<char>(src[i + 5]);
+      target[size + 3] = static_cast<char>(src[i + 7]);
+    }
+    if (i >= len)
+    {
+      break;
+    }
+    size += encodeUTF8(decodeUTF16BE(src, len, i), target + size);
+  }
+  return size;
+}
+
+size_t dami::utf8ToUTF16BE(const char* source, size_t len, char* target)
+{
+  const uchar* src = reinterpret_cast<const uchar*>(source);
+  size_t size = 0;
+  size_t i = 0;
+  while (i < len)
+  {
+    size_t ascii = asciiLength(source + i, len - i);
+    size += latin1ToUTF16BE(source + i, ascii, target + size);
+    i += ascii;
+    if (i < len)
+    {
+      size += encodeUTF16BE(decodeUTF8(src, len, i), target + size);
+    }
+  }
+  return size;
+}
+
+void dami::swapUTF16(char* text, size_t len)
+{
+  for (size_t i = 0; i + 1 < len; i += 2)
+  {
+    char ch = text[i];
+    text[i] = text[i + 1];
+    text[i + 1] = ch;
+  }
+}
+
+String dami::convert(String data, ID3_TextEnc sourceEnc, ID3_TextEnc targetEnc)
+{
+  String target;
+  if ((sourceEnc == targetEnc) || (data.size() == 0))
+  {
+    return target;
+  }
+
+  // id3lib keeps both kinds of utf-16 text in big-endian order, without a BOM
+  bool fromUnicode = ID3TE_IS_DOUBLE_BYTE_ENC(sourceEnc);
+  bool toUnicode = ID3TE_IS_DOUBLE_BYTE_ENC(targetEnc);
+  size_t size = data.size();
+  if (fromUnicode && toUnicode)
+  {
+    target = data;
+  }
+  else if (fromUnicode)
+  {
+    // a utf-16 character (or surrogate pair) is never more than half as long
+    // again in utf-8
+    target.resize(size / 2 * 3);
+    size = (targetEnc == ID3TE_UTF8)
+      ? utf16BEToUTF8(data.data(), size, &target[0])
+      : utf16BEToLatin1(data.data(), size, &target[0]);
+    target.resize(size);
+  }
+  else if (toUnicode)
+  {
+    target.resize(size * 2);
+    size = (sourceEnc == ID3TE_UTF8)
+      ? utf8ToUTF16BE(data.data(), size, &target[0])
+      : latin1ToUTF16BE(data.data(), size, &target[0]);
+    target.resize(size);
+  }
+  else
+  {
+    target.resize(size * 2);
+    size = (sourceEnc == ID3TE_UTF8)
+      ? utf8ToLatin1(data.data(), size, &target[0])
+      : latin1ToUTF8(data.data(), size, &target[0]);
+    target.resize(size);
   }
   return target;
 }